@@ -0,0 +1,139 @@
+// Standard library:
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/program_options.hpp>
+// - Google Benchmark:
+#include <benchmark/benchmark.h>
+
+// This project:
+#include "bench_data.h"
+
+int
+main(int argc_, char** argv_)
+{
+  int error_code = EXIT_SUCCESS;
+  try {
+    snfee::bench::synthetic_generator::config_type generator_config;
+    std::string work_dir = "/tmp/snfee_bench";
+
+    // clang-format off
+    // Parse options:
+    namespace po = boost::program_options;
+    po::options_description opts("Allowed options");
+    opts.add_options()
+
+      ("help,h", "produce help message")
+
+      ("work-dir,W",
+       po::value<std::string>(&work_dir)
+       ->value_name("path")
+       ->default_value(work_dir),
+       "set the directory of the generated input files")
+
+      ("seed,s",
+       po::value<uint32_t>(&generator_config.seed)
+       ->value_name("number")
+       ->default_value(generator_config.seed),
+       "set the seed of the synthetic data generator")
+
+      ("triggers,n",
+       po::value<std::size_t>(&generator_config.number_of_triggers)
+       ->value_name("number")
+       ->default_value(generator_config.number_of_triggers),
+       "set the number of generated triggers")
+
+      ("trigger-rate,r",
+       po::value<double>(&generator_config.trigger_rate)
+       ->value_name("hertz")
+       ->default_value(generator_config.trigger_rate),
+       "set the rate of the generated triggers")
+
+      ("calo-hits",
+       po::value<double>(&generator_config.mean_calo_hits)
+       ->value_name("number")
+       ->default_value(generator_config.mean_calo_hits),
+       "set the mean number of calorimeter hits per trigger")
+
+      ("tracker-cells",
+       po::value<double>(&generator_config.mean_tracker_cells)
+       ->value_name("number")
+       ->default_value(generator_config.mean_tracker_cells),
+       "set the mean number of fired tracker cells per trigger")
+
+      ("waveform-samples",
+       po::value<uint16_t>(&generator_config.waveform_number_of_samples)
+       ->value_name("number")
+       ->default_value(generator_config.waveform_number_of_samples),
+       "set the number of waveform samples per calorimeter hit")
+
+      ; // end of options description
+    // clang-format on
+
+    // Describe command line arguments :
+    // The unregistered options are the ones of Google Benchmark:
+    po::variables_map vm;
+    po::parsed_options parsed = po::command_line_parser(argc_, argv_)
+                                  .options(opts)
+                                  .allow_unregistered()
+                                  .run();
+    po::store(parsed, vm);
+    po::notify(vm);
+    std::vector<std::string> bench_args =
+      po::collect_unrecognized(parsed.options, po::include_positional);
+
+    // Use command line arguments :
+    if (vm.count("help")) {
+      std::cout << "snfee-bench : "
+                << "Run the performance benchmarks on synthetic raw data"
+                << std::endl
+                << std::endl;
+      std::cout << "Usage : " << std::endl << std::endl;
+      std::cout << "  snfee-bench [OPTIONS]" << std::endl << std::endl;
+      std::cout << opts << std::endl;
+      std::cout << "All the options of Google Benchmark are also accepted "
+                << "(see --benchmark_help)." << std::endl
+                << std::endl;
+      std::cout << "Example : " << std::endl << std::endl;
+      std::cout << "  snfee-bench \\\n";
+      std::cout << "    --benchmark_filter=\"crd_parse|rtd_build\" \\\n";
+      std::cout << "    --triggers 5000 \\\n";
+      std::cout << "    --benchmark_format=csv > bench.csv\n";
+      std::cout << std::endl;
+      return (-1);
+    }
+
+    snfee::bench::bench_data::instance().configure(generator_config,
+                                                   work_dir);
+
+    // Run the benchmarks:
+    std::vector<char*> bench_argv;
+    bench_argv.push_back(argv_[0]);
+    for (std::string& arg : bench_args) {
+      bench_argv.push_back(&arg[0]);
+    }
+    int bench_argc = bench_argv.size();
+    bench_argv.push_back(nullptr);
+    benchmark::Initialize(&bench_argc, bench_argv.data());
+    if (benchmark::ReportUnrecognizedArguments(bench_argc,
+                                               bench_argv.data())) {
+      return (EXIT_FAILURE);
+    }
+    benchmark::RunSpecifiedBenchmarks();
+  }
+  catch (std::exception& x) {
+    std::cerr << "error: " << x.what() << std::endl;
+    error_code = EXIT_FAILURE;
+  }
+  catch (...) {
+    std::cerr << "error: "
+              << "unexpected error!" << std::endl;
+    error_code = EXIT_FAILURE;
+  }
+  return (error_code);
+}
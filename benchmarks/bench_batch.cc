@@ -0,0 +1,236 @@
+// benchmarks/bench_batch.cc
+//
+// Benchmarks of the columnar batch of RTD records compared to the RTD
+// records themselves (argument 0: records, 1: batch).
+
+// Standard library:
+#include <memory>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+// - Google Benchmark:
+#include <benchmark/benchmark.h>
+
+// This project:
+#include <snfee/data/RRawTriggerData.h>
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/data/rtdReformater.h>
+#include <snfee/data/rtd_batch.h>
+
+#include "bench_data.h"
+#include "rtd2root_data.h"
+
+namespace {
+
+  /// Minimum peak amplitude (in absolute value) of a selected channel
+  const int16_t SELECTION_MIN_PEAK = 100;
+
+  //! Return the "online" RTD records of all the triggers
+  const std::vector<snfee::data::raw_trigger_data>&
+  get_records()
+  {
+    static std::unique_ptr<std::vector<snfee::data::raw_trigger_data>>
+      records;
+    if (!records) {
+      snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+      records.reset(new std::vector<snfee::data::raw_trigger_data>);
+      records->reserve(data.get_triggers().size());
+      for (const auto& trigger_data : data.get_triggers()) {
+        records->emplace_back();
+        snfee::data::raw_trigger_data& rtd = records->back();
+        rtd.set_run_id(data.get_generator_config().run_id);
+        rtd.set_trigger_id(trigger_data.trig.get_trigger_id());
+        rtd.set_trig(
+          std::make_shared<snfee::data::trigger_record>(trigger_data.trig));
+        for (const auto& calo_hit : trigger_data.calo_hits) {
+          rtd.append_calo_hit(
+            std::make_shared<snfee::data::calo_hit_record>(calo_hit));
+        }
+        for (const auto& tracker_hit : trigger_data.tracker_hits) {
+          rtd.append_tracker_hit(
+            std::make_shared<snfee::data::tracker_hit_record>(tracker_hit));
+        }
+      }
+    }
+    return *records;
+  }
+
+  //! Return the batch of all the triggers
+  const snfee::data::rtd_batch&
+  get_batch()
+  {
+    static std::unique_ptr<snfee::data::rtd_batch> batch;
+    if (!batch) {
+      batch.reset(new snfee::data::rtd_batch);
+      for (const auto& rtd : get_records()) {
+        batch->append(rtd);
+      }
+    }
+    return *batch;
+  }
+
+  //! Return the number of hits of all the triggers
+  std::size_t
+  number_of_hits()
+  {
+    const snfee::data::rtd_batch& batch = get_batch();
+    return batch.get_number_of_calo_hits() +
+           batch.get_number_of_tracker_hits();
+  }
+
+  //! Sum the charges of the calorimeter channels above threshold and
+  //! count the anode tracker hits, on the records
+  int64_t
+  select_and_sum(const std::vector<snfee::data::raw_trigger_data>& records_)
+  {
+    int64_t sum = 0;
+    for (const auto& rtd : records_) {
+      for (const auto& hchit : rtd.get_calo_hits()) {
+        for (uint16_t ichannel = 0; ichannel < 2; ichannel++) {
+          const snfee::data::calo_hit_record::channel_data_record& ch =
+            hchit->get_channel_data(ichannel);
+          if (ch.is_ht() and
+              (ch.get_peak() <= -SELECTION_MIN_PEAK or
+               ch.get_peak() >= SELECTION_MIN_PEAK)) {
+            sum += ch.get_charge();
+          }
+        }
+      }
+      for (const auto& hthit : rtd.get_tracker_hits()) {
+        if (hthit->get_channel_category() ==
+            snfee::data::tracker_hit_record::CHANNEL_ANODE) {
+          sum++;
+        }
+      }
+    }
+    return sum;
+  }
+
+  //! Same as above on the columns of a batch
+  int64_t
+  select_and_sum(const snfee::data::rtd_batch& batch_)
+  {
+    int64_t sum = 0;
+    const std::size_t nb_calo = batch_.get_number_of_calo_hits();
+    for (uint16_t ichannel = 0; ichannel < 2; ichannel++) {
+      const snfee::data::rtd_batch::calo_channel_columns& ch =
+        batch_.calo_channels[ichannel];
+      const uint8_t* ht = ch.ht.data();
+      const int16_t* peak = ch.peak.data();
+      const int32_t* charge = ch.charge.data();
+      for (std::size_t ihit = 0; ihit < nb_calo; ihit++) {
+        const bool selected =
+          ht[ihit] and (peak[ihit] <= -SELECTION_MIN_PEAK or
+                        peak[ihit] >= SELECTION_MIN_PEAK);
+        sum += selected ? charge[ihit] : 0;
+      }
+    }
+    const std::size_t nb_tracker = batch_.get_number_of_tracker_hits();
+    const int16_t* category = batch_.tracker_channel_category.data();
+    for (std::size_t ihit = 0; ihit < nb_tracker; ihit++) {
+      sum += category[ihit] == snfee::data::tracker_hit_record::CHANNEL_ANODE;
+    }
+    return sum;
+  }
+
+  //! Fill a batch from the "online" (0) or "offline" (1) RTD records
+  void
+  bench_rtd_batch_build(benchmark::State& state_)
+  {
+    const std::vector<snfee::data::raw_trigger_data>& records =
+      get_records();
+    std::vector<snfee::data::RRawTriggerData> offline_records;
+    if (state_.range(0) == 1) {
+      offline_records.reserve(records.size());
+      for (const auto& rtd : records) {
+        offline_records.push_back(snfee::data::rtdOnlineToOffline(rtd));
+      }
+    }
+    snfee::data::rtd_batch batch;
+    for (auto _ : state_) {
+      batch.clear();
+      if (state_.range(0) == 1) {
+        for (const auto& rtd : offline_records) {
+          batch.append(rtd);
+        }
+      } else {
+        for (const auto& rtd : records) {
+          batch.append(rtd);
+        }
+      }
+    }
+    state_.SetItemsProcessed(state_.iterations() * number_of_hits());
+    state_.SetLabel(state_.range(0) == 1 ? "RRawTriggerData"
+                                           : "raw_trigger_data");
+    return;
+  }
+
+  //! Select hits and sum their charges
+  void
+  bench_rtd_select_sum(benchmark::State& state_)
+  {
+    const std::vector<snfee::data::raw_trigger_data>& records =
+      get_records();
+    const snfee::data::rtd_batch& batch = get_batch();
+    const int64_t expected = select_and_sum(records);
+    DT_THROW_IF(select_and_sum(batch) != expected,
+                std::logic_error,
+                "Batch and records selections differ!");
+    int64_t sum = 0;
+    for (auto _ : state_) {
+      if (state_.range(0) == 1) {
+        sum += select_and_sum(batch);
+      } else {
+        sum += select_and_sum(records);
+      }
+    }
+    DT_THROW_IF(sum != expected * int64_t(state_.iterations()),
+                std::logic_error,
+                "Unexpected selection result!");
+    state_.SetItemsProcessed(state_.iterations() * number_of_hits());
+    state_.SetLabel(state_.range(0) == 1 ? "batch" : "records");
+    return;
+  }
+
+  //! Export the events to the flat data of the Root tree of rtd2root
+  void
+  bench_rtd_batch_root_data_export(benchmark::State& state_)
+  {
+    const std::vector<snfee::data::raw_trigger_data>& records =
+      get_records();
+    const snfee::data::rtd_batch& batch = get_batch();
+    std::unique_ptr<snfee::data::rtd2root_data> data(
+      new snfee::data::rtd2root_data);
+    for (auto _ : state_) {
+      if (state_.range(0) == 1) {
+        for (std::size_t ievent = 0; ievent < batch.size(); ievent++) {
+          snfee::data::rtd2root_data::export_to_root(batch, ievent, *data);
+        }
+      } else {
+        for (const auto& rtd : records) {
+          snfee::data::rtd2root_data::export_to_root(rtd, *data);
+        }
+      }
+    }
+    state_.SetItemsProcessed(state_.iterations() * records.size());
+    state_.SetLabel(state_.range(0) == 1 ? "batch" : "records");
+    return;
+  }
+
+} // namespace
+
+BENCHMARK(bench_rtd_batch_build)
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMicrosecond);
+BENCHMARK(bench_rtd_select_sum)
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMicrosecond);
+BENCHMARK(bench_rtd_batch_root_data_export)
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,445 @@
+// benchmarks/bench_building.cc
+//
+// Benchmarks of the building of RTD records from RHD files (rhd2rtd) and
+// of their export to Root files (rtd2root).
+
+// Standard library:
+#include <map>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/filesystem.hpp>
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+// - Google Benchmark:
+#include <benchmark/benchmark.h>
+// - Root:
+#include <TFile.h>
+#include <TTree.h>
+
+// This project:
+#include <snfee/model/utils.h>
+
+#include "bench_data.h"
+#include "builder.h"
+#include "builder_config.h"
+#include "rtd2root_converter.h"
+
+namespace {
+
+  /// Number of samples of the former fixed-size waveform branches of the
+  /// Root export ([nb_calo_hits][1024] per channel)
+  const std::size_t FIXED_WAVEFORM_NUMBER_OF_SAMPLES = 1024;
+
+  //! Return the configuration of the builder of the RTD records from a
+  //! calorimeter and a tracker RHD file
+  snfee::rtdb::builder_config
+  make_builder_config(const std::string& rtd_path_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    const int32_t crate_id = data.get_generator_config().crate_num;
+    snfee::rtdb::builder_config builder_config;
+    builder_config.set_run_id(data.get_generator_config().run_id);
+    builder_config.add_input_config(
+      "CaloCrate" + std::to_string(crate_id),
+      snfee::model::CRATE_CALORIMETER,
+      crate_id,
+      std::vector<std::string>{data.get_calo_rhd().path});
+    builder_config.add_input_config(
+      "TrackerCrate" + std::to_string(crate_id),
+      snfee::model::CRATE_TRACKER,
+      crate_id,
+      std::vector<std::string>{data.get_tracker_rhd().path});
+    builder_config.set_output_config(
+      "RTD", std::vector<std::string>{rtd_path_}, 0, 0);
+    return builder_config;
+  }
+
+  //! Build the RTD records with a given builder configuration
+  void
+  run_rtd_build(benchmark::State& state_,
+                const snfee::rtdb::builder_config& builder_config_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    const snfee::bench::bench_data::input_file_type& calo_rhd =
+      data.get_calo_rhd();
+    const snfee::bench::bench_data::input_file_type& tracker_rhd =
+      data.get_tracker_rhd();
+    snfee::rtdb::builder_config::check(builder_config_);
+    std::size_t nallocations = 0;
+    double cpu_time = 0.0;
+    double wall_time = 0.0;
+    for (auto _ : state_) {
+      snfee::rtdb::builder rtd_builder;
+      rtd_builder.set_config(builder_config_);
+      rtd_builder.initialize();
+      rtd_builder.run();
+      rtd_builder.terminate();
+      state_.PauseTiming();
+      for (const auto& pool_results : rtd_builder.get_pool_results()) {
+        nallocations += pool_results.object_allocations;
+      }
+      cpu_time += rtd_builder.get_timing_results().cpu_time;
+      wall_time += rtd_builder.get_timing_results().wall_time;
+      for (const std::string& rtd_path :
+           builder_config_.get_output_config().filenames) {
+        boost::filesystem::remove(rtd_path);
+      }
+      state_.ResumeTiming();
+    }
+    state_.SetItemsProcessed(
+      state_.iterations() *
+      (calo_rhd.summary.calo_hits + tracker_rhd.summary.tracker_hits));
+    state_.SetBytesProcessed(state_.iterations() *
+                             (calo_rhd.summary.bytes +
+                              tracker_rhd.summary.bytes));
+    state_.counters["allocations"] = benchmark::Counter(
+      nallocations, benchmark::Counter::kAvgIterations);
+    // CPU time of all the threads of the builder, which idle threads should
+    // not consume:
+    state_.counters["cpu_s"] =
+      benchmark::Counter(cpu_time, benchmark::Counter::kAvgIterations);
+    state_.counters["cpu/wall"] = wall_time > 0.0 ? cpu_time / wall_time : 0.0;
+    return;
+  }
+
+  //! Build the RTD records from a calorimeter and a tracker RHD file
+  void
+  bench_rtd_build(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    run_rtd_build(
+      state_, make_builder_config(data.make_path("snfee_bench_build.data.gz")));
+    return;
+  }
+
+  //! Build the RTD records, encoding the output files on a given number of
+  //! threads (one output file per block of records)
+  void
+  bench_rtd_build_encoders(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    const std::size_t nb_files = 8;
+    std::vector<std::string> rtd_paths;
+    for (std::size_t ifile = 0; ifile < nb_files; ifile++) {
+      rtd_paths.push_back(data.make_path(
+        "snfee_bench_build_" + std::to_string(ifile) + ".data.gz"));
+    }
+    snfee::rtdb::builder_config builder_config =
+      make_builder_config(rtd_paths.front());
+    const std::size_t nb_triggers =
+      data.get_generator_config().number_of_triggers;
+    builder_config.set_output_config(
+      "RTD", rtd_paths, (nb_triggers + nb_files - 1) / nb_files, 0);
+    builder_config.output_config.number_of_encoders = state_.range(0);
+    run_rtd_build(state_, builder_config);
+    return;
+  }
+
+  //! Build the RTD records, decoding the inputs ahead with a given prefetch
+  //! depth (0: no prefetch)
+  void
+  bench_rtd_build_prefetch(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    snfee::rtdb::builder_config builder_config =
+      make_builder_config(data.make_path("snfee_bench_build.data.gz"));
+    builder_config.input_prefetch_depth = state_.range(0);
+    run_rtd_build(state_, builder_config);
+    return;
+  }
+
+  //! Build the RTD records, recycling the records through pools of a given
+  //! capacity (0: no recycling)
+  void
+  bench_rtd_build_record_pool(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    snfee::rtdb::builder_config builder_config =
+      make_builder_config(data.make_path("snfee_bench_build.data.gz"));
+    builder_config.record_pool_capacity = state_.range(0);
+    run_rtd_build(state_, builder_config);
+    return;
+  }
+
+  //! Build the RTD records, sorting the inputs with an external sort of a
+  //! given memory cap (MB, 0: no sort)
+  void
+  bench_rtd_build_sorted_inputs(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    snfee::rtdb::builder_config builder_config =
+      make_builder_config(data.make_path("snfee_bench_build.data.gz"));
+    builder_config.input_sort_memory_size = state_.range(0) * 1024 * 1024;
+    run_rtd_build(state_, builder_config);
+    return;
+  }
+
+  //! Export the RTD records to a Root file with a given number of threads,
+  //! merging the trees of the threads (ordered: 0) or filling a single tree
+  //! in the input order (ordered: 1)
+  void
+  bench_rtd_root_export(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    const snfee::bench::bench_data::input_file_type& rtd = data.get_rtd();
+    snfee::io::rtd2root_converter::config_type converter_config;
+    converter_config.input_rtd_filenames.push_back(rtd.path);
+    converter_config.output_root_filename =
+      data.make_path("snfee_bench_rtd.root");
+    converter_config.number_of_threads = state_.range(0);
+    converter_config.preserve_order = state_.range(1) == 1;
+    for (auto _ : state_) {
+      snfee::io::rtd2root_converter converter;
+      converter.set_config(converter_config);
+      converter.initialize();
+      converter.run();
+      converter.terminate();
+      state_.PauseTiming();
+      boost::filesystem::remove(converter_config.output_root_filename);
+      state_.ResumeTiming();
+    }
+    state_.SetItemsProcessed(state_.iterations() * rtd.summary.triggers);
+    state_.SetBytesProcessed(state_.iterations() * rtd.summary.bytes);
+    if (converter_config.number_of_threads == 1) {
+      state_.SetLabel("sequential");
+    } else {
+      state_.SetLabel(converter_config.preserve_order ? "ordered"
+                                                      : "TBufferMerger");
+    }
+    return;
+  }
+
+  //! Return the RTD file of the triggers with a given number of waveform
+  //! samples per calorimeter hit, written on first use
+  const snfee::bench::bench_data::input_file_type&
+  get_waveforms_rtd(const uint16_t nb_samples_)
+  {
+    static std::map<uint16_t, snfee::bench::bench_data::input_file_type>
+      rtds;
+    auto found = rtds.find(nb_samples_);
+    if (found == rtds.end()) {
+      snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+      snfee::bench::synthetic_generator::config_type config =
+        data.get_generator_config();
+      config.waveform_number_of_samples = nb_samples_;
+      snfee::bench::bench_data::input_file_type rtd;
+      rtd.path = data.make_path("snfee_bench_rtd_waveforms-" +
+                                std::to_string(nb_samples_) + ".data.gz");
+      snfee::bench::synthetic_generator generator(config);
+      rtd.summary = generator.write_rtd(rtd.path);
+      found = rtds.emplace(nb_samples_, rtd).first;
+    }
+    return found->second;
+  }
+
+  //! Export to a Root file the RTD records with a given number of waveform
+  //! samples per calorimeter hit, and compare the size of the waveforms
+  //! with the one of the former fixed-size waveform branches
+  void
+  bench_rtd_root_waveforms(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    const uint16_t nb_samples = state_.range(0);
+    const snfee::bench::bench_data::input_file_type& rtd =
+      get_waveforms_rtd(nb_samples);
+    snfee::io::rtd2root_converter::config_type converter_config;
+    converter_config.input_rtd_filenames.push_back(rtd.path);
+    converter_config.output_root_filename =
+      data.make_path("snfee_bench_rtd_waveforms.root");
+    std::size_t file_size = 0;
+    for (auto _ : state_) {
+      snfee::io::rtd2root_converter converter;
+      converter.set_config(converter_config);
+      converter.initialize();
+      converter.run();
+      converter.terminate();
+      state_.PauseTiming();
+      file_size =
+        boost::filesystem::file_size(converter_config.output_root_filename);
+      boost::filesystem::remove(converter_config.output_root_filename);
+      state_.ResumeTiming();
+    }
+    state_.SetItemsProcessed(state_.iterations() * rtd.summary.triggers);
+    state_.SetBytesProcessed(state_.iterations() * rtd.summary.bytes);
+    // Bytes per RTD record (both channels of all the calorimeter hits for
+    // the waveforms):
+    const double nb_rtds = rtd.summary.triggers;
+    const double hit_samples_size = 2 * sizeof(int16_t) * rtd.summary.calo_hits;
+    state_.counters["file_B/RTD"] = file_size / nb_rtds;
+    state_.counters["waveforms_B/RTD"] =
+      hit_samples_size * nb_samples / nb_rtds;
+    state_.counters["fixed_waveforms_B/RTD"] =
+      hit_samples_size * FIXED_WAVEFORM_NUMBER_OF_SAMPLES / nb_rtds;
+    return;
+  }
+
+  //! Return the Root output tuning of a compression (algorithm, level)
+  snfee::io::root_output_config
+  make_root_output(const benchmark::State& state_)
+  {
+    snfee::io::root_output_config root_output;
+    root_output.compression.algorithm =
+      static_cast<snfee::io::root_output_config::compression_algorithm_type>(
+        state_.range(0));
+    root_output.compression.level = state_.range(1);
+    return root_output;
+  }
+
+  //! Export the RTD records to a Root file with a given compression
+  void
+  bench_rtd_root_compression_write(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    const snfee::bench::bench_data::input_file_type& rtd = data.get_rtd();
+    snfee::io::rtd2root_converter::config_type converter_config;
+    converter_config.input_rtd_filenames.push_back(rtd.path);
+    converter_config.output_root_filename =
+      data.make_path("snfee_bench_rtd_compression.root");
+    converter_config.root_output = make_root_output(state_);
+    std::size_t file_size = 0;
+    for (auto _ : state_) {
+      snfee::io::rtd2root_converter converter;
+      converter.set_config(converter_config);
+      converter.initialize();
+      converter.run();
+      converter.terminate();
+      state_.PauseTiming();
+      file_size =
+        boost::filesystem::file_size(converter_config.output_root_filename);
+      boost::filesystem::remove(converter_config.output_root_filename);
+      state_.ResumeTiming();
+    }
+    state_.SetItemsProcessed(state_.iterations() * rtd.summary.triggers);
+    state_.SetBytesProcessed(state_.iterations() * rtd.summary.bytes);
+    state_.counters["file_MB"] = file_size / (1024.0 * 1024.0);
+    state_.SetLabel(converter_config.root_output.compression.to_string());
+    return;
+  }
+
+  //! Read all the entries of a Root file written with a given compression
+  void
+  bench_rtd_root_compression_read(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    const snfee::bench::bench_data::input_file_type& rtd = data.get_rtd();
+    snfee::io::rtd2root_converter::config_type converter_config;
+    converter_config.input_rtd_filenames.push_back(rtd.path);
+    converter_config.output_root_filename =
+      data.make_path("snfee_bench_rtd_compression.root");
+    converter_config.root_output = make_root_output(state_);
+    {
+      snfee::io::rtd2root_converter converter;
+      converter.set_config(converter_config);
+      converter.initialize();
+      converter.run();
+      converter.terminate();
+    }
+    const std::string& root_path = converter_config.output_root_filename;
+    const std::size_t file_size = boost::filesystem::file_size(root_path);
+    std::size_t nentries = 0;
+    for (auto _ : state_) {
+      TFile root_file(root_path.c_str(), "READ");
+      TTree* tree = dynamic_cast<TTree*>(root_file.Get("RTD"));
+      DT_THROW_IF(tree == nullptr,
+                  std::logic_error,
+                  "No RTD tree in '" << root_path << "'!");
+      // All the branches, read in the buffers allocated by Root:
+      for (Long64_t ientry = 0; ientry < tree->GetEntries(); ientry++) {
+        benchmark::DoNotOptimize(tree->GetEntry(ientry));
+        nentries++;
+      }
+    }
+    boost::filesystem::remove(root_path);
+    DT_THROW_IF(nentries != state_.iterations() * rtd.summary.triggers,
+                std::logic_error,
+                "Unexpected number of Root entries!");
+    state_.SetItemsProcessed(nentries);
+    state_.SetBytesProcessed(state_.iterations() * rtd.summary.bytes);
+    state_.counters["file_MB"] = file_size / (1024.0 * 1024.0);
+    state_.SetLabel(converter_config.root_output.compression.to_string());
+    return;
+  }
+
+  //! Set the compressions (algorithm, level) of the Root export
+  void
+  root_compressions(benchmark::internal::Benchmark* bench_)
+  {
+    bench_->Args({snfee::io::root_output_config::COMPRESSION_NONE, 0});
+    for (int algorithm = snfee::io::root_output_config::COMPRESSION_ZLIB;
+         algorithm <= snfee::io::root_output_config::COMPRESSION_ZSTD;
+         algorithm++) {
+      for (int level : {1, 5, 9}) {
+        bench_->Args({algorithm, level});
+      }
+    }
+    return;
+  }
+
+  //! Set the numbers of threads of the Root export, in both modes beyond
+  //! one thread
+  void
+  root_export_threads(benchmark::internal::Benchmark* bench_)
+  {
+    bench_->Args({1, 0});
+    for (int nb_threads = 2; nb_threads <= 8; nb_threads *= 2) {
+      bench_->Args({nb_threads, 0});
+      bench_->Args({nb_threads, 1});
+    }
+    return;
+  }
+
+} // namespace
+
+// The builder runs its stages in threads which are not seen by the CPU time
+// of the main thread:
+BENCHMARK(bench_rtd_build)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(bench_rtd_build_encoders)
+  ->ArgName("encoders")
+  ->Arg(1)
+  ->Arg(2)
+  ->Arg(4)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+BENCHMARK(bench_rtd_build_prefetch)
+  ->ArgName("depth")
+  ->Arg(0)
+  ->Arg(16)
+  ->Arg(256)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+BENCHMARK(bench_rtd_build_record_pool)
+  ->ArgName("capacity")
+  ->Arg(0)
+  ->Arg(snfee::rtdb::builder_config::DEFAULT_RECORD_POOL_CAPACITY)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+BENCHMARK(bench_rtd_build_sorted_inputs)
+  ->ArgName("memory_MB")
+  ->Arg(0)
+  ->Arg(4)
+  ->Arg(64)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+BENCHMARK(bench_rtd_root_export)
+  ->ArgNames({"threads", "ordered"})
+  ->Apply(root_export_threads)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+BENCHMARK(bench_rtd_root_waveforms)
+  ->ArgName("samples")
+  ->Arg(0)
+  ->Arg(64)
+  ->Arg(256)
+  ->Arg(1024)
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK(bench_rtd_root_compression_write)
+  ->ArgNames({"algorithm", "level"})
+  ->Apply(root_compressions)
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK(bench_rtd_root_compression_read)
+  ->ArgNames({"algorithm", "level"})
+  ->Apply(root_compressions)
+  ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,104 @@
+// benchmarks/bench_codec.cc
+//
+// Benchmarks of the packing of the two-channel 12-bit ADC samples of the
+// calorimeter waveforms (adc12_codec) with each instruction set (argument
+// 0: scalar, 1: SSSE3, 2: AVX2), as done by the serialization of the
+// calorimeter hits.
+
+// Standard library:
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Third party:
+// - Google Benchmark:
+#include <benchmark/benchmark.h>
+
+// This project:
+#include <snfee/data/adc12_codec.h>
+
+namespace {
+
+  /// Seed of the ADC values
+  const uint32_t ADC_SEED = 4096;
+
+  //! Fill the ADC values of both channels with random 12-bit values
+  void
+  make_samples(const std::size_t nb_samples_,
+               std::vector<uint16_t>& adc0_,
+               std::vector<uint16_t>& adc1_)
+  {
+    std::mt19937 random(ADC_SEED);
+    std::uniform_int_distribution<int> adc(0, 4095);
+    adc0_.resize(nb_samples_);
+    adc1_.resize(nb_samples_);
+    for (std::size_t i = 0; i < nb_samples_; i++) {
+      adc0_[i] = adc(random);
+      adc1_[i] = adc(random);
+    }
+    return;
+  }
+
+  //! Pack a waveform with a given instruction set and number of samples
+  void
+  bench_adc12_pack(benchmark::State& state_)
+  {
+    const snfee::data::adc12_codec::isa_type isa =
+      static_cast<snfee::data::adc12_codec::isa_type>(state_.range(0));
+    if (isa > snfee::data::adc12_codec::best_isa()) {
+      state_.SkipWithError("Instruction set not supported by the CPU");
+      return;
+    }
+    const snfee::data::adc12_codec codec(isa);
+    const std::size_t nb_samples = state_.range(1);
+    std::vector<uint16_t> adc0;
+    std::vector<uint16_t> adc1;
+    make_samples(nb_samples, adc0, adc1);
+    std::vector<char> packed(
+      snfee::data::adc12_codec::PACKED_SAMPLE_SIZE * nb_samples);
+    for (auto _ : state_) {
+      codec.pack(adc0.data(), adc1.data(), nb_samples, packed.data());
+      benchmark::ClobberMemory();
+    }
+    state_.SetItemsProcessed(state_.iterations() * nb_samples);
+    state_.SetBytesProcessed(state_.iterations() * packed.size());
+    state_.SetLabel(snfee::data::adc12_codec::isa_label(isa));
+    return;
+  }
+
+  //! Unpack a waveform with a given instruction set and number of samples
+  void
+  bench_adc12_unpack(benchmark::State& state_)
+  {
+    const snfee::data::adc12_codec::isa_type isa =
+      static_cast<snfee::data::adc12_codec::isa_type>(state_.range(0));
+    if (isa > snfee::data::adc12_codec::best_isa()) {
+      state_.SkipWithError("Instruction set not supported by the CPU");
+      return;
+    }
+    const snfee::data::adc12_codec codec(isa);
+    const std::size_t nb_samples = state_.range(1);
+    std::vector<uint16_t> adc0;
+    std::vector<uint16_t> adc1;
+    make_samples(nb_samples, adc0, adc1);
+    std::vector<char> packed(
+      snfee::data::adc12_codec::PACKED_SAMPLE_SIZE * nb_samples);
+    codec.pack(adc0.data(), adc1.data(), nb_samples, packed.data());
+    for (auto _ : state_) {
+      codec.unpack(packed.data(), nb_samples, adc0.data(), adc1.data());
+      benchmark::ClobberMemory();
+    }
+    state_.SetItemsProcessed(state_.iterations() * nb_samples);
+    state_.SetBytesProcessed(state_.iterations() * packed.size());
+    state_.SetLabel(snfee::data::adc12_codec::isa_label(isa));
+    return;
+  }
+
+} // namespace
+
+BENCHMARK(bench_adc12_pack)
+  ->ArgNames({"isa", "samples"})
+  ->ArgsProduct({{0, 1, 2}, {64, 1024}});
+BENCHMARK(bench_adc12_unpack)
+  ->ArgNames({"isa", "samples"})
+  ->ArgsProduct({{0, 1, 2}, {64, 1024}});
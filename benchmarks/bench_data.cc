@@ -0,0 +1,161 @@
+// benchmarks/bench_data.cc
+
+// Ourselves:
+#include "bench_data.h"
+
+// Standard library:
+#include <iostream>
+
+// Third party:
+// - Boost:
+#include <boost/filesystem.hpp>
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/utils.h>
+
+// This project:
+#include <snfee/io/native_format.h>
+
+namespace snfee {
+  namespace bench {
+
+    namespace {
+
+      //! Print the contents of a generated file
+      void
+      log_generated(const bench_data::input_file_type& file_)
+      {
+        std::clog << "Generated '" << file_.path
+                  << "' : " << file_.summary.triggers << " triggers, "
+                  << file_.summary.calo_hits << " calo hits, "
+                  << file_.summary.tracker_hits << " tracker hits, "
+                  << file_.summary.bytes << " bytes" << std::endl;
+        return;
+      }
+
+    } // namespace
+
+    bench_data&
+    bench_data::instance()
+    {
+      static bench_data _instance;
+      return _instance;
+    }
+
+    void
+    bench_data::configure(const synthetic_generator::config_type& cfg_,
+                          const std::string& work_dir_)
+    {
+      _config_ = cfg_;
+      _work_dir_ = work_dir_;
+      datatools::fetch_path_with_env(_work_dir_);
+      boost::filesystem::create_directories(_work_dir_);
+      _crd_.reset();
+      for (int iformat = 0; iformat < 2; iformat++) {
+        _calo_rhd_[iformat].reset();
+        _tracker_rhd_[iformat].reset();
+        _rtd_[iformat].reset();
+      }
+      _triggers_.reset();
+      return;
+    }
+
+    const synthetic_generator::config_type&
+    bench_data::get_generator_config() const
+    {
+      return _config_;
+    }
+
+    std::string
+    bench_data::make_path(const std::string& name_) const
+    {
+      return _work_dir_ + "/" + name_;
+    }
+
+    std::string
+    bench_data::file_extension(const file_format_type format_)
+    {
+      if (format_ == FORMAT_NATIVE) {
+        return snfee::io::native_format::file_extension();
+      }
+      return ".data.gz";
+    }
+
+    const bench_data::input_file_type&
+    bench_data::get_crd()
+    {
+      if (!_crd_) {
+        std::unique_ptr<input_file_type> crd(new input_file_type);
+        crd->path = make_path("snfee_bench_crate-" +
+                              std::to_string(_config_.crate_num) + ".crd");
+        synthetic_generator generator(_config_);
+        crd->summary = generator.write_crd(crd->path);
+        log_generated(*crd);
+        _crd_ = std::move(crd);
+      }
+      return *_crd_;
+    }
+
+    const bench_data::input_file_type&
+    bench_data::get_calo_rhd(const file_format_type format_)
+    {
+      std::unique_ptr<input_file_type>& calo_rhd = _calo_rhd_[format_];
+      if (!calo_rhd) {
+        std::unique_ptr<input_file_type> rhd(new input_file_type);
+        rhd->path = make_path("snfee_bench_calo_rhd" + file_extension(format_));
+        synthetic_generator generator(_config_);
+        rhd->summary = generator.write_rhd(rhd->path, "");
+        log_generated(*rhd);
+        calo_rhd = std::move(rhd);
+      }
+      return *calo_rhd;
+    }
+
+    const bench_data::input_file_type&
+    bench_data::get_tracker_rhd(const file_format_type format_)
+    {
+      std::unique_ptr<input_file_type>& tracker_rhd = _tracker_rhd_[format_];
+      if (!tracker_rhd) {
+        std::unique_ptr<input_file_type> rhd(new input_file_type);
+        rhd->path =
+          make_path("snfee_bench_tracker_rhd" + file_extension(format_));
+        synthetic_generator generator(_config_);
+        rhd->summary = generator.write_rhd("", rhd->path);
+        log_generated(*rhd);
+        tracker_rhd = std::move(rhd);
+      }
+      return *tracker_rhd;
+    }
+
+    const bench_data::input_file_type&
+    bench_data::get_rtd(const file_format_type format_)
+    {
+      std::unique_ptr<input_file_type>& rtd_file = _rtd_[format_];
+      if (!rtd_file) {
+        std::unique_ptr<input_file_type> rtd(new input_file_type);
+        rtd->path = make_path("snfee_bench_rtd" + file_extension(format_));
+        synthetic_generator generator(_config_);
+        rtd->summary = generator.write_rtd(rtd->path);
+        log_generated(*rtd);
+        rtd_file = std::move(rtd);
+      }
+      return *rtd_file;
+    }
+
+    const std::vector<synthetic_generator::trigger_data_type>&
+    bench_data::get_triggers()
+    {
+      if (!_triggers_) {
+        _triggers_.reset(
+          new std::vector<synthetic_generator::trigger_data_type>(
+            _config_.number_of_triggers));
+        synthetic_generator generator(_config_);
+        for (auto& trigger_data : *_triggers_) {
+          generator.generate_trigger(trigger_data);
+        }
+      }
+      return *_triggers_;
+    }
+
+  } // namespace bench
+} // namespace snfee
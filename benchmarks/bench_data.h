@@ -0,0 +1,96 @@
+//! \file benchmarks/bench_data.h
+//! \brief Synthetic input data shared by the benchmarks
+
+#ifndef SNFEE_BENCH_BENCH_DATA_H
+#define SNFEE_BENCH_BENCH_DATA_H
+
+// Standard library:
+#include <memory>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/utility.hpp>
+
+// This project:
+#include "synthetic_generator.h"
+
+namespace snfee {
+  namespace bench {
+
+    //! \brief Synthetic input data shared by the benchmarks
+    //!
+    //! The input files are generated in the working directory the first
+    //! time they are requested, so that only the data needed by the
+    //! selected benchmarks is produced.
+    class bench_data : private boost::noncopyable {
+    public:
+      /// \brief Format of the generated RHD and RTD files
+      enum file_format_type {
+        FORMAT_BOOST = 0, //!< Boost portable binary archives
+        FORMAT_NATIVE = 1 //!< Native binary format
+      };
+
+      /// \brief Generated input file
+      struct input_file_type {
+        std::string path;                      //!< Path of the file
+        synthetic_generator::summary_type summary; //!< Contents
+      };
+
+      //! Return the global instance
+      static bench_data& instance();
+
+      //! Set the generator configuration and the working directory
+      void configure(const synthetic_generator::config_type& cfg_,
+                     const std::string& work_dir_);
+
+      //! Return the generator configuration
+      const synthetic_generator::config_type& get_generator_config() const;
+
+      //! Return the path of a file in the working directory
+      std::string make_path(const std::string& name_) const;
+
+      //! Return the extension of the files of a given format
+      static std::string file_extension(const file_format_type format_);
+
+      //! Return the CRD text file
+      const input_file_type& get_crd();
+
+      //! Return the calorimeter RHD file
+      const input_file_type& get_calo_rhd(
+        const file_format_type format_ = FORMAT_BOOST);
+
+      //! Return the tracker RHD file
+      const input_file_type& get_tracker_rhd(
+        const file_format_type format_ = FORMAT_BOOST);
+
+      //! Return the RTD file
+      const input_file_type& get_rtd(
+        const file_format_type format_ = FORMAT_BOOST);
+
+      //! Return the records of all the triggers (kept in memory)
+      const std::vector<synthetic_generator::trigger_data_type>&
+      get_triggers();
+
+    private:
+      bench_data() = default;
+
+    private:
+      // Configuration:
+      synthetic_generator::config_type _config_;
+      std::string _work_dir_ = "/tmp";
+
+      // Working:
+      std::unique_ptr<input_file_type> _crd_;
+      std::unique_ptr<input_file_type> _calo_rhd_[2];    //!< Per format
+      std::unique_ptr<input_file_type> _tracker_rhd_[2]; //!< Per format
+      std::unique_ptr<input_file_type> _rtd_[2];         //!< Per format
+      std::unique_ptr<std::vector<synthetic_generator::trigger_data_type>>
+        _triggers_;
+    };
+
+  } // namespace bench
+} // namespace snfee
+
+#endif // SNFEE_BENCH_BENCH_DATA_H
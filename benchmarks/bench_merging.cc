@@ -0,0 +1,185 @@
+// benchmarks/bench_merging.cc
+//
+// Benchmarks of the selection of the next trigger ID by the merger of the
+// RTD builder (rhd2rtd_merger), on 7 synthetic input streams: the trigger
+// stream, 3 calorimeter crates and 3 tracker crates.
+
+// Standard library:
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+// Third party:
+// - Google Benchmark:
+#include <benchmark/benchmark.h>
+
+// This project:
+#include "bench_data.h"
+#include "trigger_id_tree.h"
+
+namespace {
+
+  /// Number of calorimeter crates
+  const std::size_t NUMBER_OF_CALO_CRATES = 3;
+
+  /// Number of tracker crates
+  const std::size_t NUMBER_OF_TRACKER_CRATES = 3;
+
+  /// Maximum number of records of a crate per trigger
+  const std::size_t MAX_RECORDS_PER_CRATE = 6;
+
+  /// \brief Input stream of the merger: sorted trigger IDs of its records
+  struct stream_type {
+    std::mutex mutex; //!< Lock of the stream (as a RHD buffer)
+    std::vector<int32_t> trigger_ids;
+    std::size_t front = 0;
+
+    bool
+    empty() const
+    {
+      return front == trigger_ids.size();
+    }
+  };
+
+  //! Return the trigger IDs of the records of the 7 streams
+  const std::vector<std::vector<int32_t>>&
+  get_stream_trigger_ids()
+  {
+    static std::unique_ptr<std::vector<std::vector<int32_t>>> streams;
+    if (!streams) {
+      const std::size_t ntriggers = snfee::bench::bench_data::instance()
+                                      .get_generator_config()
+                                      .number_of_triggers;
+      streams.reset(new std::vector<std::vector<int32_t>>(
+        1 + NUMBER_OF_CALO_CRATES + NUMBER_OF_TRACKER_CRATES));
+      std::mt19937 random(271828);
+      for (std::size_t itrig = 0; itrig < ntriggers; itrig++) {
+        const int32_t trigger_id = itrig;
+        (*streams)[0].push_back(trigger_id);
+        for (std::size_t istream = 1; istream < streams->size(); istream++) {
+          // Most triggers leave no hit in a given crate:
+          const std::size_t nrecords =
+            random() % 2 == 0 ? 0 : random() % (MAX_RECORDS_PER_CRATE + 1);
+          for (std::size_t irec = 0; irec < nrecords; irec++) {
+            (*streams)[istream].push_back(trigger_id);
+          }
+        }
+      }
+    }
+    return *streams;
+  }
+
+  //! Pop the records of a trigger from the front of a stream
+  std::size_t
+  pop_trigger(stream_type& stream_, const int32_t trigger_id_)
+  {
+    std::lock_guard<std::mutex> lock(stream_.mutex);
+    std::size_t nrecords = 0;
+    while (!stream_.empty() and
+           stream_.trigger_ids[stream_.front] == trigger_id_) {
+      stream_.front++;
+      nrecords++;
+    }
+    return nrecords;
+  }
+
+  //! Assemble the RTD records by locking and scanning every stream
+  std::size_t
+  merge_scan(std::vector<stream_type>& streams_)
+  {
+    std::size_t nrtd = 0;
+    while (true) {
+      bool found = false;
+      int32_t min_trigger_id = 0;
+      for (auto& stream : streams_) {
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        if (stream.empty()) {
+          continue;
+        }
+        const int32_t trigger_id = stream.trigger_ids[stream.front];
+        if (!found or trigger_id < min_trigger_id) {
+          min_trigger_id = trigger_id;
+          found = true;
+        }
+      }
+      if (!found) {
+        break;
+      }
+      std::size_t nrecords = 0;
+      for (auto& stream : streams_) {
+        nrecords += pop_trigger(stream, min_trigger_id);
+      }
+      benchmark::DoNotOptimize(nrecords);
+      nrtd++;
+    }
+    return nrtd;
+  }
+
+  //! Assemble the RTD records with the tournament tree of the streams
+  std::size_t
+  merge_tree(std::vector<stream_type>& streams_)
+  {
+    snfee::rtdb::trigger_id_tree tree(streams_.size());
+    for (std::size_t istream = 0; istream < streams_.size(); istream++) {
+      const stream_type& stream = streams_[istream];
+      if (!stream.empty()) {
+        tree.update(istream, stream.trigger_ids[stream.front]);
+      }
+    }
+    std::size_t nrtd = 0;
+    while (!tree.is_empty()) {
+      const int32_t trigger_id = tree.top_trig_id();
+      std::size_t nrecords = 0;
+      while (!tree.is_empty() and tree.top_trig_id() == trigger_id) {
+        const std::size_t istream = tree.top_stream();
+        stream_type& stream = streams_[istream];
+        nrecords += pop_trigger(stream, trigger_id);
+        if (stream.empty()) {
+          tree.remove(istream);
+        } else {
+          tree.update(istream, stream.trigger_ids[stream.front]);
+        }
+      }
+      benchmark::DoNotOptimize(nrecords);
+      nrtd++;
+    }
+    return nrtd;
+  }
+
+  //! Merge the streams by linear scan (0) or with the tournament tree (1)
+  void
+  bench_rtd_merge(benchmark::State& state_)
+  {
+    const std::vector<std::vector<int32_t>>& trigger_ids =
+      get_stream_trigger_ids();
+    std::vector<stream_type> streams(trigger_ids.size());
+    for (std::size_t istream = 0; istream < streams.size(); istream++) {
+      streams[istream].trigger_ids = trigger_ids[istream];
+    }
+    std::size_t nrtd = 0;
+    for (auto _ : state_) {
+      for (auto& stream : streams) {
+        stream.front = 0;
+      }
+      if (state_.range(0) == 1) {
+        nrtd += merge_tree(streams);
+      } else {
+        nrtd += merge_scan(streams);
+      }
+    }
+    state_.counters["RTD/s"] =
+      benchmark::Counter(nrtd, benchmark::Counter::kIsRate);
+    state_.SetLabel(state_.range(0) == 1 ? "tournament tree"
+                                         : "lock and scan");
+    return;
+  }
+
+} // namespace
+
+BENCHMARK(bench_rtd_merge)
+  ->ArgName("tree")
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,193 @@
+// benchmarks/bench_parsing.cc
+//
+// Benchmarks of the parsing of the CRD text files (crd2rhd).
+
+// Standard library:
+#include <memory>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/spirit/include/qi.hpp>
+// - Google Benchmark:
+#include <benchmark/benchmark.h>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/tracker_hit_record.h>
+
+#include "bench_data.h"
+#include "crd_tokenizer.h"
+#include "raw_hit_reader.h"
+#include "waveform_decoder.h"
+
+namespace {
+
+  //! Parse the whole CRD file, return the number of hits
+  std::size_t
+  parse_crd(const snfee::io::raw_hit_reader::config_type& reader_config_)
+  {
+    std::size_t nhits = 0;
+    snfee::data::calo_hit_record calo_hit;
+    snfee::data::tracker_hit_record tracker_hit;
+    snfee::io::raw_hit_reader reader;
+    reader.set_config(reader_config_);
+    reader.initialize();
+    while (reader.has_next_hit()) {
+      reader.load_next_hit(calo_hit, tracker_hit);
+      nhits++;
+    }
+    reader.reset();
+    return nhits;
+  }
+
+  //! Parse the CRD file with a given number of parsing threads (argument
+  //! #0), with or without decoding the calorimeter waveforms (argument #1)
+  void
+  bench_crd_parse(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    const snfee::bench::bench_data::input_file_type& crd = data.get_crd();
+    snfee::io::raw_hit_reader::config_type reader_config;
+    reader_config.input_filename = crd.path;
+    reader_config.crate_num = data.get_generator_config().crate_num;
+    reader_config.number_of_parser_threads = state_.range(0);
+    reader_config.with_calo_waveforms = state_.range(1) != 0;
+    std::size_t nhits = 0;
+    for (auto _ : state_) {
+      nhits += parse_crd(reader_config);
+    }
+    state_.SetItemsProcessed(nhits);
+    state_.SetBytesProcessed(state_.iterations() * crd.summary.bytes);
+    return;
+  }
+
+  //! Parse the CRD file on 4 threads with a given chunk size (kB)
+  void
+  bench_crd_parse_chunk_size(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    const snfee::bench::bench_data::input_file_type& crd = data.get_crd();
+    snfee::io::raw_hit_reader::config_type reader_config;
+    reader_config.input_filename = crd.path;
+    reader_config.crate_num = data.get_generator_config().crate_num;
+    reader_config.number_of_parser_threads = 4;
+    reader_config.parser_chunk_size = state_.range(0) * 1024;
+    std::size_t nhits = 0;
+    for (auto _ : state_) {
+      nhits += parse_crd(reader_config);
+    }
+    state_.SetItemsProcessed(nhits);
+    state_.SetBytesProcessed(state_.iterations() * crd.summary.bytes);
+    return;
+  }
+
+  //! Return the waveform lines of the calorimeter hits of all the
+  //! triggers, as written in the CRD file
+  const std::vector<std::string>&
+  get_waveform_lines()
+  {
+    static std::unique_ptr<std::vector<std::string>> lines;
+    if (!lines) {
+      lines.reset(new std::vector<std::string>);
+      for (const auto& trigger_data :
+           snfee::bench::bench_data::instance().get_triggers()) {
+        for (const auto& calo_hit : trigger_data.calo_hits) {
+          if (!calo_hit.has_waveforms()) {
+            continue;
+          }
+          const auto& waveforms = calo_hit.get_waveforms();
+          for (uint16_t ichannel = 0; ichannel < 2; ichannel++) {
+            std::string line;
+            for (const uint16_t adc : waveforms.channel_samples(ichannel)) {
+              line += std::to_string(adc);
+              line += ' ';
+            }
+            lines->push_back(line);
+          }
+        }
+      }
+    }
+    return *lines;
+  }
+
+  //! Decode the waveform lines with the former Spirit parser (argument
+  //! -1) or with the decoder and a given instruction set (see
+  //! waveform_decoder::isa_type)
+  void
+  bench_waveform_decode(benchmark::State& state_)
+  {
+    namespace qi = boost::spirit::qi;
+    const std::vector<std::string>& lines = get_waveform_lines();
+    const bool spirit = state_.range(0) < 0;
+    const snfee::io::waveform_decoder::isa_type isa =
+      spirit ? snfee::io::waveform_decoder::ISA_SCALAR
+             : static_cast<snfee::io::waveform_decoder::isa_type>(
+                 state_.range(0));
+    if (isa > snfee::io::waveform_decoder::best_isa()) {
+      state_.SkipWithError("Instruction set not supported by the CPU");
+      return;
+    }
+    snfee::io::waveform_decoder decoder(isa);
+    std::vector<int16_t> buffer;
+    snfee::data::calo_hit_record::waveforms_record waveforms;
+    std::size_t nbytes = 0;
+    for (const auto& line : lines) {
+      nbytes += line.size();
+    }
+    for (auto _ : state_) {
+      for (const auto& line : lines) {
+        if (spirit) {
+          // Former path: parse into a temporary buffer, then copy the
+          // samples one at a time:
+          buffer.clear();
+          std::string::const_iterator first = line.begin();
+          qi::phrase_parse(first, line.end(), +qi::int_, qi::space, buffer);
+          waveforms.reset(buffer.size());
+          for (uint16_t isample = 0; isample < buffer.size(); isample++) {
+            waveforms.set_adc(isample, 0, buffer[isample]);
+          }
+        } else {
+          snfee::io::crd_line crd_line;
+          crd_line.begin = line.data();
+          crd_line.end = line.data() + line.size();
+          std::size_t nsamples = 0;
+          decoder.decode(crd_line,
+                         waveforms.channel_samples(0).data(),
+                         waveforms.get_number_of_samples(),
+                         nsamples);
+        }
+        benchmark::DoNotOptimize(waveforms);
+      }
+    }
+    state_.SetItemsProcessed(state_.iterations() * lines.size());
+    state_.SetBytesProcessed(state_.iterations() * nbytes);
+    state_.SetLabel(spirit ? "spirit"
+                           : snfee::io::waveform_decoder::isa_label(isa));
+    return;
+  }
+
+} // namespace
+
+// The parsing threads are not seen by the CPU time of the main thread:
+BENCHMARK(bench_crd_parse)
+  ->ArgNames({"threads", "waveforms"})
+  ->ArgsProduct({{1, 2, 4, 8}, {0, 1}})
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+BENCHMARK(bench_crd_parse_chunk_size)
+  ->ArgName("chunk_kB")
+  ->Arg(256)
+  ->Arg(1024)
+  ->Arg(4096)
+  ->Arg(16384)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+BENCHMARK(bench_waveform_decode)
+  ->ArgName("isa")
+  ->Arg(-1)
+  ->Arg(snfee::io::waveform_decoder::ISA_SCALAR)
+  ->Arg(snfee::io::waveform_decoder::ISA_SSE42)
+  ->Arg(snfee::io::waveform_decoder::ISA_AVX2)
+  ->Unit(benchmark::kMicrosecond);
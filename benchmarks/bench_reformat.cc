@@ -0,0 +1,131 @@
+// benchmarks/bench_reformat.cc
+//
+// Benchmarks of the conversion of "online" RTD records to "offline" ones
+// (rtdOnlineToOffline) on high-multiplicity events.
+
+// Standard library:
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Third party:
+// - Google Benchmark:
+#include <benchmark/benchmark.h>
+
+// This project:
+#include <snfee/data/RRawTriggerData.h>
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/data/rtdReformater.h>
+
+#include "bench_data.h"
+#include "synthetic_generator.h"
+
+namespace {
+
+  /// Minimum mean number of calorimeter hits per trigger
+  const double HIGH_MULTIPLICITY_CALO_HITS = 40.0;
+
+  /// Minimum mean number of fired tracker cells per trigger
+  const double HIGH_MULTIPLICITY_TRACKER_CELLS = 100.0;
+
+  /// Maximum number of triggers (the records of all the triggers are
+  /// rebuilt before each iteration)
+  const std::size_t HIGH_MULTIPLICITY_MAX_TRIGGERS = 250;
+
+  //! Return the records of the high-multiplicity triggers
+  const std::vector<snfee::bench::synthetic_generator::trigger_data_type>&
+  get_high_multiplicity_triggers()
+  {
+    static std::unique_ptr<
+      std::vector<snfee::bench::synthetic_generator::trigger_data_type>>
+      triggers;
+    if (!triggers) {
+      snfee::bench::synthetic_generator::config_type config =
+        snfee::bench::bench_data::instance().get_generator_config();
+      config.mean_calo_hits =
+        std::max(config.mean_calo_hits, HIGH_MULTIPLICITY_CALO_HITS);
+      config.mean_tracker_cells =
+        std::max(config.mean_tracker_cells, HIGH_MULTIPLICITY_TRACKER_CELLS);
+      config.number_of_triggers =
+        std::min(config.number_of_triggers, HIGH_MULTIPLICITY_MAX_TRIGGERS);
+      triggers.reset(
+        new std::vector<snfee::bench::synthetic_generator::trigger_data_type>(
+          config.number_of_triggers));
+      snfee::bench::synthetic_generator generator(config);
+      for (auto& trigger_data : *triggers) {
+        generator.generate_trigger(trigger_data);
+      }
+    }
+    return *triggers;
+  }
+
+  //! Build the "online" RTD records of the high-multiplicity triggers
+  void
+  make_records(std::vector<snfee::data::raw_trigger_data>& records_)
+  {
+    const auto& triggers = get_high_multiplicity_triggers();
+    const int32_t run_id =
+      snfee::bench::bench_data::instance().get_generator_config().run_id;
+    records_.clear();
+    records_.resize(triggers.size());
+    for (std::size_t itrig = 0; itrig < triggers.size(); itrig++) {
+      const auto& trigger_data = triggers[itrig];
+      snfee::data::raw_trigger_data& rtd = records_[itrig];
+      rtd.set_run_id(run_id);
+      rtd.set_trigger_id(trigger_data.trig.get_trigger_id());
+      rtd.set_trig(
+        std::make_shared<snfee::data::trigger_record>(trigger_data.trig));
+      for (const auto& calo_hit : trigger_data.calo_hits) {
+        rtd.append_calo_hit(
+          std::make_shared<snfee::data::calo_hit_record>(calo_hit));
+      }
+      for (const auto& tracker_hit : trigger_data.tracker_hits) {
+        rtd.append_tracker_hit(
+          std::make_shared<snfee::data::tracker_hit_record>(tracker_hit));
+      }
+    }
+    return;
+  }
+
+  //! Convert the records (0: copy to a new record, 1: copy to a reused
+  //! record, 2: move to a reused record)
+  void
+  bench_rtd_online_to_offline(benchmark::State& state_)
+  {
+    std::vector<snfee::data::raw_trigger_data> records;
+    snfee::data::RRawTriggerData offline_rtd;
+    std::size_t nhits = 0;
+    for (auto _ : state_) {
+      state_.PauseTiming();
+      make_records(records);
+      state_.ResumeTiming();
+      for (auto& rtd : records) {
+        nhits += rtd.get_calo_hits().size() + rtd.get_tracker_hits().size();
+        if (state_.range(0) == 2) {
+          snfee::data::rtdOnlineToOffline(std::move(rtd), offline_rtd);
+        } else if (state_.range(0) == 1) {
+          snfee::data::rtdOnlineToOffline(rtd, offline_rtd);
+        } else {
+          offline_rtd = snfee::data::rtdOnlineToOffline(rtd);
+        }
+      }
+      // Release the consumed records outside of the timed section:
+      state_.PauseTiming();
+      records.clear();
+      state_.ResumeTiming();
+    }
+    state_.SetItemsProcessed(nhits);
+    const char* labels[] = {"copy", "copy to reused record", "move"};
+    state_.SetLabel(labels[state_.range(0)]);
+    return;
+  }
+
+} // namespace
+
+BENCHMARK(bench_rtd_online_to_offline)
+  ->Arg(0)
+  ->Arg(1)
+  ->Arg(2)
+  ->Unit(benchmark::kMicrosecond);
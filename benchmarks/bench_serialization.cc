@@ -0,0 +1,308 @@
+// benchmarks/bench_serialization.cc
+//
+// Benchmarks of the serialization of RHD and RTD records, in the Boost
+// portable binary archives (argument "format" 0) and in the native format
+// (argument "format" 1).
+
+// Standard library:
+#include <memory>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/filesystem.hpp>
+// - Google Benchmark:
+#include <benchmark/benchmark.h>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/data/tracker_hit_record.h>
+#include <snfee/io/multifile_data_reader.h>
+#include <snfee/io/multifile_data_writer.h>
+
+#include "bench_data.h"
+
+namespace {
+
+  //! Return the format of the files of a benchmark
+  snfee::bench::bench_data::file_format_type
+  get_format(const benchmark::State& state_)
+  {
+    return static_cast<snfee::bench::bench_data::file_format_type>(
+      state_.range(0));
+  }
+
+  //! Return the extension of the files of a benchmark
+  std::string
+  format_extension(const benchmark::State& state_)
+  {
+    return snfee::bench::bench_data::file_extension(get_format(state_));
+  }
+
+  //! Store the hits of all the triggers in an RHD file
+  void
+  bench_rhd_store(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    // Mutable copy of the hits (the writer stores non-const records):
+    std::vector<snfee::bench::synthetic_generator::trigger_data_type>
+      triggers = data.get_triggers();
+    const std::string path = data.make_path(
+      "snfee_bench_rhd_store" + format_extension(state_));
+    std::size_t nrecords = 0;
+    std::size_t nbytes = 0;
+    for (auto _ : state_) {
+      {
+        snfee::io::multifile_data_writer::config_type writer_config;
+        writer_config.filenames.push_back(path);
+        snfee::io::multifile_data_writer writer(writer_config);
+        for (auto& trigger_data : triggers) {
+          for (auto& calo_hit : trigger_data.calo_hits) {
+            writer.store(calo_hit);
+          }
+          for (auto& tracker_hit : trigger_data.tracker_hits) {
+            writer.store(tracker_hit);
+          }
+        }
+        nrecords += writer.get_counter();
+      }
+      state_.PauseTiming();
+      nbytes += boost::filesystem::file_size(path);
+      boost::filesystem::remove(path);
+      state_.ResumeTiming();
+    }
+    state_.SetItemsProcessed(nrecords);
+    state_.SetBytesProcessed(nbytes);
+    state_.SetLabel(format_extension(state_));
+    return;
+  }
+
+  //! Load the records of an RHD file
+  template <typename Record>
+  void
+  run_rhd_load(benchmark::State& state_,
+               const snfee::bench::bench_data::input_file_type& rhd_)
+  {
+    std::size_t nrecords = 0;
+    Record record;
+    for (auto _ : state_) {
+      snfee::io::multifile_data_reader::config_type reader_config;
+      reader_config.filenames.push_back(rhd_.path);
+      snfee::io::multifile_data_reader reader(reader_config);
+      while (reader.has_record_tag()) {
+        reader.load(record);
+        nrecords++;
+      }
+    }
+    state_.SetItemsProcessed(nrecords);
+    state_.SetBytesProcessed(state_.iterations() * rhd_.summary.bytes);
+    state_.SetLabel(format_extension(state_));
+    return;
+  }
+
+  //! Load the calorimeter hits of an RHD file
+  void
+  bench_rhd_load_calo(benchmark::State& state_)
+  {
+    run_rhd_load<snfee::data::calo_hit_record>(
+      state_,
+      snfee::bench::bench_data::instance().get_calo_rhd(get_format(state_)));
+    return;
+  }
+
+  //! Load the tracker hits of an RHD file
+  void
+  bench_rhd_load_tracker(benchmark::State& state_)
+  {
+    run_rhd_load<snfee::data::tracker_hit_record>(
+      state_,
+      snfee::bench::bench_data::instance().get_tracker_rhd(
+        get_format(state_)));
+    return;
+  }
+
+  /// Number of files of the multi-file RHD set
+  const std::size_t MULTIFILE_RHD_NFILES = 4;
+
+  /// \brief Multi-file set of RHD files
+  struct multifile_rhd_type {
+    std::vector<std::string> paths;
+    std::size_t records = 0; //!< Number of records of all the files
+    std::size_t bytes = 0;   //!< Size of all the files
+  };
+
+  //! Return the set of RHD files of the calorimeter hits of all the
+  //! triggers split in several files, written on first use
+  const multifile_rhd_type&
+  get_multifile_calo_rhd(
+    const snfee::bench::bench_data::file_format_type format_)
+  {
+    static std::unique_ptr<multifile_rhd_type> sets[2];
+    std::unique_ptr<multifile_rhd_type>& set = sets[format_];
+    if (!set) {
+      snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+      set.reset(new multifile_rhd_type);
+      std::vector<snfee::data::calo_hit_record> calo_hits;
+      for (const auto& trigger_data : data.get_triggers()) {
+        calo_hits.insert(calo_hits.end(),
+                         trigger_data.calo_hits.begin(),
+                         trigger_data.calo_hits.end());
+      }
+      snfee::io::multifile_data_writer::config_type writer_config;
+      for (std::size_t ifile = 0; ifile < MULTIFILE_RHD_NFILES; ifile++) {
+        writer_config.filenames.push_back(
+          data.make_path("snfee_bench_calo_rhd_part-" + std::to_string(ifile) +
+                         snfee::bench::bench_data::file_extension(format_)));
+      }
+      writer_config.max_records_per_file =
+        (calo_hits.size() + MULTIFILE_RHD_NFILES - 1) / MULTIFILE_RHD_NFILES;
+      {
+        snfee::io::multifile_data_writer writer(writer_config);
+        for (auto& calo_hit : calo_hits) {
+          writer.store(calo_hit);
+        }
+      }
+      set->paths = writer_config.filenames;
+      set->records = calo_hits.size();
+      for (const auto& path : set->paths) {
+        set->bytes += boost::filesystem::file_size(path);
+      }
+    }
+    return *set;
+  }
+
+  //! Load the calorimeter hits of a multi-file RHD set, decoding them
+  //! ahead with a given prefetch depth (argument #1, 0: no prefetch)
+  void
+  bench_rhd_load_multifile(benchmark::State& state_)
+  {
+    const multifile_rhd_type& rhd_set =
+      get_multifile_calo_rhd(get_format(state_));
+    std::size_t nrecords = 0;
+    snfee::data::calo_hit_record calo_hit;
+    for (auto _ : state_) {
+      snfee::io::multifile_data_reader::config_type reader_config;
+      reader_config.filenames = rhd_set.paths;
+      reader_config.prefetch_depth = state_.range(1);
+      snfee::io::multifile_data_reader reader(reader_config);
+      reader.add_record_type<snfee::data::calo_hit_record>();
+      while (reader.has_record_tag()) {
+        reader.load(calo_hit);
+        nrecords++;
+      }
+    }
+    state_.SetItemsProcessed(nrecords);
+    state_.SetBytesProcessed(state_.iterations() * rhd_set.bytes);
+    state_.SetLabel(format_extension(state_));
+    return;
+  }
+
+  //! Store all the triggers in an RTD file
+  void
+  bench_rtd_store(benchmark::State& state_)
+  {
+    snfee::bench::bench_data& data = snfee::bench::bench_data::instance();
+    const auto& triggers = data.get_triggers();
+    const std::string path = data.make_path(
+      "snfee_bench_rtd_store" + format_extension(state_));
+    // Build the RTD records once, only their serialization is timed:
+    std::vector<snfee::data::raw_trigger_data> rtds(triggers.size());
+    for (std::size_t itrig = 0; itrig < triggers.size(); itrig++) {
+      const auto& trigger_data = triggers[itrig];
+      snfee::data::raw_trigger_data& rtd = rtds[itrig];
+      rtd.set_run_id(data.get_generator_config().run_id);
+      rtd.set_trigger_id(trigger_data.trig.get_trigger_id());
+      rtd.set_trig(
+        std::make_shared<snfee::data::trigger_record>(trigger_data.trig));
+      for (const auto& calo_hit : trigger_data.calo_hits) {
+        rtd.append_calo_hit(
+          std::make_shared<snfee::data::calo_hit_record>(calo_hit));
+      }
+      for (const auto& tracker_hit : trigger_data.tracker_hits) {
+        rtd.append_tracker_hit(
+          std::make_shared<snfee::data::tracker_hit_record>(tracker_hit));
+      }
+    }
+    std::size_t nbytes = 0;
+    for (auto _ : state_) {
+      {
+        snfee::io::multifile_data_writer::config_type writer_config;
+        writer_config.filenames.push_back(path);
+        snfee::io::multifile_data_writer writer(writer_config);
+        for (auto& rtd : rtds) {
+          writer.store(rtd);
+        }
+      }
+      state_.PauseTiming();
+      nbytes += boost::filesystem::file_size(path);
+      boost::filesystem::remove(path);
+      state_.ResumeTiming();
+    }
+    state_.SetItemsProcessed(state_.iterations() * rtds.size());
+    state_.SetBytesProcessed(nbytes);
+    state_.SetLabel(format_extension(state_));
+    return;
+  }
+
+  //! Load the records of an RTD file, decoding them ahead with a given
+  //! prefetch depth (argument #1, 0: no prefetch)
+  void
+  bench_rtd_load(benchmark::State& state_)
+  {
+    const snfee::bench::bench_data::input_file_type& rtd_file =
+      snfee::bench::bench_data::instance().get_rtd(get_format(state_));
+    std::size_t nrecords = 0;
+    for (auto _ : state_) {
+      snfee::io::multifile_data_reader::config_type reader_config;
+      reader_config.filenames.push_back(rtd_file.path);
+      reader_config.prefetch_depth = state_.range(1);
+      snfee::io::multifile_data_reader reader(reader_config);
+      reader.add_record_type<snfee::data::raw_trigger_data>();
+      while (reader.has_record_tag()) {
+        snfee::data::raw_trigger_data rtd;
+        reader.load(rtd);
+        nrecords++;
+      }
+    }
+    state_.SetItemsProcessed(nrecords);
+    state_.SetBytesProcessed(state_.iterations() * rtd_file.summary.bytes);
+    state_.SetLabel(format_extension(state_));
+    return;
+  }
+
+} // namespace
+
+BENCHMARK(bench_rhd_store)
+  ->ArgName("format")
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK(bench_rhd_load_calo)
+  ->ArgName("format")
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMillisecond);
+BENCHMARK(bench_rhd_load_tracker)
+  ->ArgName("format")
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMillisecond);
+// The prefetch thread is not seen by the CPU time of the main thread:
+BENCHMARK(bench_rhd_load_multifile)
+  ->ArgNames({"format", "prefetch"})
+  ->ArgsProduct({{0, 1}, {0, 4, 64}})
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+BENCHMARK(bench_rtd_store)
+  ->ArgName("format")
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMillisecond);
+// The prefetch thread is not seen by the CPU time of the main thread:
+BENCHMARK(bench_rtd_load)
+  ->ArgNames({"format", "prefetch"})
+  ->ArgsProduct({{0, 1}, {0, 4, 64}})
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
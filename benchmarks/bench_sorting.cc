@@ -0,0 +1,107 @@
+// benchmarks/bench_sorting.cc
+//
+// Benchmarks of the external merge sort of RHD records by trigger ID
+// (rhd_sorter), in memory and spilling runs to temporary files.
+
+// Standard library:
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/filesystem.hpp>
+// - Google Benchmark:
+#include <benchmark/benchmark.h>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/tracker_hit_record.h>
+
+#include "bench_data.h"
+#include "rhd_record.h"
+#include "rhd_sorter.h"
+
+namespace {
+
+  /// Number of consecutive records shuffled together (out of order records
+  /// of the DAQ stay close to their sorted position)
+  const std::size_t SHUFFLE_WINDOW = 256;
+
+  /// Seed of the shuffling of the records
+  const uint32_t SHUFFLE_SEED = 314159;
+
+  //! Return the hits of all the triggers, shuffled by windows
+  const std::vector<snfee::io::rhd_record>&
+  get_shuffled_records()
+  {
+    static std::unique_ptr<std::vector<snfee::io::rhd_record>> records;
+    if (!records) {
+      records.reset(new std::vector<snfee::io::rhd_record>);
+      for (const auto& trigger_data :
+           snfee::bench::bench_data::instance().get_triggers()) {
+        for (const auto& calo_hit : trigger_data.calo_hits) {
+          records->emplace_back(
+            std::make_shared<snfee::data::calo_hit_record>(calo_hit));
+        }
+        for (const auto& tracker_hit : trigger_data.tracker_hits) {
+          records->emplace_back(
+            std::make_shared<snfee::data::tracker_hit_record>(tracker_hit));
+        }
+      }
+      std::mt19937 random(SHUFFLE_SEED);
+      for (std::size_t first = 0; first < records->size();
+           first += SHUFFLE_WINDOW) {
+        const std::size_t last =
+          std::min(first + SHUFFLE_WINDOW, records->size());
+        std::shuffle(
+          records->begin() + first, records->begin() + last, random);
+      }
+    }
+    return *records;
+  }
+
+  //! Sort the shuffled hits with a given memory cap (MB)
+  void
+  bench_rhd_sort(benchmark::State& state_)
+  {
+    const std::vector<snfee::io::rhd_record>& records =
+      get_shuffled_records();
+    snfee::io::rhd_sorter::config_type sorter_config;
+    sorter_config.max_memory_size = state_.range(0) * 1024 * 1024;
+    sorter_config.temporary_directory =
+      snfee::bench::bench_data::instance().make_path("snfee_bench_sort");
+    boost::filesystem::create_directories(sorter_config.temporary_directory);
+    std::size_t nruns = 0;
+    std::size_t nmerges = 0;
+    for (auto _ : state_) {
+      snfee::io::rhd_sorter sorter(sorter_config);
+      for (const auto& rec : records) {
+        sorter.push_record(rec);
+      }
+      sorter.terminate_input();
+      while (sorter.has_next_record()) {
+        benchmark::DoNotOptimize(sorter.pop_next_record());
+      }
+      nruns += sorter.get_number_of_runs();
+      nmerges += sorter.get_number_of_intermediate_merges();
+    }
+    boost::filesystem::remove_all(sorter_config.temporary_directory);
+    state_.SetItemsProcessed(state_.iterations() * records.size());
+    state_.counters["runs"] =
+      benchmark::Counter(nruns, benchmark::Counter::kAvgIterations);
+    state_.counters["merges"] =
+      benchmark::Counter(nmerges, benchmark::Counter::kAvgIterations);
+    return;
+  }
+
+} // namespace
+
+BENCHMARK(bench_rhd_sort)
+  ->ArgName("memory_MB")
+  ->Arg(2)
+  ->Arg(16)
+  ->Arg(1024)
+  ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,173 @@
+// Standard library:
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+// - Boost:
+#include <boost/program_options.hpp>
+
+// This project:
+#include "synthetic_generator.h"
+
+namespace {
+
+  //! Print the contents of a generated file
+  void
+  print_summary(const std::string& what_,
+                const snfee::bench::synthetic_generator::summary_type& summary_)
+  {
+    std::cout << what_ << " : " << summary_.triggers << " triggers, "
+              << summary_.calo_hits << " calo hits, " << summary_.tracker_hits
+              << " tracker hits, " << summary_.bytes << " bytes" << std::endl;
+    return;
+  }
+
+} // namespace
+
+int
+main(int argc_, char** argv_)
+{
+  int error_code = EXIT_SUCCESS;
+  try {
+    snfee::bench::synthetic_generator::config_type generator_config;
+    std::string crd_filename;
+    std::string calo_rhd_filename;
+    std::string tracker_rhd_filename;
+    std::string rtd_filename;
+
+    // clang-format off
+    // Parse options:
+    namespace po = boost::program_options;
+    po::options_description opts("Allowed options");
+    opts.add_options()
+
+      ("help,h", "produce help message")
+
+      ("crd-file",
+       po::value<std::string>(&crd_filename)
+       ->value_name("path"),
+       "set the CRD output filename")
+
+      ("calo-rhd-file",
+       po::value<std::string>(&calo_rhd_filename)
+       ->value_name("path"),
+       "set the RHD output filename for the calorimeter hits")
+
+      ("tracker-rhd-file",
+       po::value<std::string>(&tracker_rhd_filename)
+       ->value_name("path"),
+       "set the RHD output filename for the tracker hits")
+
+      ("rtd-file",
+       po::value<std::string>(&rtd_filename)
+       ->value_name("path"),
+       "set the RTD output filename")
+
+      ("seed,s",
+       po::value<uint32_t>(&generator_config.seed)
+       ->value_name("number")
+       ->default_value(generator_config.seed),
+       "set the seed of the generator")
+
+      ("run-id",
+       po::value<int32_t>(&generator_config.run_id)
+       ->value_name("number")
+       ->default_value(generator_config.run_id),
+       "set the run ID of the RTD records")
+
+      ("crate-number,c",
+       po::value<int16_t>(&generator_config.crate_num)
+       ->value_name("number")
+       ->default_value(generator_config.crate_num),
+       "set the crate number (0, 1 or 2)")
+
+      ("triggers,n",
+       po::value<std::size_t>(&generator_config.number_of_triggers)
+       ->value_name("number")
+       ->default_value(generator_config.number_of_triggers),
+       "set the number of generated triggers")
+
+      ("trigger-rate,r",
+       po::value<double>(&generator_config.trigger_rate)
+       ->value_name("hertz")
+       ->default_value(generator_config.trigger_rate),
+       "set the rate of the generated triggers")
+
+      ("calo-hits",
+       po::value<double>(&generator_config.mean_calo_hits)
+       ->value_name("number")
+       ->default_value(generator_config.mean_calo_hits),
+       "set the mean number of calorimeter hits per trigger")
+
+      ("tracker-cells",
+       po::value<double>(&generator_config.mean_tracker_cells)
+       ->value_name("number")
+       ->default_value(generator_config.mean_tracker_cells),
+       "set the mean number of fired tracker cells per trigger")
+
+      ("waveform-samples",
+       po::value<uint16_t>(&generator_config.waveform_number_of_samples)
+       ->value_name("number")
+       ->default_value(generator_config.waveform_number_of_samples),
+       "set the number of waveform samples per calorimeter hit")
+
+      ; // end of options description
+    // clang-format on
+
+    // Describe command line arguments :
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc_, argv_).options(opts).run(), vm);
+    po::notify(vm);
+
+    // Use command line arguments :
+    if (vm.count("help")) {
+      std::cout << "snfee-bench-generate : "
+                << "Generate synthetic CRD, RHD and RTD files" << std::endl
+                << std::endl;
+      std::cout << "Usage : " << std::endl << std::endl;
+      std::cout << "  snfee-bench-generate [OPTIONS]" << std::endl
+                << std::endl;
+      std::cout << opts << std::endl;
+      std::cout << "Example : " << std::endl << std::endl;
+      std::cout << "  snfee-bench-generate \\\n";
+      std::cout << "    --triggers 100000 \\\n";
+      std::cout << "    --trigger-rate 500 \\\n";
+      std::cout << "    --crd-file \"synthetic_crate-0.crd\" \\\n";
+      std::cout << "    --rtd-file \"synthetic_rtd.data.gz\" \n";
+      std::cout << std::endl;
+      return (-1);
+    }
+
+    DT_THROW_IF(crd_filename.empty() and calo_rhd_filename.empty() and
+                  tracker_rhd_filename.empty() and rtd_filename.empty(),
+                std::logic_error,
+                "Missing output file!");
+    snfee::bench::synthetic_generator generator(generator_config);
+    if (!crd_filename.empty()) {
+      print_summary(crd_filename, generator.write_crd(crd_filename));
+    }
+    if (!calo_rhd_filename.empty() or !tracker_rhd_filename.empty()) {
+      print_summary("RHD",
+                    generator.write_rhd(calo_rhd_filename,
+                                        tracker_rhd_filename));
+    }
+    if (!rtd_filename.empty()) {
+      print_summary(rtd_filename, generator.write_rtd(rtd_filename));
+    }
+  }
+  catch (std::exception& x) {
+    std::cerr << "error: " << x.what() << std::endl;
+    error_code = EXIT_FAILURE;
+  }
+  catch (...) {
+    std::cerr << "error: "
+              << "unexpected error!" << std::endl;
+    error_code = EXIT_FAILURE;
+  }
+  return (error_code);
+}
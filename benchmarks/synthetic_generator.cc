@@ -0,0 +1,412 @@
+// benchmarks/synthetic_generator.cc
+
+// Ourselves:
+#include "synthetic_generator.h"
+
+// Standard library:
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+// Third party:
+// - Boost:
+#include <boost/filesystem.hpp>
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/utils.h>
+
+// This project:
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/io/multifile_data_writer.h>
+#include <snfee/model/feb_constants.h>
+
+namespace snfee {
+  namespace bench {
+
+    namespace {
+
+      //! Format a line in the buffer of a CRD file
+      template <typename... Args>
+      void
+      crd_printf(std::string& buffer_, const char* format_, Args... args_)
+      {
+        char line[512];
+        const int n = std::snprintf(line, sizeof(line), format_, args_...);
+        buffer_.append(line, n);
+        return;
+      }
+
+      //! Return the size of a file (0 if it does not exist)
+      std::size_t
+      file_size(const std::string& path_)
+      {
+        boost::system::error_code ec;
+        const boost::uintmax_t size = boost::filesystem::file_size(path_, ec);
+        return ec ? 0 : static_cast<std::size_t>(size);
+      }
+
+      //! Build a writer for a single output file
+      std::unique_ptr<snfee::io::multifile_data_writer>
+      make_writer(const std::string& path_)
+      {
+        snfee::io::multifile_data_writer::config_type writer_config;
+        writer_config.filenames.push_back(path_);
+        return std::unique_ptr<snfee::io::multifile_data_writer>(
+          new snfee::io::multifile_data_writer(writer_config));
+      }
+
+    } // namespace
+
+    synthetic_generator::synthetic_generator(const config_type& cfg_)
+      : _config_(cfg_)
+    {
+      DT_THROW_IF(_config_.crate_num < 0 or
+                    _config_.crate_num >=
+                      snfee::model::feb_constants::MAX_NUMBER_OF_CALO_CRATES,
+                  std::logic_error,
+                  "Invalid crate number [" << _config_.crate_num << "]!");
+      DT_THROW_IF(!(_config_.trigger_rate > 0.0),
+                  std::logic_error,
+                  "Invalid trigger rate!");
+      DT_THROW_IF(_config_.mean_calo_hits < 0.0 or
+                    _config_.mean_tracker_cells < 0.0,
+                  std::logic_error,
+                  "Invalid hit multiplicity!");
+      DT_THROW_IF(_config_.waveform_number_of_samples >
+                    snfee::model::feb_constants::SAMLONG_MAX_NUMBER_OF_SAMPLES,
+                  std::logic_error,
+                  "Invalid number of waveform samples!");
+      rewind();
+      return;
+    }
+
+    const synthetic_generator::config_type&
+    synthetic_generator::get_config() const
+    {
+      return _config_;
+    }
+
+    void
+    synthetic_generator::rewind()
+    {
+      _random_.seed(_config_.seed);
+      _next_trigger_id_ = 0;
+      _next_hit_num_ = 0;
+      return;
+    }
+
+    std::size_t
+    synthetic_generator::_draw_multiplicity_(const double mean_,
+                                             const std::size_t max_)
+    {
+      if (mean_ <= 0.0) {
+        return 0;
+      }
+      std::poisson_distribution<std::size_t> multiplicity(mean_);
+      const std::size_t n = multiplicity(_random_);
+      return n < max_ ? n : max_;
+    }
+
+    void
+    synthetic_generator::generate_trigger(trigger_data_type& data_)
+    {
+      typedef snfee::model::feb_constants feb;
+      const int32_t trigger_id = _next_trigger_id_++;
+      const double trigger_time_ns =
+        trigger_id / _config_.trigger_rate * 1.0e9;
+      // The L2 clocktick starts at 1 (a null clocktick is invalid):
+      data_.trig.make(trigger_id,
+                      snfee::data::trigger_record::TRIGGER_MODE_CALO_ONLY,
+                      1 + static_cast<uint32_t>(trigger_time_ns / 1600.0));
+
+      // Calorimeter hits (one per SAMLONG chip):
+      std::uniform_int_distribution<int> calo_board(
+        0, feb::MAX_CALO_CRATE_NUMBER_OF_FEBS - 1);
+      std::uniform_int_distribution<int> calo_chip(
+        0, feb::CFEB_NUMBER_OF_SAMLONGS - 1);
+      std::uniform_int_distribution<int> calo_jitter(0, 63);
+      std::uniform_int_distribution<int> signal_channels(1, 3);
+      std::uniform_int_distribution<int> fcr(
+        0, feb::SAMLONG_MAX_NUMBER_OF_SAMPLES - 1);
+      const std::size_t ncalo = _draw_multiplicity_(
+        _config_.mean_calo_hits,
+        feb::MAX_CALO_CRATE_NUMBER_OF_FEBS * feb::CFEB_NUMBER_OF_SAMLONGS);
+      data_.calo_hits.resize(ncalo);
+      for (auto& calo_hit : data_.calo_hits) {
+        const int signals = signal_channels(_random_);
+        const uint64_t tdc =
+          static_cast<uint64_t>(trigger_time_ns /
+                                feb::SAMLONG_DEFAULT_TDC_LSB_NS) +
+          calo_jitter(_random_);
+        const int16_t board_num = calo_board(_random_);
+        const int16_t chip_num = calo_chip(_random_);
+        snfee::data::calo_hit_record::populate_mock_hit(
+          calo_hit,
+          (signals & 1) != 0,
+          (signals & 2) != 0,
+          _next_hit_num_++,
+          trigger_id,
+          tdc,
+          _config_.crate_num,
+          board_num,
+          chip_num,
+          static_cast<uint16_t>(trigger_id & 0xFF),
+          0,
+          static_cast<uint16_t>(fcr(_random_)),
+          _config_.waveform_number_of_samples > 0,
+          0,
+          _config_.waveform_number_of_samples);
+      }
+
+      // Tracker hits (an anode and two cathode timestamps per cell):
+      typedef snfee::data::tracker_hit_record tracker_hit_record;
+      std::uniform_int_distribution<int> tracker_board(
+        0, feb::MAX_TRACKER_CRATE_NUMBER_OF_FEBS - 1);
+      std::uniform_int_distribution<int> tracker_chip(
+        0, feb::TFEB_NUMBER_OF_FEASTS - 1);
+      std::uniform_int_distribution<int> tracker_channel(
+        0, feb::FEAST_NUMBER_OF_CHANNELS - 3);
+      std::uniform_int_distribution<int> drift_ticks(0, 400);
+      const uint64_t trigger_tick = static_cast<uint64_t>(
+        trigger_time_ns * feb::FEAST_CLOCK_FREQUENCY_MHZ / 1000.0);
+      const std::size_t ncells = _draw_multiplicity_(
+        _config_.mean_tracker_cells,
+        feb::MAX_TRACKER_CRATE_NUMBER_OF_FEBS * feb::TFEB_NUMBER_OF_CHANNELS /
+          3);
+      data_.tracker_hits.resize(3 * ncells);
+      for (std::size_t icell = 0; icell < ncells; icell++) {
+        const int16_t board_num = tracker_board(_random_);
+        const int16_t chip_num = tracker_chip(_random_);
+        const int16_t channel_num = tracker_channel(_random_);
+        const uint64_t anode_tick = trigger_tick + drift_ticks(_random_);
+        data_.tracker_hits[3 * icell].make(
+          _next_hit_num_++,
+          trigger_id,
+          _config_.crate_num,
+          board_num,
+          chip_num,
+          channel_num,
+          tracker_hit_record::CHANNEL_ANODE,
+          tracker_hit_record::TIMESTAMP_ANODE_R0,
+          anode_tick);
+        data_.tracker_hits[3 * icell + 1].make(
+          _next_hit_num_++,
+          trigger_id,
+          _config_.crate_num,
+          board_num,
+          chip_num,
+          channel_num + 1,
+          tracker_hit_record::CHANNEL_CATHODE,
+          tracker_hit_record::TIMESTAMP_CATHODE_R5,
+          anode_tick + drift_ticks(_random_));
+        data_.tracker_hits[3 * icell + 2].make(
+          _next_hit_num_++,
+          trigger_id,
+          _config_.crate_num,
+          board_num,
+          chip_num,
+          channel_num + 2,
+          tracker_hit_record::CHANNEL_CATHODE,
+          tracker_hit_record::TIMESTAMP_CATHODE_R6,
+          anode_tick + drift_ticks(_random_));
+      }
+      return;
+    }
+
+    synthetic_generator::summary_type
+    synthetic_generator::write_crd(const std::string& path_)
+    {
+      DT_THROW_IF(_config_.waveform_number_of_samples == 0,
+                  std::logic_error,
+                  "CRD files need calorimeter waveform samples!");
+      std::string path = path_;
+      datatools::fetch_path_with_env(path);
+      std::ofstream fout(path.c_str(), std::ios::binary);
+      DT_THROW_IF(
+        !fout, std::logic_error, "Cannot open CRD file '" << path << "'!");
+      rewind();
+      summary_type summary;
+      fout << "=== DATA FILE SAVED WITH SN CRATE SOFTWARE VERSION: V2.4 == "
+              "DATE OF RUN: UnixTime = 1530000000.000 date = 26/6/2018 "
+              "time = 10h0m0s ===\n"
+           << "=== Synthetic data (seed = " << _config_.seed << ") ===\n"
+           << "=== DATA TYPE : RAW DATA ===\n";
+      for (std::size_t iline = 3; iline < 9; iline++) {
+        fout << "=== Generated by snfee-bench-generate ===\n";
+      }
+      std::string buffer;
+      trigger_data_type data;
+      int32_t crd_hit_num = 0;
+      for (std::size_t itrig = 0; itrig < _config_.number_of_triggers;
+           itrig++) {
+        generate_trigger(data);
+        const int32_t trigger_id = data.trig.get_trigger_id();
+        const double unix_time = 1530000000.0 + itrig / _config_.trigger_rate;
+        buffer.clear();
+        for (const auto& calo_hit : data.calo_hits) {
+          const auto& waveforms = calo_hit.get_waveforms();
+          for (uint16_t ich = 0;
+               ich < snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS;
+               ich++) {
+            const auto& ch_data = calo_hit.get_channel_data(ich);
+            crd_printf(buffer,
+                       "= HIT %d = CALO = TRIG_ID %d =\n",
+                       crd_hit_num++,
+                       trigger_id);
+            crd_printf(
+              buffer,
+              "Slot %d Ch %d LTO %d HT %d EvtID %d RawTDC %llu TDC %.3f "
+              "TrigCount %d Timecount %d RawBaseline %d Baseline %.3f "
+              "RawPeak %d Peak %.3f PeakCell %d RawCharge %d Charge %.3f "
+              "Overflow %d RisingCell %d RisingOffset %d RisingTime %.3f "
+              "FallingCell %d FallingOffset %d FallingTime %.3f FCR %d "
+              "UnixTime %.6f\n",
+              calo_hit.get_board_num(),
+              calo_hit.get_chip_num() *
+                  snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS +
+                ich,
+              ch_data.is_lt() ? 1 : 0,
+              ch_data.is_ht() ? 1 : 0,
+              calo_hit.get_event_id(),
+              static_cast<unsigned long long>(calo_hit.get_tdc()),
+              calo_hit.get_tdc() *
+                snfee::model::feb_constants::SAMLONG_DEFAULT_TDC_LSB_NS,
+              0,
+              0,
+              ch_data.get_baseline(),
+              ch_data.get_baseline() / 16.0,
+              ch_data.get_peak(),
+              ch_data.get_peak() / 8.0,
+              ch_data.get_peak_cell(),
+              ch_data.get_charge(),
+              ch_data.get_charge() / 1024.0,
+              ch_data.is_overflow() ? 1 : 0,
+              ch_data.get_rising_cell() / 256,
+              ch_data.get_rising_cell() % 256,
+              ch_data.get_rising_cell() / 256.0,
+              ch_data.get_falling_cell() / 256,
+              ch_data.get_falling_cell() % 256,
+              ch_data.get_falling_cell() / 256.0,
+              calo_hit.get_fcr(),
+              unix_time);
+            const std::size_t nsamples = waveforms.get_number_of_samples();
+            for (std::size_t isample = 0; isample < nsamples; isample++) {
+              crd_printf(buffer,
+                         isample + 1 < nsamples ? "%d " : "%d\n",
+                         waveforms.get_adc(isample, ich));
+            }
+          }
+        }
+        for (const auto& tracker_hit : data.tracker_hits) {
+          const bool anode = (tracker_hit.get_channel_category() ==
+                              snfee::data::tracker_hit_record::CHANNEL_ANODE);
+          crd_printf(buffer,
+                     "= HIT %d = TRACKER = TRIG_ID %d =\n",
+                     crd_hit_num++,
+                     trigger_id);
+          crd_printf(buffer,
+                     "Slot %d Feast %d Ch %d %s R%d %llu %.4f "
+                     "UnixTime %.3f\n",
+                     tracker_hit.get_board_num(),
+                     tracker_hit.get_chip_num(),
+                     tracker_hit.get_channel_num(),
+                     anode ? "AN" : "CA",
+                     static_cast<int>(tracker_hit.get_timestamp_category()),
+                     static_cast<unsigned long long>(
+                       tracker_hit.get_timestamp()),
+                     tracker_hit.get_timestamp() * 12.5e-3,
+                     unix_time);
+        }
+        fout.write(buffer.data(), buffer.size());
+        summary.triggers++;
+        summary.calo_hits += data.calo_hits.size();
+        summary.tracker_hits += data.tracker_hits.size();
+      }
+      fout << '\n';
+      fout.close();
+      DT_THROW_IF(
+        !fout, std::logic_error, "Cannot write CRD file '" << path << "'!");
+      summary.bytes = file_size(path);
+      return summary;
+    }
+
+    synthetic_generator::summary_type
+    synthetic_generator::write_rhd(const std::string& calo_path_,
+                                   const std::string& tracker_path_)
+    {
+      std::unique_ptr<snfee::io::multifile_data_writer> calo_writer;
+      std::unique_ptr<snfee::io::multifile_data_writer> tracker_writer;
+      if (!calo_path_.empty()) {
+        calo_writer = make_writer(calo_path_);
+      }
+      if (!tracker_path_.empty()) {
+        tracker_writer = make_writer(tracker_path_);
+      }
+      rewind();
+      summary_type summary;
+      trigger_data_type data;
+      for (std::size_t itrig = 0; itrig < _config_.number_of_triggers;
+           itrig++) {
+        generate_trigger(data);
+        if (calo_writer) {
+          for (auto& calo_hit : data.calo_hits) {
+            calo_writer->store(calo_hit);
+          }
+          summary.calo_hits += data.calo_hits.size();
+        }
+        if (tracker_writer) {
+          for (auto& tracker_hit : data.tracker_hits) {
+            tracker_writer->store(tracker_hit);
+          }
+          summary.tracker_hits += data.tracker_hits.size();
+        }
+        summary.triggers++;
+      }
+      // Close the files:
+      calo_writer.reset();
+      tracker_writer.reset();
+      if (!calo_path_.empty()) {
+        summary.bytes += file_size(calo_path_);
+      }
+      if (!tracker_path_.empty()) {
+        summary.bytes += file_size(tracker_path_);
+      }
+      return summary;
+    }
+
+    synthetic_generator::summary_type
+    synthetic_generator::write_rtd(const std::string& path_)
+    {
+      std::unique_ptr<snfee::io::multifile_data_writer> writer =
+        make_writer(path_);
+      rewind();
+      summary_type summary;
+      trigger_data_type data;
+      for (std::size_t itrig = 0; itrig < _config_.number_of_triggers;
+           itrig++) {
+        generate_trigger(data);
+        snfee::data::raw_trigger_data rtd;
+        rtd.set_run_id(_config_.run_id);
+        rtd.set_trigger_id(data.trig.get_trigger_id());
+        rtd.set_trig(std::make_shared<snfee::data::trigger_record>(data.trig));
+        for (auto& calo_hit : data.calo_hits) {
+          rtd.append_calo_hit(std::make_shared<snfee::data::calo_hit_record>(
+            std::move(calo_hit)));
+        }
+        for (auto& tracker_hit : data.tracker_hits) {
+          rtd.append_tracker_hit(
+            std::make_shared<snfee::data::tracker_hit_record>(
+              std::move(tracker_hit)));
+        }
+        writer->store(rtd);
+        summary.triggers++;
+        summary.calo_hits += data.calo_hits.size();
+        summary.tracker_hits += data.tracker_hits.size();
+      }
+      writer.reset();
+      summary.bytes = file_size(path_);
+      return summary;
+    }
+
+  } // namespace bench
+} // namespace snfee
@@ -0,0 +1,108 @@
+//! \file benchmarks/synthetic_generator.h
+//! \brief Deterministic generator of synthetic raw data files
+
+#ifndef SNFEE_BENCH_SYNTHETIC_GENERATOR_H
+#define SNFEE_BENCH_SYNTHETIC_GENERATOR_H
+
+// Standard library:
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/utility.hpp>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/tracker_hit_record.h>
+#include <snfee/data/trigger_record.h>
+
+namespace snfee {
+  namespace bench {
+
+    //! \brief Generator of synthetic CRD, RHD and RTD files
+    //!
+    //! Triggers are generated at a fixed rate. Each trigger holds a
+    //! Poisson-distributed number of calorimeter hits (one per SAMLONG
+    //! chip, with waveforms) and of fired tracker cells (one anode and two
+    //! cathode timestamps per cell). Channels are drawn uniformly within
+    //! the limits of the front-end boards of a crate
+    //! (see snfee::model::feb_constants).
+    //!
+    //! The random sequence only depends on the seed: the same configuration
+    //! always produces the same hits, whatever the output format, so that
+    //! the CRD, RHD and RTD files describe the same data.
+    class synthetic_generator : private boost::noncopyable {
+    public:
+      /// \brief Generator configuration
+      struct config_type {
+        uint32_t seed = 314159;             //!< Seed of the random sequence
+        int32_t run_id = 100;               //!< Run ID
+        int16_t crate_num = 0;              //!< Crate number
+        std::size_t number_of_triggers = 1000; //!< Number of triggers
+        double trigger_rate = 100.0;        //!< Trigger rate (Hz)
+        double mean_calo_hits = 2.0;        //!< Calo hits per trigger
+        double mean_tracker_cells = 8.0;    //!< Tracker cells per trigger
+        uint16_t waveform_number_of_samples =
+          1024; //!< Number of waveform samples per calo hit (0: none)
+      };
+
+      /// \brief Records of a trigger
+      struct trigger_data_type {
+        snfee::data::trigger_record trig;
+        std::vector<snfee::data::calo_hit_record> calo_hits;
+        std::vector<snfee::data::tracker_hit_record> tracker_hits;
+      };
+
+      /// \brief Summary of a generated file
+      struct summary_type {
+        std::size_t triggers = 0;     //!< Number of triggers
+        std::size_t calo_hits = 0;    //!< Number of calorimeter hits
+        std::size_t tracker_hits = 0; //!< Number of tracker hits
+        std::size_t bytes = 0;        //!< Size of the file(s)
+      };
+
+      //! Constructor
+      explicit synthetic_generator(const config_type& cfg_);
+
+      //! Return the configuration
+      const config_type& get_config() const;
+
+      //! Restart the random sequence from the seed
+      void rewind();
+
+      //! Generate the records of the next trigger
+      void generate_trigger(trigger_data_type& data_);
+
+      //! Write a commissioning raw data (CRD) text file
+      summary_type write_crd(const std::string& path_);
+
+      //! Write raw hit data (RHD) files for the calorimeter and tracker
+      //! hits (an empty path skips the corresponding hits)
+      summary_type write_rhd(const std::string& calo_path_,
+                             const std::string& tracker_path_);
+
+      //! Write a raw trigger data (RTD) file
+      summary_type write_rtd(const std::string& path_);
+
+    private:
+      //! Return a Poisson-distributed number of hits
+      std::size_t _draw_multiplicity_(const double mean_,
+                                      const std::size_t max_);
+
+    private:
+      // Configuration:
+      config_type _config_;
+
+      // Working:
+      std::mt19937 _random_;          //!< Random engine
+      int32_t _next_trigger_id_ = 0;  //!< ID of the next trigger
+      int32_t _next_hit_num_ = 0;     //!< Number of the next hit
+    };
+
+  } // namespace bench
+} // namespace snfee
+
+#endif // SNFEE_BENCH_SYNTHETIC_GENERATOR_H
@@ -9,6 +9,7 @@
 #include "snfee/data/raw_trigger_data.h"
 #include "snfee/data/rtdReformater.h"
 #include "snfee/io/multifile_data_reader.h"
+#include "snfee/io/root_output_config.h"
 
 // Input is 1-N RTD file to convert
 // Output is 1 root file
@@ -21,6 +22,7 @@ main(int argc, char* argv[])
   // - Command Line
   snfee::io::multifile_data_reader::config_type inputConfig;
   std::string outputFile{};
+  snfee::io::root_output_config outputConfig;
 
   // clang-format off
   namespace po = boost::program_options;
@@ -38,6 +40,7 @@ main(int argc, char* argv[])
       ->value_name("<PATH>")
       ->required(),
       "path to ROOT output file");
+  snfee::io::root_output_config::add_options(opts);
 
   // Describe command line arguments
   try {
@@ -50,6 +53,7 @@ main(int argc, char* argv[])
       return 0;
     }
     po::notify(vm);
+    outputConfig.configure(vm);
   }
   catch (std::exception& e) {
     std::cerr << "error: " << e.what() << "\n";
@@ -65,10 +69,12 @@ main(int argc, char* argv[])
   // Output
   // Create TFile, TTree, branches?
   TFile writer{outputFile.c_str(), "RECREATE"};
+  outputConfig.apply(writer);
   TTree rtdTree{"RawTriggerData", "SuperNEMO Raw Trigger Data"};
 
   snfee::data::RRawTriggerData* workingRTD{nullptr};
   rtdTree.Branch("RTD", &workingRTD);
+  outputConfig.apply(rtdTree);
 
   // Test handful of records only
   size_t counter{0};
@@ -77,7 +83,7 @@ main(int argc, char* argv[])
   while (reader.has_record_tag() &&
          reader.record_tag_is(snfee::data::raw_trigger_data::SERIAL_TAG)) {
     reader.load(rtdRaw);
-    *workingRTD = snfee::data::rtdOnlineToOffline(rtdRaw);
+    snfee::data::rtdOnlineToOffline(std::move(rtdRaw), *workingRTD);
     rtdTree.Fill();
 
     if (!(counter % 1000))
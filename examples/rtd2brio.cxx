@@ -34,6 +34,10 @@ main(int argc, char* argv[])
       ->required()
       ->multitoken(),
       "path to RTD input file")
+    ("prefetch-depth",
+      po::value<std::size_t>(&inputConfig.prefetch_depth)
+      ->value_name("<N>"),
+      "number of RTD records decoded ahead by a reading thread")
     ("output-file,o",
       po::value<std::string>(&outputFile)
       ->value_name("<PATH>")
@@ -62,6 +66,7 @@ main(int argc, char* argv[])
   // Input
   snfee::data::raw_trigger_data rtdRaw;
   snfee::io::multifile_data_reader reader{inputConfig};
+  reader.add_record_type<snfee::data::raw_trigger_data>();
 
   // Output
   // Create Brio writer
@@ -82,7 +87,7 @@ main(int argc, char* argv[])
 
     workItem.clear();
     auto& rtdBrio = workItem.add<snfee::data::RRawTriggerData>("RTD");
-    rtdBrio = snfee::data::rtdOnlineToOffline(rtdRaw);
+    snfee::data::rtdOnlineToOffline(std::move(rtdRaw), rtdBrio);
     writer.store(workItem, erStore);
 
     if (!(counter % 1000))
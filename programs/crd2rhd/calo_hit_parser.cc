@@ -4,22 +4,16 @@
 #include "calo_hit_parser.h"
 
 // Standard library:
-// #include <limits>
+#include <algorithm>
 
 // Third party:
-// - Boost:
-#include <boost/lexical_cast.hpp>
-#include <boost/phoenix/phoenix.hpp>
-#include <boost/spirit/include/qi.hpp>
-#include <boost/spirit/include/qi_real.hpp>
-// #include <boost/fusion/include/at_c.hpp>
-#include <boost/algorithm/string.hpp>
 // - Bayeux:
 #include <bayeux/datatools/exception.h>
 #include <bayeux/datatools/utils.h>
 
 // This project:
 #include <snfee/model/feb_constants.h>
+#include "raw_record_parser.h"
 
 namespace snfee {
   namespace io {
@@ -119,12 +113,11 @@ namespace snfee {
     }
 
     bool
-    calo_hit_parser::parse(std::istream& in_,
+    calo_hit_parser::parse(crd_tokenizer& in_,
                            snfee::data::calo_hit_record& hit_)
     {
       DT_LOG_TRACE_ENTERING(_logging_);
       bool success = false;
-      namespace qi = boost::spirit::qi;
       try {
         // Backup hit number and trigger ID from the hit:
         int32_t hit_num = hit_.get_hit_num();
@@ -140,29 +133,27 @@ namespace snfee {
           // Header line(s):
           for (std::size_t ihline = 0; ihline < NB_CALO_HEADER_LINES;
                ihline++) {
-            std::string hline;
-            std::getline(in_, hline);
+            crd_line hline = in_.next_line();
             DT_LOG_DEBUG(_logging_,
                          "Calo hit parsing header line number "
-                           << ihline << " : '" << hline << "'");
+                           << ihline << " : '" << hline.to_string() << "'");
             _parse_header_(hline, ihline, headers[ichannel]);
-            in_ >> std::ws;
+            in_.skip_whitespace();
           }
           if (_config_.with_waveforms) {
             // Waveforms:
             snfee::data::calo_hit_record::waveforms_record& waveforms =
               const_cast<snfee::data::calo_hit_record::waveforms_record&>(
                 hit_.get_waveforms());
-            std::string raw_waveform_data_line;
-            std::getline(in_, raw_waveform_data_line);
+            crd_line raw_waveform_data_line = in_.next_line();
             DT_LOG_DEBUG(_logging_,
                          "Parsing raw waveform data line : '"
-                           << raw_waveform_data_line << "'");
+                           << raw_waveform_data_line.to_string() << "'");
             _parse_waveform_(raw_waveform_data_line, ichannel, waveforms);
-            in_ >> std::ws;
+            in_.skip_whitespace();
             DT_LOG_DEBUG(_logging_,
                          "Raw waveforms size             : "
-                           << waveforms.get_samples().size());
+                           << waveforms.get_number_of_samples());
             /// >>> XXX
             // std::cerr << "==============================================" <<
             // std::endl; DT_LOG_DEBUG(_logging_, "[DEVEL] >>>>> TEST 0");
@@ -180,37 +171,40 @@ namespace snfee {
             // std::cerr << "==============================================" <<
             // std::endl;
             /// <<< XXX
+          } else if (!in_.at_end()) {
+            // Skip the raw waveform data line, if any, peeking at it first
+            // not to consume the header of the next hit:
+            crd_tokenizer lookahead = in_;
+            crd_line next_line = lookahead.next_line();
+            uint64_t next_hit_id;
+            std::string next_hit_type;
+            uint64_t next_trigger_id;
+            if (!raw_record_parser::scan_hit_header(
+                  next_line, next_hit_id, next_hit_type, next_trigger_id)) {
+              in_ = lookahead;
+              in_.skip_whitespace();
+            }
           }
           if (ichannel == 0) {
             // Parse intermediate line between 2 associated calorimeter channel
             // hits (same SAMLONG):
-            std::string hitline;
-            std::getline(in_, hitline);
-            DT_LOG_DEBUG(_logging_, "hitline = '" << hitline << "'");
-            std::string::const_iterator str_iter = hitline.begin();
-            std::string::const_iterator end_iter = hitline.end();
+            crd_line hitline = in_.next_line();
+            DT_LOG_DEBUG(_logging_,
+                         "hitline = '" << hitline.to_string() << "'");
+            crd_line_scanner scanner(hitline);
             int32_t next_hit_number;
             int32_t next_trigger_id;
             bool res = false;
-            res =
-              qi::phrase_parse(str_iter,
-                               end_iter,
-                               //  Begin grammar
-                               (qi::lit("=") >> qi::lit("HIT") >>
-                                qi::int_[boost::phoenix::ref(next_hit_number) =
-                                           boost::spirit::qi::_1] >>
-                                qi::lit("=") >> qi::lit("CALO") >>
-                                qi::lit("=") >> qi::lit("TRIG_ID") >>
-                                qi::int_[boost::phoenix::ref(next_trigger_id) =
-                                           boost::spirit::qi::_1] >>
-                                qi::lit("=")),
-                               //  End grammar
-                               qi::space);
+            res = scanner.lit("=") && scanner.lit("HIT") &&
+                  scanner.parse_int(next_hit_number) && scanner.lit("=") &&
+                  scanner.lit("CALO") && scanner.lit("=") &&
+                  scanner.lit("TRIG_ID") &&
+                  scanner.parse_int(next_trigger_id) && scanner.lit("=");
             DT_THROW_IF(
-              !res || str_iter != end_iter,
+              !res || !scanner.at_end(),
               std::logic_error,
               "Cannot parse file calo intermediate hit line; failed at '"
-                << *str_iter << "'!");
+                << scanner.current() << "'!");
             DT_THROW_IF(next_hit_number != hit_.get_hit_num() + 1,
                         std::logic_error,
                         "Hit numbers (" << next_hit_number << " vs "
@@ -266,11 +260,11 @@ namespace snfee {
           snfee::data::calo_hit_record::INVALID_WAVEFORM_NUMBER_OF_SAMPLES;
         if (has_waveforms) {
           waveform_start_sample = 0;
-          DT_LOG_DEBUG(
-            _logging_,
-            "# samples      = " << hit_.get_waveforms().get_samples().size());
+          DT_LOG_DEBUG(_logging_,
+                       "# samples      = "
+                         << hit_.get_waveforms().get_number_of_samples());
           waveform_number_of_samples =
-            hit_.get_waveforms().get_samples().size();
+            hit_.get_waveforms().get_number_of_samples();
         }
         DT_LOG_DEBUG(_logging_,
                      "waveform_start_sample      = " << waveform_start_sample);
@@ -364,7 +358,7 @@ namespace snfee {
     }
 
     void
-    calo_hit_parser::_parse_header_(const std::string& header_line_,
+    calo_hit_parser::_parse_header_(const crd_line& header_line_,
                                     const int index_,
                                     header_type& header_)
     {
@@ -381,97 +375,72 @@ namespace snfee {
     }
 
     void
-    calo_hit_parser::_parse_header_from_2_4_(const std::string& header_line_,
+    calo_hit_parser::_parse_header_from_2_4_(const crd_line& header_line_,
                                              const int index_,
                                              header_type& header_)
     {
       DT_LOG_TRACE_ENTERING(_logging_);
-      namespace qi = boost::spirit::qi;
       bool res = false;
       if (index_ == 0) {
-        std::string header_line = header_line_;
-        DT_LOG_DEBUG(_logging_, "header_line = '" << header_line << "'");
-        std::string::const_iterator str_iter = header_line.begin();
-        std::string::const_iterator end_iter = header_line.end();
-        res = qi::phrase_parse(
-          str_iter,
-          end_iter,
-          //  Begin grammar
-          (qi::lit("Slot") >> qi::uint_[boost::phoenix::ref(header_.slot_id) =
-                                          boost::spirit::qi::_1] >>
-           qi::lit("Ch") >> qi::uint_[boost::phoenix::ref(header_.channel_id) =
-                                        boost::spirit::qi::_1] >>
-           qi::lit("LTO") >> qi::uint_[boost::phoenix::ref(header_.lto_flag) =
-                                         boost::spirit::qi::_1] >>
-           qi::lit("HT") >> qi::uint_[boost::phoenix::ref(header_.ht_flag) =
-                                        boost::spirit::qi::_1] >>
-           qi::lit("EvtID") >> qi::uint_[boost::phoenix::ref(header_.event_id) =
-                                           boost::spirit::qi::_1] >>
-           qi::lit("RawTDC") >>
-           qi::ulong_long[boost::phoenix::ref(header_.raw_tdc) =
-                            boost::spirit::qi::_1] >>
-           qi::lit("TDC") >>
-           qi::double_[boost::phoenix::ref(header_.raw_tdc_ns) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("TrigCount") >>
-           qi::uint_[boost::phoenix::ref(header_.lt_trig_count) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("Timecount") >>
-           qi::uint_[boost::phoenix::ref(header_.lt_time_count) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RawBaseline") >>
-           qi::int_[boost::phoenix::ref(header_.raw_baseline) =
-                      boost::spirit::qi::_1] >>
-           qi::lit("Baseline") >>
-           qi::double_[boost::phoenix::ref(header_.baseline_volt) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("RawPeak") >>
-           qi::int_[boost::phoenix::ref(header_.raw_peak) =
-                      boost::spirit::qi::_1] >>
-           qi::lit("Peak") >>
-           qi::double_[boost::phoenix::ref(header_.peak_volt) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("PeakCell") >>
-           qi::uint_[boost::phoenix::ref(header_.peak_cell) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RawCharge") >>
-           qi::int_[boost::phoenix::ref(header_.raw_charge) =
-                      boost::spirit::qi::_1] >>
-           qi::lit("Charge") >>
-           qi::double_[boost::phoenix::ref(header_.charge_picocoulomb) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("Overflow") >>
-           qi::uint_[boost::phoenix::ref(header_.charge_overflow) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RisingCell") >>
-           qi::uint_[boost::phoenix::ref(header_.rising_cell) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RisingOffset") >>
-           qi::uint_[boost::phoenix::ref(header_.rising_offset) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RisingTime") >>
-           qi::double_[boost::phoenix::ref(header_.rising_ns) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("FallingCell") >>
-           qi::uint_[boost::phoenix::ref(header_.falling_cell) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("FallingOffset") >>
-           qi::uint_[boost::phoenix::ref(header_.falling_offset) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("FallingTime") >>
-           qi::double_[boost::phoenix::ref(header_.falling_ns) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("FCR") >> qi::uint_[boost::phoenix::ref(header_.fcr) =
-                                         boost::spirit::qi::_1] >>
-           qi::lit("UnixTime") >>
-           qi::double_[boost::phoenix::ref(header_.unix_time) =
-                         boost::spirit::qi::_1]),
-          //  End grammar
-          qi::space);
-        DT_THROW_IF(!res || str_iter != end_iter,
+        DT_LOG_DEBUG(_logging_,
+                     "header_line = '" << header_line_.to_string() << "'");
+        crd_line_scanner scanner(header_line_);
+        uint32_t lto_flag = 0;
+        uint32_t ht_flag = 0;
+        int32_t raw_peak = 0;
+        uint32_t peak_cell = 0;
+        uint32_t charge_overflow = 0;
+        uint32_t fcr = 0;
+        res = scanner.lit("Slot") && scanner.parse_uint(header_.slot_id) &&
+              scanner.lit("Ch") && scanner.parse_uint(header_.channel_id) &&
+              scanner.lit("LTO") && scanner.parse_uint(lto_flag) &&
+              scanner.lit("HT") && scanner.parse_uint(ht_flag) &&
+              scanner.lit("EvtID") && scanner.parse_uint(header_.event_id) &&
+              scanner.lit("RawTDC") &&
+              scanner.parse_ulong_long(header_.raw_tdc) &&
+              scanner.lit("TDC") && scanner.parse_double(header_.raw_tdc_ns) &&
+              scanner.lit("TrigCount") &&
+              scanner.parse_uint(header_.lt_trig_count) &&
+              scanner.lit("Timecount") &&
+              scanner.parse_uint(header_.lt_time_count) &&
+              scanner.lit("RawBaseline") &&
+              scanner.parse_int(header_.raw_baseline) &&
+              scanner.lit("Baseline") &&
+              scanner.parse_double(header_.baseline_volt) &&
+              scanner.lit("RawPeak") && scanner.parse_int(raw_peak) &&
+              scanner.lit("Peak") && scanner.parse_double(header_.peak_volt) &&
+              scanner.lit("PeakCell") && scanner.parse_uint(peak_cell) &&
+              scanner.lit("RawCharge") &&
+              scanner.parse_int(header_.raw_charge) &&
+              scanner.lit("Charge") &&
+              scanner.parse_double(header_.charge_picocoulomb) &&
+              scanner.lit("Overflow") && scanner.parse_uint(charge_overflow) &&
+              scanner.lit("RisingCell") &&
+              scanner.parse_uint(header_.rising_cell) &&
+              scanner.lit("RisingOffset") &&
+              scanner.parse_uint(header_.rising_offset) &&
+              scanner.lit("RisingTime") &&
+              scanner.parse_double(header_.rising_ns) &&
+              scanner.lit("FallingCell") &&
+              scanner.parse_uint(header_.falling_cell) &&
+              scanner.lit("FallingOffset") &&
+              scanner.parse_uint(header_.falling_offset) &&
+              scanner.lit("FallingTime") &&
+              scanner.parse_double(header_.falling_ns) &&
+              scanner.lit("FCR") && scanner.parse_uint(fcr) &&
+              scanner.lit("UnixTime") &&
+              scanner.parse_double(header_.unix_time);
+        DT_THROW_IF(!res || !scanner.at_end(),
                     std::logic_error,
                     "Cannot parse file header line #"
-                      << index_ << "; failed at '" << *str_iter << "'!");
+                      << index_ << "; failed at '" << scanner.current()
+                      << "'!");
+        header_.lto_flag = lto_flag;
+        header_.ht_flag = ht_flag;
+        header_.raw_peak = raw_peak;
+        header_.peak_cell = peak_cell;
+        header_.charge_overflow = charge_overflow;
+        header_.fcr = fcr;
       }
 
       DT_LOG_TRACE_EXITING(_logging_);
@@ -480,94 +449,70 @@ namespace snfee {
 
     /// Header parsing
     void
-    calo_hit_parser::_parse_header_from_2_3_(const std::string& header_line_,
+    calo_hit_parser::_parse_header_from_2_3_(const crd_line& header_line_,
                                              const int index_,
                                              header_type& header_)
     {
       DT_LOG_TRACE_ENTERING(_logging_);
-      namespace qi = boost::spirit::qi;
       bool res = false;
       if (index_ == 0) {
-        std::string header_line = header_line_;
-        DT_LOG_DEBUG(_logging_, "header_line = '" << header_line << "'");
-        std::string::const_iterator str_iter = header_line.begin();
-        std::string::const_iterator end_iter = header_line.end();
-        res = qi::phrase_parse(
-          str_iter,
-          end_iter,
-          //  Begin grammar
-          (qi::lit("Slot") >> qi::uint_[boost::phoenix::ref(header_.slot_id) =
-                                          boost::spirit::qi::_1] >>
-           qi::lit("Ch") >> qi::uint_[boost::phoenix::ref(header_.channel_id) =
-                                        boost::spirit::qi::_1] >>
-           qi::lit("LTO") >> qi::uint_[boost::phoenix::ref(header_.lto_flag) =
-                                         boost::spirit::qi::_1] >>
-           qi::lit("HT") >> qi::uint_[boost::phoenix::ref(header_.ht_flag) =
-                                        boost::spirit::qi::_1] >>
-           qi::lit("EvtID") >> qi::uint_[boost::phoenix::ref(header_.event_id) =
-                                           boost::spirit::qi::_1] >>
-           qi::lit("RawTDC") >>
-           qi::ulong_long[boost::phoenix::ref(header_.raw_tdc) =
-                            boost::spirit::qi::_1] >>
-           qi::lit("TDC") >>
-           qi::double_[boost::phoenix::ref(header_.raw_tdc_ns) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("TrigCount") >>
-           qi::uint_[boost::phoenix::ref(header_.lt_trig_count) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("Timecount") >>
-           qi::uint_[boost::phoenix::ref(header_.lt_time_count) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RawBaseline") >>
-           qi::int_[boost::phoenix::ref(header_.raw_baseline) =
-                      boost::spirit::qi::_1] >>
-           qi::lit("Baseline") >>
-           qi::double_[boost::phoenix::ref(header_.baseline_volt) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("RawPeak") >>
-           qi::int_[boost::phoenix::ref(header_.raw_peak) =
-                      boost::spirit::qi::_1] >>
-           qi::lit("Peak") >>
-           qi::double_[boost::phoenix::ref(header_.peak_volt) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("PeakCell") >>
-           qi::uint_[boost::phoenix::ref(header_.peak_cell) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RawCharge") >>
-           qi::int_[boost::phoenix::ref(header_.raw_charge) =
-                      boost::spirit::qi::_1] >>
-           qi::lit("Charge") >>
-           qi::double_[boost::phoenix::ref(header_.charge_picocoulomb) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("Overflow") >>
-           qi::uint_[boost::phoenix::ref(header_.charge_overflow) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RisingCell") >>
-           qi::uint_[boost::phoenix::ref(header_.rising_cell) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RisingOffset") >>
-           qi::uint_[boost::phoenix::ref(header_.rising_offset) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RisingTime") >>
-           qi::double_[boost::phoenix::ref(header_.rising_ns) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("FallingCell") >>
-           qi::uint_[boost::phoenix::ref(header_.falling_cell) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("FallingOffset") >>
-           qi::uint_[boost::phoenix::ref(header_.falling_offset) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("FallingTime") >>
-           qi::double_[boost::phoenix::ref(header_.falling_ns) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("FCR") >>
-           qi::uint_[boost::phoenix::ref(header_.fcr) = boost::spirit::qi::_1]),
-          //  End grammar
-          qi::space);
-        DT_THROW_IF(!res || str_iter != end_iter,
+        DT_LOG_DEBUG(_logging_,
+                     "header_line = '" << header_line_.to_string() << "'");
+        crd_line_scanner scanner(header_line_);
+        uint32_t lto_flag = 0;
+        uint32_t ht_flag = 0;
+        int32_t raw_peak = 0;
+        uint32_t peak_cell = 0;
+        uint32_t charge_overflow = 0;
+        uint32_t fcr = 0;
+        res = scanner.lit("Slot") && scanner.parse_uint(header_.slot_id) &&
+              scanner.lit("Ch") && scanner.parse_uint(header_.channel_id) &&
+              scanner.lit("LTO") && scanner.parse_uint(lto_flag) &&
+              scanner.lit("HT") && scanner.parse_uint(ht_flag) &&
+              scanner.lit("EvtID") && scanner.parse_uint(header_.event_id) &&
+              scanner.lit("RawTDC") &&
+              scanner.parse_ulong_long(header_.raw_tdc) &&
+              scanner.lit("TDC") && scanner.parse_double(header_.raw_tdc_ns) &&
+              scanner.lit("TrigCount") &&
+              scanner.parse_uint(header_.lt_trig_count) &&
+              scanner.lit("Timecount") &&
+              scanner.parse_uint(header_.lt_time_count) &&
+              scanner.lit("RawBaseline") &&
+              scanner.parse_int(header_.raw_baseline) &&
+              scanner.lit("Baseline") &&
+              scanner.parse_double(header_.baseline_volt) &&
+              scanner.lit("RawPeak") && scanner.parse_int(raw_peak) &&
+              scanner.lit("Peak") && scanner.parse_double(header_.peak_volt) &&
+              scanner.lit("PeakCell") && scanner.parse_uint(peak_cell) &&
+              scanner.lit("RawCharge") &&
+              scanner.parse_int(header_.raw_charge) &&
+              scanner.lit("Charge") &&
+              scanner.parse_double(header_.charge_picocoulomb) &&
+              scanner.lit("Overflow") && scanner.parse_uint(charge_overflow) &&
+              scanner.lit("RisingCell") &&
+              scanner.parse_uint(header_.rising_cell) &&
+              scanner.lit("RisingOffset") &&
+              scanner.parse_uint(header_.rising_offset) &&
+              scanner.lit("RisingTime") &&
+              scanner.parse_double(header_.rising_ns) &&
+              scanner.lit("FallingCell") &&
+              scanner.parse_uint(header_.falling_cell) &&
+              scanner.lit("FallingOffset") &&
+              scanner.parse_uint(header_.falling_offset) &&
+              scanner.lit("FallingTime") &&
+              scanner.parse_double(header_.falling_ns) &&
+              scanner.lit("FCR") && scanner.parse_uint(fcr);
+        DT_THROW_IF(!res || !scanner.at_end(),
                     std::logic_error,
                     "Cannot parse file header line #"
-                      << index_ << "; failed at '" << *str_iter << "'!");
+                      << index_ << "; failed at '" << scanner.current()
+                      << "'!");
+        header_.lto_flag = lto_flag;
+        header_.ht_flag = ht_flag;
+        header_.raw_peak = raw_peak;
+        header_.peak_cell = peak_cell;
+        header_.charge_overflow = charge_overflow;
+        header_.fcr = fcr;
       }
 
       DT_LOG_TRACE_EXITING(_logging_);
@@ -576,87 +521,61 @@ namespace snfee {
 
     /// Header parsing
     void
-    calo_hit_parser::_parse_header_legacy_(const std::string& header_line_,
+    calo_hit_parser::_parse_header_legacy_(const crd_line& header_line_,
                                            const int index_,
                                            header_type& header_)
     {
       DT_LOG_TRACE_ENTERING(_logging_);
-      namespace qi = boost::spirit::qi;
       bool res = false;
       if (index_ == 0) {
-        std::string header_line = header_line_;
-        DT_LOG_DEBUG(_logging_, "header_line = '" << header_line << "'");
-        std::string::const_iterator str_iter = header_line.begin();
-        std::string::const_iterator end_iter = header_line.end();
-        res = qi::phrase_parse(
-          str_iter,
-          end_iter,
-          //  Begin grammar
-          (qi::lit("Slot") >> qi::uint_[boost::phoenix::ref(header_.slot_id) =
-                                          boost::spirit::qi::_1] >>
-           qi::lit("Ch") >> qi::uint_[boost::phoenix::ref(header_.channel_id) =
-                                        boost::spirit::qi::_1] >>
-           qi::lit("EvtID") >> qi::uint_[boost::phoenix::ref(header_.event_id) =
-                                           boost::spirit::qi::_1] >>
-           qi::lit("RawTDC") >>
-           qi::ulong_long[boost::phoenix::ref(header_.raw_tdc) =
-                            boost::spirit::qi::_1] >>
-           qi::lit("TDC") >>
-           qi::double_[boost::phoenix::ref(header_.raw_tdc_ns) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("TrigCount") >>
-           qi::uint_[boost::phoenix::ref(header_.lt_trig_count) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("Timecount") >>
-           qi::uint_[boost::phoenix::ref(header_.lt_time_count) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RawBaseline") >>
-           qi::int_[boost::phoenix::ref(header_.raw_baseline) =
-                      boost::spirit::qi::_1] >>
-           qi::lit("Baseline") >>
-           qi::double_[boost::phoenix::ref(header_.baseline_volt) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("RawPeak") >>
-           qi::int_[boost::phoenix::ref(header_.raw_peak) =
-                      boost::spirit::qi::_1] >>
-           qi::lit("Peak") >>
-           qi::double_[boost::phoenix::ref(header_.peak_volt) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("RawCharge") >>
-           qi::int_[boost::phoenix::ref(header_.raw_charge) =
-                      boost::spirit::qi::_1] >>
-           qi::lit("Charge") >>
-           qi::double_[boost::phoenix::ref(header_.charge_picocoulomb) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("Overflow") >>
-           qi::uint_[boost::phoenix::ref(header_.charge_overflow) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RisingCell") >>
-           qi::uint_[boost::phoenix::ref(header_.rising_cell) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RisingOffset") >>
-           qi::uint_[boost::phoenix::ref(header_.rising_offset) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("RisingTime") >>
-           qi::double_[boost::phoenix::ref(header_.rising_ns) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("FallingCell") >>
-           qi::uint_[boost::phoenix::ref(header_.falling_cell) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("FallingOffset") >>
-           qi::uint_[boost::phoenix::ref(header_.falling_offset) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("FallingTime") >>
-           qi::double_[boost::phoenix::ref(header_.falling_ns) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("FCR") >>
-           qi::uint_[boost::phoenix::ref(header_.fcr) = boost::spirit::qi::_1]),
-          //  End grammar
-          qi::space);
-        DT_THROW_IF(!res || str_iter != end_iter,
+        DT_LOG_DEBUG(_logging_,
+                     "header_line = '" << header_line_.to_string() << "'");
+        crd_line_scanner scanner(header_line_);
+        int32_t raw_peak = 0;
+        uint32_t charge_overflow = 0;
+        uint32_t fcr = 0;
+        res = scanner.lit("Slot") && scanner.parse_uint(header_.slot_id) &&
+              scanner.lit("Ch") && scanner.parse_uint(header_.channel_id) &&
+              scanner.lit("EvtID") && scanner.parse_uint(header_.event_id) &&
+              scanner.lit("RawTDC") &&
+              scanner.parse_ulong_long(header_.raw_tdc) &&
+              scanner.lit("TDC") && scanner.parse_double(header_.raw_tdc_ns) &&
+              scanner.lit("TrigCount") &&
+              scanner.parse_uint(header_.lt_trig_count) &&
+              scanner.lit("Timecount") &&
+              scanner.parse_uint(header_.lt_time_count) &&
+              scanner.lit("RawBaseline") &&
+              scanner.parse_int(header_.raw_baseline) &&
+              scanner.lit("Baseline") &&
+              scanner.parse_double(header_.baseline_volt) &&
+              scanner.lit("RawPeak") && scanner.parse_int(raw_peak) &&
+              scanner.lit("Peak") && scanner.parse_double(header_.peak_volt) &&
+              scanner.lit("RawCharge") &&
+              scanner.parse_int(header_.raw_charge) &&
+              scanner.lit("Charge") &&
+              scanner.parse_double(header_.charge_picocoulomb) &&
+              scanner.lit("Overflow") && scanner.parse_uint(charge_overflow) &&
+              scanner.lit("RisingCell") &&
+              scanner.parse_uint(header_.rising_cell) &&
+              scanner.lit("RisingOffset") &&
+              scanner.parse_uint(header_.rising_offset) &&
+              scanner.lit("RisingTime") &&
+              scanner.parse_double(header_.rising_ns) &&
+              scanner.lit("FallingCell") &&
+              scanner.parse_uint(header_.falling_cell) &&
+              scanner.lit("FallingOffset") &&
+              scanner.parse_uint(header_.falling_offset) &&
+              scanner.lit("FallingTime") &&
+              scanner.parse_double(header_.falling_ns) &&
+              scanner.lit("FCR") && scanner.parse_uint(fcr);
+        DT_THROW_IF(!res || !scanner.at_end(),
                     std::logic_error,
                     "Cannot parse file header line #"
-                      << index_ << "; failed at '" << *str_iter << "'!");
+                      << index_ << "; failed at '" << scanner.current()
+                      << "'!");
+        header_.raw_peak = raw_peak;
+        header_.charge_overflow = charge_overflow;
+        header_.fcr = fcr;
       }
       DT_LOG_TRACE_EXITING(_logging_);
       return;
@@ -664,54 +583,52 @@ namespace snfee {
 
     void
     calo_hit_parser::_parse_waveform_(
-      const std::string& data_line_,
+      const crd_line& data_line_,
       const uint16_t channel_index_,
       snfee::data::calo_hit_record::waveforms_record& waveforms_)
     {
       DT_LOG_TRACE_ENTERING(_logging_);
-      namespace qi = boost::spirit::qi;
-
-      std::string::const_iterator str_iter = data_line_.begin();
-      std::string::const_iterator end_iter = data_line_.end();
-      std::vector<int16_t> channel_waveform_data;
-      //     std::size_t waveform_data_size = XXX; // unknown from the header
-      //     !!! so we let Spirit guess it...
-      bool res = false;
-      res = qi::phrase_parse(str_iter,
-                             end_iter,
-                             //  Begin grammar
-                             (
-                               // qi::repeat(hit_.waveform_data_size)[qi::int_]
-                               +qi::int_),
-                             //  End grammar
-                             qi::space,
-                             channel_waveform_data);
-      DT_THROW_IF(!res || str_iter != end_iter,
+      // The number of samples is unknown from the header of the first
+      // channel, so the samples are decoded in place in a full size
+      // waveform which is then shrunk to the parsed number of samples:
+      const bool first_channel = (waveforms_.get_number_of_samples() == 0);
+      if (first_channel) {
+        waveforms_.reset(
+          snfee::model::feb_constants::SAMLONG_MAX_NUMBER_OF_SAMPLES);
+      }
+      const snfee::data::calo_hit_record::waveforms_record::samples_view
+        samples = waveforms_.channel_samples(channel_index_);
+      const std::size_t capacity = samples.size();
+      std::size_t nsamples = 0;
+      const waveform_decoder::status_type status = _waveform_decoder_.decode(
+        data_line_, samples.data(), capacity, nsamples);
+      DT_THROW_IF(status == waveform_decoder::DECODE_SYNTAX_ERROR,
                   std::logic_error,
                   "Cannot parse hit waveform samples for channel ["
                     << channel_index_ << "!");
-      DT_LOG_DEBUG(
-        _logging_,
-        "Number of parsed samples : " << channel_waveform_data.size());
-      for (int i = 0; i < 10 /*channel_waveform_data.size()*/; i++) {
+      DT_THROW_IF(status == waveform_decoder::DECODE_RANGE_ERROR,
+                  std::logic_error,
+                  "Invalid ADC value in hit waveform samples for channel ["
+                    << channel_index_ << "]!");
+      DT_THROW_IF(
+        first_channel && status == waveform_decoder::DECODE_CAPACITY_ERROR,
+        std::logic_error,
+        "Too many hit waveform samples for channel [" << channel_index_
+                                                      << "]!");
+      DT_THROW_IF(status == waveform_decoder::DECODE_CAPACITY_ERROR ||
+                    (!first_channel && nsamples != capacity),
+                  std::logic_error,
+                  "Waveforms number of samples does not match the parsed "
+                  "waveform data for channel ["
+                    << channel_index_ << "!");
+      if (first_channel) {
+        waveforms_.resize(nsamples);
+      }
+      DT_LOG_DEBUG(_logging_, "Number of parsed samples : " << nsamples);
+      for (std::size_t i = 0; i < std::min<std::size_t>(10, nsamples); i++) {
         DT_LOG_DEBUG(_logging_,
                      "Channel waveform sample["
-                       << i << "] = " << channel_waveform_data[i]);
-      }
-
-      // Populate the waveform for this channel:
-      if (waveforms_.get_samples().size() == 0) {
-        waveforms_.reset(channel_waveform_data.size());
-      } else {
-        DT_THROW_IF(waveforms_.get_samples().size() !=
-                      channel_waveform_data.size(),
-                    std::logic_error,
-                    "Waveforms number of samples does not match the parsed "
-                    "waveform data for channel ["
-                      << channel_index_ << "!");
-      }
-      for (uint16_t icell = 0; icell < channel_waveform_data.size(); icell++) {
-        waveforms_.set_adc(icell, channel_index_, channel_waveform_data[icell]);
+                       << i << "] = " << waveforms_.get_adc(i, channel_index_));
       }
       DT_LOG_TRACE_EXITING(_logging_);
       return;
@@ -10,6 +10,7 @@
 #include <iostream>
 #include <limits>
 #include <string>
+#include <vector>
 
 // Third party:
 // - Bayeux:
@@ -18,6 +19,8 @@
 
 // This project:
 #include <snfee/data/calo_hit_record.h>
+#include "crd_tokenizer.h"
+#include "waveform_decoder.h"
 
 namespace snfee {
   namespace io {
@@ -59,7 +62,7 @@ namespace snfee {
       void set_config(const config_type&);
 
       //! Parse
-      bool parse(std::istream& in_, snfee::data::calo_hit_record& hit_);
+      bool parse(crd_tokenizer& in_, snfee::data::calo_hit_record& hit_);
 
       /// \brief SuperNEMO Crate Software output
       struct header_type {
@@ -118,28 +121,28 @@ namespace snfee {
 
     private:
       /// Header parsing
-      void _parse_header_(const std::string& header_line_,
+      void _parse_header_(const crd_line& header_line_,
                           const int index_,
                           header_type& header_);
 
       /// Header parsing
-      void _parse_header_from_2_4_(const std::string& header_line_,
+      void _parse_header_from_2_4_(const crd_line& header_line_,
                                    const int index_,
                                    header_type& header_);
 
       /// Header parsing
-      void _parse_header_from_2_3_(const std::string& header_line_,
+      void _parse_header_from_2_3_(const crd_line& header_line_,
                                    const int index_,
                                    header_type& header_);
 
       /// Header parsing
-      void _parse_header_legacy_(const std::string& header_line_,
+      void _parse_header_legacy_(const crd_line& header_line_,
                                  const int index_,
                                  header_type& header_);
 
       /// Waveform samples parsing for one SAMLONG channel
       void _parse_waveform_(
-        const std::string& samples_line_,
+        const crd_line& samples_line_,
         const uint16_t channel_index_,
         snfee::data::calo_hit_record::waveforms_record& waveforms_);
 
@@ -154,6 +157,7 @@ namespace snfee {
       format_version_type _format_ = FORMAT_INVALID;
       // status_type _status_;
       header_type _current_header_;
+      waveform_decoder _waveform_decoder_; //!< Waveform data line decoder
     };
 
   } // namespace io
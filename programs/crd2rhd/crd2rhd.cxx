@@ -1,4 +1,5 @@
 // Standard library:
+#include <chrono>
 #include <cstdio>
 #include <exception>
 #include <fstream>
@@ -7,6 +8,8 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 // Third party:
 // - Bayeux:
@@ -21,10 +24,12 @@
 #include <snfee/data/calo_hit_record.h>
 #include <snfee/data/tracker_hit_record.h>
 #include <snfee/data/trigger_record.h>
+#include <snfee/io/metrics.h>
 #include <snfee/io/multifile_data_writer.h>
 #include <snfee/utils.h>
 
 #include "raw_hit_reader.h"
+#include "thread_pool.h"
 
 // \brief Application configuration parameters
 struct app_params_type {
@@ -44,8 +49,33 @@ struct app_params_type {
   bool force_fake_trigger_ids = false;
   int32_t session_id = 0;
   std::size_t max_crd_per_input_file = 0;
+  std::string batch_listname;
+  snfee::io::metrics_dumper::config_type metrics_config;
 };
 
+// \brief Conversion results of a crate
+struct crate_results_type {
+  int16_t crate_num = -1;
+  std::size_t crd_counter = 0;        ///< Number of loaded CRD records
+  std::size_t stored_rhd_counter = 0; ///< Number of stored RHD records
+  std::size_t input_size = 0;         ///< Size of the CRD input files (bytes)
+  double wall_time = 0.0;             ///< Conversion time (s)
+};
+
+//! Convert the CRD input files of a crate to RHD output files
+void convert_crate(const app_params_type& app_params_,
+                   crate_results_type& results_);
+
+//! Build the parameters of each crate from a batch list file
+void load_batch_list(const app_params_type& app_params_,
+                     std::vector<app_params_type>& crates_params_);
+
+//! Print the throughput of a conversion
+void print_throughput(const std::string& title_,
+                      const std::size_t crd_counter_,
+                      const std::size_t input_size_,
+                      const double wall_time_);
+
 int
 main(int argc_, char** argv_)
 {
@@ -121,6 +151,12 @@ main(int argc_, char** argv_)
        ->default_value(false),
        "allow data writer overrun (expert)")
 
+      ("trigger-index,X",
+       po::value<bool>(& app_params.writer_config.with_trigger_index)
+       ->zero_tokens()
+       ->default_value(false),
+       "save a trigger ID index next to each RHD output file")
+
       ("print-records,P",
        po::value<bool>(& app_params.print_records)
        ->zero_tokens()
@@ -150,8 +186,27 @@ main(int argc_, char** argv_)
        ->default_value(0),
        "set the maximum number of records collected per CRD input file (expert)")
 
+      ("parser-threads,j",
+       po::value<std::size_t>(& app_params.reader_config.number_of_parser_threads)
+       ->value_name("number")
+       ->default_value(1),
+       "set the number of CRD parsing threads (1: sequential parsing)")
+
+      ("parser-chunk-size",
+       po::value<std::size_t>(& app_params.reader_config.parser_chunk_size)
+       ->value_name("bytes")
+       ->default_value(snfee::io::parallel_hit_parser::DEFAULT_CHUNK_SIZE),
+       "set the size of the CRD blocks parsed by each thread (expert)")
+
+      ("batch-list,B",
+       po::value<std::string>(&app_params.batch_listname)
+       ->value_name("path"),
+       "set the filename of the list of crates to be converted concurrently"
+       " (lines: crate number, RHD output file, CRD input files)")
+
       ; // end of options description
     // clang-format on
+    snfee::io::metrics_dumper::config_type::add_options(opts);
 
     // Describe command line arguments :
     po::variables_map vm;
@@ -190,6 +245,27 @@ main(int argc_, char** argv_)
       std::cout << "      --input-list \"snemo_run-8_crd_files.lis\" \\\n";
       std::cout << "      --output-file \"snemo_run-8_rhd_crate-0.xml\" \n";
       std::cout << std::endl << std::endl;
+      std::cout << " 3) Convert the CRD files of all the crates of a run "
+                   "concurrently: "
+                << std::endl
+                << std::endl;
+      std::cout << "    snfee-crd2rhd \\\n";
+      std::cout << "      --parser-threads 8 \\\n";
+      std::cout << "      --max-records-per-file 500000 \\\n";
+      std::cout << "      --dynamic-output-files \\\n";
+      std::cout << "      --batch-list \"snemo_run-8_crates.lis\" \n";
+      std::cout << std::endl;
+      std::cout << "    with the list file holding one line per crate: "
+                << std::endl
+                << std::endl;
+      std::cout << "      0 snemo_run-8_rhd_crate-0.xml RunCalo_8_0.dat "
+                   "RunCalo_8_1.dat"
+                << std::endl;
+      std::cout << "      1 snemo_run-8_rhd_crate-1.xml RunCalo_8_0.dat"
+                << std::endl;
+      std::cout << "      3 snemo_run-8_rhd_crate-3.xml RunTracker_8.dat"
+                << std::endl;
+      std::cout << std::endl << std::endl;
       return (-1);
     }
 
@@ -216,10 +292,17 @@ main(int argc_, char** argv_)
                     << vm["reader-logging"].as<std::string>() << "'!");
     }
 
+    // Run time metrics:
+    app_params.metrics_config.configure(vm);
+
     // Checks:
-    DT_THROW_IF(app_params.reader_config.crate_num < 0,
+    DT_THROW_IF(app_params.batch_listname.empty() and
+                  app_params.reader_config.crate_num < 0,
                 std::logic_error,
                 "Missing crate number!");
+    DT_THROW_IF(app_params.reader_config.number_of_parser_threads == 0,
+                std::logic_error,
+                "Invalid number of parser threads!");
     // DT_THROW_IF(app_params.output_filename.empty(), std::logic_error,
     // "Missing output production raw hit data file!");
 
@@ -241,6 +324,9 @@ main(int argc_, char** argv_)
                      << std::boolalpha
                      << app_params.reader_config.with_calo_waveforms);
     }
+    DT_LOG_DEBUG(app_params.logging,
+                 "Parser threads  = "
+                   << app_params.reader_config.number_of_parser_threads);
     DT_LOG_DEBUG(app_params.logging,
                  "Output filename   = '" << app_params.output_filename << "'");
     DT_LOG_DEBUG(
@@ -253,105 +339,10 @@ main(int argc_, char** argv_)
                  "Terminate/overrun = "
                    << std::boolalpha
                    << app_params.writer_config.terminate_on_overrun);
-
-    // Writer:
-    std::unique_ptr<snfee::io::multifile_data_writer> pWriter;
-    std::string output_file_dirname;
-    std::string output_file_basename;
-    std::string output_file_extension;
-    int output_file_part_num = -1;
-    if (!app_params.output_filename.empty()) {
-      std::string dirpath;
-      std::string basename;
-      // Extract output file:
-      {
-        std::size_t basename_pos = app_params.output_filename.find_last_of("/");
-        basename = app_params.output_filename;
-        if (basename_pos != std::string::npos) {
-          dirpath = app_params.output_filename.substr(0, basename_pos);
-          basename = app_params.output_filename.substr(basename_pos + 1);
-        }
-        std::vector<std::string> strs;
-        boost::split(strs, basename, boost::is_any_of("."));
-        DT_THROW_IF(strs.size() < 2,
-                    std::logic_error,
-                    "Missing output filename extension!");
-        std::ostringstream basename_s;
-        basename_s << strs[0];
-        output_file_basename = basename_s.str();
-        std::ostringstream extension_s;
-        for (int i = 1; i < (int)strs.size(); i++) {
-          extension_s << '.' << strs[i];
-        }
-        output_file_extension = extension_s.str();
-        output_file_part_num = 0;
-      }
-      bool unique_output_file = true;
-      if (app_params.writer_config.max_records_per_file != 0) {
-        unique_output_file = false;
-      }
-      if (app_params.max_rhd_files > 1) {
-        unique_output_file = false;
-      }
-      if (app_params.dynamic_output_files) {
-        unique_output_file = false;
-      }
-      snfee::io::multifile_data_writer::config_type writerCfg =
-        app_params.writer_config;
-      // Build the initial list of output files:
-      if (unique_output_file) {
-        // Unique output file:
-        DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
-                           "Set output file : '" << app_params.output_filename
-                                                 << "'");
-        writerCfg.filenames.push_back(app_params.output_filename);
-      } else {
-        // Multiple output files (with automated postfix index):
-        for (int ipart = 0; ipart < (int)app_params.max_rhd_files; ipart++) {
-          int part_index = 0;
-          // if (output_file_part_num >= 0) {
-          //   part_index = output_file_part_num;
-          // }
-          part_index += ipart;
-          std::ostringstream filename_s;
-          if (!dirpath.empty()) {
-            filename_s << dirpath << '/';
-          }
-          filename_s << output_file_basename << "_part-" << part_index
-                     << output_file_extension;
-          std::string filename = filename_s.str();
-          DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
-                             "Add output file : '" << filename << "'");
-          writerCfg.filenames.push_back(filename);
-          output_file_part_num = ipart;
-        }
-      }
-      output_file_dirname = dirpath;
-      pWriter.reset(
-        new snfee::io::multifile_data_writer(writerCfg, app_params.logging));
-    }
-
-    // Hack for messy trigger IDs:
-    int32_t fake_trigger_id = 0;
-    std::string fake_trigger_id_save =
-      app_params.work_dir + "/snfee-crd2rhd_fake_trigger_ids-" +
-      std::to_string(app_params.session_id) + ".save";
-    if (app_params.force_fake_trigger_ids) {
-      datatools::fetch_path_with_env(fake_trigger_id_save);
-      if (boost::filesystem::exists(fake_trigger_id_save)) {
-        std::ifstream load_fake_trigger_id(fake_trigger_id_save);
-        DT_THROW_IF(!load_fake_trigger_id,
-                    std::logic_error,
-                    "Cannot open '" << fake_trigger_id_save << "'!");
-        load_fake_trigger_id >> fake_trigger_id;
-        DT_THROW_IF(!load_fake_trigger_id,
-                    std::logic_error,
-                    "Cannot read next fake trigger ID from file '"
-                      << fake_trigger_id_save << "'!");
-      }
-      DT_LOG_NOTICE(app_params.logging,
-                    "Forcing starting trigger ID : " << fake_trigger_id);
-    }
+    DT_LOG_DEBUG(app_params.logging,
+                 "Trigger index     = "
+                   << std::boolalpha
+                   << app_params.writer_config.with_trigger_index);
 
     if (!app_params.input_listname.empty()) {
       // Read a file containing a list of input filenames:
@@ -376,131 +367,94 @@ main(int argc_, char** argv_)
         }
       }
     }
-    DT_THROW_IF(app_params.input_filenames.empty(),
-                std::logic_error,
-                "Missing CRD input files!");
-    std::size_t stored_rhd_counter = 0;
-    std::size_t crd_counter = 0;
-    // Input file loop:
-    bool end_of_input = false;
-    for (int i_input_filename = 0;
-         i_input_filename < (int)app_params.input_filenames.size();
-         i_input_filename++) {
-      app_params.reader_config.input_filename =
-        app_params.input_filenames[i_input_filename];
-      DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
-                         "Reading CRD input file : '" +
-                           app_params.reader_config.input_filename + "'");
-      // Reader for RHD data file (for the commissioning phase using the SN
-      // CRATE SOFTWARE acquisition program):
-      snfee::io::raw_hit_reader reader;
-      reader.set_logging(app_params.reader_logging);
-      reader.set_config(app_params.reader_config);
-      reader.initialize();
-      reader.print(std::cerr);
-      std::size_t crd_counter_for_this_file = 0;
-      bool end_of_input_for_this_file = false;
-      // Reader loop:
-      while (reader.has_next_hit()) {
-        DT_LOG_DEBUG(app_params.logging, "Loading next record...");
-        snfee::data::calo_hit_record myCaloRec;
-        snfee::data::tracker_hit_record myTrackerRec;
-        snfee::io::raw_record_parser::record_type ret =
-          reader.load_next_hit(myCaloRec, myTrackerRec);
-        if (ret == snfee::io::raw_record_parser::RECORD_CALO) {
-          DT_LOG_DEBUG(app_params.logging, "Found a calo hit record.");
-          if (app_params.print_records) {
-            boost::property_tree::ptree options;
-            options.put("title", "Loaded calorimeter raw hit data record: ");
-            // options.put("with_waveform_samples", true);
-            myCaloRec.print_tree(std::clog, options);
-          }
-          if (app_params.force_fake_trigger_ids) {
-            myCaloRec.set_trigger_id(fake_trigger_id);
-            fake_trigger_id++;
-          }
-          if (pWriter) {
-            pWriter->store(myCaloRec);
-            stored_rhd_counter++;
-          }
-        } else if (ret == snfee::io::raw_record_parser::RECORD_TRACKER) {
-          DT_LOG_DEBUG(app_params.logging, "Found a tracker hit record.");
-          if (app_params.print_records) {
-            boost::property_tree::ptree options;
-            options.put("title", "Loaded tracker raw hit data record: ");
-            myTrackerRec.print_tree(std::clog, options);
-          }
-          if (pWriter and !pWriter->is_terminated()) {
-            pWriter->store(myTrackerRec);
-            stored_rhd_counter++;
-          }
-        } else if (ret == snfee::io::raw_record_parser::RECORD_TRIGGER) {
-          DT_LOG_WARNING(app_params.logging, "Found a trigger record.");
-          DT_THROW(std::logic_error, "Trigger records are not supported!");
-        } else {
-          DT_THROW(std::logic_error, "Parsing failed!");
-        }
-        crd_counter++;
-        crd_counter_for_this_file++;
-        // End of loop:
-        if (crd_counter % app_params.crd_counter_period == 0) {
-          DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
-                             "Loaded CRD records: " << crd_counter);
-        }
-        if (app_params.writer_config.max_total_records and
-            crd_counter == app_params.writer_config.max_total_records) {
-          DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
-                             "Max CRD records reached!");
-          end_of_input_for_this_file = true;
-          end_of_input = true;
-        }
-        if (app_params.max_crd_per_input_file and
-            crd_counter_for_this_file == app_params.max_crd_per_input_file) {
-          DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
-                             "Max CRD records per input file reached!");
-          end_of_input_for_this_file = true;
-        }
-        if (end_of_input)
-          break;
-        if (end_of_input_for_this_file)
-          break;
-        if (pWriter) {
-          if (app_params.dynamic_output_files && pWriter->is_last_file()) {
-            output_file_part_num++;
-            std::ostringstream filename_s;
-            if (!output_file_dirname.empty()) {
-              filename_s << output_file_dirname << '/';
-            }
-            filename_s << output_file_basename << "_part-"
-                       << output_file_part_num << output_file_extension;
-            std::string rhd_filename = filename_s.str();
-            DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
-                               "Additional output file : '" << rhd_filename
-                                                            << "'");
-            pWriter->add_filename(rhd_filename);
-          }
-        }
-      } // end of reader loop:
-      reader.reset();
-      if (end_of_input)
-        break;
-    } // end of input file loop.
 
-    if (app_params.force_fake_trigger_ids) {
-      DT_LOG_NOTICE(datatools::logger::PRIO_INFORMATION,
-                    "Saving next starting trigger ID : " << fake_trigger_id);
-      std::ofstream save_fake_trigger_id(fake_trigger_id_save);
-      save_fake_trigger_id << fake_trigger_id << std::endl;
+    // Run time metrics (enabled before building the pipeline):
+    std::unique_ptr<snfee::io::metrics_dumper> metricsDumper;
+    if (!app_params.metrics_config.filename.empty()) {
+      snfee::io::metrics_registry::global().set_enabled(true);
+      metricsDumper.reset(
+        new snfee::io::metrics_dumper(app_params.metrics_config));
+      metricsDumper->start();
     }
 
-    if (pWriter) {
-      pWriter.reset();
+    if (app_params.batch_listname.empty()) {
+      crate_results_type results;
+      convert_crate(app_params, results);
+      print_throughput("Throughput",
+                       results.crd_counter,
+                       results.input_size,
+                       results.wall_time);
+    } else {
+      // One conversion pipeline per crate, the parsing of the CRD files
+      // being shared by a common pool of threads:
+      DT_THROW_IF(!app_params.input_filenames.empty() or
+                    !app_params.output_filename.empty(),
+                  std::logic_error,
+                  "Input and output files must be set from the batch list!");
+      DT_THROW_IF(app_params.force_fake_trigger_ids,
+                  std::logic_error,
+                  "Fake trigger IDs are not supported in batch mode!");
+      std::vector<app_params_type> crates_params;
+      load_batch_list(app_params, crates_params);
+      const std::size_t ncrates = crates_params.size();
+      // The parsing tasks never wait for each other, so any number of
+      // threads can serve all the crates:
+      const std::size_t npool_threads =
+        app_params.reader_config.number_of_parser_threads;
+      DT_LOG_NOTICE(app_params.logging,
+                    "Converting " << ncrates << " crates with a pool of "
+                                  << npool_threads << " parsing threads...");
+      snfee::io::thread_pool parser_pool(npool_threads);
+      std::vector<crate_results_type> crates_results(ncrates);
+      std::vector<std::exception_ptr> crates_errors(ncrates);
+      std::vector<std::thread> crates_threads;
+      const auto start_time = std::chrono::steady_clock::now();
+      for (std::size_t icrate = 0; icrate < ncrates; icrate++) {
+        crates_params[icrate].reader_config.parser_pool = &parser_pool;
+        crates_threads.emplace_back(
+          [&crates_params, &crates_results, &crates_errors, icrate] {
+            try {
+              convert_crate(crates_params[icrate], crates_results[icrate]);
+            }
+            catch (...) {
+              crates_errors[icrate] = std::current_exception();
+            }
+          });
+      }
+      for (auto& crate_thread : crates_threads) {
+        crate_thread.join();
+      }
+      const std::chrono::duration<double> wall_time =
+        std::chrono::steady_clock::now() - start_time;
+      for (const auto& crate_error : crates_errors) {
+        if (crate_error) {
+          std::rethrow_exception(crate_error);
+        }
+      }
+      std::size_t crd_counter = 0;
+      std::size_t stored_rhd_counter = 0;
+      std::size_t input_size = 0;
+      for (const auto& results : crates_results) {
+        std::ostringstream title_s;
+        title_s << "Crate #" << results.crate_num << " : "
+                << results.stored_rhd_counter << " stored RHD records";
+        print_throughput(title_s.str(),
+                         results.crd_counter,
+                         results.input_size,
+                         results.wall_time);
+        crd_counter += results.crd_counter;
+        stored_rhd_counter += results.stored_rhd_counter;
+        input_size += results.input_size;
+      }
+      std::ostringstream title_s;
+      title_s << "All crates : " << stored_rhd_counter
+              << " stored RHD records";
+      print_throughput(
+        title_s.str(), crd_counter, input_size, wall_time.count());
+    }
+    if (metricsDumper) {
+      metricsDumper->stop();
     }
-
-    DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
-                       "Loaded CRD records: " << crd_counter);
-    DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
-                       "Stored RHD records: " << stored_rhd_counter);
   }
   catch (std::exception& x) {
     std::cerr << "error: " << x.what() << std::endl;
@@ -513,3 +467,363 @@ main(int argc_, char** argv_)
   }
   return (error_code);
 }
+
+void
+convert_crate(const app_params_type& app_params_, crate_results_type& results_)
+{
+  app_params_type app_params = app_params_;
+  const auto start_time = std::chrono::steady_clock::now();
+  results_ = crate_results_type();
+  results_.crate_num = app_params.reader_config.crate_num;
+
+  // Metrics (null if disabled):
+  const std::string crate_label =
+    "crate#" + std::to_string(app_params.reader_config.crate_num);
+  snfee::io::metrics_counter* records_metrics = nullptr;
+  snfee::io::metrics_counter* bytes_metrics = nullptr;
+  snfee::io::metrics_histogram* parse_metrics = nullptr;
+  snfee::io::metrics_registry& registry = snfee::io::metrics_registry::global();
+  if (registry.is_enabled()) {
+    const snfee::io::metrics_registry::labels_type labels = {
+      {"crate", crate_label}};
+    records_metrics =
+      &registry.make_counter("snfee_crd2rhd_records_total",
+                             "Number of CRD records loaded from the input",
+                             labels);
+    bytes_metrics =
+      &registry.make_counter("snfee_crd2rhd_bytes_total",
+                             "Size of the CRD input files read through",
+                             labels);
+    parse_metrics = &registry.make_histogram(
+      "snfee_crd2rhd_parse_seconds",
+      "Time spent waiting for the next parsed CRD record (s)",
+      labels);
+  }
+
+  // Writer:
+  std::unique_ptr<snfee::io::multifile_data_writer> pWriter;
+  std::string output_file_dirname;
+  std::string output_file_basename;
+  std::string output_file_extension;
+  int output_file_part_num = -1;
+  if (!app_params.output_filename.empty()) {
+    std::string dirpath;
+    std::string basename;
+    // Extract output file:
+    {
+      std::size_t basename_pos = app_params.output_filename.find_last_of("/");
+      basename = app_params.output_filename;
+      if (basename_pos != std::string::npos) {
+        dirpath = app_params.output_filename.substr(0, basename_pos);
+        basename = app_params.output_filename.substr(basename_pos + 1);
+      }
+      std::vector<std::string> strs;
+      boost::split(strs, basename, boost::is_any_of("."));
+      DT_THROW_IF(strs.size() < 2,
+                  std::logic_error,
+                  "Missing output filename extension!");
+      std::ostringstream basename_s;
+      basename_s << strs[0];
+      output_file_basename = basename_s.str();
+      std::ostringstream extension_s;
+      for (int i = 1; i < (int)strs.size(); i++) {
+        extension_s << '.' << strs[i];
+      }
+      output_file_extension = extension_s.str();
+      output_file_part_num = 0;
+    }
+    bool unique_output_file = true;
+    if (app_params.writer_config.max_records_per_file != 0) {
+      unique_output_file = false;
+    }
+    if (app_params.max_rhd_files > 1) {
+      unique_output_file = false;
+    }
+    if (app_params.dynamic_output_files) {
+      unique_output_file = false;
+    }
+    snfee::io::multifile_data_writer::config_type writerCfg =
+      app_params.writer_config;
+    writerCfg.metrics_label = crate_label;
+    // Build the initial list of output files:
+    if (unique_output_file) {
+      // Unique output file:
+      DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
+                         "Set output file : '" << app_params.output_filename
+                                               << "'");
+      writerCfg.filenames.push_back(app_params.output_filename);
+    } else {
+      // Multiple output files (with automated postfix index):
+      for (int ipart = 0; ipart < (int)app_params.max_rhd_files; ipart++) {
+        int part_index = 0;
+        // if (output_file_part_num >= 0) {
+        //   part_index = output_file_part_num;
+        // }
+        part_index += ipart;
+        std::ostringstream filename_s;
+        if (!dirpath.empty()) {
+          filename_s << dirpath << '/';
+        }
+        filename_s << output_file_basename << "_part-" << part_index
+                   << output_file_extension;
+        std::string filename = filename_s.str();
+        DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
+                           "Add output file : '" << filename << "'");
+        writerCfg.filenames.push_back(filename);
+        output_file_part_num = ipart;
+      }
+    }
+    output_file_dirname = dirpath;
+    pWriter.reset(
+      new snfee::io::multifile_data_writer(writerCfg, app_params.logging));
+  }
+
+  // Hack for messy trigger IDs:
+  int32_t fake_trigger_id = 0;
+  std::string fake_trigger_id_save =
+    app_params.work_dir + "/snfee-crd2rhd_fake_trigger_ids-" +
+    std::to_string(app_params.session_id) + ".save";
+  if (app_params.force_fake_trigger_ids) {
+    datatools::fetch_path_with_env(fake_trigger_id_save);
+    if (boost::filesystem::exists(fake_trigger_id_save)) {
+      std::ifstream load_fake_trigger_id(fake_trigger_id_save);
+      DT_THROW_IF(!load_fake_trigger_id,
+                  std::logic_error,
+                  "Cannot open '" << fake_trigger_id_save << "'!");
+      load_fake_trigger_id >> fake_trigger_id;
+      DT_THROW_IF(!load_fake_trigger_id,
+                  std::logic_error,
+                  "Cannot read next fake trigger ID from file '"
+                    << fake_trigger_id_save << "'!");
+    }
+    DT_LOG_NOTICE(app_params.logging,
+                  "Forcing starting trigger ID : " << fake_trigger_id);
+  }
+
+  DT_THROW_IF(app_params.input_filenames.empty(),
+              std::logic_error,
+              "Missing CRD input files!");
+  std::size_t stored_rhd_counter = 0;
+  std::size_t crd_counter = 0;
+  // Input file loop:
+  bool end_of_input = false;
+  for (int i_input_filename = 0;
+       i_input_filename < (int)app_params.input_filenames.size();
+       i_input_filename++) {
+    app_params.reader_config.input_filename =
+      app_params.input_filenames[i_input_filename];
+    DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
+                       "Reading CRD input file : '" +
+                         app_params.reader_config.input_filename + "'");
+    // Reader for RHD data file (for the commissioning phase using the SN
+    // CRATE SOFTWARE acquisition program):
+    snfee::io::raw_hit_reader reader;
+    reader.set_logging(app_params.reader_logging);
+    reader.set_config(app_params.reader_config);
+    reader.initialize();
+    reader.print(std::cerr);
+    std::size_t crd_counter_for_this_file = 0;
+    bool end_of_input_for_this_file = false;
+    // Reader loop:
+    while (reader.has_next_hit()) {
+      DT_LOG_DEBUG(app_params.logging, "Loading next record...");
+      snfee::data::calo_hit_record myCaloRec;
+      snfee::data::tracker_hit_record myTrackerRec;
+      snfee::io::raw_record_parser::record_type ret =
+        snfee::io::raw_record_parser::RECORD_UNDEF;
+      {
+        snfee::io::metrics_timer parse_timer(parse_metrics);
+        ret = reader.load_next_hit(myCaloRec, myTrackerRec);
+      }
+      if (ret == snfee::io::raw_record_parser::RECORD_CALO) {
+        DT_LOG_DEBUG(app_params.logging, "Found a calo hit record.");
+        if (app_params.print_records) {
+          boost::property_tree::ptree options;
+          options.put("title", "Loaded calorimeter raw hit data record: ");
+          // options.put("with_waveform_samples", true);
+          myCaloRec.print_tree(std::clog, options);
+        }
+        if (app_params.force_fake_trigger_ids) {
+          myCaloRec.set_trigger_id(fake_trigger_id);
+          fake_trigger_id++;
+        }
+        if (pWriter) {
+          pWriter->store(myCaloRec);
+          stored_rhd_counter++;
+        }
+      } else if (ret == snfee::io::raw_record_parser::RECORD_TRACKER) {
+        DT_LOG_DEBUG(app_params.logging, "Found a tracker hit record.");
+        if (app_params.print_records) {
+          boost::property_tree::ptree options;
+          options.put("title", "Loaded tracker raw hit data record: ");
+          myTrackerRec.print_tree(std::clog, options);
+        }
+        if (pWriter and !pWriter->is_terminated()) {
+          pWriter->store(myTrackerRec);
+          stored_rhd_counter++;
+        }
+      } else if (ret == snfee::io::raw_record_parser::RECORD_TRIGGER) {
+        DT_LOG_WARNING(app_params.logging, "Found a trigger record.");
+        DT_THROW(std::logic_error, "Trigger records are not supported!");
+      } else {
+        DT_THROW(std::logic_error, "Parsing failed!");
+      }
+      crd_counter++;
+      crd_counter_for_this_file++;
+      if (records_metrics) {
+        records_metrics->add();
+      }
+      // End of loop:
+      if (crd_counter % app_params.crd_counter_period == 0) {
+        DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
+                           "Loaded CRD records: " << crd_counter);
+      }
+      if (app_params.writer_config.max_total_records and
+          crd_counter == app_params.writer_config.max_total_records) {
+        DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
+                           "Max CRD records reached!");
+        end_of_input_for_this_file = true;
+        end_of_input = true;
+      }
+      if (app_params.max_crd_per_input_file and
+          crd_counter_for_this_file == app_params.max_crd_per_input_file) {
+        DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
+                           "Max CRD records per input file reached!");
+        end_of_input_for_this_file = true;
+      }
+      if (end_of_input)
+        break;
+      if (end_of_input_for_this_file)
+        break;
+      if (pWriter) {
+        if (app_params.dynamic_output_files && pWriter->is_last_file()) {
+          output_file_part_num++;
+          std::ostringstream filename_s;
+          if (!output_file_dirname.empty()) {
+            filename_s << output_file_dirname << '/';
+          }
+          filename_s << output_file_basename << "_part-"
+                     << output_file_part_num << output_file_extension;
+          std::string rhd_filename = filename_s.str();
+          DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
+                             "Additional output file : '" << rhd_filename
+                                                          << "'");
+          pWriter->add_filename(rhd_filename);
+        }
+      }
+    } // end of reader loop:
+    reader.reset();
+    if (bytes_metrics) {
+      boost::system::error_code ec;
+      const boost::uintmax_t input_size = boost::filesystem::file_size(
+        app_params.input_filenames[i_input_filename], ec);
+      if (!ec) {
+        bytes_metrics->add(input_size);
+      }
+    }
+    if (end_of_input)
+      break;
+  } // end of input file loop.
+
+  if (app_params.force_fake_trigger_ids) {
+    DT_LOG_NOTICE(datatools::logger::PRIO_INFORMATION,
+                  "Saving next starting trigger ID : " << fake_trigger_id);
+    std::ofstream save_fake_trigger_id(fake_trigger_id_save);
+    save_fake_trigger_id << fake_trigger_id << std::endl;
+  }
+
+  if (pWriter) {
+    pWriter.reset();
+  }
+
+  DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
+                     "Loaded CRD records: " << crd_counter);
+  DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION,
+                     "Stored RHD records: " << stored_rhd_counter);
+
+  results_.crd_counter = crd_counter;
+  results_.stored_rhd_counter = stored_rhd_counter;
+  for (const auto& input_filename : app_params.input_filenames) {
+    boost::system::error_code ec;
+    const boost::uintmax_t input_size =
+      boost::filesystem::file_size(input_filename, ec);
+    if (!ec) {
+      results_.input_size += input_size;
+    }
+  }
+  const std::chrono::duration<double> wall_time =
+    std::chrono::steady_clock::now() - start_time;
+  results_.wall_time = wall_time.count();
+  return;
+}
+
+void
+load_batch_list(const app_params_type& app_params_,
+                std::vector<app_params_type>& crates_params_)
+{
+  std::string listname = app_params_.batch_listname;
+  datatools::fetch_path_with_env(listname);
+  std::ifstream fbatch_list(listname);
+  DT_THROW_IF(!fbatch_list,
+              std::logic_error,
+              "Cannot open batch list filename '" << listname << "'!");
+  while (fbatch_list and !fbatch_list.eof()) {
+    std::string line;
+    std::getline(fbatch_list, line);
+    boost::trim(line);
+    if (line.empty() or line[0] == '#') {
+      continue;
+    }
+    // Format: crate number, RHD output file, CRD input files...
+    std::istringstream ins(line);
+    app_params_type crate_params = app_params_;
+    crate_params.batch_listname.clear();
+    ins >> crate_params.reader_config.crate_num >> std::ws;
+    DT_THROW_IF(!ins or crate_params.reader_config.crate_num < 0,
+                std::logic_error,
+                "Invalid crate number in batch list line '" << line << "'!");
+    ins >> crate_params.output_filename >> std::ws;
+    while (ins and !ins.eof()) {
+      std::string input_filename;
+      ins >> input_filename >> std::ws;
+      if (!input_filename.empty()) {
+        crate_params.input_filenames.push_back(input_filename);
+      }
+    }
+    DT_THROW_IF(crate_params.output_filename.empty() or
+                  crate_params.input_filenames.empty(),
+                std::logic_error,
+                "Missing RHD output file or CRD input files in batch list "
+                "line '"
+                  << line << "'!");
+    for (const auto& other_params : crates_params_) {
+      DT_THROW_IF(other_params.reader_config.crate_num ==
+                    crate_params.reader_config.crate_num,
+                  std::logic_error,
+                  "Duplicated crate number ["
+                    << crate_params.reader_config.crate_num
+                    << "] in batch list!");
+    }
+    crates_params_.push_back(crate_params);
+  }
+  DT_THROW_IF(
+    crates_params_.empty(), std::logic_error, "Empty batch list!");
+  return;
+}
+
+void
+print_throughput(const std::string& title_,
+                 const std::size_t crd_counter_,
+                 const std::size_t input_size_,
+                 const double wall_time_)
+{
+  std::ostringstream out;
+  out << title_ << " : " << crd_counter_ << " CRD records ("
+      << input_size_ / (1024 * 1024) << " MB) in " << wall_time_ << " s";
+  if (wall_time_ > 0.0) {
+    out << " (" << crd_counter_ / wall_time_ << " records/s, "
+        << input_size_ / (1024.0 * 1024.0) / wall_time_ << " MB/s)";
+  }
+  DT_LOG_INFORMATION(datatools::logger::PRIO_INFORMATION, out.str());
+  return;
+}
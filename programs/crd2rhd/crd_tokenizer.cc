@@ -0,0 +1,288 @@
+// programs/crd2rhd/crd_tokenizer.cc
+
+// Ourselves:
+#include "crd_tokenizer.h"
+
+// Standard library:
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+// - POSIX:
+#include <fcntl.h>
+#include <locale.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/utils.h>
+
+namespace snfee {
+  namespace io {
+
+    namespace {
+
+      //! Return the "C" locale, so that the parsing of the real numbers does
+      //! not depend on the global locale
+      locale_t
+      c_locale()
+      {
+        static const locale_t locale =
+          ::newlocale(LC_ALL_MASK, "C", static_cast<locale_t>(0));
+        return locale;
+      }
+
+      //! Case insensitive match of a lower case keyword
+      inline bool
+      match_nocase(const char* first_, const char* last_, const char* kw_)
+      {
+        for (; *kw_ != 0; ++kw_, ++first_) {
+          if (first_ == last_ || (*first_ | 0x20) != *kw_) {
+            return false;
+          }
+        }
+        return true;
+      }
+
+    } // namespace
+
+    // ---------------------------------------------------------------------
+
+    crd_mapped_file::~crd_mapped_file()
+    {
+      close();
+      return;
+    }
+
+    void
+    crd_mapped_file::open(const std::string& path_)
+    {
+      DT_THROW_IF(is_open(), std::logic_error, "A file is already mapped!");
+      std::string path = path_;
+      datatools::fetch_path_with_env(path);
+      int fd = ::open(path.c_str(), O_RDONLY);
+      DT_THROW_IF(
+        fd < 0, std::runtime_error, "Cannot open input file '" << path_ << "'");
+      struct stat st;
+      if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        DT_THROW(std::runtime_error,
+                 "Cannot stat input file '" << path_ << "'");
+      }
+      _fd_ = fd;
+      _size_ = static_cast<std::size_t>(st.st_size);
+      if (_size_ > 0) {
+        void* addr = ::mmap(nullptr, _size_, PROT_READ, MAP_PRIVATE, _fd_, 0);
+        if (addr == MAP_FAILED) {
+          const int err = errno;
+          ::close(_fd_);
+          _fd_ = -1;
+          _size_ = 0;
+          DT_THROW(std::runtime_error,
+                   "Cannot map input file '" << path_
+                                             << "': " << std::strerror(err));
+        }
+        // Records are consumed once, from front to back:
+        ::madvise(addr, _size_, MADV_SEQUENTIAL);
+        _data_ = static_cast<const char*>(addr);
+      }
+      return;
+    }
+
+    void
+    crd_mapped_file::close()
+    {
+      if (_data_ != nullptr) {
+        ::munmap(const_cast<char*>(_data_), _size_);
+        _data_ = nullptr;
+      }
+      if (_fd_ >= 0) {
+        ::close(_fd_);
+        _fd_ = -1;
+      }
+      _size_ = 0;
+      return;
+    }
+
+    bool
+    crd_mapped_file::is_open() const
+    {
+      return _fd_ >= 0;
+    }
+
+    const char*
+    crd_mapped_file::begin() const
+    {
+      return _data_;
+    }
+
+    const char*
+    crd_mapped_file::end() const
+    {
+      return _data_ + _size_;
+    }
+
+    std::size_t
+    crd_mapped_file::size() const
+    {
+      return _size_;
+    }
+
+    // ---------------------------------------------------------------------
+
+    crd_tokenizer::crd_tokenizer(const char* begin_, const char* end_)
+      : _cursor_(begin_)
+      , _end_(end_)
+    {
+      return;
+    }
+
+    void
+    crd_tokenizer::skip_whitespace()
+    {
+      while (_cursor_ != _end_ && crd_is_space(*_cursor_)) {
+        ++_cursor_;
+      }
+      return;
+    }
+
+    crd_line
+    crd_tokenizer::next_line()
+    {
+      crd_line line;
+      line.begin = _cursor_;
+      const std::size_t n = _end_ - _cursor_;
+      const char* eol = nullptr;
+      if (n > 0) {
+        eol = static_cast<const char*>(std::memchr(_cursor_, '\n', n));
+      }
+      if (eol == nullptr) {
+        line.end = _end_;
+        _cursor_ = _end_;
+      } else {
+        line.end = eol;
+        _cursor_ = eol + 1;
+      }
+      return line;
+    }
+
+    // ---------------------------------------------------------------------
+
+    crd_line_scanner::crd_line_scanner(const crd_line& line_)
+      : _cursor_(line_.begin)
+      , _end_(line_.end)
+    {
+      return;
+    }
+
+    char
+    crd_line_scanner::current() const
+    {
+      return _cursor_ == _end_ ? '\0' : *_cursor_;
+    }
+
+    bool
+    crd_line_scanner::parse_double(double& value_)
+    {
+      skip_spaces();
+      const char* start = _cursor_;
+      const char* p = _cursor_;
+      bool negative = false;
+      if (p != _end_ && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+      }
+      // Special values:
+      if (match_nocase(p, _end_, "nan")) {
+        p += 3;
+        if (p != _end_ && *p == '(') {
+          const char* q = p;
+          while (q != _end_ && *q != ')') {
+            ++q;
+          }
+          if (q != _end_) {
+            p = q + 1;
+          }
+        }
+        value_ = negative ? -std::numeric_limits<double>::quiet_NaN()
+                          : std::numeric_limits<double>::quiet_NaN();
+        _cursor_ = p;
+        return true;
+      }
+      if (match_nocase(p, _end_, "inf")) {
+        p += match_nocase(p, _end_, "infinity") ? 8 : 3;
+        value_ = negative ? -std::numeric_limits<double>::infinity()
+                          : std::numeric_limits<double>::infinity();
+        _cursor_ = p;
+        return true;
+      }
+      // Mantissa (leading and trailing dots are allowed):
+      std::size_t ndigits = 0;
+      for (; p != _end_ && crd_is_digit(*p); ++p) {
+        ndigits++;
+      }
+      if (p != _end_ && *p == '.') {
+        ++p;
+        for (; p != _end_ && crd_is_digit(*p); ++p) {
+          ndigits++;
+        }
+      }
+      if (ndigits == 0) {
+        return false;
+      }
+      // Exponent (ignored if not followed by digits):
+      if (p != _end_ && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        if (q != _end_ && (*q == '-' || *q == '+')) {
+          ++q;
+        }
+        if (q != _end_ && crd_is_digit(*q)) {
+          for (; q != _end_ && crd_is_digit(*q); ++q) {
+          }
+          p = q;
+        }
+      }
+      // The token is validated, let the C library do the rounding:
+      const std::size_t len = p - start;
+      char buffer[64];
+      if (len < sizeof(buffer)) {
+        std::memcpy(buffer, start, len);
+        buffer[len] = 0;
+        value_ = ::strtod_l(buffer, nullptr, c_locale());
+      } else {
+        const std::string token(start, p);
+        value_ = ::strtod_l(token.c_str(), nullptr, c_locale());
+      }
+      _cursor_ = p;
+      return true;
+    }
+
+    bool
+    crd_line_scanner::parse_until(const char stop_, std::string& value_)
+    {
+      skip_spaces();
+      if (_cursor_ == _end_ || *_cursor_ == stop_) {
+        return false;
+      }
+      value_.clear();
+      while (_cursor_ != _end_ && *_cursor_ != stop_) {
+        if (!crd_is_space(*_cursor_)) {
+          value_.push_back(*_cursor_);
+        }
+        ++_cursor_;
+      }
+      return true;
+    }
+
+    bool
+    crd_line_scanner::at_end()
+    {
+      skip_spaces();
+      return _cursor_ == _end_;
+    }
+
+  } // namespace io
+} // namespace snfee
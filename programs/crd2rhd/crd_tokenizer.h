@@ -0,0 +1,250 @@
+//! \file programs/crd2rhd/crd_tokenizer.h
+//! \brief Memory-mapped tokenizer for commissioning raw data (CRD) files
+
+#ifndef SNFEE_IO_CRD_TOKENIZER_H
+#define SNFEE_IO_CRD_TOKENIZER_H
+
+// Standard library:
+#include <cstdint>
+#include <limits>
+#include <string>
+
+// Third party:
+// - Boost:
+#include <boost/utility.hpp>
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Read-only memory mapping of a CRD file
+    class crd_mapped_file : private boost::noncopyable {
+    public:
+      //! Default constructor
+      crd_mapped_file() = default;
+
+      //! Destructor
+      ~crd_mapped_file();
+
+      //! Map the file with given path (environment variables are expanded)
+      void open(const std::string& path_);
+
+      //! Unmap the file
+      void close();
+
+      //! Check if a file is mapped
+      bool is_open() const;
+
+      //! Return the first mapped byte
+      const char* begin() const;
+
+      //! Return the past-the-end mapped byte
+      const char* end() const;
+
+      //! Return the size of the mapped file in bytes
+      std::size_t size() const;
+
+    private:
+      int _fd_ = -1;                //!< File descriptor
+      const char* _data_ = nullptr; //!< Mapped bytes
+      std::size_t _size_ = 0;       //!< Number of mapped bytes
+    };
+
+    //! \brief Non-owning view on a single line (without its end of line)
+    struct crd_line {
+      const char* begin = nullptr;
+      const char* end = nullptr;
+
+      //! Check if the line has no character
+      bool empty() const { return begin == end; }
+
+      //! Return a copy of the line (diagnostics only)
+      std::string to_string() const { return std::string(begin, end); }
+    };
+
+    //! \brief Line cursor over a block of CRD bytes
+    //!
+    //! Mimics the std::getline / std::ws sequence formerly used on the
+    //! input file stream, without copying any byte.
+    class crd_tokenizer {
+    public:
+      //! Default constructor
+      crd_tokenizer() = default;
+
+      //! Constructor over a block of bytes
+      crd_tokenizer(const char* begin_, const char* end_);
+
+      //! Check if all bytes have been consumed
+      bool at_end() const { return _cursor_ == _end_; }
+
+      //! Skip leading whitespaces, including end of lines (as std::ws)
+      void skip_whitespace();
+
+      //! Extract the next line (as std::getline)
+      crd_line next_line();
+
+      //! Return the current position in the block
+      const char* get_cursor() const { return _cursor_; }
+
+    private:
+      const char* _cursor_ = nullptr; //!< Current position
+      const char* _end_ = nullptr;    //!< End of the block
+    };
+
+    //! \brief Field scanner for a single CRD line
+    //!
+    //! Each method skips leading spaces then consumes one token, following
+    //! the rules of the Boost/Spirit Qi grammars formerly used with the
+    //! qi::space skipper. On failure the cursor is left on the offending
+    //! character and false is returned.
+    class crd_line_scanner {
+    public:
+      //! Constructor
+      explicit crd_line_scanner(const crd_line& line_);
+
+      //! Skip spaces
+      void skip_spaces();
+
+      //! Match a literal keyword (as qi::lit)
+      bool lit(const char* keyword_);
+
+      //! Parse an unsigned 32 bits integer (as qi::uint_)
+      bool parse_uint(uint32_t& value_);
+
+      //! Parse a signed 32 bits integer (as qi::int_)
+      bool parse_int(int32_t& value_);
+
+      //! Parse an unsigned 64 bits integer (as qi::ulong_long)
+      bool parse_ulong_long(uint64_t& value_);
+
+      //! Parse a real number (as qi::double_)
+      bool parse_double(double& value_);
+
+      //! Collect non-space characters up to a stop character (as +~qi::char_)
+      bool parse_until(const char stop_, std::string& value_);
+
+      //! Check if only trailing spaces remain (as the post-skip check)
+      bool at_end();
+
+      //! Return the current position in the line
+      const char* get_cursor() const { return _cursor_; }
+
+      //! Return the current character or a null character at end of line
+      char current() const;
+
+    private:
+      template <typename UInt>
+      bool _parse_digits_(UInt& value_);
+
+    private:
+      const char* _cursor_ = nullptr; //!< Current position
+      const char* _end_ = nullptr;    //!< End of the line
+    };
+
+    //! Same set of characters as the qi::space skipper
+    inline bool
+    crd_is_space(const char c_)
+    {
+      return c_ == ' ' || c_ == '\t' || c_ == '\n' || c_ == '\r' ||
+             c_ == '\v' || c_ == '\f';
+    }
+
+    inline bool
+    crd_is_digit(const char c_)
+    {
+      return c_ >= '0' && c_ <= '9';
+    }
+
+    // The scanning primitives below are called once per waveform sample,
+    // they are kept inline on purpose.
+
+    inline void
+    crd_line_scanner::skip_spaces()
+    {
+      while (_cursor_ != _end_ && crd_is_space(*_cursor_)) {
+        ++_cursor_;
+      }
+      return;
+    }
+
+    inline bool
+    crd_line_scanner::lit(const char* keyword_)
+    {
+      skip_spaces();
+      const char* p = _cursor_;
+      for (; *keyword_ != 0; ++keyword_, ++p) {
+        if (p == _end_ || *p != *keyword_) {
+          return false;
+        }
+      }
+      _cursor_ = p;
+      return true;
+    }
+
+    template <typename UInt>
+    inline bool
+    crd_line_scanner::_parse_digits_(UInt& value_)
+    {
+      static const UInt max_tens = std::numeric_limits<UInt>::max() / 10;
+      static const UInt max_last = std::numeric_limits<UInt>::max() % 10;
+      const char* p = _cursor_;
+      UInt value = 0;
+      for (; p != _end_ && crd_is_digit(*p); ++p) {
+        const UInt digit = static_cast<UInt>(*p - '0');
+        if (value >= max_tens && (value > max_tens || digit > max_last)) {
+          // Overflow:
+          return false;
+        }
+        value = value * 10 + digit;
+      }
+      if (p == _cursor_) {
+        return false;
+      }
+      _cursor_ = p;
+      value_ = value;
+      return true;
+    }
+
+    inline bool
+    crd_line_scanner::parse_uint(uint32_t& value_)
+    {
+      skip_spaces();
+      return _parse_digits_(value_);
+    }
+
+    inline bool
+    crd_line_scanner::parse_ulong_long(uint64_t& value_)
+    {
+      skip_spaces();
+      return _parse_digits_(value_);
+    }
+
+    inline bool
+    crd_line_scanner::parse_int(int32_t& value_)
+    {
+      skip_spaces();
+      const char* start = _cursor_;
+      bool negative = false;
+      if (_cursor_ != _end_ && (*_cursor_ == '-' || *_cursor_ == '+')) {
+        negative = (*_cursor_ == '-');
+        ++_cursor_;
+      }
+      uint32_t magnitude = 0;
+      if (!_parse_digits_(magnitude)) {
+        _cursor_ = start;
+        return false;
+      }
+      static const uint32_t max_magnitude =
+        std::numeric_limits<int32_t>::max();
+      if (magnitude > max_magnitude + (negative ? 1U : 0U)) {
+        _cursor_ = start;
+        return false;
+      }
+      value_ = negative ? static_cast<int32_t>(0U - magnitude)
+                        : static_cast<int32_t>(magnitude);
+      return true;
+    }
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_CRD_TOKENIZER_H
@@ -0,0 +1,335 @@
+// programs/crd2rhd/parallel_hit_parser.cc
+
+// Ourselves:
+#include "parallel_hit_parser.h"
+
+// Standard library:
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snfee {
+  namespace io {
+
+    // static
+    const std::size_t parallel_hit_parser::DEFAULT_CHUNK_SIZE;
+
+    parallel_hit_parser::parallel_hit_parser(
+      const raw_record_parser::config_type& parser_cfg_,
+      const config_type& cfg_,
+      const datatools::logger::priority logging_)
+      : _logging_(logging_)
+      , _parser_config_(parser_cfg_)
+      , _config_(cfg_)
+    {
+      if (_config_.pool != nullptr) {
+        _config_.number_of_workers = _config_.pool->get_number_of_threads();
+      }
+      DT_THROW_IF(_config_.number_of_workers == 0,
+                  std::logic_error,
+                  "Invalid number of parsing workers!");
+      DT_THROW_IF(
+        _config_.chunk_size == 0, std::logic_error, "Invalid chunk size!");
+      if (_config_.max_pending_chunks == 0) {
+        _config_.max_pending_chunks = 2 * _config_.number_of_workers;
+      }
+      return;
+    }
+
+    parallel_hit_parser::~parallel_hit_parser()
+    {
+      stop();
+      return;
+    }
+
+    void
+    parallel_hit_parser::start(const char* begin_, const char* end_)
+    {
+      DT_THROW_IF(!_workers_.empty() || _running_tasks_ > 0,
+                  std::logic_error,
+                  "Parsing workers are already started!");
+      _begin_ = begin_;
+      _end_ = end_;
+      const std::size_t nbytes = _end_ - _begin_;
+      _nchunks_ = (nbytes + _config_.chunk_size - 1) / _config_.chunk_size;
+      _stop_request_ = false;
+      _next_chunk_ = 0;
+      _front_chunk_ = 0;
+      _chunks_.clear();
+      _current_ = nullptr;
+      DT_LOG_DEBUG(_logging_,
+                   "Parsing " << nbytes << " bytes in " << _nchunks_
+                              << " chunks with "
+                              << _config_.number_of_workers << " workers");
+      if (_config_.pool != nullptr) {
+        std::lock_guard<std::mutex> lock(_mutex_);
+        _schedule_chunks_();
+        return;
+      }
+      for (std::size_t iworker = 0; iworker < _config_.number_of_workers;
+           iworker++) {
+        _workers_.emplace_back(&parallel_hit_parser::_worker_run_, this);
+      }
+      return;
+    }
+
+    void
+    parallel_hit_parser::stop()
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex_);
+        _stop_request_ = true;
+      }
+      _chunk_freed_cv_.notify_all();
+      _chunk_done_cv_.notify_all();
+      for (auto& worker : _workers_) {
+        worker.join();
+      }
+      _workers_.clear();
+      {
+        // Tasks queued in the shared pool still refer to the chunks:
+        std::unique_lock<std::mutex> lock(_mutex_);
+        _chunk_done_cv_.wait(lock, [this] { return _running_tasks_ == 0; });
+      }
+      _chunks_.clear();
+      _current_ = nullptr;
+      return;
+    }
+
+    bool
+    parallel_hit_parser::has_next_hit()
+    {
+      return _wait_current_chunk_();
+    }
+
+    raw_record_parser::record_type
+    parallel_hit_parser::load_next_hit(
+      snfee::data::calo_hit_record& calo_hit_,
+      snfee::data::tracker_hit_record& tracker_hit_)
+    {
+      DT_THROW_IF(
+        !_wait_current_chunk_(), std::logic_error, "No more raw hit record!");
+      raw_record_parser::record_type rec_type =
+        _current_->record_types[_record_index_++];
+      if (rec_type == raw_record_parser::RECORD_CALO) {
+        calo_hit_ = std::move(_current_->calo_hits[_calo_index_++]);
+      } else if (rec_type == raw_record_parser::RECORD_TRACKER) {
+        tracker_hit_ = std::move(_current_->tracker_hits[_tracker_index_++]);
+      }
+      return rec_type;
+    }
+
+    bool
+    parallel_hit_parser::_wait_current_chunk_()
+    {
+      if (_current_ != nullptr &&
+          _record_index_ < _current_->record_types.size()) {
+        return true;
+      }
+      std::unique_lock<std::mutex> lock(_mutex_);
+      while (true) {
+        if (_current_ != nullptr) {
+          // The current chunk is exhausted, release it:
+          _chunks_.pop_front();
+          _front_chunk_++;
+          _current_ = nullptr;
+          _chunk_freed_cv_.notify_all();
+          if (_config_.pool != nullptr) {
+            _schedule_chunks_();
+          }
+        }
+        if (_front_chunk_ >= _nchunks_) {
+          return false;
+        }
+        _chunk_done_cv_.wait(lock, [this] {
+          return _stop_request_ ||
+                 (!_chunks_.empty() && _chunks_.front()->done);
+        });
+        DT_THROW_IF(
+          _stop_request_, std::logic_error, "Parsing workers are stopped!");
+        _current_ = _chunks_.front().get();
+        _record_index_ = 0;
+        _calo_index_ = 0;
+        _tracker_index_ = 0;
+        if (!_current_->record_types.empty()) {
+          return true;
+        }
+      }
+    }
+
+    void
+    parallel_hit_parser::_worker_run_()
+    {
+      raw_record_parser parser(_parser_config_, _logging_);
+      while (true) {
+        std::size_t chunk_index = 0;
+        chunk_type* chunk = nullptr;
+        {
+          std::unique_lock<std::mutex> lock(_mutex_);
+          _chunk_freed_cv_.wait(lock, [this] {
+            return _stop_request_ || _next_chunk_ >= _nchunks_ ||
+                   _next_chunk_ < _front_chunk_ + _config_.max_pending_chunks;
+          });
+          if (_stop_request_ || _next_chunk_ >= _nchunks_) {
+            break;
+          }
+          chunk_index = _next_chunk_++;
+          while (_front_chunk_ + _chunks_.size() <= chunk_index) {
+            _chunks_.emplace_back(new chunk_type);
+          }
+          chunk = _chunks_[chunk_index - _front_chunk_].get();
+        }
+        _parse_chunk_(parser, chunk_index, *chunk);
+        {
+          std::lock_guard<std::mutex> lock(_mutex_);
+          chunk->done = true;
+        }
+        _chunk_done_cv_.notify_all();
+      }
+      return;
+    }
+
+    void
+    parallel_hit_parser::_schedule_chunks_()
+    {
+      while (!_stop_request_ && _next_chunk_ < _nchunks_ &&
+             _next_chunk_ < _front_chunk_ + _config_.max_pending_chunks) {
+        const std::size_t chunk_index = _next_chunk_++;
+        while (_front_chunk_ + _chunks_.size() <= chunk_index) {
+          _chunks_.emplace_back(new chunk_type);
+        }
+        chunk_type* chunk = _chunks_[chunk_index - _front_chunk_].get();
+        _running_tasks_++;
+        _config_.pool->submit([this, chunk_index, chunk] {
+          _run_chunk_task_(chunk_index, *chunk);
+        });
+      }
+      return;
+    }
+
+    void
+    parallel_hit_parser::_run_chunk_task_(const std::size_t chunk_index_,
+                                          chunk_type& chunk_)
+    {
+      bool stopped = false;
+      {
+        std::lock_guard<std::mutex> lock(_mutex_);
+        stopped = _stop_request_;
+      }
+      if (!stopped) {
+        raw_record_parser parser(_parser_config_, _logging_);
+        _parse_chunk_(parser, chunk_index_, chunk_);
+      }
+      // Notify under the lock: the parser may be destroyed as soon as its
+      // last task is seen as done.
+      std::lock_guard<std::mutex> lock(_mutex_);
+      chunk_.done = true;
+      _running_tasks_--;
+      _chunk_done_cv_.notify_all();
+      return;
+    }
+
+    void
+    parallel_hit_parser::_parse_chunk_(raw_record_parser& parser_,
+                                       const std::size_t chunk_index_,
+                                       chunk_type& chunk_)
+    {
+      // Both ends of a chunk are resynchronised the same way, so adjacent
+      // chunks share their boundary:
+      const std::size_t nbytes = _end_ - _begin_;
+      const std::size_t nominal_begin = chunk_index_ * _config_.chunk_size;
+      const std::size_t nominal_end =
+        std::min(nbytes, nominal_begin + _config_.chunk_size);
+      const char* chunk_begin = _begin_;
+      if (chunk_index_ > 0) {
+        chunk_begin =
+          find_record_start(_begin_ + nominal_begin, _begin_, _end_);
+      }
+      const char* chunk_end = _end_;
+      if (chunk_index_ + 1 < _nchunks_) {
+        chunk_end = find_record_start(_begin_ + nominal_end, _begin_, _end_);
+      }
+      DT_LOG_DEBUG(_logging_,
+                   "Parsing chunk #" << chunk_index_ << " : ["
+                                     << (chunk_begin - _begin_) << ", "
+                                     << (chunk_end - _begin_) << "[");
+      if (chunk_begin >= chunk_end) {
+        return;
+      }
+      crd_tokenizer tokenizer(chunk_begin, chunk_end);
+      // Records are parsed in scratch records, only the parsed one is moved
+      // to the chunk:
+      snfee::data::calo_hit_record calo_hit;
+      snfee::data::tracker_hit_record tracker_hit;
+      while (!tokenizer.at_end()) {
+        raw_record_parser::record_type rec_type =
+          parser_.parse(tokenizer, calo_hit, tracker_hit);
+        if (rec_type == raw_record_parser::RECORD_CALO) {
+          chunk_.calo_hits.push_back(std::move(calo_hit));
+        } else if (rec_type == raw_record_parser::RECORD_TRACKER) {
+          chunk_.tracker_hits.push_back(std::move(tracker_hit));
+        }
+        chunk_.record_types.push_back(rec_type);
+        if (rec_type == raw_record_parser::RECORD_UNDEF) {
+          // The consumer reports the failure when it reaches this record
+          break;
+        }
+        tokenizer.skip_whitespace();
+      }
+      return;
+    }
+
+    // static
+    const char*
+    parallel_hit_parser::find_record_start(const char* from_,
+                                           const char* begin_,
+                                           const char* end_)
+    {
+      const char* p = from_;
+      if (p >= end_) {
+        return end_;
+      }
+      if (p != begin_ && p[-1] != '\n') {
+        // Move to the beginning of the next line:
+        p = static_cast<const char*>(std::memchr(p, '\n', end_ - p));
+        if (p == nullptr) {
+          return end_;
+        }
+        p++;
+      }
+      while (p < end_) {
+        const char* eol =
+          static_cast<const char*>(std::memchr(p, '\n', end_ - p));
+        const char* line_end = (eol == nullptr) ? end_ : eol;
+        const char* first = p;
+        while (first < line_end && crd_is_space(*first)) {
+          first++;
+        }
+        if (first < line_end && *first == '=') {
+          crd_line header_line;
+          header_line.begin = first;
+          header_line.end = line_end;
+          crd_line next_line;
+          if (eol != nullptr) {
+            crd_tokenizer next(eol + 1, end_);
+            next.skip_whitespace();
+            next_line = next.next_line();
+          }
+          if (raw_record_parser::is_record_start(header_line, next_line)) {
+            return first;
+          }
+        }
+        if (eol == nullptr) {
+          break;
+        }
+        p = eol + 1;
+      }
+      return end_;
+    }
+
+  } // namespace io
+} // namespace snfee
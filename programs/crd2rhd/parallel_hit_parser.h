@@ -0,0 +1,145 @@
+//! \file programs/crd2rhd/parallel_hit_parser.h
+//! \brief Multi-threaded parser for the raw hit records of a CRD file
+
+#ifndef SNFEE_IO_PARALLEL_HIT_PARSER_H
+#define SNFEE_IO_PARALLEL_HIT_PARSER_H
+
+// Standard library:
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/utility.hpp>
+// - Bayeux:
+#include <bayeux/datatools/logger.h>
+
+// This project:
+#include "crd_tokenizer.h"
+#include "raw_record_parser.h"
+#include "thread_pool.h"
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Parse the raw hit records of a mapped CRD file on a pool of
+    //!        worker threads
+    //!
+    //! The data block is split in byte ranges of fixed size. Each range is
+    //! resynchronised on the first hit header starting a record (see
+    //! raw_record_parser::is_record_start) so that consecutive chunks share
+    //! their boundary. Chunks are parsed concurrently and the records are
+    //! delivered in the original order of the file. A bounded number of
+    //! parsed chunks is kept in memory.
+    //!
+    //! Chunks are parsed either by worker threads owned by the parser, or
+    //! as tasks queued in a thread pool shared with other parsers.
+    class parallel_hit_parser : private boost::noncopyable {
+    public:
+      //! Default size of a chunk
+      static const std::size_t DEFAULT_CHUNK_SIZE = 16 * 1024 * 1024;
+
+      /// \brief Parser configuration
+      struct config_type {
+        std::size_t number_of_workers = 2; //!< Number of parsing threads
+        std::size_t chunk_size = DEFAULT_CHUNK_SIZE; //!< Chunk size (bytes)
+        std::size_t max_pending_chunks =
+          0; //!< Max number of chunks in memory (0: twice the workers)
+        thread_pool* pool =
+          nullptr; //!< Shared pool of parsing threads (default: the parser
+                   //!< owns its workers)
+      };
+
+      //! Constructor
+      parallel_hit_parser(const raw_record_parser::config_type& parser_cfg_,
+                          const config_type& cfg_,
+                          const datatools::logger::priority logging_ =
+                            datatools::logger::PRIO_FATAL);
+
+      //! Destructor
+      ~parallel_hit_parser();
+
+      //! Start the workers on a block of CRD raw hit records
+      void start(const char* begin_, const char* end_);
+
+      //! Stop the workers
+      void stop();
+
+      //! Check if a next hit is available (blocking)
+      bool has_next_hit();
+
+      //! Load the next hit (blocking)
+      raw_record_parser::record_type load_next_hit(
+        snfee::data::calo_hit_record& calo_hit_,
+        snfee::data::tracker_hit_record& tracker_hit_);
+
+      //! Return the start of the first record at or after a given position
+      static const char* find_record_start(const char* from_,
+                                           const char* begin_,
+                                           const char* end_);
+
+    private:
+      /// \brief Records parsed from one chunk
+      //!
+      //! Hits are stored in deques so that they are parsed in place and
+      //! never relocated.
+      struct chunk_type {
+        bool done = false; //!< Set by the worker once the chunk is parsed
+        std::vector<raw_record_parser::record_type> record_types;
+        std::deque<snfee::data::calo_hit_record> calo_hits;
+        std::deque<snfee::data::tracker_hit_record> tracker_hits;
+      };
+
+      void _worker_run_();
+
+      //! Queue the parsing of the next chunks in the shared pool (the mutex
+      //! must be locked)
+      void _schedule_chunks_();
+
+      //! Parse a chunk from a task of the shared pool
+      void _run_chunk_task_(const std::size_t chunk_index_, chunk_type& chunk_);
+
+      void _parse_chunk_(raw_record_parser& parser_,
+                         const std::size_t chunk_index_,
+                         chunk_type& chunk_);
+
+      //! Wait for the current chunk to be parsed, skipping empty chunks
+      bool _wait_current_chunk_();
+
+    private:
+      // Management:
+      datatools::logger::priority _logging_ = datatools::logger::PRIO_FATAL;
+
+      // Configuration:
+      raw_record_parser::config_type _parser_config_;
+      config_type _config_;
+
+      // Working:
+      const char* _begin_ = nullptr; //!< Start of the data block
+      const char* _end_ = nullptr;   //!< End of the data block
+      std::size_t _nchunks_ = 0;     //!< Total number of chunks
+      std::vector<std::thread> _workers_;
+      std::mutex _mutex_;
+      std::condition_variable _chunk_done_cv_;  //!< Wakes up the consumer
+      std::condition_variable _chunk_freed_cv_; //!< Wakes up the workers
+      bool _stop_request_ = false;
+      std::size_t _next_chunk_ = 0; //!< Index of the next chunk to parse
+      std::size_t _running_tasks_ =
+        0; //!< Number of chunk tasks queued or running in the shared pool
+      std::size_t _front_chunk_ = 0; //!< Index of the chunk being consumed
+      std::deque<std::unique_ptr<chunk_type>>
+        _chunks_; //!< Pending chunks (first one is being consumed)
+      chunk_type* _current_ = nullptr; //!< Chunk being consumed
+      std::size_t _record_index_ = 0;  //!< Position in the current chunk
+      std::size_t _calo_index_ = 0;    //!< Position in the calo hits
+      std::size_t _tracker_index_ = 0; //!< Position in the tracker hits
+    };
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_PARALLEL_HIT_PARSER_H
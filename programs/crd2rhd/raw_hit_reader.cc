@@ -7,9 +7,6 @@
 #include <stdexcept>
 
 // Third party:
-// - Boost:
-#include <boost/lexical_cast.hpp>
-#include <boost/spirit/include/qi.hpp>
 // - Bayeux:
 #include <bayeux/datatools/exception.h>
 #include <bayeux/datatools/utils.h>
@@ -29,7 +26,10 @@ namespace snfee {
     {
       DT_THROW_IF(
         !_initialized_, std::logic_error, "Reader is not initialized!");
-      if (!*_fin_ || _fin_->eof())
+      if (_parallel_parser_) {
+        return _parallel_parser_->has_next_hit();
+      }
+      if (_tokenizer_.at_end())
         return false;
       return true;
     }
@@ -57,12 +57,20 @@ namespace snfee {
         !_initialized_, std::logic_error, "Reader is not initialized!");
       calo_hit_.invalidate();
       tracker_hit_.invalidate();
+      if (_parallel_parser_) {
+        raw_record_parser::record_type rec_type =
+          _parallel_parser_->load_next_hit(calo_hit_, tracker_hit_);
+        if (rec_type == raw_record_parser::RECORD_UNDEF) {
+          DT_THROW(std::logic_error, "Parsing failed!");
+        }
+        return rec_type;
+      }
       raw_record_parser::record_type rec_type =
-        _record_parser_->parse(*_fin_, calo_hit_, tracker_hit_);
+        _record_parser_->parse(_tokenizer_, calo_hit_, tracker_hit_);
       if (rec_type == raw_record_parser::RECORD_UNDEF) {
         DT_THROW(std::logic_error, "Parsing failed!");
       }
-      *_fin_ >> std::ws;
+      _tokenizer_.skip_whitespace();
       return rec_type;
     }
 
@@ -107,8 +115,8 @@ namespace snfee {
         _initialized_, std::logic_error, "Reader is already initialized!");
       _init_input_file_();
       _init_header_();
+      _tokenizer_.skip_whitespace();
       _init_parser_();
-      *_fin_ >> std::ws;
       _initialized_ = true;
       return;
     }
@@ -146,9 +154,21 @@ namespace snfee {
            << "With tracker   : " << std::boolalpha << _config_.with_tracker
            << std::endl;
       out_ << "|   "
-           << "`-- "
+           << "|-- "
            << "With calo waveforms : " << std::boolalpha
            << _config_.with_calo_waveforms << std::endl;
+      out_ << "|   "
+           << "|-- "
+           << "Parser threads : " << _config_.number_of_parser_threads;
+      if (_config_.parser_pool != nullptr) {
+        out_ << " (shared pool of "
+             << _config_.parser_pool->get_number_of_threads() << ")";
+      }
+      out_ << std::endl;
+      out_ << "|   "
+           << "`-- "
+           << "Parser chunk size : " << _config_.parser_chunk_size
+           << std::endl;
       out_ << "`-- "
            << "Initialized  : " << std::boolalpha << _initialized_ << std::endl;
       return;
@@ -157,22 +177,19 @@ namespace snfee {
     void
     raw_hit_reader::_init_input_file_()
     {
-      _fin_.reset(new std::ifstream);
-      std::string ifn = _config_.input_filename;
-      datatools::fetch_path_with_env(ifn);
-      _fin_->open(ifn.c_str());
-      DT_THROW_IF(!*_fin_,
-                  std::runtime_error,
-                  "Cannot open input file '" << _config_.input_filename << "'");
+      _fmap_.reset(new crd_mapped_file);
+      _fmap_->open(_config_.input_filename);
+      _tokenizer_ = crd_tokenizer(_fmap_->begin(), _fmap_->end());
       return;
     }
 
     void
     raw_hit_reader::_reset_input_file_()
     {
-      if (_fin_) {
-        _fin_->close();
-        _fin_.reset();
+      _tokenizer_ = crd_tokenizer();
+      if (_fmap_) {
+        _fmap_->close();
+        _fmap_.reset();
       }
       return;
     }
@@ -182,10 +199,10 @@ namespace snfee {
     {
       _header_.reset(new raw_run_header);
       for (std::size_t ih = 0; ih < HEADER_NBLINES; ih++) {
-        std::string hlines;
-        std::getline(*_fin_, hlines);
-        DT_LOG_DEBUG(_logging_, "Header[#" << ih << "] : " << hlines);
-        _decode_header_(hlines, ih);
+        crd_line hline = _tokenizer_.next_line();
+        DT_LOG_DEBUG(_logging_,
+                     "Header[#" << ih << "] : " << hline.to_string());
+        _decode_header_(hline, ih);
       }
       return;
     }
@@ -212,13 +229,27 @@ namespace snfee {
       parser_config.with_tracker = _config_.with_tracker;
       parser_config.with_calo_waveforms = _config_.with_calo_waveforms;
       _record_parser_.reset(new raw_record_parser(parser_config, _logging_));
-
+      if (_config_.number_of_parser_threads > 1 ||
+          _config_.parser_pool != nullptr) {
+        // Hit records are parsed ahead by a pool of workers:
+        parallel_hit_parser::config_type parallel_config;
+        parallel_config.number_of_workers = _config_.number_of_parser_threads;
+        parallel_config.chunk_size = _config_.parser_chunk_size;
+        parallel_config.pool = _config_.parser_pool;
+        _parallel_parser_.reset(
+          new parallel_hit_parser(parser_config, parallel_config, _logging_));
+        _parallel_parser_->start(_tokenizer_.get_cursor(), _fmap_->end());
+      }
       return;
     }
 
     void
     raw_hit_reader::_reset_parser_()
     {
+      if (_parallel_parser_) {
+        _parallel_parser_->stop();
+        _parallel_parser_.reset();
+      }
       if (_record_parser_) {
         _record_parser_.reset();
       }
@@ -226,12 +257,10 @@ namespace snfee {
     }
 
     void
-    raw_hit_reader::_decode_header_(const std::string& hline_, const int index_)
+    raw_hit_reader::_decode_header_(const crd_line& hline_, const int index_)
     {
       DT_LOG_TRACE_ENTERING(_logging_);
-      namespace qi = boost::spirit::qi;
-      std::string::const_iterator str_iter = hline_.begin();
-      std::string::const_iterator end_iter = hline_.end();
+      crd_line_scanner scanner(hline_);
       bool res = false;
 
       std::string sw_version;
@@ -242,25 +271,14 @@ namespace snfee {
 
       if (index_ == 0) {
         std::string data_type;
-        res = qi::phrase_parse(
-          str_iter,
-          end_iter,
-          //  Begin grammar
-          ("===" >>
-           qi::lit("DATA FILE SAVED WITH SN CRATE SOFTWARE VERSION:") >>
-           (+~qi::char_("=")) >> "==" >> qi::lit("DATE OF RUN:") >>
-           qi::lit("UnixTime =")
-           // >> (+~qi::char_("="))
-           // >> "="
-           >> qi::double_ >> qi::lit("date =") >> (+~qi::char_("t")) >>
-           qi::lit("time =") >> (+~qi::char_("=")) >> "==="),
-          //  End grammar
-          qi::space,
-          sw_version,
-          unix_time,
-          date,
-          time);
-        DT_THROW_IF(!res || str_iter != end_iter,
+        res = scanner.lit("===") &&
+              scanner.lit("DATA FILE SAVED WITH SN CRATE SOFTWARE VERSION:") &&
+              scanner.parse_until('=', sw_version) && scanner.lit("==") &&
+              scanner.lit("DATE OF RUN:") && scanner.lit("UnixTime =") &&
+              scanner.parse_double(unix_time) && scanner.lit("date =") &&
+              scanner.parse_until('t', date) && scanner.lit("time =") &&
+              scanner.parse_until('=', time) && scanner.lit("===");
+        DT_THROW_IF(!res || !scanner.at_end(),
                     std::logic_error,
                     "Cannot parse file header line #" << index_);
         DT_LOG_DEBUG(_logging_, "sw_version = " << sw_version);
@@ -272,15 +290,9 @@ namespace snfee {
 
       if (index_ == 2) {
         std::string data_type;
-        res = qi::phrase_parse(
-          str_iter,
-          end_iter,
-          //  Begin grammar
-          ("===" >> qi::lit("DATA TYPE :") >> (+~qi::char_("=")) >> "==="),
-          //  End grammar
-          qi::space,
-          data_type);
-        DT_THROW_IF(!res || str_iter != end_iter,
+        res = scanner.lit("===") && scanner.lit("DATA TYPE :") &&
+              scanner.parse_until('=', data_type) && scanner.lit("===");
+        DT_THROW_IF(!res || !scanner.at_end(),
                     std::logic_error,
                     "Cannot parse file header line #" << index_);
         DT_LOG_DEBUG(_logging_, "data_type = " << data_type);
@@ -7,7 +7,6 @@
 #define SNFEE_IO_RAW_HIT_READER_H
 
 // Standard library:
-#include <fstream>
 #include <memory>
 #include <string>
 
@@ -18,6 +17,8 @@
 #include <bayeux/datatools/logger.h>
 
 // This project:
+#include "crd_tokenizer.h"
+#include "parallel_hit_parser.h"
 #include "raw_record_parser.h"
 #include "raw_run_header.h"
 
@@ -36,6 +37,13 @@ namespace snfee {
         bool with_calo = true;
         bool with_tracker = true;
         bool with_calo_waveforms = true;
+        std::size_t number_of_parser_threads =
+          1; //!< Number of parsing threads (1: sequential parsing)
+        std::size_t parser_chunk_size =
+          parallel_hit_parser::DEFAULT_CHUNK_SIZE; //!< Bytes per parsed chunk
+        thread_pool* parser_pool =
+          nullptr; //!< Shared pool of parsing threads (overrides the number
+                   //!< of parsing threads)
       };
 
       //! Default constructor
@@ -91,7 +99,7 @@ namespace snfee {
 
       void _reset_header_();
 
-      void _decode_header_(const std::string& hline_, const int index_);
+      void _decode_header_(const crd_line& hline_, const int index_);
 
     private:
       // Configuration:
@@ -102,11 +110,15 @@ namespace snfee {
       datatools::logger::priority _logging_ = datatools::logger::PRIO_FATAL;
 
       // Working:
-      std::unique_ptr<std::ifstream> _fin_; //!< Handle to the input file stream
+      std::unique_ptr<crd_mapped_file>
+        _fmap_;                  //!< Handle to the memory-mapped input file
+      crd_tokenizer _tokenizer_; //!< Line cursor over the mapped input file
       std::unique_ptr<raw_run_header>
         _header_; //!< Handle to the input file header
       std::unique_ptr<raw_record_parser>
         _record_parser_; //!< Raw hit record parser
+      std::unique_ptr<parallel_hit_parser>
+        _parallel_parser_; //!< Multi-threaded raw hit record parser
     };
 
   } // namespace io
@@ -4,12 +4,6 @@
 #include "raw_record_parser.h"
 
 // Third party:
-// - Boost:
-#include <boost/lexical_cast.hpp>
-#include <boost/phoenix/phoenix.hpp>
-#include <boost/spirit/include/qi.hpp>
-// #include <boost/fusion/include/at_c.hpp>
-#include <boost/algorithm/string.hpp>
 // - Bayeux:
 #include <bayeux/datatools/exception.h>
 #include <bayeux/datatools/utils.h>
@@ -86,7 +80,7 @@ namespace snfee {
     }
 
     raw_record_parser::record_type
-    raw_record_parser::parse(std::istream& in_,
+    raw_record_parser::parse(crd_tokenizer& in_,
                              snfee::data::calo_hit_record& calo_hit_,
                              snfee::data::tracker_hit_record& tracker_hit_)
     {
@@ -97,13 +91,12 @@ namespace snfee {
 
         // Header:
         for (std::size_t ih = 0; ih < NB_HIT_HEADER_LINES; ih++) {
-          std::string hline;
-          std::getline(in_, hline);
+          crd_line hline = in_.next_line();
           DT_LOG_DEBUG(_logging_,
-                       "Parsing header line number " << ih << " : {" << hline
-                                                     << "}");
+                       "Parsing header line number "
+                         << ih << " : {" << hline.to_string() << "}");
           _parse_hit_header_(hline, ih);
-          in_ >> std::ws;
+          in_.skip_whitespace();
         }
 
         DT_LOG_DEBUG(
@@ -149,7 +142,7 @@ namespace snfee {
           ret = _record_type_;
           DT_LOG_DEBUG(_logging_, "Parsed a tracker hit record");
         }
-        in_ >> std::ws;
+        in_.skip_whitespace();
         // success = true;
       }
       catch (std::exception& error) {
@@ -161,30 +154,58 @@ namespace snfee {
       return ret;
     }
 
+    // static
+    bool
+    raw_record_parser::scan_hit_header(const crd_line& header_line_,
+                                       uint64_t& hit_id_,
+                                       std::string& hit_type_,
+                                       uint64_t& trigger_id_)
+    {
+      crd_line_scanner scanner(header_line_);
+      bool res = scanner.lit("= HIT") && scanner.parse_ulong_long(hit_id_) &&
+                 scanner.lit("=") && scanner.parse_until('=', hit_type_) &&
+                 scanner.lit("=") && scanner.lit("TRIG_ID") &&
+                 scanner.parse_ulong_long(trigger_id_) && scanner.lit("=");
+      return res && scanner.at_end();
+    }
+
+    // static
+    bool
+    raw_record_parser::is_record_start(const crd_line& header_line_,
+                                       const crd_line& next_line_)
+    {
+      uint64_t hit_id;
+      std::string hit_type;
+      uint64_t trigger_id;
+      if (!scan_hit_header(header_line_, hit_id, hit_type, trigger_id)) {
+        return false;
+      }
+      if (hit_type == "TRACKER") {
+        return true;
+      }
+      if (hit_type == "CALO") {
+        crd_line_scanner scanner(next_line_);
+        uint32_t slot_id;
+        uint32_t channel_id;
+        if (scanner.lit("Slot") && scanner.parse_uint(slot_id) &&
+            scanner.lit("Ch") && scanner.parse_uint(channel_id)) {
+          return channel_id % 2 == 0;
+        }
+      }
+      return false;
+    }
+
     void
-    raw_record_parser::_parse_hit_header_(const std::string& header_line_,
+    raw_record_parser::_parse_hit_header_(const crd_line& header_line_,
                                           const int index_)
     {
       DT_LOG_TRACE_ENTERING(_logging_);
-      namespace qi = boost::spirit::qi;
       bool res = false;
       std::string hit_type;
 
       if (index_ == 0) {
-        std::string::const_iterator str_iter = header_line_.begin();
-        std::string::const_iterator end_iter = header_line_.end();
-        res = qi::phrase_parse(str_iter,
-                               end_iter,
-                               //  Begin grammar
-                               (qi::lit("= HIT") >> qi::ulong_long >> "=" >>
-                                (+~qi::char_("=")) >> "=" >>
-                                qi::lit("TRIG_ID") >> qi::ulong_long >> "="),
-                               //  End grammar
-                               qi::space,
-                               _hit_id_,
-                               hit_type,
-                               _trigger_id_);
-        DT_THROW_IF(!res || str_iter != end_iter,
+        res = scan_hit_header(header_line_, _hit_id_, hit_type, _trigger_id_);
+        DT_THROW_IF(!res,
                     std::logic_error,
                     "Cannot parse file header line #" << index_);
         DT_LOG_DEBUG(_logging_, "_hit_id_ = " << _hit_id_);
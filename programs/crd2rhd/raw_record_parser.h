@@ -7,7 +7,6 @@
 #define SNFEE_IO_RAW_RECORD_PARSER_H
 
 // Standard library:
-#include <fstream>
 #include <memory>
 #include <string>
 
@@ -17,6 +16,7 @@
 
 // This project:
 #include "calo_hit_parser.h"
+#include "crd_tokenizer.h"
 #include "tracker_hit_parser.h"
 
 namespace snfee {
@@ -58,12 +58,26 @@ namespace snfee {
       void set_config(const config_type&);
 
       //! Parse
-      record_type parse(std::istream& in_,
+      record_type parse(crd_tokenizer& in_,
                         snfee::data::calo_hit_record& calo_hit_,
                         snfee::data::tracker_hit_record& tracker_channel_hit_);
 
+      //! Scan a hit header line ('= HIT n = TYPE = TRIG_ID t =')
+      static bool scan_hit_header(const crd_line& header_line_,
+                                  uint64_t& hit_id_,
+                                  std::string& hit_type_,
+                                  uint64_t& trigger_id_);
+
+      //! Check if a line is the hit header starting a new raw record
+      //!
+      //! The line following a calorimeter hit header must be provided: a
+      //! calorimeter record spans two hit headers, only the first one,
+      //! followed by the even SAMLONG channel, starts the record.
+      static bool is_record_start(const crd_line& header_line_,
+                                  const crd_line& next_line_);
+
     private:
-      void _parse_hit_header_(const std::string& header_line_, const int index);
+      void _parse_hit_header_(const crd_line& header_line_, const int index);
 
     public:
       // Management:
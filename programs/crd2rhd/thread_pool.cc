@@ -0,0 +1,76 @@
+// programs/crd2rhd/thread_pool.cc
+
+// Ourselves:
+#include "thread_pool.h"
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snfee {
+  namespace io {
+
+    thread_pool::thread_pool(const std::size_t number_of_threads_)
+    {
+      DT_THROW_IF(number_of_threads_ == 0,
+                  std::logic_error,
+                  "Invalid number of threads!");
+      for (std::size_t ithread = 0; ithread < number_of_threads_; ithread++) {
+        _threads_.emplace_back(&thread_pool::_run_, this);
+      }
+      return;
+    }
+
+    thread_pool::~thread_pool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex_);
+        _stop_request_ = true;
+      }
+      _cv_.notify_all();
+      for (auto& thread : _threads_) {
+        thread.join();
+      }
+      return;
+    }
+
+    std::size_t
+    thread_pool::get_number_of_threads() const
+    {
+      return _threads_.size();
+    }
+
+    void
+    thread_pool::submit(const task_type& task_)
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex_);
+        _tasks_.push_back(task_);
+      }
+      _cv_.notify_one();
+      return;
+    }
+
+    void
+    thread_pool::_run_()
+    {
+      while (true) {
+        task_type task;
+        {
+          std::unique_lock<std::mutex> lock(_mutex_);
+          _cv_.wait(lock,
+                    [this] { return _stop_request_ || !_tasks_.empty(); });
+          if (_tasks_.empty()) {
+            // Stop requested and nothing left to do:
+            break;
+          }
+          task = std::move(_tasks_.front());
+          _tasks_.pop_front();
+        }
+        task();
+      }
+      return;
+    }
+
+  } // namespace io
+} // namespace snfee
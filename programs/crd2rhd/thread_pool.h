@@ -0,0 +1,59 @@
+//! \file programs/crd2rhd/thread_pool.h
+//! \brief Fixed-size pool of threads running queued tasks
+
+#ifndef SNFEE_IO_THREAD_POOL_H
+#define SNFEE_IO_THREAD_POOL_H
+
+// Standard library:
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/utility.hpp>
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Fixed-size pool of threads running tasks in submission order
+    //!
+    //! The pool lets several parsers share a bounded number of threads (ex:
+    //! the CRD files of all the crates of a run converted concurrently).
+    //! Tasks must not throw; the pool waits for all queued tasks before its
+    //! threads are joined.
+    class thread_pool : private boost::noncopyable {
+    public:
+      /// Task type
+      typedef std::function<void()> task_type;
+
+      //! Constructor
+      explicit thread_pool(const std::size_t number_of_threads_);
+
+      //! Destructor (queued tasks are run before the threads are joined)
+      ~thread_pool();
+
+      //! Return the number of threads
+      std::size_t get_number_of_threads() const;
+
+      //! Queue a task
+      void submit(const task_type& task_);
+
+    private:
+      void _run_();
+
+    private:
+      std::vector<std::thread> _threads_;
+      std::mutex _mutex_;
+      std::condition_variable _cv_; //!< Wakes up the threads
+      std::deque<task_type> _tasks_; //!< Queued tasks
+      bool _stop_request_ = false;
+    };
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_THREAD_POOL_H
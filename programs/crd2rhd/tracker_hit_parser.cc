@@ -3,12 +3,6 @@
 #include "tracker_hit_parser.h"
 
 // Third party:
-// - Boost:
-#include <boost/lexical_cast.hpp>
-#include <boost/phoenix/phoenix.hpp>
-#include <boost/spirit/include/qi.hpp>
-// #include <boost/fusion/include/at_c.hpp>
-#include <boost/algorithm/string.hpp>
 // - Bayeux:
 #include <bayeux/datatools/exception.h>
 #include <bayeux/datatools/utils.h>
@@ -60,7 +54,7 @@ namespace snfee {
     }
 
     bool
-    tracker_hit_parser::parse(std::istream& in_,
+    tracker_hit_parser::parse(crd_tokenizer& in_,
                               snfee::data::tracker_hit_record& hit_)
     {
       DT_LOG_TRACE_ENTERING(_logging_);
@@ -82,12 +76,12 @@ namespace snfee {
         //   in_ >> std::ws;
         // }
         // Data:
-        std::string data_line;
-        std::getline(in_, data_line);
-        DT_LOG_DEBUG(_logging_, "Parsing data line '" << data_line << "'");
+        crd_line data_line = in_.next_line();
+        DT_LOG_DEBUG(_logging_,
+                     "Parsing data line '" << data_line.to_string() << "'");
         hit_data_type hit_data;
         _parse_timestamp_(data_line, hit_data);
-        in_ >> std::ws;
+        in_.skip_whitespace();
 
         // Populate the tracker hit record:
 
@@ -146,84 +140,75 @@ namespace snfee {
       return success;
     }
 
+    namespace {
+      const char* const tracker_channel_type_labels[] = {"AN", "CA"};
+      const char* const tracker_timestamp_type_labels[] =
+        {"R0", "R1", "R2", "R3", "R4", "R5", "R6"};
+    } // namespace
+
     void
-    tracker_hit_parser::_parse_timestamp_(const std::string& data_line_,
+    tracker_hit_parser::_parse_timestamp_(const crd_line& data_line_,
                                           hit_data_type& hit_data_)
     {
       DT_LOG_TRACE_ENTERING(_logging_);
-      std::string data_line = data_line_;
-      namespace qi = boost::spirit::qi;
+      crd_line_scanner scanner(data_line_);
       bool res = false;
-      // We use a trick because of nasty syntax from the DAQ ascii output:
-      // boost::replace_all(data_line, "Slot", "Slot ");
-      // boost::replace_all(data_line, " Feast", " Feast ");
-      // boost::replace_all(data_line, " Ch", " Ch ");
-      boost::replace_all(data_line, " CA R0 ", " CA R5 ");
-      DT_LOG_DEBUG(_logging_, "data_line before parsing = " << data_line);
-
-      std::string::const_iterator str_iter = data_line.begin();
-      std::string::const_iterator end_iter = data_line.end();
-
+      uint32_t slot_id = 0;
+      uint32_t feast_id = 0;
+      uint32_t channel_id = 0;
+      res = scanner.lit("Slot") && scanner.parse_uint(slot_id) &&
+            scanner.lit("Feast") && scanner.parse_uint(feast_id) &&
+            scanner.lit("Ch") && scanner.parse_uint(channel_id);
+      if (res) {
+        hit_data_.slot_id = slot_id;
+        hit_data_.feast_id = feast_id;
+        hit_data_.channel_id = channel_id;
+        scanner.skip_spaces();
+        const char* channel_type_pos = scanner.get_cursor();
+        res = false;
+        for (const char* label : tracker_channel_type_labels) {
+          if (scanner.lit(label)) {
+            hit_data_.channel_type = label;
+            res = true;
+            break;
+          }
+        }
+        scanner.skip_spaces();
+        const char* timestamp_type_pos = scanner.get_cursor();
+        if (res) {
+          res = false;
+          for (const char* label : tracker_timestamp_type_labels) {
+            if (scanner.lit(label)) {
+              hit_data_.timestamp_type = label;
+              res = true;
+              break;
+            }
+          }
+        }
+        // We use a trick because of nasty syntax from the DAQ ascii output:
+        // an exact " CA R0 " sequence is read as " CA R5 ".
+        if (res && hit_data_.channel_type == "CA" &&
+            hit_data_.timestamp_type == "R0" &&
+            channel_type_pos != data_line_.begin &&
+            channel_type_pos[-1] == ' ' &&
+            timestamp_type_pos == channel_type_pos + 3 &&
+            channel_type_pos[2] == ' ' &&
+            timestamp_type_pos + 2 != data_line_.end &&
+            timestamp_type_pos[2] == ' ') {
+          hit_data_.timestamp_type = "R5";
+        }
+      }
+      res = res && scanner.parse_ulong_long(hit_data_.timestamp_value) &&
+            scanner.parse_double(hit_data_.timestamp_ns);
       if (_format_ == FORMAT_FROM_2_4) {
-        res = qi::phrase_parse(
-          str_iter,
-          end_iter,
-          //  Begin grammar
-          (qi::lit("Slot") >> qi::uint_[boost::phoenix::ref(hit_data_.slot_id) =
-                                          boost::spirit::qi::_1] >>
-           qi::lit("Feast") >>
-           qi::uint_[boost::phoenix::ref(hit_data_.feast_id) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("Ch") >>
-           qi::uint_[boost::phoenix::ref(hit_data_.channel_id) =
-                       boost::spirit::qi::_1] >>
-           (qi::string("AN") |
-            qi::string("CA"))[boost::phoenix::ref(hit_data_.channel_type) =
-                                boost::spirit::qi::_1] >>
-           (qi::string("R0") | qi::string("R1") | qi::string("R2") |
-            qi::string("R3") | qi::string("R4") | qi::string("R5") |
-            qi::string("R6"))[boost::phoenix::ref(hit_data_.timestamp_type) =
-                                boost::spirit::qi::_1] >>
-           qi::ulong_long[boost::phoenix::ref(hit_data_.timestamp_value) =
-                            boost::spirit::qi::_1] >>
-           qi::double_[boost::phoenix::ref(hit_data_.timestamp_ns) =
-                         boost::spirit::qi::_1] >>
-           qi::lit("UnixTime") >>
-           qi::double_[boost::phoenix::ref(hit_data_.unix_time) =
-                         boost::spirit::qi::_1]),
-          //  End grammar
-          qi::space);
-      } else {
-        res = qi::phrase_parse(
-          str_iter,
-          end_iter,
-          //  Begin grammar
-          (qi::lit("Slot") >> qi::uint_[boost::phoenix::ref(hit_data_.slot_id) =
-                                          boost::spirit::qi::_1] >>
-           qi::lit("Feast") >>
-           qi::uint_[boost::phoenix::ref(hit_data_.feast_id) =
-                       boost::spirit::qi::_1] >>
-           qi::lit("Ch") >>
-           qi::uint_[boost::phoenix::ref(hit_data_.channel_id) =
-                       boost::spirit::qi::_1] >>
-           (qi::string("AN") |
-            qi::string("CA"))[boost::phoenix::ref(hit_data_.channel_type) =
-                                boost::spirit::qi::_1] >>
-           (qi::string("R0") | qi::string("R1") | qi::string("R2") |
-            qi::string("R3") | qi::string("R4") | qi::string("R5") |
-            qi::string("R6"))[boost::phoenix::ref(hit_data_.timestamp_type) =
-                                boost::spirit::qi::_1] >>
-           qi::ulong_long[boost::phoenix::ref(hit_data_.timestamp_value) =
-                            boost::spirit::qi::_1] >>
-           qi::double_[boost::phoenix::ref(hit_data_.timestamp_ns) =
-                         boost::spirit::qi::_1]),
-          //  End grammar
-          qi::space);
+        res = res && scanner.lit("UnixTime") &&
+              scanner.parse_double(hit_data_.unix_time);
       }
-      DT_THROW_IF(!res || str_iter != end_iter,
+      DT_THROW_IF(!res || !scanner.at_end(),
                   std::logic_error,
                   "Cannot parse file timestamp : "
-                    << data_line << "; failed at '" << *str_iter << "'!");
+                    << data_line_.to_string() << "; failed at '"
+                    << scanner.current() << "'!");
       DT_LOG_DEBUG(_logging_, "slot_id         = " << hit_data_.slot_id);
       DT_LOG_DEBUG(_logging_, "feast_id        = " << hit_data_.feast_id);
       DT_LOG_DEBUG(_logging_, "channel_id      = " << hit_data_.channel_id);
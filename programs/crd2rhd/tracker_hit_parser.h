@@ -8,7 +8,6 @@
 #define SNFEE_IO_TRACKER_HIT_PARSER_H
 
 // Standard library:
-#include <fstream>
 #include <string>
 
 // Third party:
@@ -18,6 +17,7 @@
 
 // This project:
 #include <snfee/data/tracker_hit_record.h>
+#include "crd_tokenizer.h"
 
 namespace snfee {
   namespace io {
@@ -62,10 +62,10 @@ namespace snfee {
       void set_config(const config_type&);
 
       //! Parse
-      bool parse(std::istream& in_, snfee::data::tracker_hit_record& hit_);
+      bool parse(crd_tokenizer& in_, snfee::data::tracker_hit_record& hit_);
 
     private:
-      void _parse_timestamp_(const std::string& data_line_,
+      void _parse_timestamp_(const crd_line& data_line_,
                              hit_data_type& hit_data_);
 
     private:
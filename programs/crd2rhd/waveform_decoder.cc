@@ -0,0 +1,367 @@
+// programs/crd2rhd/waveform_decoder.cc
+
+// Ourselves:
+#include "waveform_decoder.h"
+
+// Standard library:
+#include <cstring>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+  (defined(__GNUC__) || defined(__clang__))
+#define SNFEE_IO_WAVEFORM_DECODER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace snfee {
+  namespace io {
+
+    namespace {
+
+      //! Number of bytes classified per bitmap word
+      const std::size_t WORD_NBYTES = 64;
+
+      //! Maximum number of digits handled by the fast path
+      const std::size_t FAST_MAX_DIGITS = 4;
+
+      //! Classify bytes one at a time (also used for the tail of a line)
+      void
+      classify_scalar(const char* begin_,
+                      const std::size_t nbytes_,
+                      uint64_t& digits_,
+                      uint64_t& spaces_)
+      {
+        digits_ = 0;
+        spaces_ = 0;
+        for (std::size_t i = 0; i < nbytes_; i++) {
+          const char c = begin_[i];
+          if (crd_is_digit(c)) {
+            digits_ |= (uint64_t(1) << i);
+          } else if (crd_is_space(c)) {
+            spaces_ |= (uint64_t(1) << i);
+          }
+        }
+        return;
+      }
+
+      void
+      classify_line_scalar(const char* begin_,
+                           const std::size_t nwords_,
+                           uint64_t* digits_,
+                           uint64_t* spaces_)
+      {
+        for (std::size_t iw = 0; iw < nwords_; iw++) {
+          classify_scalar(
+            begin_ + iw * WORD_NBYTES, WORD_NBYTES, digits_[iw], spaces_[iw]);
+        }
+        return;
+      }
+
+#if defined(SNFEE_IO_WAVEFORM_DECODER_X86)
+
+      __attribute__((target("sse4.2"))) void
+      classify_line_sse42(const char* begin_,
+                          const std::size_t nwords_,
+                          uint64_t* digits_,
+                          uint64_t* spaces_)
+      {
+        const __m128i before_zero = _mm_set1_epi8('0' - 1);
+        const __m128i after_nine = _mm_set1_epi8('9' + 1);
+        const __m128i blank = _mm_set1_epi8(' ');
+        const __m128i before_tab = _mm_set1_epi8('\t' - 1);
+        const __m128i after_cr = _mm_set1_epi8('\r' + 1);
+        for (std::size_t iw = 0; iw < nwords_; iw++) {
+          uint64_t digits = 0;
+          uint64_t spaces = 0;
+          for (std::size_t ib = 0; ib < WORD_NBYTES; ib += 16) {
+            const __m128i c = _mm_loadu_si128(
+              reinterpret_cast<const __m128i*>(begin_ + iw * WORD_NBYTES + ib));
+            const __m128i d = _mm_and_si128(_mm_cmpgt_epi8(c, before_zero),
+                                            _mm_cmplt_epi8(c, after_nine));
+            const __m128i s =
+              _mm_or_si128(_mm_cmpeq_epi8(c, blank),
+                           _mm_and_si128(_mm_cmpgt_epi8(c, before_tab),
+                                         _mm_cmplt_epi8(c, after_cr)));
+            digits |= uint64_t(uint16_t(_mm_movemask_epi8(d))) << ib;
+            spaces |= uint64_t(uint16_t(_mm_movemask_epi8(s))) << ib;
+          }
+          digits_[iw] = digits;
+          spaces_[iw] = spaces;
+        }
+        return;
+      }
+
+      __attribute__((target("avx2"))) void
+      classify_line_avx2(const char* begin_,
+                         const std::size_t nwords_,
+                         uint64_t* digits_,
+                         uint64_t* spaces_)
+      {
+        const __m256i before_zero = _mm256_set1_epi8('0' - 1);
+        const __m256i after_nine = _mm256_set1_epi8('9' + 1);
+        const __m256i blank = _mm256_set1_epi8(' ');
+        const __m256i before_tab = _mm256_set1_epi8('\t' - 1);
+        const __m256i after_cr = _mm256_set1_epi8('\r' + 1);
+        for (std::size_t iw = 0; iw < nwords_; iw++) {
+          uint64_t digits = 0;
+          uint64_t spaces = 0;
+          for (std::size_t ib = 0; ib < WORD_NBYTES; ib += 32) {
+            const __m256i c = _mm256_loadu_si256(
+              reinterpret_cast<const __m256i*>(begin_ + iw * WORD_NBYTES + ib));
+            const __m256i d =
+              _mm256_and_si256(_mm256_cmpgt_epi8(c, before_zero),
+                               _mm256_cmpgt_epi8(after_nine, c));
+            const __m256i s = _mm256_or_si256(
+              _mm256_cmpeq_epi8(c, blank),
+              _mm256_and_si256(_mm256_cmpgt_epi8(c, before_tab),
+                               _mm256_cmpgt_epi8(after_cr, c)));
+            digits |= uint64_t(uint32_t(_mm256_movemask_epi8(d))) << ib;
+            spaces |= uint64_t(uint32_t(_mm256_movemask_epi8(s))) << ib;
+          }
+          digits_[iw] = digits;
+          spaces_[iw] = spaces;
+        }
+        return;
+      }
+
+#endif // defined(SNFEE_IO_WAVEFORM_DECODER_X86)
+
+      inline unsigned
+      count_trailing_zeros(const uint64_t word_)
+      {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(word_);
+#else
+        unsigned n = 0;
+        for (uint64_t w = word_; (w & 1) == 0; w >>= 1) {
+          n++;
+        }
+        return n;
+#endif
+      }
+
+      //! Convert a token of 1 to 4 decimal digits
+      inline uint16_t
+      convert_digits(const char* token_,
+                     const unsigned ndigits_,
+                     const std::size_t navailable_)
+      {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        // SWAR conversion of the 4 bytes starting the token, the digits
+        // are aligned on the last byte so that missing digits are zeros:
+        uint32_t x = 0;
+        if (navailable_ >= 4) {
+          std::memcpy(&x, token_, 4);
+        } else {
+          std::memcpy(&x, token_, ndigits_);
+        }
+        x -= 0x30303030;
+        x <<= 8 * (4 - ndigits_);
+        x = (x * 10 + (x >> 8)) & 0x00FF00FF;
+        x = (x * 100 + (x >> 16)) & 0x0000FFFF;
+        return static_cast<uint16_t>(x);
+#else
+        uint16_t value = 0;
+        for (unsigned i = 0; i < ndigits_; i++) {
+          value = value * 10 + (token_[i] - '0');
+        }
+        return value;
+#endif
+      }
+
+      //! Decode the space separated tokens of 1 to 4 digits of a line made
+      //! of digits and spaces only
+      //!
+      //! Return the position of the first token left to the scalar path
+      std::size_t
+      decode_fast(const char* begin_,
+                  const std::size_t nbytes_,
+                  const uint64_t* digits_,
+                  const std::size_t nwords_,
+                  uint16_t* adc_,
+                  const std::size_t capacity_,
+                  std::size_t& nsamples_)
+      {
+        static const uint16_t adc_max =
+          snfee::data::calo_hit_record::SAMPLE_ADC_MAX;
+        std::size_t nsamples = nsamples_;
+        uint64_t carry = 0;
+        for (std::size_t iw = 0; iw < nwords_; iw++) {
+          const uint64_t digits = digits_[iw];
+          uint64_t starts = digits & ~((digits << 1) | carry);
+          carry = digits >> (WORD_NBYTES - 1);
+          while (starts != 0) {
+            const unsigned offset = count_trailing_zeros(starts);
+            starts &= starts - 1;
+            const std::size_t pos = iw * WORD_NBYTES + offset;
+            // Digits run from the token start, possibly on the next word:
+            uint64_t run = digits >> offset;
+            if (offset != 0) {
+              run |= digits_[iw + 1] << (WORD_NBYTES - offset);
+            }
+            if (~run == 0) {
+              nsamples_ = nsamples;
+              return pos;
+            }
+            const unsigned ndigits = count_trailing_zeros(~run);
+            if (ndigits > FAST_MAX_DIGITS || nsamples == capacity_) {
+              nsamples_ = nsamples;
+              return pos;
+            }
+            const uint16_t adc =
+              convert_digits(begin_ + pos, ndigits, nbytes_ - pos);
+            if (adc > adc_max) {
+              nsamples_ = nsamples;
+              return pos;
+            }
+            adc_[nsamples] = adc;
+            nsamples++;
+          }
+        }
+        nsamples_ = nsamples;
+        return nbytes_;
+      }
+
+    } // namespace
+
+    // static
+    waveform_decoder::isa_type
+    waveform_decoder::best_isa()
+    {
+#if defined(SNFEE_IO_WAVEFORM_DECODER_X86)
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+        return ISA_AVX2;
+      }
+      if (__builtin_cpu_supports("sse4.2")) {
+        return ISA_SSE42;
+      }
+#endif
+      return ISA_SCALAR;
+    }
+
+    // static
+    const char*
+    waveform_decoder::isa_label(const isa_type isa_)
+    {
+      switch (isa_) {
+        case ISA_SSE42:
+          return "sse4.2";
+        case ISA_AVX2:
+          return "avx2";
+        default:
+          break;
+      }
+      return "scalar";
+    }
+
+    waveform_decoder::waveform_decoder()
+      : waveform_decoder(best_isa())
+    {
+      return;
+    }
+
+    waveform_decoder::waveform_decoder(const isa_type isa_)
+      : _isa_(isa_)
+    {
+#if !defined(SNFEE_IO_WAVEFORM_DECODER_X86)
+      _isa_ = ISA_SCALAR;
+#endif
+      return;
+    }
+
+    waveform_decoder::isa_type
+    waveform_decoder::get_isa() const
+    {
+      return _isa_;
+    }
+
+    waveform_decoder::status_type
+    waveform_decoder::decode(const crd_line& line_,
+                             uint16_t* adc_,
+                             const std::size_t capacity_,
+                             std::size_t& nsamples_)
+    {
+      static const uint16_t adc_max =
+        snfee::data::calo_hit_record::SAMPLE_ADC_MAX;
+      const char* begin = line_.begin;
+      const std::size_t nbytes = line_.end - line_.begin;
+
+      // Build the digit/space bitmaps of the line. The bytes past the end
+      // of the line are flagged as spaces so that the last token ends, an
+      // extra word ends tokens that cross the last word boundary:
+      const std::size_t nfull = nbytes / WORD_NBYTES;
+      const std::size_t ntail = nbytes % WORD_NBYTES;
+      const std::size_t nwords = nfull + 1;
+      if (_digits_.size() < nwords + 1) {
+        _digits_.resize(nwords + 1);
+        _spaces_.resize(nwords + 1);
+      }
+      uint64_t* digits = _digits_.data();
+      uint64_t* spaces = _spaces_.data();
+#if defined(SNFEE_IO_WAVEFORM_DECODER_X86)
+      if (_isa_ == ISA_AVX2) {
+        classify_line_avx2(begin, nfull, digits, spaces);
+      } else if (_isa_ == ISA_SSE42) {
+        classify_line_sse42(begin, nfull, digits, spaces);
+      } else {
+        classify_line_scalar(begin, nfull, digits, spaces);
+      }
+#else
+      classify_line_scalar(begin, nfull, digits, spaces);
+#endif
+      classify_scalar(
+        begin + nfull * WORD_NBYTES, ntail, digits[nfull], spaces[nfull]);
+      spaces[nfull] |= ~uint64_t(0) << ntail;
+      digits[nwords] = 0;
+      spaces[nwords] = ~uint64_t(0);
+
+      // Fast path for lines made of digits and spaces only:
+      uint64_t others = 0;
+      for (std::size_t iw = 0; iw < nwords; iw++) {
+        others |= ~(digits[iw] | spaces[iw]);
+      }
+      std::size_t pos = 0;
+      std::size_t nsamples = 0;
+      if (others == 0) {
+        pos = decode_fast(
+          begin, nbytes, digits, nwords, adc_, capacity_, nsamples);
+      }
+
+      // Scalar path for the rest of the line (if any):
+      status_type status = DECODE_OK;
+      if (pos < nbytes) {
+        crd_line rest;
+        rest.begin = begin + pos;
+        rest.end = line_.end;
+        crd_line_scanner scanner(rest);
+        int32_t value = 0;
+        while (scanner.parse_int(value)) {
+          // Same conversion as the former int16_t buffer:
+          const uint16_t adc = static_cast<int16_t>(value);
+          if (adc > adc_max) {
+            status = DECODE_RANGE_ERROR;
+            break;
+          }
+          if (nsamples == capacity_) {
+            status = DECODE_CAPACITY_ERROR;
+            break;
+          }
+          adc_[nsamples] = adc;
+          nsamples++;
+        }
+        if (status == DECODE_OK && !scanner.at_end()) {
+          status = DECODE_SYNTAX_ERROR;
+        }
+      }
+      if (status == DECODE_OK && nsamples == 0) {
+        status = DECODE_SYNTAX_ERROR;
+      }
+      nsamples_ = nsamples;
+      return status;
+    }
+
+  } // namespace io
+} // namespace snfee
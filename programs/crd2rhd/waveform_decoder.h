@@ -0,0 +1,79 @@
+//! \file programs/crd2rhd/waveform_decoder.h
+//! \brief Fast decoder for the raw waveform data lines of calorimeter hits
+
+#ifndef SNFEE_IO_WAVEFORM_DECODER_H
+#define SNFEE_IO_WAVEFORM_DECODER_H
+
+// Standard library:
+#include <cstdint>
+#include <vector>
+
+// This project:
+#include "crd_tokenizer.h"
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Decoder of a line of SAMLONG ADC samples
+    //!
+    //! A waveform line is a sequence of decimal integers separated by
+    //! spaces. The digit and space bitmaps of the line are first computed
+    //! with SSE4.2 or AVX2 instructions when the CPU supports them, then
+    //! the common short unsigned tokens are located with bit scans and
+    //! converted without any per byte classification. Any unusual token
+    //! (sign, more than 4 digits, unexpected character) hands the rest of
+    //! the line over to the scalar path which follows the rules of
+    //! crd_line_scanner::parse_int. Both paths produce the same samples.
+    class waveform_decoder {
+    public:
+      /// \brief Instruction set used for character classification
+      enum isa_type {
+        ISA_SCALAR = 0, ///< Portable code
+        ISA_SSE42 = 1,  ///< SSE4.2 (x86)
+        ISA_AVX2 = 2    ///< AVX2 (x86)
+      };
+
+      /// \brief Decoding status
+      enum status_type {
+        DECODE_OK = 0,           ///< Success
+        DECODE_SYNTAX_ERROR = 1, ///< Not a list of integers
+        DECODE_RANGE_ERROR = 2,  ///< ADC value out of the 12-bit range
+        DECODE_CAPACITY_ERROR = 3 ///< Too many samples
+      };
+
+      //! Return the best instruction set supported by the running CPU
+      static isa_type best_isa();
+
+      //! Return the label associated to an instruction set
+      static const char* isa_label(const isa_type isa_);
+
+      //! Constructor (the best instruction set is used by default)
+      waveform_decoder();
+
+      //! Constructor with a forced instruction set (testing/benchmarking)
+      explicit waveform_decoder(const isa_type isa_);
+
+      //! Return the instruction set in use
+      isa_type get_isa() const;
+
+      //! Decode a waveform line
+      //!
+      //! \param line_ the waveform data line
+      //! \param adc_ the contiguous storage of the samples
+      //! \param capacity_ the maximum number of samples
+      //! \param nsamples_ the number of decoded samples
+      status_type decode(const crd_line& line_,
+                         uint16_t* adc_,
+                         const std::size_t capacity_,
+                         std::size_t& nsamples_);
+
+    private:
+      isa_type _isa_ = ISA_SCALAR;    //!< Instruction set in use
+      std::vector<uint64_t> _digits_; //!< Digit bitmap of the line (reused)
+      std::vector<uint64_t> _spaces_; //!< Space bitmap of the line (reused)
+    };
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_WAVEFORM_DECODER_H
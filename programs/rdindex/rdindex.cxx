@@ -0,0 +1,228 @@
+//! Build the trigger ID index of existing RHD/RTD files
+
+// Standard library:
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/io_factory.h>
+#include <bayeux/datatools/logger.h>
+#include <bayeux/datatools/utils.h>
+// - Boost:
+#include <boost/program_options.hpp>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/data/tracker_hit_record.h>
+#include <snfee/data/trigger_record.h>
+#include <snfee/io/native_data_reader.h>
+#include <snfee/io/trigger_index.h>
+
+struct app_params_type {
+  datatools::logger::priority logging = datatools::logger::PRIO_FATAL;
+  std::string input_listname;
+  std::vector<std::string> input_filenames;
+  std::size_t block_size = snfee::io::trigger_index::DEFAULT_BLOCK_SIZE;
+  bool print_index = false;
+};
+
+namespace {
+
+  // Load the next record of a given type and index its trigger ID
+  template <typename Data, typename Reader>
+  void
+  index_next_record(Reader& reader_, snfee::io::trigger_index& index_)
+  {
+    Data data;
+    reader_.load(data);
+    index_.add_record(data.get_trigger_id());
+    return;
+  }
+
+  // Index all the records of a RHD/RTD file
+  template <typename Reader>
+  void
+  index_records(Reader& reader_,
+                const std::string& data_filename_,
+                snfee::io::trigger_index& index_)
+  {
+    Reader& reader = reader_;
+    const std::string& data_filename = data_filename_;
+    index_.reset();
+    while (reader.has_record_tag()) {
+      const std::string tag = reader.get_record_tag();
+      if (tag == snfee::data::raw_trigger_data::SERIAL_TAG) {
+        index_next_record<snfee::data::raw_trigger_data>(reader, index_);
+      } else if (tag == snfee::data::calo_hit_record::SERIAL_TAG) {
+        index_next_record<snfee::data::calo_hit_record>(reader, index_);
+      } else if (tag == snfee::data::tracker_hit_record::SERIAL_TAG) {
+        index_next_record<snfee::data::tracker_hit_record>(reader, index_);
+      } else if (tag == snfee::data::trigger_record::SERIAL_TAG) {
+        index_next_record<snfee::data::trigger_record>(reader, index_);
+      } else {
+        DT_THROW(std::logic_error,
+                 "Unsupported record '" << tag << "' in file '"
+                                        << data_filename << "'!");
+      }
+    }
+    return;
+  }
+
+  // Build the index of a RHD/RTD file
+  void
+  build_index(const std::string& data_filename_,
+              snfee::io::trigger_index& index_)
+  {
+    std::string data_filename = data_filename_;
+    datatools::fetch_path_with_env(data_filename);
+    if (snfee::io::native_format::is_native_filename(data_filename)) {
+      snfee::io::native_data_reader reader(data_filename);
+      index_records(reader, data_filename, index_);
+      return;
+    }
+    datatools::data_reader reader(data_filename,
+                                  datatools::using_multi_archives);
+    DT_THROW_IF(!reader.is_initialized(),
+                std::logic_error,
+                "Cannot read file '" << data_filename << "'!");
+    index_records(reader, data_filename, index_);
+    return;
+  }
+
+} // namespace
+
+int
+main(int argc_, char** argv_)
+{
+  int error_code = EXIT_SUCCESS;
+  try {
+    app_params_type app_params;
+
+    // clang-format off
+    // Parse options:
+    namespace po = boost::program_options;
+    po::options_description opts("Allowed options");
+    opts.add_options()
+      ("help,h", "produce help message")
+
+      ("logging,L",
+       po::value<std::string>()->value_name("level"),
+       "logging priority")
+
+      ("input-list,l",
+       po::value<std::string>(&app_params.input_listname)
+       ->value_name("path"),
+       "set a list of RHD/RTD input filenames")
+
+      ("input-file,i",
+       po::value<std::vector<std::string>>(&app_params.input_filenames)
+       ->multitoken()
+       ->value_name("path"),
+       "add a RHD/RTD input filename")
+
+      ("block-size,b",
+       po::value<std::size_t>(&app_params.block_size)
+       ->value_name("number")
+       ->default_value(snfee::io::trigger_index::DEFAULT_BLOCK_SIZE),
+       "set the number of records per index block")
+
+      ("print-index,P",
+       po::value<bool>(&app_params.print_index)
+       ->zero_tokens()
+       ->default_value(false),
+       "print the index of each file")
+
+    ; // end of options description
+    // clang-format on
+
+    // Describe command line arguments :
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc_, argv_).options(opts).run(), vm);
+    po::notify(vm);
+
+    // clang-format off
+    // Use command line arguments :
+    if (vm.count("help")) {
+      std::cout << "snfee-rdindex : "
+                << "Build the trigger ID index of RHD/RTD files"
+                << std::endl << std::endl;
+      std::cout << "Usage : " << std::endl << std::endl;
+      std::cout << "  snfee-rdindex [OPTIONS]" << std::endl << std::endl;
+      std::cout << opts << std::endl;
+      std::cout << "The index of each input file is saved next to it, with"
+                << " the '.tidx' extension." << std::endl << std::endl;
+      std::cout << "Example : " << std::endl << std::endl;
+      std::cout << "  snfee-rdindex \\\n";
+      std::cout << "    --input-file \"snemo_run-8_rtd_part-0.data.gz\" \\\n";
+      std::cout << "    --input-file \"snemo_run-8_rtd_part-1.data.gz\"";
+      std::cout << std::endl << std::endl;
+      return (-1);
+    }
+    // clang-format on
+
+    if (vm.count("logging")) {
+      std::string logging_repr = vm["logging"].as<std::string>();
+      app_params.logging = datatools::logger::get_priority(logging_repr);
+      DT_THROW_IF(app_params.logging == datatools::logger::PRIO_UNDEFINED,
+                  std::logic_error,
+                  "Invalid logging priority '"
+                    << vm["logging"].as<std::string>() << "'!");
+    }
+
+    // Build the list of input files:
+    std::vector<std::string> filenames;
+    if (!app_params.input_listname.empty()) {
+      std::string listname = app_params.input_listname;
+      datatools::fetch_path_with_env(listname);
+      std::ifstream fin(listname.c_str());
+      DT_THROW_IF(!fin,
+                  std::runtime_error,
+                  "Cannot open input list '" << listname << "'!");
+      while (fin) {
+        std::string filename;
+        fin >> filename >> std::ws;
+        if (!filename.empty() and filename[0] != '#') {
+          filenames.push_back(filename);
+        }
+      }
+    }
+    for (const auto& filename : app_params.input_filenames) {
+      filenames.push_back(filename);
+    }
+    DT_THROW_IF(
+      filenames.size() == 0, std::logic_error, "Missing input filenames!");
+
+    // Index the files:
+    for (const auto& filename : filenames) {
+      DT_LOG_NOTICE(app_params.logging,
+                    "Indexing file '" << filename << "'...");
+      snfee::io::trigger_index index(app_params.block_size);
+      build_index(filename, index);
+      index.store(snfee::io::trigger_index::index_filename(filename));
+      if (app_params.print_index) {
+        std::cout << "Index of '" << filename << "' : " << std::endl;
+        index.print(std::cout);
+      }
+      DT_LOG_NOTICE(app_params.logging,
+                    "Indexed records : " << index.get_number_of_records());
+    }
+  }
+  catch (std::exception& x) {
+    std::cerr << "error: " << x.what() << std::endl;
+    error_code = EXIT_FAILURE;
+  }
+  catch (...) {
+    std::cerr << "error: "
+              << "unexpected error!" << std::endl;
+    error_code = EXIT_FAILURE;
+  }
+  return (error_code);
+}
@@ -1,24 +1,28 @@
 //! Convert an RHD Stream to Root
 
 // - Boost:
+#include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
-#include <cstdio>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "snfee/data/calo_hit_record.h"
 #include "snfee/data/tracker_hit_record.h"
 #include "snfee/data/trigger_record.h"
 #include "snfee/io/multifile_data_reader.h"
+#include "snfee/io/root_output_config.h"
+
+// External sort of rhd2rtd
+#include "rhd_record.h"
+#include "rhd_sorter.h"
 
 // Input is 1-N RTD file to convert
 // Output is 1 root file
 #include "TFile.h"
-#include "TROOT.h"
 #include "TTree.h"
-#include "TTreeIndex.h"
 
-#include "ROOT/TSeq.hxx"
 #include "TRandom.h"
 #include "TStopwatch.h"
 
@@ -31,104 +35,106 @@ namespace {
     return nt < 0 ? 0 : nt;
   }
 
+  // Default memory cap (MB) of the sort of the RHD records
+  const std::size_t defaultSortMemory{
+    snfee::io::rhd_sorter::DEFAULT_MAX_MEMORY_SIZE / 1048576};
+
+  // Return the record of a given type wrapped in a RHD record
+  snfee::data::calo_hit_record*
+  getRecord(snfee::io::rhd_record const& rec, snfee::data::calo_hit_record*)
+  {
+    return rec.get_calo_hit_rec().get();
+  }
+
+  snfee::data::tracker_hit_record*
+  getRecord(snfee::io::rhd_record const& rec,
+            snfee::data::tracker_hit_record*)
+  {
+    return rec.get_tracker_hit_rec().get();
+  }
+
+  snfee::data::trigger_record*
+  getRecord(snfee::io::rhd_record const& rec, snfee::data::trigger_record*)
+  {
+    return rec.get_trig_rec().get();
+  }
+
   // Convert a Boost stream of RHD records to a TTree, with sorting of entries
   // by trigger_id
+  //
+  // Records are sorted with the external merge sort of rhd2rtd, bounded to
+  // sortMemory bytes: if the input does not fit, sorted runs are spilled to
+  // temporary native files next to the output file, then merged (in several
+  // passes if there are too many runs to be merged at once).
   template <typename RHDType>
   void
   rhd2root(snfee::io::multifile_data_reader& reader,
-           std::string const& ofilename)
+           std::string const& ofilename,
+           snfee::io::root_output_config const& outputConfig,
+           std::size_t const sortMemory)
   {
     // Parameters (for future factorization)
-    const std::string unsortedFilename{ofilename + ".unsorted"};
-    // Use gsl finally once C++17...
-    const std::string sortedFilename{ofilename};
-
     const std::string rhdFileTitle{"SuperNEMO RHD File"};
     const std::string rhdTreeName{"RawHitData"};
     const std::string rhdTreeTitle{"SuperNEMO Raw Hit Data"};
     const std::string rhdBranchName{"RHD"};
-    const std::string rhdTriggerIDBranchName{"_trigger_id_"};
-
-    // Intermediate direct conversion
-    {
-      TStopwatch tsp;
-      tsp.Start();
-      TFile unsortedFile{unsortedFilename.c_str(), "RECREATE"};
-      TTree rhdTree{rhdTreeName.c_str(), rhdTreeTitle.c_str()};
-
-      auto rhd = new RHDType{};
-      rhdTree.Branch(rhdBranchName.c_str(), &rhd);
-
-      std::string msg{"Converting RHD stream to ROOT Tree, done: "};
 
-      size_t counter{0};
-      while (reader.has_record_tag()) {
-        reader.load(*rhd);
-
-        // Mix up to model non-time ordering
-        rhd->set_trigger_id(mixTriggerID(rhd->get_trigger_id()));
-
-        rhdTree.Fill();
-
-        if (!(counter % 1000)) {
-          std::clog << msg << counter << "\r";
-        }
-        counter++;
+    TStopwatch tsp;
+    tsp.Start();
+
+    // Output, entries are filled from the record pointed to by rhd
+    RHDType working{};
+    RHDType* rhd{&working};
+    TFile sortedFile{ofilename.c_str(), "RECREATE", rhdFileTitle.c_str()};
+    outputConfig.apply(sortedFile);
+    TTree rhdTree{rhdTreeName.c_str(), rhdTreeTitle.c_str()};
+    rhdTree.Branch(rhdBranchName.c_str(), &rhd);
+    outputConfig.apply(rhdTree);
+
+    // Read the input through the sorter
+    snfee::io::rhd_sorter::config_type sorterConfig;
+    sorterConfig.max_memory_size = sortMemory;
+    sorterConfig.temporary_directory =
+      boost::filesystem::absolute(ofilename).parent_path().string();
+    snfee::io::rhd_sorter sorter{sorterConfig};
+    std::string msg{"Reading RHD stream, done: "};
+    size_t counter{0};
+    while (reader.has_record_tag()) {
+      auto record = std::make_shared<RHDType>();
+      reader.load(*record);
+
+      // Mix up to model non-time ordering
+      record->set_trigger_id(mixTriggerID(record->get_trigger_id()));
+      sorter.push_record(snfee::io::rhd_record{record});
+
+      if (!(counter % 1000)) {
+        std::clog << msg << counter << "\r";
       }
-      std::clog << msg << counter << "\n";
-
-      unsortedFile.Write();
-      tsp.Stop();
-      tsp.Print();
+      counter++;
+    }
+    std::clog << msg << counter << "\n";
+    sorter.terminate_input();
+    if (sorter.get_number_of_runs() > 0) {
+      std::clog << "Merging " << sorter.get_number_of_runs()
+                << " sorted runs of RHD records\n";
     }
 
-    // Sort entries by trigger_id
-    {
-      TStopwatch tsp;
-      tsp.Start();
-
-      ROOT::EnableImplicitMT();
-
-      TFile unsortedFile{unsortedFilename.c_str()};
-      TTree* unsortedTree;
-      unsortedFile.GetObject(rhdTreeName.c_str(), unsortedTree);
-      // Help random access performance, can expect same trigger_ids to
-      // be close to each other
-      // To be adjusted based on typical RHD file size (or from GetNbytes)
-      unsortedTree->SetMaxVirtualSize(1e9);
-
-      const auto nentries = unsortedTree->BuildIndex(rhdTriggerIDBranchName.c_str());
-      auto index = dynamic_cast<TTreeIndex*>(unsortedTree->GetTreeIndex());
-
-      RHDType* hit{nullptr};
-      unsortedTree->SetBranchAddress(rhdBranchName.c_str(), &hit);
-
-      TFile sortedFile{sortedFilename.c_str(), "RECREATE", rhdFileTitle.c_str()};
-      auto sortedTree = unsortedTree->CloneTree(0);
-
-      std::string msg{"Sorting RHD Tree by Trigger ID: "};
-
-      for (auto i : ROOT::TSeqI(nentries)) {
-        unsortedTree->GetEntry(index->GetIndex()[i]);
-        sortedTree->Fill();
-        if (!(i % 1000)) {
-          std::clog << msg << 100 * i / nentries << "%\r";
-        }
+    msg = "Writing RHD Tree sorted by Trigger ID: ";
+    std::size_t i{0};
+    while (sorter.has_next_record()) {
+      snfee::io::rhd_record const record{sorter.pop_next_record()};
+      rhd = getRecord(record, rhd);
+      rhdTree.Fill();
+      if (!(i % 1000)) {
+        std::clog << msg << 100 * i / counter << "%\r";
       }
-      std::clog << msg << "100%\n";
-
-      sortedFile.Write();
-      tsp.Stop();
-      tsp.Print();
+      i++;
     }
+    std::clog << msg << "100%\n";
 
-    // Remove intermediate file (eventually handled automatically
-    // by gsl finally)
-    int rmStatus = std::remove(unsortedFilename.c_str());
-    if (rmStatus) {
-      std::perror(("Failed to remove intermediate ROOT file '" +
-                  unsortedFilename + "'").c_str());
-    }
+    sortedFile.Write();
+    tsp.Stop();
+    tsp.Print();
   }
 } // namespace
 
@@ -138,6 +144,8 @@ main(int argc, char* argv[])
   // - Command Line
   snfee::io::multifile_data_reader::config_type inputConfig;
   std::string outputFile{};
+  snfee::io::root_output_config outputConfig;
+  std::size_t sortMemory{defaultSortMemory};
 
   namespace po = boost::program_options;
   po::options_description opts("Allowed options");
@@ -150,7 +158,14 @@ main(int argc, char* argv[])
     "path to RHD input file")(
     "output-file,o",
     po::value<std::string>(&outputFile)->value_name("<PATH>")->required(),
-    "path to ROOT output file");
+    "path to ROOT output file")(
+    "sort-memory,M",
+    po::value<std::size_t>(&sortMemory)
+      ->value_name("<MB>")
+      ->default_value(defaultSortMemory),
+    "memory cap (MB) of the sort of the RHD records, larger inputs are "
+    "sorted in runs merged from temporary files");
+  snfee::io::root_output_config::add_options(opts);
 
   // Describe command line arguments
   try {
@@ -161,6 +176,7 @@ main(int argc, char* argv[])
       return 0;
     }
     po::notify(vm);
+    outputConfig.configure(vm);
   }
   catch (std::exception& e) {
     std::cerr << "error: " << e.what() << "\n";
@@ -175,11 +191,14 @@ main(int argc, char* argv[])
 
     // 2. Process according to stream type
     if (rhdType == snfee::data::calo_hit_record::SERIAL_TAG) {
-      rhd2root<snfee::data::calo_hit_record>(reader, outputFile);
+      rhd2root<snfee::data::calo_hit_record>(
+        reader, outputFile, outputConfig, sortMemory * 1048576);
     } else if (rhdType == snfee::data::tracker_hit_record::SERIAL_TAG) {
-      rhd2root<snfee::data::tracker_hit_record>(reader, outputFile);
+      rhd2root<snfee::data::tracker_hit_record>(
+        reader, outputFile, outputConfig, sortMemory * 1048576);
     } else if (rhdType == snfee::data::trigger_record::SERIAL_TAG) {
-      rhd2root<snfee::data::tracker_hit_record>(reader, outputFile);
+      rhd2root<snfee::data::trigger_record>(
+        reader, outputFile, outputConfig, sortMemory * 1048576);
     } else {
       std::cerr << "Unknown RHD type '" << rhdType << "' in input stream "
           << std::endl;
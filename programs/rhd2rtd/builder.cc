@@ -2,14 +2,18 @@
 #include "builder.h"
 
 // Standard Library:
+#include <atomic>
 #include <chrono>
-#include <condition_variable>
+#include <ctime>
 #include <deque>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <mutex>
 #include <sstream>
 #include <thread>
+#include <utility>
 #include <vector>
 
 // Third party:
@@ -20,11 +24,18 @@
 
 // This project:
 #include "rhd_record.h"
+#include "record_pool.h"
+#include "rhd_buffer.h"
+#include "rhd_sorter.h"
 #include "rtd_record.h"
+#include "spsc_queue.h"
+#include "trigger_id_tree.h"
+#include "wait_event.h"
 #include <snfee/data/calo_hit_record.h>
 #include <snfee/data/raw_trigger_data.h>
 #include <snfee/data/tracker_hit_record.h>
 #include <snfee/data/trigger_record.h>
+#include <snfee/io/metrics.h>
 #include <snfee/io/multifile_data_reader.h>
 #include <snfee/io/multifile_data_writer.h>
 
@@ -121,6 +132,10 @@ namespace snfee {
     builder::stop()
     {
       _stop_request_ = true;
+      std::lock_guard<std::mutex> lock(_pimpl_mutex_);
+      if (_pimpl_) {
+        _stop_workers_();
+      }
       return;
     }
 
@@ -130,6 +145,24 @@ namespace snfee {
       return _results_;
     }
 
+    const builder::timing_results_type&
+    builder::get_timing_results() const
+    {
+      return _timing_results_;
+    }
+
+    const std::vector<builder::queue_results_type>&
+    builder::get_queue_results() const
+    {
+      return _queue_results_;
+    }
+
+    const std::vector<builder::pool_results_type>&
+    builder::get_pool_results() const
+    {
+      return _pool_results_;
+    }
+
     // virtual
     void
     builder::print_tree(std::ostream& out_,
@@ -169,9 +202,7 @@ namespace snfee {
     // ============================ Private ============================= //
 
     // Forward declarations:
-    struct rhd_buffer;
     struct rhd2rtd_merger;
-    struct rtd_buffer;
     struct input_worker;
     struct output_worker;
 
@@ -184,361 +215,122 @@ namespace snfee {
     /// Smart pointer to a RHD merger
     typedef std::shared_ptr<rhd2rtd_merger> rhd2rtd_merger_ptr;
 
-    /// \brief RHD input buffer
-    ///
-    /// \code
-    /// min_popping_trig_ids = 2
-    /// current_trig_id      = 4
-    /// rhd_recs             =
-    /// [TRIGID=4][TRIGID=4][TRIGID=4][TRIGID=5][TRIGID=5][TRIGID=7][TRIGID=8][TRIGID=8]
-    /// trig_ids             = {4,5,7,8}
-    /// terminated           = false
-    /// \endcode
-    ///
-    struct rhd_buffer {
-      rhd_buffer(const int32_t id_,
-                 const uint32_t capacity_ = 0,
-                 const std::size_t min_popping_trig_ids_ = 2)
-      {
-        _id_ = id_;
-        _min_popping_trig_ids_ = min_popping_trig_ids_;
-        _capacity_ = capacity_;
-        return;
-      }
+    /// Queue of RHD records from an input worker to the merger
+    typedef spsc_queue<snfee::io::rhd_record> rhd_queue_type;
 
-      ~rhd_buffer()
-      {
-        // std::cerr << "[devel] **** RHD buffer #" << _id_ << " destroyed!" <<
-        // std::endl;
-        return;
-      }
+    /// Queue of RTD records from the merger to the output worker
+    typedef spsc_queue<snfee::io::rtd_record> rtd_queue_type;
 
-      std::size_t
-      size() const
-      {
-        return _rhd_recs_.size();
-      }
-
-      std::size_t
-      get_capacity() const
-      {
-        return _capacity_;
-      }
-
-      /// Reset the RHD buffer
-      void
-      reset()
-      {
-        _rhd_recs_.clear();
-        _front_trig_id_ = snfee::data::INVALID_TRIGGER_ID;
-        return;
-      }
-
-      /// Check if the buffer is finished
-      bool
-      is_finished() const
-      {
-        return is_empty() and is_terminated();
-      }
-
-      /// Check if a given trigger ID is complete
-      bool
-      trig_id_is_finished(const int32_t test_trig_id_) const
-      {
-        if (is_finished()) {
-          // No more record is the buffer and no hope to get more:
-          return true;
-        }
-        if (_front_trig_id_ != snfee::data::INVALID_TRIGGER_ID and
-            test_trig_id_ < _front_trig_id_) {
-          // The current trigger ID in the buffer is newer than the tested
-          // value:
-          return true;
-        }
-        return false;
-      }
-
-      int32_t
-      get_front_trig_id() const
-      {
-        return _front_trig_id_;
-      }
-
-      bool
-      can_push() const
-      {
-        if (_capacity_ > 0 and _rhd_recs_.size() >= _capacity_) {
-          return false;
-        }
-        return true;
-      }
+    /// Set the capacity of the pool of records of a given type and reset
+    /// its statistics
+    template <typename T>
+    void
+    setup_record_pool(const std::size_t capacity_)
+    {
+      snfee::io::record_pool<T>& pool = snfee::io::record_pool<T>::instance();
+      pool.set_capacity(capacity_);
+      pool.reset_statistics();
+      return;
+    }
 
-      /// Insert a new record in the buffer
-      void
-      insert_record(const snfee::io::rhd_record rhd_rec_)
-      {
-        bool process_unsorted_records = false;
-        if (_min_popping_trig_ids_ > 1) {
-          process_unsorted_records = true;
-        }
-        int32_t new_trig_id = rhd_rec_.get_trigger_id();
-        if (_rhd_recs_.size() == 0) {
-          // RHD records =      [ ]
-          // New record  = [6]---^
-          _rhd_recs_.push_back(rhd_rec_);
-          _front_trig_id_ = new_trig_id;
-        } else {
-          if (new_trig_id < _front_trig_id_) {
-            DT_THROW_IF(!process_unsorted_records,
-                        std::logic_error,
-                        "Unsorted input RHD! This is a bug!");
-            // Exceptional case:
-            // RHD records =      [
-            // ][4][4][4][5][5][6][6][6][6][7][7][7][9][9][9][9][9] New record
-            // = [3]---^
-            _rhd_recs_.push_front(rhd_rec_);
-            _front_trig_id_ = new_trig_id;
-          }
-          if (new_trig_id < *_trig_ids_.rbegin()) {
-            DT_THROW_IF(!process_unsorted_records,
-                        std::logic_error,
-                        "Unsorted input RHD! This is a bug!");
-            // Rare case (rhd_rec_.get_trigger_id() < *_trig_ids_.rbegin() :
-            // RHD records = [4][4][4][5][5][6][6][6][6][7][7][7][9][9][9][9][9]
-            // New record  = [6]-------------^                    ^
-            // New record  = [8]----------------------------------'
-            std::deque<snfee::io::rhd_record>::iterator insert_iter =
-              _rhd_recs_.end();
-            for (std::deque<snfee::io::rhd_record>::iterator it =
-                   _rhd_recs_.begin();
-                 it != _rhd_recs_.end();
-                 it++) {
-              if (it->get_trigger_id() >= new_trig_id) {
-                insert_iter = it;
-                break;
-              }
-            }
-            _rhd_recs_.insert(insert_iter, rhd_rec_);
-          }
-          // Usual case:
-          // RHD records = [4][4][4][5][5][6][6][ ]
-          // New record  = [6]-------------------^
-          // New record  = [8]-------------------'
-          _rhd_recs_.push_back(rhd_rec_);
-        }
-        _trig_ids_.insert(new_trig_id);
-        return;
-      }
+    /// Return a new record of a given type from its pool
+    template <typename T>
+    std::shared_ptr<T>
+    make_pooled_record()
+    {
+      return snfee::io::record_pool<T>::instance().make();
+    }
 
-      /// Insert with sorting a new record in the buffer
-      void
-      insert_record_with_sort(const snfee::io::rhd_record rhd_rec_)
-      {
-        // DT_LOG_DEBUG(_logging_, "About to insert record in RHD buffer " <<
-        // _id_);
-        int32_t new_trig_id = rhd_rec_.get_trigger_id();
-        // DT_LOG_DEBUG(_logging_, "Buffer id=" << _id_ << " new trigger ID = "
-        // << new_trig_id); if (_front_trig_id_ ==
-        // snfee::data::INVALID_TRIGGER_ID) {
-        //   _front_trig_id_ = new_trig_id;
-        //   // DT_LOG_DEBUG(_logging_, "Buffer id=" << _id_ << " front trigger
-        //   ID = " << _front_trig_id_);
-        // }
-        // DT_LOG_DEBUG(_logging_, "Buffer id=" << _id_ << " insert new trigger
-        // ID = " << new_trig_id); DT_LOG_DEBUG(_logging_, "Buffer id=" << _id_
-        // << " insert RHD record"); if (_trig_ids_.size()) {
-        //   std::ostringstream outs;
-        //   outs << "Input buffer # " << _id_ << " : " << std::endl;
-        //   outs << "  New trigger ID   = " << rhd_rec_.get_trigger_id() <<
-        //   std::endl; outs << "  Front trigger ID = " << _front_trig_id_ <<
-        //   std::endl; outs << "  Min trigger ID   = " << *_trig_ids_.begin()
-        //   << std::endl; outs << "  Max trigger ID   = " <<
-        //   *_trig_ids_.rbegin() << std::endl; std::cerr << outs.str();
-        // }
-        if (_rhd_recs_.size() == 0) {
-          // RHD records =      [ ]
-          // New record  = [6]---^
-          _rhd_recs_.push_back(rhd_rec_);
-          _front_trig_id_ = new_trig_id;
-        } else {
-          if (new_trig_id >= *_trig_ids_.rbegin()) {
-            // Usual case:
-            // RHD records = [4][4][4][5][5][6][6][ ]
-            // New record  = [6]-------------------^
-            // New record  = [8]-------------------'
-            _rhd_recs_.push_back(rhd_rec_);
-          } else if (new_trig_id < _front_trig_id_) {
-            // Exceptional case:
-            // RHD records =      [
-            // ][4][4][4][5][5][6][6][6][6][7][7][7][9][9][9][9][9] New record
-            // = [3]---^
-            _rhd_recs_.push_front(rhd_rec_);
-            _front_trig_id_ = new_trig_id;
-          } else {
-            // Rare case (rhd_rec_.get_trigger_id() < *_trig_ids_.rbegin() :
-            // RHD records = [4][4][4][5][5][6][6][6][6][7][7][7][9][9][9][9][9]
-            // New record  = [6]-------------^                    ^
-            // New record  = [8]----------------------------------'
-            std::deque<snfee::io::rhd_record>::iterator insert_iter =
-              _rhd_recs_.end();
-            for (std::deque<snfee::io::rhd_record>::iterator it =
-                   _rhd_recs_.begin();
-                 it != _rhd_recs_.end();
-                 it++) {
-              if (it->get_trigger_id() >= new_trig_id) {
-                insert_iter = it;
-                break;
-              }
-            }
-            _rhd_recs_.insert(insert_iter, rhd_rec_);
-          }
-        }
-        _trig_ids_.insert(new_trig_id);
-        return;
-      }
+    /// Return the allocation statistics of the pool of records of a given
+    /// type
+    template <typename T>
+    builder::pool_results_type
+    record_pool_results(const std::string& record_type_)
+    {
+      const snfee::io::record_pool_statistics stats =
+        snfee::io::record_pool<T>::instance().get_statistics();
+      builder::pool_results_type results;
+      results.record_type = record_type_;
+      results.object_allocations = stats.object_allocations;
+      results.object_reuses = stats.object_reuses;
+      results.block_allocations = stats.block_allocations;
+      results.block_reuses = stats.block_reuses;
+      return results;
+    }
 
-      /// Pop a record from the buffer
-      snfee::io::rhd_record
-      pop_record()
-      {
-        DT_THROW_IF(
-          is_empty(), std::logic_error, "No more record in the RHD buffer!");
-        snfee::io::rhd_record rec = _rhd_recs_.front();
-        _rhd_recs_.pop_front();
-        _front_trig_id_ = snfee::data::INVALID_TRIGGER_ID;
-        _trig_ids_.clear();
-        if (_rhd_recs_.size()) {
-          // Update the current trigger ID with the ones from the next record:
-          const snfee::io::rhd_record& next_rec = _rhd_recs_.front();
-          _front_trig_id_ = next_rec.get_trigger_id();
-          // Update the set of embedded trigger IDs
-          for (const auto& rhd_rec : _rhd_recs_) {
-            _trig_ids_.insert(rhd_rec.get_trigger_id());
-          }
-        }
-        return rec;
+    /// Return the counter of the records processed by a stage of the
+    /// pipeline (null if the metrics are disabled)
+    snfee::io::metrics_counter*
+    make_records_metrics(const std::string& stage_)
+    {
+      snfee::io::metrics_registry& registry =
+        snfee::io::metrics_registry::global();
+      if (!registry.is_enabled()) {
+        return nullptr;
       }
+      return &registry.make_counter("snfee_rtdb_records_total",
+                                    "Number of records processed by a stage "
+                                    "of the RTD builder",
+                                    {{"stage", stage_}});
+    }
 
-      void
-      terminate()
-      {
-        _terminated_ = true;
-        return;
+    /// Return the histogram of the time spent by a stage of the pipeline
+    /// waiting on a queue (null if the metrics are disabled)
+    snfee::io::metrics_histogram*
+    make_wait_metrics(const std::string& stage_, const std::string& queue_)
+    {
+      snfee::io::metrics_registry& registry =
+        snfee::io::metrics_registry::global();
+      if (!registry.is_enabled()) {
+        return nullptr;
       }
+      return &registry.make_histogram(
+        "snfee_rtdb_wait_seconds",
+        "Time spent by a stage of the RTD builder waiting for records or "
+        "for room in a queue (s)",
+        {{"stage", stage_}, {"queue", queue_}});
+    }
 
-      bool
-      is_terminated() const
-      {
-        return _terminated_;
-      }
+    /// Name of the gauges of the number of records in the queues
+    static const std::string QUEUE_FILL_METRICS = "snfee_rtdb_queue_records";
 
-      bool
-      is_empty() const
-      {
-        return _rhd_recs_.size() == 0;
-      }
+    /// Name of the gauges of the number of records in the input buffers
+    static const std::string BUFFER_FILL_METRICS = "snfee_rtdb_buffer_records";
 
-      int32_t
-      get_next_poppable_trig_id() const
-      {
-        if (is_empty())
-          return snfee::data::INVALID_TRIGGER_ID;
-        if (is_terminated())
-          return _front_trig_id_;
-        if (_trig_ids_.size() >= _min_popping_trig_ids_)
-          return _front_trig_id_;
-        return snfee::data::INVALID_TRIGGER_ID;
+    /// Return the gauge of the number of records in a queue or an input
+    /// buffer (null if the metrics are disabled)
+    snfee::io::metrics_gauge*
+    make_fill_metrics(const std::string& name_, const std::string& queue_)
+    {
+      snfee::io::metrics_registry& registry =
+        snfee::io::metrics_registry::global();
+      if (!registry.is_enabled()) {
+        return nullptr;
       }
+      const std::string help = name_ == BUFFER_FILL_METRICS
+                                 ? "Number of records in an input buffer"
+                                 : "Number of records in a queue";
+      return &registry.make_gauge(name_, help, {{"queue", queue_}});
+    }
 
-      bool
-      can_be_popped() const
-      {
-        if (is_empty())
-          return false;
-        if (is_terminated())
-          return true;
-        if (_trig_ids_.size() >= _min_popping_trig_ids_)
-          return true;
-        return false;
+    /// Return the label of an input in the metrics
+    std::string
+    input_metrics_label(
+      const int id_,
+      const snfee::rtdb::builder_config::input_config_type& iconfig_)
+    {
+      if (!iconfig_.label.empty()) {
+        return iconfig_.label;
       }
+      return "input#" + std::to_string(id_);
+    }
 
-      void
-      print(std::ostream& out_) const
-      {
-        std::ostringstream out;
-        out << "RHD buffer : " << std::endl;
-        out << "|-- ID : " << _id_ << std::endl;
-        out << "|-- Minimum popping trig. IDs : " << _min_popping_trig_ids_
-            << std::endl;
-        out << "|-- Capacity : " << _capacity_ << std::endl;
-        out << "|-- RHD records FIFO : " << _rhd_recs_.size() << std::endl;
-        {
-          std::size_t counter = 0;
-          for (const auto& rhd_rec : _rhd_recs_) {
-            out << "|   ";
-            if (counter + 1 == _rhd_recs_.size()) {
-              out << "`-- ";
-            } else {
-              out << "|-- ";
-            }
-            // out << "RHD";
-            out << rhd_rec;
-            out << std::endl;
-            counter++;
-          }
-        }
-        out << "|-- Front trigger ID : " << _front_trig_id_ << std::endl;
-        out << "|-- Embedded trigger IDs : " << _trig_ids_.size() << std::endl;
-        {
-          std::size_t counter = 0;
-          for (const auto& trigid : _trig_ids_) {
-            bool print_it = false;
-            if (counter == 0)
-              print_it = true;
-            if (counter + 1 == _trig_ids_.size())
-              print_it = true;
-            if (print_it) {
-              out << "|   ";
-              if (counter + 1 == _trig_ids_.size()) {
-                out << "`-- ";
-              } else {
-                out << "|-- ";
-              }
-              out << trigid;
-              out << std::endl;
-              if (counter == 0 and _trig_ids_.size() >= 3) {
-                out << "|   "
-                    << "|-- "
-                    << "..." << std::endl;
-              }
-            }
-            counter++;
-          }
-        }
-        out << "|-- Terminated : " << std::boolalpha << _terminated_
-            << std::endl;
-        out << "`-- Finished : " << std::boolalpha << is_finished()
-            << std::endl;
-        out << std::endl;
-        out_ << out.str();
-        return;
-      }
+    /// Default capacity of a queue of RHD records (if not bounded by the
+    /// configuration)
+    static const std::size_t DEFAULT_RHD_QUEUE_CAPACITY = 1000;
 
-    private:
-      // Configuration:
-      datatools::logger::priority _logging_ = datatools::logger::PRIO_FATAL;
-      int32_t _id_ = -1;       ///< FIFO identifier
-      uint32_t _capacity_ = 0; ///< FIFO max capacity
-      std::size_t _min_popping_trig_ids_ =
-        1; ///< Minimal number of trigger IDs needed before popping
-      std::deque<snfee::io::rhd_record> _rhd_recs_; ///< FIFO of RHD records
-      std::set<int32_t> _trig_ids_; ///< Set of trigger IDs associated to
-                                    ///< currently stored RHD records
-      int32_t _front_trig_id_ =
-        snfee::data::INVALID_TRIGGER_ID; ///< Front record trigger ID
-      bool _terminated_ =
-        false; ///< Input source is terminated and cannot push more RHD records
-    };
+    /// Capacity of the queue of RTD records
+    static const std::size_t RTD_QUEUE_CAPACITY = 100;
 
     /// \brief RHD input worker
     struct input_worker {
@@ -547,6 +339,7 @@ namespace snfee {
       stop()
       {
         _stop_request_ = true;
+        _room_event_.notify();
         return;
       }
 
@@ -559,15 +352,17 @@ namespace snfee {
       /// Constructor
       input_worker(
         const int id_,
-        std::mutex& imtx_,
-        rhd_buffer& ibuf_,
+        rhd_queue_type& iqueue_,
         const snfee::rtdb::builder_config::input_config_type& iconfig_,
+        const std::size_t prefetch_depth_,
+        const std::size_t sort_memory_size_,
         const datatools::logger::priority logging_)
-        : _mtx_(imtx_), _buf_(ibuf_)
+        : _queue_(iqueue_)
       {
         _logging_ = logging_;
         DT_LOG_TRACE_ENTERING(_logging_);
         DT_LOG_DEBUG(_logging_, "Worker #" << id_);
+        _queue_.set_producer_event(&_room_event_);
         _id_ = id_;
         DT_LOG_DEBUG(_logging_,
                      "Open a multi-file reader from worker [" << _id_
@@ -601,7 +396,27 @@ namespace snfee {
         for (int ifile = 0; ifile < (int)iconfig_.filenames.size(); ifile++) {
           reader_config.filenames.push_back(iconfig_.filenames[ifile]);
         }
+        reader_config.prefetch_depth = prefetch_depth_;
+        const std::string label = input_metrics_label(id_, iconfig_);
+        reader_config.metrics_label = label;
+        _records_metrics_ = make_records_metrics("input:" + label);
+        _wait_metrics_ = make_wait_metrics("input:" + label, "rhd:" + label);
+        _queue_fill_metrics_ =
+          make_fill_metrics(QUEUE_FILL_METRICS, "rhd:" + label);
         _preader_.reset(new snfee::io::multifile_data_reader(reader_config));
+        // The records are recycled through the pools, in prefetch mode too:
+        _preader_->add_record_type<snfee::data::calo_hit_record>(
+          make_pooled_record<snfee::data::calo_hit_record>);
+        _preader_->add_record_type<snfee::data::tracker_hit_record>(
+          make_pooled_record<snfee::data::tracker_hit_record>);
+        _preader_->add_record_type<snfee::data::trigger_record>(
+          make_pooled_record<snfee::data::trigger_record>);
+        if (sort_memory_size_ > 0) {
+          snfee::io::rhd_sorter::config_type sorter_config;
+          sorter_config.max_memory_size = sort_memory_size_;
+          _psorter_.reset(new snfee::io::rhd_sorter(sorter_config));
+          _psorter_->set_logging(_logging_);
+        }
         DT_LOG_TRACE_EXITING(_logging_);
         return;
       }
@@ -631,117 +446,69 @@ namespace snfee {
         DT_LOG_DEBUG(_logging_,
                      "Starting main running loop from worker [" << _id_
                                                                 << "]...");
+        if (_psorter_) {
+          // The whole input is sorted before feeding the queue:
+          DT_LOG_NOTICE(_logging_,
+                        "Sorting the input of worker [" << _id_ << "]...");
+          while (!_stop_request_ and _load_record_(rec)) {
+            _psorter_->push_record(rec);
+            rec.reset();
+          }
+          _psorter_->terminate_input();
+          DT_LOG_NOTICE(_logging_,
+                        "Input of worker ["
+                          << _id_ << "] is sorted : "
+                          << _psorter_->get_number_of_records()
+                          << " records in " << _psorter_->get_number_of_runs()
+                          << " spilled runs (peak memory : "
+                          << _psorter_->get_peak_memory_size() << " bytes)");
+        }
         bool terminated_input = false;
         while (!_stop_request_) {
           DT_LOG_DEBUG(_logging_, "Do loop from worker [" << _id_ << "]...");
           if (rec.empty()) {
-            // Try to load a new RHD record:
-            if (_preader_->has_record_tag()) {
-              if (_preader_->record_tag_is(
-                    snfee::data::calo_hit_record::SERIAL_TAG)) {
-                DT_LOG_DEBUG(_logging_,
-                             "Loading a new calo hit record from worker ["
-                               << _id_ << "]...");
-                rec.make_calo_hit();
-                _preader_->load(*rec.get_calo_hit_rec());
-                DT_LOG_DEBUG(_logging_,
-                             "New calo hit record is loaded from worker ["
-                               << _id_ << "]...");
-                _records_counter_++;
-                DT_LOG_DEBUG(_logging_,
-                             "Input buffer #"
-                               << _id_ << " is unlocked by input worker.");
-              } else if (_preader_->record_tag_is(
-                           snfee::data::tracker_hit_record::SERIAL_TAG)) {
-                DT_LOG_DEBUG(_logging_,
-                             "Loading a new tracker hit record from worker ["
-                               << _id_ << "]...");
-                rec.make_tracker_hit();
-                _preader_->load(*rec.get_tracker_hit_rec());
-                DT_LOG_DEBUG(_logging_,
-                             "New tracker hit record is loaded from worker ["
-                               << _id_ << "]...");
-                _records_counter_++;
-                DT_LOG_DEBUG(_logging_,
-                             "Input buffer #"
-                               << _id_ << " is unlocked by input worker.");
-              } else if (_preader_->record_tag_is(
-                           snfee::data::trigger_record::SERIAL_TAG)) {
-                DT_LOG_DEBUG(_logging_,
-                             "Loading a new trigger record from worker ["
-                               << _id_ << "]...");
-                rec.make_trig();
-                _preader_->load(*rec.get_trig_rec());
-                DT_LOG_DEBUG(_logging_,
-                             "New trigger record is loaded from worker ["
-                               << _id_ << "]...");
-                _records_counter_++;
-                DT_LOG_DEBUG(_logging_,
-                             "Input buffer #"
-                               << _id_ << " is unlocked by input worker.");
-              } else {
-                DT_THROW(std::logic_error,
-                         "Worker [" << _id_
-                                    << "] met unknown serialized object '"
-                                    << _preader_->get_record_tag() << "'");
-              }
-            } else {
+            // Try to fetch a new RHD record:
+            if (!_next_record_(rec)) {
               terminated_input = true;
             }
           }
 
+          bool queue_is_full = false;
+          uint64_t ticket = 0;
           if (!rec.empty()) {
-            std::lock_guard<std::mutex> lock(_mtx_);
-            DT_LOG_DEBUG(_logging_,
-                         "Input buffer #" << _id_
-                                          << " is locked by input worker.");
-            if (_buf_.can_push()) {
-              // DT_LOG_NOTICE(_logging_, "Input worker [" << _id_ << "] run :
-              // can push!");
-              DT_LOG_DEBUG(_logging_,
-                           "Inserting the RHD record in the input buffer #"
-                             << _id_ << "...");
-              _buf_.insert_record(rec);
+            ticket = _room_event_.prepare_wait();
+            // The record is kept for a next try if the queue is full:
+            if (_queue_.try_push(rec)) {
               DT_LOG_DEBUG(_logging_,
-                           "RHD record was inserted in the input buffer #"
+                           "RHD record was pushed in the input queue #"
                              << _id_ << "...");
-              if (datatools::logger::is_debug(_logging_)) {
-                _buf_.print(std::cerr);
-              }
               rec.reset();
+              if (_queue_fill_metrics_) {
+                _queue_fill_metrics_->set(_queue_.size());
+              }
             } else {
-              // DT_LOG_NOTICE(_logging_, "Input worker [" << _id_ << "] run :
-              // cannot push!");
+              queue_is_full = true;
             }
           }
 
           if (terminated_input and rec.empty()) {
             // No more records from the reader and no waiting current record:
-            std::lock_guard<std::mutex> lock(_mtx_);
-            DT_LOG_DEBUG(_logging_,
-                         "Input buffer #" << _id_
-                                          << " is locked by input worker.");
             DT_LOG_DEBUG(_logging_, "RHD [" << _id_ << "] source is done.");
-            _buf_.terminate();
-            DT_LOG_DEBUG(_logging_,
-                         "Input buffer #" << _id_
-                                          << " is unlocked by input worker.");
+            _queue_.close();
             stop();
-            if (is_stopped()) {
-              DT_LOG_NOTICE(_logging_,
-                            "Input buffer [" << _id_ << "] at worker stop: ");
-              _buf_.print(std::cerr);
-            }
           }
 
-          DT_LOG_DEBUG(_logging_, "Worker [" << _id_ << "] yields...");
-          if (_records_counter_ % 1000 == 0 or is_stopped()) {
+          if (queue_is_full) {
+            // Sleep until the merger pops some records:
+            DT_LOG_DEBUG(_logging_, "Worker [" << _id_ << "] waits...");
+            snfee::io::metrics_timer wait_timer(_wait_metrics_);
+            _room_event_.wait(ticket);
+          } else if (_records_counter_ % 1000 == 0 or is_stopped()) {
             DT_LOG_NOTICE(_logging_,
                           "Input worker [" << _id_
                                            << "] run : " << _records_counter_
                                            << " input records");
           }
-          std::this_thread::yield();
         } // end of run loop
         DT_LOG_NOTICE(_logging_,
                       "Input worker [" << _id_ << "] run is stopped.");
@@ -749,14 +516,69 @@ namespace snfee {
         return;
       }
 
+      /// Load the next RHD record from the reader, return false at the end
+      /// of the input
+      bool
+      _load_record_(snfee::io::rhd_record& rec_)
+      {
+        if (!_preader_->has_record_tag()) {
+          return false;
+        }
+        if (_preader_->record_tag_is(
+              snfee::data::calo_hit_record::SERIAL_TAG)) {
+          DT_LOG_DEBUG(_logging_,
+                       "Loading a new calo hit record from worker [" << _id_
+                                                                     << "]...");
+          rec_ = snfee::io::rhd_record(
+            _preader_->load_shared<snfee::data::calo_hit_record>());
+        } else if (_preader_->record_tag_is(
+                     snfee::data::tracker_hit_record::SERIAL_TAG)) {
+          DT_LOG_DEBUG(_logging_,
+                       "Loading a new tracker hit record from worker ["
+                         << _id_ << "]...");
+          rec_ = snfee::io::rhd_record(
+            _preader_->load_shared<snfee::data::tracker_hit_record>());
+        } else if (_preader_->record_tag_is(
+                     snfee::data::trigger_record::SERIAL_TAG)) {
+          DT_LOG_DEBUG(_logging_,
+                       "Loading a new trigger record from worker [" << _id_
+                                                                    << "]...");
+          rec_ = snfee::io::rhd_record(
+            _preader_->load_shared<snfee::data::trigger_record>());
+        } else {
+          DT_THROW(std::logic_error,
+                   "Worker [" << _id_ << "] met unknown serialized object '"
+                              << _preader_->get_record_tag() << "'");
+        }
+        _records_counter_++;
+        if (_records_metrics_) {
+          _records_metrics_->add();
+        }
+        return true;
+      }
+
+      /// Fetch the next RHD record to be pushed in the queue, from the
+      /// sorter if any, return false at the end of the input
+      bool
+      _next_record_(snfee::io::rhd_record& rec_)
+      {
+        if (_psorter_) {
+          if (!_psorter_->has_next_record()) {
+            return false;
+          }
+          rec_ = _psorter_->pop_next_record();
+          return true;
+        }
+        return _load_record_(rec_);
+      }
+
       void
       print(std::ostream& out_) const
       {
         std::ostringstream out;
         out << "Input worker [@" << this << "] :" << std::endl;
         out << "|-- ID     : " << _id_ << std::endl;
-        out << "|-- Mutex  : [@" << &_mtx_ << ']' << std::endl;
-        out << "|-- Buffer : [@" << &_buf_ << ']' << std::endl;
+        out << "|-- Queue  : [@" << &_queue_ << ']' << std::endl;
         out << "|-- Reader : [@" << _preader_.get() << ']' << std::endl;
         out << "`-- Stop   : " << std::boolalpha << _stop_request_ << std::endl;
         out << std::endl;
@@ -773,138 +595,69 @@ namespace snfee {
       // Configuration:
       datatools::logger::priority _logging_; ///< Logging priority
       int _id_ = -1;                         ///< Identifier of the input worker
-      std::mutex&
-        _mtx_; ///< Handle to the mutex associated to the input RHD buffer
-      rhd_buffer& _buf_; ///< Handle to the input RHD buffer
+      rhd_queue_type& _queue_; ///< Handle to the input RHD queue
       bool _accept_unsorted_input_ = false;
       std::shared_ptr<snfee::io::multifile_data_reader>
         _preader_; ///< Data reader
+      std::unique_ptr<snfee::io::rhd_sorter>
+        _psorter_; ///< Optional external sorter of the input records
 
       // Working:
-      bool _stop_request_ = false;       ///< Control stop
+      std::atomic<bool> _stop_request_{false}; ///< Control stop
       std::size_t _records_counter_ = 0; ///< Counter of processed RHD records
+      wait_event _room_event_; ///< Event notified when the queue is popped
 
-    }; // end of struct input_worker
-
-    /// \brief RTD output buffer
-    struct rtd_buffer {
-
-      rtd_buffer() { return; }
-
-      ~rtd_buffer()
-      {
-        _front_trigger_id_ = snfee::data::INVALID_TRIGGER_ID;
-        _rtd_recs_.clear();
-        return;
-      }
-
-      void
-      terminate()
-      {
-        _terminated_ = true;
-        return;
-      }
-
-      bool
-      is_terminated()
-      {
-        return _terminated_;
-      }
-
-      bool
-      is_empty()
-      {
-        return _rtd_recs_.empty();
-      }
-
-      void
-      push_record(const snfee::io::rtd_record& rec_)
-      {
-        int32_t new_trigger_id = rec_.get_trigger_id();
-        _front_trigger_id_ = new_trigger_id;
-        _rtd_recs_.push_back(rec_);
-        return;
-      }
-
-      snfee::io::rtd_record
-      pop_record()
-      {
-        snfee::io::rtd_record rec = _rtd_recs_.front();
-        _rtd_recs_.pop_front();
-        _front_trigger_id_ = snfee::data::INVALID_TRIGGER_ID;
-        if (_rtd_recs_.size()) {
-          // Update the current trigger ID with the ones from the next record in
-          // the FIFO:
-          const snfee::io::rtd_record& next_rec = _rtd_recs_.front();
-          _front_trigger_id_ = next_rec.get_trigger_id();
-        }
-        return rec;
-      }
+      // Metrics (null if disabled):
+      snfee::io::metrics_counter* _records_metrics_ =
+        nullptr; ///< Loaded RHD records
+      snfee::io::metrics_histogram* _wait_metrics_ =
+        nullptr; ///< Waiting time for room in the queue
+      snfee::io::metrics_gauge* _queue_fill_metrics_ =
+        nullptr; ///< Records in the queue
 
-      void
-      print(std::ostream& out_) const
-      {
-        std::ostringstream out;
-        out << "RTD buffer: " << std::endl;
-        out << "|-- RTD records FIFO : " << _rtd_recs_.size() << std::endl;
-        std::size_t counter = 0;
-        for (const auto& rtd_rec : _rtd_recs_) {
-          out << "|   ";
-          if (counter + 1 == _rtd_recs_.size()) {
-            out << "`-- ";
-          } else {
-            out << "|-- ";
-          }
-          out << rtd_rec;
-          out << std::endl;
-          counter++;
-        }
-        out << "|-- Front trigger ID : " << _front_trigger_id_ << std::endl;
-        out << "`-- Terminated       : " << std::boolalpha << _terminated_
-            << std::endl;
-        out << std::endl;
-        out_ << out.str();
-        return;
-      }
-
-    private:
-      int32_t _front_trigger_id_ = -1;
-      std::deque<snfee::io::rtd_record> _rtd_recs_;
-      bool _terminated_ = false;
-    };
+    }; // end of struct input_worker
 
     /// \brief Pimpl-ized private resources
     ///
-    ///                               imtx #0
-    ///           +------------+     +------------+
-    /// [RHD]-->--| iworker #0 |-->--| ibuffer #0 |
-    ///           +------------+     +------------+.
-    ///                               imtx #1       \    +----------------+ omtx
-    ///           +------------+     +------------+  \   |                |
-    ///           +---------+
-    /// [RHD]-->--| iworker #1 |-->--| ibuffer #1 |---->-|     merger |-->--|
-    /// obuffer |-->--[RTD]
-    ///           +------------+     +------------+  /   |                |
-    ///           +---------+
-    ///                 :                  :        /    +----------------+
-    ///           +------------+     +------------+'
-    /// [RHD]-->--| iworker #N |-->--| ibuffer #N |
-    ///           +------------+     +------------+
-    ///                               imtx #N
+    ///                          iqueue #0
+    ///           +------------+     +-----------+
+    /// [RHD]-->--| iworker #0 |-->--|||||||||||||-.
+    ///           +------------+     +-----------+  \   +-----------------+
+    ///           +------------+     +-----------+   \  | merger          |
+    /// [RHD]-->--| iworker #1 |-->--|||||||||||||---->-| ibuffer #0..N   |-.
+    ///           +------------+     +-----------+   /  +-----------------+  |
+    ///                 :                  :        /                        |
+    ///           +------------+     +-----------+ /                         |
+    /// [RHD]-->--| iworker #N |-->--|||||||||||||'                          |
+    ///           +------------+     +-----------+                           |
+    ///                          iqueue #N                                   |
+    ///                                 +-----------+      +---------+       |
+    ///                       [RTD]--<--| oworker   |--<---|||||||||||--<----'
+    ///                                 +-----------+      +---------+
+    ///                                                     oqueue
     ///
+    /// Each queue links exactly one producer thread to one consumer thread
+    /// and is lock-free. The input buffers are owned by the merger thread.
+    /// A thread with nothing to do sleeps on a wait event, notified by the
+    /// thread at the other end of its queue(s).
     struct builder::pimpl_type {
       std::vector<input_worker_ptr>
         iworkers; ///< Collection of RHD input workers
+      std::vector<std::shared_ptr<rhd_queue_type>>
+        iqueues; ///< Collection of queues of input raw hit data records (RHD)
       std::vector<rhd_buffer>
         ibuffers; ///< Collection of buffers of input raw hit data records (RHD)
-      std::vector<std::shared_ptr<std::mutex>>
-        imtxs; ///< Collection of mutexes for individual access to input buffers
-      std::shared_ptr<std::mutex>
-        gimtx;                   ///< Mutex for access to all input buffers
+      wait_event ievent; ///< Event notified when an input queue is fed
       rhd2rtd_merger_ptr merger; ///< Merger of RHD records to RTD records
-      rtd_buffer obuffer;        ///< Buffer of output raw trigger data (RTD)
-      std::shared_ptr<std::mutex> omtx; ///< Mutex for access to output buffer
-      output_worker_ptr oworker;        ///< RTD output worker
+      std::shared_ptr<rtd_queue_type>
+        oqueue;                  ///< Queue of output raw trigger data (RTD)
+      output_worker_ptr oworker; ///< RTD output worker
+
+      // Metrics of the inputs (null if disabled):
+      std::vector<snfee::io::metrics_gauge*>
+        iqueue_fill_metrics; ///< Records in the input queues
+      std::vector<snfee::io::metrics_gauge*>
+        ibuffer_fill_metrics; ///< Records in the input buffers
 
       friend struct rhd_merger;
     };
@@ -922,6 +675,12 @@ namespace snfee {
         _logging_ = logging_;
         _force_complete_rtd_ = force_complete_rtd_;
         _run_id_ = run_id_;
+        _pimpl_.oqueue->set_producer_event(&_room_event_);
+        _records_metrics_ = make_records_metrics("merger");
+        _input_wait_metrics_ = make_wait_metrics("merger", "rhd");
+        _output_wait_metrics_ = make_wait_metrics("merger", "rtd");
+        _oqueue_fill_metrics_ =
+          make_fill_metrics(QUEUE_FILL_METRICS, "rtd");
         return;
       }
 
@@ -930,6 +689,8 @@ namespace snfee {
       stop()
       {
         _stop_request_ = true;
+        _pimpl_.ievent.notify();
+        _room_event_.notify();
         return;
       }
 
@@ -945,43 +706,52 @@ namespace snfee {
         return _rtd_records_counter_;
       };
 
-      int32_t
-      get_minimum_trigger_id_from_input_buffers() const
+      /// Transfer the records available from the input queues to the
+      /// input buffers, return true if any input buffer has changed
+      bool
+      fetch_input_records()
       {
-        int32_t mintrigid = snfee::data::INVALID_TRIGGER_ID;
-        bool cannot_determine = false;
+        bool fetched = false;
+        snfee::io::rhd_record rec;
         for (int i = 0; i < (int)_pimpl_.ibuffers.size(); i++) {
           auto& ibuf = _pimpl_.ibuffers[i];
-          {
-            std::lock_guard<std::mutex> lck(*_pimpl_.imtxs[i]);
-            // DT_LOG_DEBUG(_logging_, "Input buffer #" << i << " is locked by
-            // merger.");
-            if (!ibuf.is_finished()) {
-              // We consider only running buffers:
-              int32_t next_trig_id = ibuf.get_next_poppable_trig_id();
-              if (next_trig_id == snfee::data::INVALID_TRIGGER_ID) {
-                // No way to determine the next trigger ID to be collected:
-                cannot_determine = true;
-              }
-              if (!cannot_determine) {
-                if (ibuf.get_front_trig_id() !=
-                    snfee::data::INVALID_TRIGGER_ID) {
-                  if (mintrigid == snfee::data::INVALID_TRIGGER_ID or
-                      mintrigid > next_trig_id) {
-                    mintrigid = next_trig_id;
-                  }
-                }
-              }
-            }
-            // DT_LOG_DEBUG(_logging_, "Input buffer #" << i << " is unlocked by
-            // merger.");
+          if (ibuf.is_terminated()) {
+            continue;
           }
-          if (cannot_determine) {
-            mintrigid = snfee::data::INVALID_TRIGGER_ID;
-            break;
+          rhd_queue_type& iqueue = *_pimpl_.iqueues[i];
+          bool changed = false;
+          while (ibuf.can_push() and iqueue.try_pop(rec)) {
+            ibuf.insert_record(std::move(rec));
+            rec.reset();
+            changed = true;
+          }
+          if (iqueue.is_finished()) {
+            DT_LOG_DEBUG(_logging_, "Input queue #" << i << " is finished.");
+            ibuf.terminate();
+            changed = true;
+          }
+          if (changed) {
+            _update_input_state_(i);
+            fetched = true;
+            if (_pimpl_.iqueue_fill_metrics[i]) {
+              _pimpl_.iqueue_fill_metrics[i]->set(iqueue.size());
+              _pimpl_.ibuffer_fill_metrics[i]->set(ibuf.size());
+            }
           }
         }
-        return mintrigid;
+        return fetched;
+      }
+
+      /// Return the smallest trigger ID which can be safely collected from
+      /// the input buffers (invalid if at least one running buffer cannot
+      /// tell its next trigger ID yet)
+      int32_t
+      get_minimum_trigger_id_from_input_buffers() const
+      {
+        if (_nblocked_ > 0 or _ready_tree_.is_empty()) {
+          return snfee::data::INVALID_TRIGGER_ID;
+        }
+        return _ready_tree_.top_trig_id();
       };
 
       void
@@ -994,9 +764,11 @@ namespace snfee {
 
         std::size_t nin = _pimpl_.ibuffers.size();
         bool all_input_buffers_finished = false;
-        std::set<int> finished_buffers;
+        _init_input_states_();
         _rtd_records_counter_ = 0;
         while (!_stop_request_) {
+          const uint64_t ticket = _pimpl_.ievent.prepare_wait();
+          const bool fetched = fetch_input_records();
 
           // Extract the next trigger ID from the input buffers:
           int32_t fetchable_trig_id =
@@ -1039,23 +811,31 @@ namespace snfee {
             DT_LOG_DEBUG(_logging_,
                          "Current RTD record is completed with trigger ID = "
                            << rtd_rec.get_trigger_id());
-            {
-              std::lock_guard<std::mutex> olck(*_pimpl_.omtx);
-              DT_LOG_DEBUG(_logging_, "Output buffer is locked by merger.");
-              DT_THROW_IF(_force_complete_rtd_ and
-                            !rtd_rec.get_rtd().is_complete(),
-                          std::logic_error,
-                          "Incomplete RTD data!");
-              _pimpl_.obuffer.push_record(rtd_rec);
-              // We reset the working RTD record and trigger ID:
-              DT_LOG_DEBUG(_logging_, "Reset the working RTD record...");
-              rtd_rec.reset();
-              _rtd_records_counter_++;
+            DT_THROW_IF(_force_complete_rtd_ and
+                          !rtd_rec.get_rtd().is_complete(),
+                        std::logic_error,
+                        "Incomplete RTD data!");
+            while (true) {
+              const uint64_t room_ticket = _room_event_.prepare_wait();
+              if (_pimpl_.oqueue->try_push(rtd_rec)) {
+                break;
+              }
+              // The output queue is full:
+              snfee::io::metrics_timer wait_timer(_output_wait_metrics_);
+              _room_event_.wait(room_ticket);
             }
-            if (datatools::logger::is_debug(_logging_)) {
-              _pimpl_.obuffer.print(std::cerr);
+            if (_oqueue_fill_metrics_) {
+              _oqueue_fill_metrics_->set(_pimpl_.oqueue->size());
             }
-            DT_LOG_DEBUG(_logging_, "Output buffer is unlocked by merger.");
+            // We reset the working RTD record and trigger ID:
+            DT_LOG_DEBUG(_logging_, "Reset the working RTD record...");
+            rtd_rec.reset();
+            _rtd_records_counter_++;
+            if (_records_metrics_) {
+              _records_metrics_->add();
+            }
+            DT_LOG_DEBUG(_logging_,
+                         "Output queue size : " << _pimpl_.oqueue->size());
           }
 
           if (process_input_rhd) {
@@ -1069,88 +849,52 @@ namespace snfee {
               rtd_rec.make_record(_run_id_, fetchable_trig_id);
             }
 
-            DT_LOG_DEBUG(_logging_, "Loop on input buffers...");
-            // Scan all input buffers:
-            for (int i = 0; i < (int)_pimpl_.ibuffers.size(); i++) {
+            // Visit the input buffers in increasing order of their front
+            // trigger ID, as long as it matches the working trigger ID:
+            const int32_t rtd_trig_id = rtd_rec.get_trigger_id();
+            while (!_ready_tree_.is_empty() and
+                   _ready_tree_.top_trig_id() == rtd_trig_id) {
+              const std::size_t i = _ready_tree_.top_stream();
               DT_LOG_DEBUG(_logging_, "Inspect input buffer #" << i);
-              {
-                std::lock_guard<std::mutex> lck(*_pimpl_.imtxs[i]);
-                DT_LOG_DEBUG(_logging_,
-                             "Input buffer #" << i << " is locked by merger.");
-                auto& ibuf = _pimpl_.ibuffers[i];
-                if (datatools::logger::is_debug(_logging_)) {
-                  ibuf.print(std::cerr);
-                }
-                // Extract all RHD records matching the working trigger ID from
-                // the input buffer:
-                while (!ibuf.is_empty()) {
-                  if (ibuf.get_front_trig_id() != rtd_rec.get_trigger_id()) {
-                    break;
-                  }
-                  DT_LOG_DEBUG(_logging_,
-                               "Pop record from input buffer #" << i);
-                  const snfee::io::rhd_record& rec = ibuf.pop_record();
-                  if (datatools::logger::is_debug(_logging_)) {
-                    rec.print(std::cerr);
-                  }
-                  DT_LOG_DEBUG(_logging_,
-                               "Install the RHD record from input buffer #"
-                                 << i << " into the RTD record...");
-                  rtd_rec.install_rhd(rec);
-                  DT_LOG_DEBUG(
-                    _logging_,
-                    "RHD record has been inserted in the current RTD record!");
+              auto& ibuf = _pimpl_.ibuffers[i];
+              if (datatools::logger::is_debug(_logging_)) {
+                ibuf.print(std::cerr);
+              }
+              // Extract all RHD records matching the working trigger ID from
+              // the input buffer:
+              while (!ibuf.is_empty()) {
+                if (ibuf.get_front_trig_id() != rtd_trig_id) {
+                  break;
                 }
+                DT_LOG_DEBUG(_logging_, "Pop record from input buffer #" << i);
+                const snfee::io::rhd_record& rec = ibuf.pop_record();
                 if (datatools::logger::is_debug(_logging_)) {
-                  ibuf.print(std::cerr);
+                  rec.print(std::cerr);
                 }
                 DT_LOG_DEBUG(_logging_,
-                             "Input buffer #" << i
-                                              << " is unlocked by merger.");
+                             "Install the RHD record from input buffer #"
+                               << i << " into the RTD record...");
+                rtd_rec.install_rhd(rec);
+                DT_LOG_DEBUG(
+                  _logging_,
+                  "RHD record has been inserted in the current RTD record!");
+              }
+              // The front trigger ID of the buffer is now newer:
+              _update_input_state_(i);
+              if (_pimpl_.ibuffer_fill_metrics[i]) {
+                _pimpl_.ibuffer_fill_metrics[i]->set(ibuf.size());
               }
               if (datatools::logger::is_debug(_logging_)) {
+                ibuf.print(std::cerr);
                 rtd_rec.print(std::cerr);
               }
               DT_LOG_DEBUG(_logging_, "Done with input buffers #" << i);
-            } // end of scan for loop all input buffers:
+            } // end of k-way merge loop
           }   // process_input_rhd
 
-          if (!all_input_buffers_finished) {
-            // Count the number of finished input buffers:
-            std::size_t nfinished = 0;
-            // bool print_bufs = false;
-            for (int i = 0; i < (int)_pimpl_.ibuffers.size(); i++) {
-              std::lock_guard<std::mutex> lck(*_pimpl_.imtxs[i]);
-              DT_LOG_DEBUG(_logging_,
-                           "Input buffer #" << i << " is locked by merger.");
-              const auto& ibuf = _pimpl_.ibuffers[i];
-              if (ibuf.is_finished()) {
-                nfinished++;
-                if (!finished_buffers.count(i)) {
-                  finished_buffers.insert(i);
-                  // print_bufs = true;
-                  DT_LOG_NOTICE(_logging_,
-                                "Input buffer #" << i << " is finished.");
-                }
-              }
-              DT_LOG_DEBUG(_logging_,
-                           "Input buffer #" << i << " is unlocked by merger.");
-            }
-            // if (print_bufs and datatools::logger::is_debug(_logging_)) {
-            //   // Devel:
-            //   DT_LOG_DEBUG(_logging_, "# finished input buffers = " <<
-            //   nfinished << "/" << nin); DT_LOG_DEBUG(_logging_, "Status of
-            //   input buffers: "); for (int i = 0; i < _pimpl_.ibuffers.size();
-            //   i++) {
-            //     std::lock_guard<std::mutex> lck(*_pimpl_.imtxs[i]);
-            //     const auto & ibuf = _pimpl_.ibuffers[i];
-            //     ibuf.print(std::cerr);
-            //   }
-            // }
-            if (nfinished == nin) {
-              all_input_buffers_finished = true;
-              DT_LOG_NOTICE(_logging_, "All input buffers are finished.");
-            }
+          if (!all_input_buffers_finished and _nfinished_ == nin) {
+            all_input_buffers_finished = true;
+            DT_LOG_NOTICE(_logging_, "All input buffers are finished.");
           }
           if (all_input_buffers_finished and
               rtd_rec.get_trigger_id() == snfee::data::INVALID_TRIGGER_ID) {
@@ -1164,21 +908,75 @@ namespace snfee {
                           "Merger run : " << _rtd_records_counter_
                                           << " built RTD records");
           }
-          std::this_thread::yield();
+          if (!fetched and !process_input_rhd and !push_current_rtd and
+              !is_stopped()) {
+            // Sleep until an input worker feeds its queue:
+            snfee::io::metrics_timer wait_timer(_input_wait_metrics_);
+            _pimpl_.ievent.wait(ticket);
+          }
         } // main while loop
 
         rtd_rec.reset();
-        {
-          std::lock_guard<std::mutex> olck(*_pimpl_.omtx);
-          DT_LOG_DEBUG(_logging_, "Output buffer is terminated.");
-          _pimpl_.obuffer.terminate();
-        }
+        DT_LOG_DEBUG(_logging_, "Output queue is closed.");
+        _pimpl_.oqueue->close();
 
         DT_LOG_NOTICE(_logging_, "Merger run is stopped.");
         DT_LOG_TRACE_EXITING(_logging_);
         return;
       }
 
+    private:
+      /// Initialize the merging state of all input buffers
+      void
+      _init_input_states_()
+      {
+        const std::size_t nin = _pimpl_.ibuffers.size();
+        _ready_tree_.resize(nin);
+        _blocked_.assign(nin, false);
+        _nblocked_ = 0;
+        _finished_.assign(nin, false);
+        _nfinished_ = 0;
+        for (std::size_t i = 0; i < nin; i++) {
+          _update_input_state_(i);
+        }
+        return;
+      }
+
+      /// Update the merging state of an input buffer after its content or
+      /// its termination status has changed
+      void
+      _update_input_state_(const std::size_t i_)
+      {
+        const auto& ibuf = _pimpl_.ibuffers[i_];
+        bool blocked = false;
+        if (ibuf.is_finished()) {
+          _ready_tree_.remove(i_);
+          if (!_finished_[i_]) {
+            _finished_[i_] = true;
+            _nfinished_++;
+            DT_LOG_NOTICE(_logging_, "Input buffer #" << i_ << " is finished.");
+          }
+        } else {
+          const int32_t next_trig_id = ibuf.get_next_poppable_trig_id();
+          if (next_trig_id == snfee::data::INVALID_TRIGGER_ID) {
+            // No way to determine the next trigger ID to be collected:
+            _ready_tree_.remove(i_);
+            blocked = true;
+          } else {
+            _ready_tree_.update(i_, next_trig_id);
+          }
+        }
+        if (blocked != _blocked_[i_]) {
+          _blocked_[i_] = blocked;
+          if (blocked) {
+            _nblocked_++;
+          } else {
+            _nblocked_--;
+          }
+        }
+        return;
+      }
+
     private:
       // Configuration:
       int32_t _run_id_ = snfee::data::INVALID_RUN_ID;
@@ -1187,29 +985,233 @@ namespace snfee {
 
       // Working:
       builder::pimpl_type& _pimpl_;
-      bool _stop_request_ = false;           ///< Thread stop request
+      std::atomic<bool> _stop_request_{false}; ///< Thread stop request
       std::size_t _rtd_records_counter_ = 0; ///< Counter of built RTD records
+      wait_event _room_event_; ///< Event notified when the output queue is
+                               ///< popped
+
+      // Metrics (null if disabled):
+      snfee::io::metrics_counter* _records_metrics_ =
+        nullptr; ///< Built RTD records
+      snfee::io::metrics_histogram* _input_wait_metrics_ =
+        nullptr; ///< Waiting time for input records
+      snfee::io::metrics_histogram* _output_wait_metrics_ =
+        nullptr; ///< Waiting time for room in the output queue
+      snfee::io::metrics_gauge* _oqueue_fill_metrics_ =
+        nullptr; ///< Records in the output queue
+
+      // Merging state of the input buffers:
+      trigger_id_tree
+        _ready_tree_; ///< Running buffers keyed on their next trigger ID
+      std::vector<bool> _blocked_; ///< Flags of buffers waiting for records
+      std::size_t _nblocked_ = 0;  ///< Number of buffers waiting for records
+      std::vector<bool> _finished_; ///< Flags of finished buffers
+      std::size_t _nfinished_ = 0;  ///< Number of finished buffers
+    };
+
+    /// \brief RTD output encoder
+    ///
+    /// An encoder serializes and compresses its own share of the output
+    /// files in a dedicated thread. With N encoders, the encoder #e writes
+    /// the files #e, #e+N, #e+2N... Each file is fed by the output worker
+    /// with exactly the RTD records the sequential writer would have stored
+    /// in it, in the same order.
+    struct rtd_encoder {
+
+      /// Constructor
+      rtd_encoder(
+        const int id_,
+        const std::size_t nencoders_,
+        const snfee::rtdb::builder_config::output_config_type& oconfig_,
+        const datatools::logger::priority logging_ =
+          datatools::logger::PRIO_FATAL)
+        : _queue_(RTD_QUEUE_CAPACITY)
+      {
+        _logging_ = logging_;
+        _queue_.set_consumer_event(&_input_event_);
+        _id_ = id_;
+        _nencoders_ = nencoders_;
+        _filenames_ = oconfig_.filenames;
+        _max_records_per_file_ = oconfig_.max_records_per_file;
+        _with_trigger_index_ = oconfig_.with_trigger_index;
+        _metrics_label_ = oconfig_.label.empty() ? "rtd" : oconfig_.label;
+        const std::string stage = "encoder#" + std::to_string(_id_);
+        _records_metrics_ = make_records_metrics(stage);
+        _wait_metrics_ = make_wait_metrics(stage, stage);
+        _queue_fill_metrics_ =
+          make_fill_metrics(QUEUE_FILL_METRICS, stage);
+        return;
+      }
+
+      /// Return the queue of RTD records to be encoded
+      rtd_queue_type&
+      grab_queue()
+      {
+        return _queue_;
+      }
+
+      std::size_t
+      get_stored_records_counter() const
+      {
+        return _stored_records_counter_;
+      };
+
+      /// Run
+      void
+      run()
+      {
+        DT_LOG_TRACE_ENTERING(_logging_);
+        _file_index_ = _id_;
+        _records_in_file_ = 0;
+        _stored_records_counter_ = 0;
+        if (_id_ == 0) {
+          // The first file always exists, as with the sequential writer:
+          _open_file_();
+        }
+        snfee::io::rtd_record rec;
+        while (true) {
+          const uint64_t ticket = _input_event_.prepare_wait();
+          if (_queue_.try_pop(rec)) {
+            if (!_pwriter_) {
+              _open_file_();
+            } else if (_records_in_file_ == _max_records_per_file_) {
+              // Skip the files written by the other encoders:
+              _file_index_ += _nencoders_;
+              _open_file_();
+            }
+            if (_queue_fill_metrics_) {
+              _queue_fill_metrics_->set(_queue_.size());
+            }
+            _pwriter_->store(rec.get_rtd());
+            _records_in_file_++;
+            _stored_records_counter_++;
+            if (_records_metrics_) {
+              _records_metrics_->add();
+            }
+            rec.reset();
+          } else if (_queue_.is_finished()) {
+            break;
+          } else {
+            snfee::io::metrics_timer wait_timer(_wait_metrics_);
+            _input_event_.wait(ticket);
+          }
+        }
+        _pwriter_.reset();
+        DT_LOG_NOTICE(_logging_,
+                      "Encoder #" << _id_ << " run is stopped after "
+                                  << _stored_records_counter_
+                                  << " stored RTD records.");
+        DT_LOG_TRACE_EXITING(_logging_);
+        return;
+      }
+
+    private:
+      void
+      _open_file_()
+      {
+        // Close the current file first:
+        _pwriter_.reset();
+        DT_THROW_IF(_file_index_ >= _filenames_.size(),
+                    std::logic_error,
+                    "Encoder #" << _id_ << " has no more output file!");
+        DT_LOG_DEBUG(_logging_,
+                     "Encoder #" << _id_ << " opens output file #"
+                                 << _file_index_);
+        snfee::io::multifile_data_writer::config_type writer_config;
+        writer_config.filenames.push_back(_filenames_[_file_index_]);
+        writer_config.with_trigger_index = _with_trigger_index_;
+        writer_config.metrics_label = _metrics_label_;
+        _pwriter_.reset(
+          new snfee::io::multifile_data_writer(writer_config, _logging_));
+        _records_in_file_ = 0;
+        return;
+      }
+
+    private:
+      // Configuration:
+      int _id_ = -1;               ///< Encoder identifier
+      std::size_t _nencoders_ = 1; ///< Number of encoders
+      std::vector<std::string> _filenames_; ///< List of all output files
+      std::size_t _max_records_per_file_ =
+        0; ///< Maximum number of RTD records per output file
+      bool _with_trigger_index_ = false; ///< Trigger ID index flag
+      std::string _metrics_label_; ///< Label of the writers in the metrics
+      datatools::logger::priority _logging_ =
+        datatools::logger::PRIO_FATAL; ///< Logging priority
+
+      // Working:
+      wait_event _input_event_; ///< Event notified when the queue is fed
+      rtd_queue_type _queue_;   ///< Queue of RTD records to be encoded
+      std::unique_ptr<snfee::io::multifile_data_writer>
+        _pwriter_;                      ///< Writer of the current output file
+      std::size_t _file_index_ = 0;     ///< Index of the current output file
+      std::size_t _records_in_file_ = 0; ///< Records in the current file
+      std::size_t _stored_records_counter_ =
+        0; ///< Counter of stored RTD records
+
+      // Metrics (null if disabled):
+      snfee::io::metrics_counter* _records_metrics_ =
+        nullptr; ///< Stored RTD records
+      snfee::io::metrics_histogram* _wait_metrics_ =
+        nullptr; ///< Waiting time for input records
+      snfee::io::metrics_gauge* _queue_fill_metrics_ =
+        nullptr; ///< Records in the queue
     };
 
     /// \brief RTD output worker
+    ///
+    /// The RTD records popped from the merger are either stored by the
+    /// output worker itself, or, when several encoders are configured,
+    /// dispatched in order to the encoder in charge of their output file.
     struct output_worker {
 
       /// Constructor
       output_worker(
-        std::mutex& omtx_,
-        rtd_buffer& obuf_,
+        rtd_queue_type& oqueue_,
         const snfee::rtdb::builder_config::output_config_type& oconfig_,
         const datatools::logger::priority logging_ =
           datatools::logger::PRIO_FATAL)
-        : _mtx_(omtx_), _buf_(obuf_)
+        : _queue_(oqueue_)
       {
         _logging_ = logging_;
-        snfee::io::multifile_data_writer::config_type writer_config;
-        writer_config.filenames = oconfig_.filenames;
-        writer_config.max_records_per_file = oconfig_.max_records_per_file;
-        writer_config.max_total_records = oconfig_.max_total_records;
-        writer_config.terminate_on_overrun = oconfig_.terminate_on_overrun;
-        _pwriter_.reset(new snfee::io::multifile_data_writer(writer_config));
+        _queue_.set_consumer_event(&_input_event_);
+        std::size_t nencoders = oconfig_.number_of_encoders;
+        if (nencoders > 1 and oconfig_.max_records_per_file == 0) {
+          DT_LOG_WARNING(_logging_,
+                         "Parallel encoders need a maximum number of records "
+                         "per output file! Use a single encoder.");
+          nencoders = 1;
+        }
+        if (nencoders > oconfig_.filenames.size()) {
+          nencoders = oconfig_.filenames.size();
+        }
+        _records_metrics_ = make_records_metrics("output");
+        _input_wait_metrics_ = make_wait_metrics("output", "rtd");
+        _encoder_wait_metrics_ = make_wait_metrics("output", "encoder");
+        _queue_fill_metrics_ =
+          make_fill_metrics(QUEUE_FILL_METRICS, "rtd");
+        if (nencoders > 1) {
+          _filenames_ = oconfig_.filenames;
+          _max_records_per_file_ = oconfig_.max_records_per_file;
+          _max_total_records_ = oconfig_.max_total_records;
+          _terminate_on_overrun_ = oconfig_.terminate_on_overrun;
+          for (std::size_t ienc = 0; ienc < nencoders; ienc++) {
+            _encoders_.push_back(std::make_shared<rtd_encoder>(
+              ienc, nencoders, oconfig_, _logging_));
+            _encoders_.back()->grab_queue().set_producer_event(
+              &_encoder_room_event_);
+          }
+        } else {
+          snfee::io::multifile_data_writer::config_type writer_config;
+          writer_config.filenames = oconfig_.filenames;
+          writer_config.max_records_per_file = oconfig_.max_records_per_file;
+          writer_config.max_total_records = oconfig_.max_total_records;
+          writer_config.terminate_on_overrun = oconfig_.terminate_on_overrun;
+          writer_config.with_trigger_index = oconfig_.with_trigger_index;
+          writer_config.metrics_label =
+            oconfig_.label.empty() ? "rtd" : oconfig_.label;
+          _pwriter_.reset(new snfee::io::multifile_data_writer(writer_config));
+        }
         return;
       }
 
@@ -1227,6 +1229,7 @@ namespace snfee {
       stop()
       {
         _stop_request_ = true;
+        _input_event_.notify();
         return;
       }
 
@@ -1248,6 +1251,13 @@ namespace snfee {
         return _stored_records_counter_;
       };
 
+      /// Return the number of encoders
+      std::size_t
+      get_number_of_encoders() const
+      {
+        return _encoders_.size();
+      }
+
       /// Run
       void
       run()
@@ -1256,49 +1266,73 @@ namespace snfee {
         bool writer_is_terminated = false;
         _records_counter_ = 0;
         _stored_records_counter_ = 0;
+        std::vector<std::thread> ethreads;
+        for (auto& enc : _encoders_) {
+          ethreads.push_back(std::thread(&rtd_encoder::run, std::ref(*enc)));
+        }
+        snfee::io::rtd_record rec;
         while (!_stop_request_) {
-          {
-            std::lock_guard<std::mutex> lock(_mtx_);
-            while (!_buf_.is_empty()) {
-              DT_LOG_DEBUG(_logging_,
-                           "Pop RTD record from the output RTD buffer...");
-              _records_counter_++;
-              snfee::io::rtd_record rec = _buf_.pop_record();
-              if (!writer_is_terminated and _pwriter_->is_terminated()) {
-                writer_is_terminated = true;
-                DT_LOG_NOTICE(_logging_,
-                              "Output RTD writer is now terminated.");
-              }
-              if (!writer_is_terminated) {
-                DT_LOG_DEBUG(_logging_, "Store the RTD record.");
-                _pwriter_->store(rec.get_rtd());
-                _stored_records_counter_++;
-                DT_LOG_DEBUG(_logging_, "RTD record is stored.");
-              } else {
-                // Anticipated stop because writer is terminated:
-                DT_LOG_NOTICE(_logging_,
-                              "Output RTD writer: anticipated stop.");
-                stop();
-              }
+          const uint64_t ticket = _input_event_.prepare_wait();
+          bool popped = false;
+          while (!_stop_request_ and _queue_.try_pop(rec)) {
+            popped = true;
+            DT_LOG_DEBUG(_logging_,
+                         "Pop RTD record from the output RTD queue...");
+            _records_counter_++;
+            if (!writer_is_terminated and _writer_is_terminated_()) {
+              writer_is_terminated = true;
+              DT_LOG_NOTICE(_logging_, "Output RTD writer is now terminated.");
             }
-            if (_buf_.is_empty() && _buf_.is_terminated()) {
-              DT_LOG_DEBUG(_logging_, "Output RTD buffer is finished.");
-              if (datatools::logger::is_debug(_logging_)) {
-                _buf_.print(std::cerr);
+            if (!writer_is_terminated) {
+              DT_LOG_DEBUG(_logging_, "Store the RTD record.");
+              _store_(rec);
+              _stored_records_counter_++;
+              if (_records_metrics_) {
+                _records_metrics_->add();
               }
-              DT_LOG_DEBUG(_logging_, "Request the output worker to stop.");
+              DT_LOG_DEBUG(_logging_, "RTD record is stored.");
+            } else {
+              // Anticipated stop because writer is terminated:
+              DT_LOG_NOTICE(_logging_, "Output RTD writer: anticipated stop.");
               stop();
             }
+            rec.reset();
+          }
+          if (!_stop_request_ and _queue_.is_finished()) {
+            DT_LOG_DEBUG(_logging_, "Output RTD queue is finished.");
+            DT_LOG_DEBUG(_logging_, "Request the output worker to stop.");
+            stop();
           }
-          // DT_LOG_DEBUG(_logging_, "Processed records counter : " <<
-          // _records_counter_); DT_LOG_DEBUG(_logging_, "Stored records counter
-          // : " << _stored_records_counter_);
-          if (_records_counter_ % 100 == 0 or is_stopped()) {
+          if (popped and
+              (_records_counter_ % 100 == 0 or is_stopped())) {
             DT_LOG_NOTICE(_logging_,
                           "Output worker run : " << _records_counter_
                                                  << " saved RTD records");
           }
-          std::this_thread::yield();
+          if (popped and _queue_fill_metrics_) {
+            _queue_fill_metrics_->set(_queue_.size());
+          }
+          if (!popped and !is_stopped()) {
+            // Sleep until the merger feeds the queue:
+            snfee::io::metrics_timer wait_timer(_input_wait_metrics_);
+            _input_event_.wait(ticket);
+          }
+        }
+        // Discard the records still produced by the merger after an
+        // anticipated stop, so that it is never blocked on a full queue:
+        while (true) {
+          const uint64_t ticket = _input_event_.prepare_wait();
+          if (_queue_.try_pop(rec)) {
+            rec.reset();
+          } else if (_queue_.is_finished()) {
+            break;
+          } else {
+            _input_event_.wait(ticket);
+          }
+        }
+        for (std::size_t ienc = 0; ienc < _encoders_.size(); ienc++) {
+          _encoders_[ienc]->grab_queue().close();
+          ethreads[ienc].join();
         }
         DT_LOG_NOTICE(_logging_, "Output worker run is stopped.");
         DT_LOG_TRACE_EXITING(_logging_);
@@ -1306,29 +1340,109 @@ namespace snfee {
       }
 
     private:
-      std::mutex& _mtx_; ///< Mutex for access to the output RTD buffer
-      rtd_buffer& _buf_; ///< Handle to the output RTD buffer
+      /// Check if no more RTD record can be stored
+      bool
+      _writer_is_terminated_() const
+      {
+        if (_encoders_.empty()) {
+          return _pwriter_->is_terminated();
+        }
+        if (_max_total_records_ > 0 and
+            _stored_records_counter_ == _max_total_records_) {
+          return true;
+        }
+        const std::size_t file_index =
+          _stored_records_counter_ / _max_records_per_file_;
+        if (file_index >= _filenames_.size()) {
+          // Overrun:
+          DT_THROW_IF(!_terminate_on_overrun_,
+                      std::logic_error,
+                      "Overrunning multiple data writer has no more output "
+                      "file!");
+          return true;
+        }
+        return false;
+      }
+
+      /// Store a RTD record or hand it over to the encoder of its file
+      void
+      _store_(snfee::io::rtd_record& rec_)
+      {
+        if (_encoders_.empty()) {
+          _pwriter_->store(rec_.get_rtd());
+          return;
+        }
+        const std::size_t file_index =
+          _stored_records_counter_ / _max_records_per_file_;
+        rtd_queue_type& equeue =
+          _encoders_[file_index % _encoders_.size()]->grab_queue();
+        while (true) {
+          const uint64_t ticket = _encoder_room_event_.prepare_wait();
+          if (equeue.try_push(rec_)) {
+            break;
+          }
+          // The encoder is busy:
+          snfee::io::metrics_timer wait_timer(_encoder_wait_metrics_);
+          _encoder_room_event_.wait(ticket);
+        }
+        return;
+      }
+
+    private:
+      rtd_queue_type& _queue_; ///< Handle to the output RTD queue
       std::shared_ptr<snfee::io::multifile_data_writer>
-        _pwriter_;                 ///< Data writer
-      bool _stop_request_ = false; ///< Thread stop request
+        _pwriter_; ///< Data writer (sequential mode)
+      std::vector<std::shared_ptr<rtd_encoder>>
+        _encoders_; ///< Output encoders (parallel mode)
+      std::vector<std::string> _filenames_; ///< List of all output files
+      std::size_t _max_records_per_file_ =
+        0; ///< Maximum number of RTD records per output file
+      std::size_t _max_total_records_ = 0; ///< Maximum total number of records
+      bool _terminate_on_overrun_ = false; ///< Terminate on file overrun
+      std::atomic<bool> _stop_request_{false}; ///< Thread stop request
+      wait_event _input_event_; ///< Event notified when the queue is fed
+      wait_event
+        _encoder_room_event_; ///< Event notified when an encoder queue is
+                              ///< popped
       datatools::logger::priority _logging_ =
         datatools::logger::PRIO_FATAL;   ///< Logging priority
       std::size_t _records_counter_ = 0; ///< Counter of processed RTD records
       std::size_t _stored_records_counter_ =
         0; ///< Counter of stored RTD records
+
+      // Metrics (null if disabled):
+      snfee::io::metrics_counter* _records_metrics_ =
+        nullptr; ///< Stored RTD records
+      snfee::io::metrics_histogram* _input_wait_metrics_ =
+        nullptr; ///< Waiting time for input records
+      snfee::io::metrics_histogram* _encoder_wait_metrics_ =
+        nullptr; ///< Waiting time for room in the encoder queues
+      snfee::io::metrics_gauge* _queue_fill_metrics_ =
+        nullptr; ///< Records in the queue
     };
 
     void
     builder::_at_init_()
     {
+      std::lock_guard<std::mutex> lock(_pimpl_mutex_);
       _pimpl_.reset(new pimpl_type);
       pimpl_type& pimpl = *_pimpl_;
 
+      // Pools of records:
+      setup_record_pool<snfee::data::calo_hit_record>(
+        _config_.record_pool_capacity);
+      setup_record_pool<snfee::data::tracker_hit_record>(
+        _config_.record_pool_capacity);
+      setup_record_pool<snfee::data::trigger_record>(
+        _config_.record_pool_capacity);
+      setup_record_pool<snfee::data::raw_trigger_data>(
+        _config_.record_pool_capacity);
+
       // Ouput manager:
       DT_LOG_NOTICE(_logging_, "Instantiating the output worker...");
-      pimpl.omtx = std::make_shared<std::mutex>();
+      pimpl.oqueue = std::make_shared<rtd_queue_type>(RTD_QUEUE_CAPACITY);
       pimpl.oworker = std::make_shared<output_worker>(
-        *pimpl.omtx.get(), pimpl.obuffer, _config_.output_config, _logging_);
+        *pimpl.oqueue, _config_.output_config, _logging_);
 
       // Merger:
       DT_LOG_NOTICE(_logging_, "Instantiating the merger...");
@@ -1337,13 +1451,8 @@ namespace snfee {
 
       // Input managers:
       {
-        pimpl.gimtx = std::make_shared<std::mutex>();
         int icount = 0;
         for (const auto& iconfig : _config_.input_configs) {
-          DT_LOG_NOTICE(_logging_,
-                        "Instantiating the input buffer mutex #" << icount
-                                                                 << "...");
-          pimpl.imtxs.push_back(std::make_shared<std::mutex>());
           DT_LOG_NOTICE(
             _logging_,
             "Instantiating the input buffer #"
@@ -1364,6 +1473,16 @@ namespace snfee {
           }
           rhd_buffer buf(icount, capacity, min_popping_trig_ids);
           pimpl.ibuffers.push_back(buf);
+          DT_LOG_NOTICE(_logging_,
+                        "Instantiating the input queue #" << icount << "...");
+          pimpl.iqueues.push_back(std::make_shared<rhd_queue_type>(
+            capacity > 0 ? capacity : DEFAULT_RHD_QUEUE_CAPACITY));
+          pimpl.iqueues.back()->set_consumer_event(&pimpl.ievent);
+          const std::string label = input_metrics_label(icount, iconfig);
+          pimpl.iqueue_fill_metrics.push_back(
+            make_fill_metrics(QUEUE_FILL_METRICS, "rhd:" + label));
+          pimpl.ibuffer_fill_metrics.push_back(
+            make_fill_metrics(BUFFER_FILL_METRICS, "rhd:" + label));
           icount++;
         }
       }
@@ -1383,11 +1502,13 @@ namespace snfee {
         for (const auto& iconfig : _config_.input_configs) {
           DT_LOG_NOTICE(_logging_,
                         "Instantiating the input worker #" << icount << "...");
-          auto iwrk = std::make_shared<input_worker>(icount,
-                                                     *pimpl.imtxs[icount].get(),
-                                                     pimpl.ibuffers[icount],
-                                                     iconfig,
-                                                     _logging_);
+          auto iwrk =
+            std::make_shared<input_worker>(icount,
+                                           *pimpl.iqueues[icount],
+                                           iconfig,
+                                           _config_.input_prefetch_depth,
+                                           _config_.input_sort_memory_size,
+                                           _logging_);
           DT_LOG_DEBUG(_logging_, "iwrk = [@" << iwrk.get() << "]");
           pimpl.iworkers.emplace_back(iwrk);
           DT_LOG_DEBUG(_logging_,
@@ -1401,12 +1522,34 @@ namespace snfee {
         }
       }
 
+      if (_stop_request_) {
+        // The builder was stopped before its workers were instantiated:
+        _stop_workers_();
+      }
+
+      return;
+    }
+
+    void
+    builder::_stop_workers_()
+    {
+      pimpl_type& pimpl = *_pimpl_;
+      for (auto& iwkr : pimpl.iworkers) {
+        iwkr->stop();
+      }
+      if (pimpl.merger) {
+        pimpl.merger->stop();
+      }
+      if (pimpl.oworker) {
+        pimpl.oworker->stop();
+      }
       return;
     }
 
     void
     builder::_at_terminate_()
     {
+      std::lock_guard<std::mutex> lock(_pimpl_mutex_);
       if (_pimpl_) {
         pimpl_type& pimpl = *_pimpl_;
 
@@ -1418,6 +1561,49 @@ namespace snfee {
           pimpl.oworker->get_stored_records_counter();
         _results_.push_back(owResults);
 
+        // Statistics of the queues:
+        for (std::size_t iq = 0; iq < pimpl.iqueues.size(); iq++) {
+          const rhd_queue_type::statistics_type stats =
+            pimpl.iqueues[iq]->get_statistics();
+          queue_results_type iqResults;
+          iqResults.category = WORKER_INPUT_RHD;
+          iqResults.crate_model = _config_.input_configs[iq].crate_model;
+          iqResults.capacity = stats.capacity;
+          iqResults.pushed = stats.pushed;
+          iqResults.popped = stats.popped;
+          iqResults.max_occupancy = stats.max_occupancy;
+          iqResults.mean_occupancy = stats.mean_occupancy;
+          iqResults.full_stalls = stats.full_stalls;
+          iqResults.empty_stalls = stats.empty_stalls;
+          _queue_results_.push_back(iqResults);
+        }
+        {
+          const rtd_queue_type::statistics_type stats =
+            pimpl.oqueue->get_statistics();
+          queue_results_type oqResults;
+          oqResults.category = WORKER_OUTPUT_RTD;
+          oqResults.capacity = stats.capacity;
+          oqResults.pushed = stats.pushed;
+          oqResults.popped = stats.popped;
+          oqResults.max_occupancy = stats.max_occupancy;
+          oqResults.mean_occupancy = stats.mean_occupancy;
+          oqResults.full_stalls = stats.full_stalls;
+          oqResults.empty_stalls = stats.empty_stalls;
+          _queue_results_.push_back(oqResults);
+        }
+
+        // Statistics of the pools of records:
+        _pool_results_.push_back(
+          record_pool_results<snfee::data::calo_hit_record>("calo_hit_record"));
+        _pool_results_.push_back(
+          record_pool_results<snfee::data::tracker_hit_record>(
+            "tracker_hit_record"));
+        _pool_results_.push_back(
+          record_pool_results<snfee::data::trigger_record>("trigger_record"));
+        _pool_results_.push_back(
+          record_pool_results<snfee::data::raw_trigger_data>(
+            "raw_trigger_data"));
+
         std::size_t icount = 0;
         if (pimpl.iworkers.size()) {
           for (auto& iwkr : pimpl.iworkers) {
@@ -1458,6 +1644,8 @@ namespace snfee {
     {
       DT_LOG_TRACE_ENTERING(_logging_);
       pimpl_type& pimpl = *_pimpl_;
+      const auto wall_start = std::chrono::steady_clock::now();
+      const std::clock_t cpu_start = std::clock();
 
       // Input worker threads:
       std::vector<std::thread> ithreads;
@@ -1487,6 +1675,16 @@ namespace snfee {
       mthread.join();
       othread.join();
 
+      // Resource usage:
+      const std::chrono::duration<double> wall_time =
+        std::chrono::steady_clock::now() - wall_start;
+      _timing_results_.wall_time = wall_time.count();
+      _timing_results_.cpu_time =
+        double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+      DT_LOG_NOTICE(_logging_,
+                    "Run took " << _timing_results_.wall_time << " s (CPU : "
+                                << _timing_results_.cpu_time << " s)");
+
       DT_LOG_TRACE_EXITING(_logging_);
       return;
     }
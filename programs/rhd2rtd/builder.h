@@ -23,7 +23,9 @@
 #define SNFEE_RTDB_BUILDER_H
 
 // Standard Library:
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -78,7 +80,7 @@ namespace snfee {
       /// Check is the builder is stopped
       bool is_stopped() const;
 
-      /// Stop request
+      /// Stop request, forwarded to the input, merge and output workers
       void stop();
 
       /// Smart print
@@ -114,6 +116,42 @@ namespace snfee {
       /// Return the results of the run
       const std::vector<worker_results_type>& get_results() const;
 
+      /// \brief Usage statistics of a queue between two stages
+      struct queue_results_type {
+        worker_category_type category =
+          WORKER_UNDEF; ///< Category of the worker at the end of the queue
+        snfee::model::crate_model_type crate_model = snfee::model::CRATE_UNDEF;
+        std::size_t capacity = 0;      ///< Maximum number of stored records
+        std::size_t pushed = 0;        ///< Number of pushed records
+        std::size_t popped = 0;        ///< Number of popped records
+        std::size_t max_occupancy = 0; ///< Maximum number of stored records
+        double mean_occupancy = 0.0;   ///< Mean number of stored records
+        std::size_t full_stalls = 0;   ///< Number of producer stalls
+        std::size_t empty_stalls = 0;  ///< Number of consumer stalls
+      };
+
+      const std::vector<queue_results_type>& get_queue_results() const;
+
+      /// \brief Allocation statistics of a pool of records
+      struct pool_results_type {
+        std::string record_type;            ///< Type of the pooled records
+        std::size_t object_allocations = 0; ///< Records allocated on the heap
+        std::size_t object_reuses = 0;      ///< Recycled records
+        std::size_t block_allocations = 0;  ///< Shared pointer control blocks
+                                            ///< allocated on the heap
+        std::size_t block_reuses = 0;       ///< Recycled control blocks
+      };
+
+      const std::vector<pool_results_type>& get_pool_results() const;
+
+      /// \brief Resource usage of the last run
+      struct timing_results_type {
+        double wall_time = 0.0; ///< Elapsed time (s)
+        double cpu_time = 0.0;  ///< CPU time used by all threads (s)
+      };
+
+      const timing_results_type& get_timing_results() const;
+
     private:
       void _at_run_();
 
@@ -121,6 +159,8 @@ namespace snfee {
 
       void _at_terminate_();
 
+      void _stop_workers_();
+
     public:
       struct pimpl_type; ///!< Private implementation type
 
@@ -128,15 +168,19 @@ namespace snfee {
       // Management
       bool _initialized_ = false;
       datatools::logger::priority _logging_ = datatools::logger::PRIO_FATAL;
-      bool _stop_request_ = false;
+      std::atomic<bool> _stop_request_{false};
 
       // Configuration
       builder_config _config_;
 
       // Results:
       std::vector<worker_results_type> _results_;
+      std::vector<queue_results_type> _queue_results_;
+      std::vector<pool_results_type> _pool_results_;
+      timing_results_type _timing_results_;
 
       // Working data:
+      std::mutex _pimpl_mutex_; ///< Guard of the private implementation
       std::unique_ptr<pimpl_type> _pimpl_;
     };
 
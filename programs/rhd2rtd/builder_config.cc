@@ -220,6 +220,13 @@ namespace snfee {
            << "Terminate/overrun : " << std::boolalpha
            << output_config.terminate_on_overrun << std::endl;
 
+      outs << popts.indent << skip_tag << tag
+           << "Encoders : " << output_config.number_of_encoders << std::endl;
+
+      outs << popts.indent << skip_tag << tag
+           << "Trigger index : " << std::boolalpha
+           << output_config.with_trigger_index << std::endl;
+
       outs << popts.indent << skip_tag << last_tag << "Format : '"
            << format_label(output_config.format) << "'" << std::endl;
 
@@ -231,6 +238,16 @@ namespace snfee {
            << "Tracker RHD buffer capacity : " << tracker_rhd_buffer_capacity
            << std::endl;
 
+      outs << popts.indent << skip_tag << last_tag
+           << "Input prefetch depth : " << input_prefetch_depth << std::endl;
+
+      outs << popts.indent << skip_tag << last_tag
+           << "Input sort memory size : " << input_sort_memory_size
+           << std::endl;
+
+      outs << popts.indent << skip_tag << last_tag
+           << "Record pool capacity : " << record_pool_capacity << std::endl;
+
       outs << popts.indent << inherit_tag(popts.inherit)
            << "Force complete RTD : " << std::boolalpha << force_complete_rtd
            << std::endl;
@@ -382,6 +399,18 @@ namespace snfee {
             ocfg.terminate_on_overrun = rtdb_config.fetch_boolean(key);
           }
         }
+        {
+          std::string key = "rtd.output.number_of_encoders";
+          if (rtdb_config.has_key(key)) {
+            ocfg.number_of_encoders = rtdb_config.fetch_positive_integer(key);
+          }
+        }
+        {
+          std::string key = "rtd.output.with_trigger_index";
+          if (rtdb_config.has_key(key)) {
+            ocfg.with_trigger_index = rtdb_config.fetch_boolean(key);
+          }
+        }
         cfg_.output_config = ocfg;
       }
 
@@ -397,6 +426,25 @@ namespace snfee {
           rtdb_config.fetch_positive_integer("tracker_rhd_buffer_capacity");
       }
 
+      // Read-ahead of the input readers:
+      if (rtdb_config.has_key("input_prefetch_depth")) {
+        cfg_.input_prefetch_depth =
+          rtdb_config.fetch_positive_integer("input_prefetch_depth");
+      }
+
+      // Recycling of the records:
+      if (rtdb_config.has_key("record_pool_capacity")) {
+        cfg_.record_pool_capacity =
+          rtdb_config.fetch_positive_integer("record_pool_capacity");
+      }
+
+      // External sort of the inputs:
+      if (rtdb_config.has_key("input_sort_memory_size_mb")) {
+        cfg_.input_sort_memory_size =
+          rtdb_config.fetch_positive_integer("input_sort_memory_size_mb") *
+          std::size_t(1048576);
+      }
+
       return;
     }
 
@@ -546,6 +594,22 @@ namespace snfee {
            "rtd.output.max_total_records : integer = 3000000                   "
            "    \n"
            "                                                                   "
+           "    \n"
+           "#@description Number of threads encoding the output files in      "
+           "    \n"
+           "#             parallel (optional, needs max_records_per_file)      "
+           "    \n"
+           "rtd.output.number_of_encoders : integer = 1                        "
+           "    \n"
+           "                                                                   "
+           "    \n"
+           "#@description Save a trigger ID index next to each output file     "
+           "    \n"
+           "#             (optional)                                           "
+           "    \n"
+           "rtd.output.with_trigger_index : boolean = false                    "
+           "    \n"
+           "                                                                   "
            "    \n";
       out_ << "###########################################################\n";
       out_ << "#@description Capacity of the buffer for calo RHD records "
@@ -559,6 +623,25 @@ namespace snfee {
               "(optional)\n"
               "tracker_rhd_buffer_capacity : integer = "
            << DEFAULT_TRACKER_RHD_BUFFER_CAPACITY
+           << "\n"
+              "                                                                "
+              "       \n"
+              "#@description Number of RHD records decoded ahead by each input "
+              "reader (optional)\n"
+              "input_prefetch_depth : integer = 0                              "
+              "       \n"
+              "                                                                "
+              "       \n"
+              "#@description Memory cap (MB) of the external sort of each "
+              "input (optional)\n"
+              "input_sort_memory_size_mb : integer = 256                       "
+              "       \n"
+              "                                                                "
+              "       \n"
+              "#@description Number of free records kept for recycling per "
+              "record type (optional)\n"
+              "record_pool_capacity : integer = "
+           << DEFAULT_RECORD_POOL_CAPACITY
            << "\n"
               "                                                                "
               "       \n";
@@ -691,6 +774,18 @@ namespace snfee {
               "          \n"
               "                                                                "
               "          \n"
+              "   #@description Number of threads encoding the output files "
+              "(optional)\n"
+              "   rtd.output.number_of_encoders : integer = 1                  "
+              "          \n"
+              "                                                                "
+              "          \n"
+              "   #@description Save a trigger ID index next to each output "
+              "file (optional)\n"
+              "   rtd.output.with_trigger_index : boolean = false              "
+              "          \n"
+              "                                                                "
+              "          \n"
               "   #@description Capacity of the buffer for calo RHD records "
               "(optional)   \n"
               "   calo_rhd_buffer_capacity    : integer = 100                  "
@@ -40,6 +40,7 @@ namespace snfee {
     public:
       static const uint32_t DEFAULT_CALO_RHD_BUFFER_CAPACITY = 100;
       static const uint32_t DEFAULT_TRACKER_RHD_BUFFER_CAPACITY = 500;
+      static const std::size_t DEFAULT_RECORD_POOL_CAPACITY = 4096;
 
       /// \brief Input format
       enum format_type { FORMAT_UNDEF = 0, FORMAT_BOOST_SERIAL = 1 };
@@ -71,6 +72,10 @@ namespace snfee {
         bool terminate_on_overrun =
           false; ///< Flag to silently terminate the overrunning writer (dont'
                  ///< throw if set, unused)
+        std::size_t number_of_encoders =
+          1; ///< Number of threads encoding output files in parallel
+        bool with_trigger_index =
+          false; ///< Save a trigger ID index next to each output file
         format_type format; ///< Format description (unused)
       };
 
@@ -170,6 +175,15 @@ namespace snfee {
                                              ///< tracker hits
       bool accept_unsorted_records = false;
       std::size_t unsorted_records_min_popping_safety_depth = 3;
+      std::size_t input_prefetch_depth =
+        0; ///< Number of RHD records decoded ahead by each input reader
+      std::size_t record_pool_capacity =
+        DEFAULT_RECORD_POOL_CAPACITY; ///< Maximum number of free records kept
+                                      ///< for recycling, per record type (0:
+                                      ///< no recycling)
+      std::size_t input_sort_memory_size =
+        0; ///< Memory cap (bytes) of the external sort of each input (0: no
+           ///< sort, the input RHD records are expected to be sorted)
     };
 
   } // namespace rtdb
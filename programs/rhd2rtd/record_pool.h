@@ -0,0 +1,320 @@
+//! \file programs/rhd2rtd/record_pool.h
+//! \brief Recycling pool of records handled through shared pointers
+
+#ifndef SNFEE_IO_RECORD_POOL_H
+#define SNFEE_IO_RECORD_POOL_H
+
+// Standard Library:
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/utility.hpp>
+
+namespace snfee {
+  namespace io {
+
+    /// \brief Allocation statistics of a record pool
+    struct record_pool_statistics {
+      std::size_t object_allocations = 0; ///< Objects allocated on the heap
+      std::size_t object_reuses = 0;      ///< Objects recycled from the pool
+      std::size_t block_allocations = 0;  ///< Control blocks allocated on the
+                                          ///< heap
+      std::size_t block_reuses = 0; ///< Control blocks recycled from the pool
+    };
+
+    /// \brief Thread-safe recycling pool of records of type T
+    ///
+    /// Records are handed out as shared pointers. When the last shared
+    /// pointer to a record is released (possibly from another thread), the
+    /// record is invalidated (T::invalidate()) and kept for a next use
+    /// instead of being destroyed. A recycled record keeps the capacity of
+    /// its containers (ex: the waveform samples of a calo hit), so that
+    /// loading a new record in it does not allocate. The control blocks of
+    /// the shared pointers are recycled the same way through the allocator
+    /// given to the shared pointers.
+    ///
+    /// The pool keeps at most a given number of free records (0: no
+    /// pooling, records are then allocated with std::make_shared). The
+    /// allocation statistics are collected in both cases.
+    ///
+    /// Usage:
+    /// \code
+    /// auto& pool =
+    ///   snfee::io::record_pool<snfee::data::calo_hit_record>::instance();
+    /// std::shared_ptr<snfee::data::calo_hit_record> hit = pool.make();
+    /// \endcode
+    template <typename T>
+    class record_pool : private boost::noncopyable {
+    public:
+      /// Default maximum number of free records kept by the pool
+      static const std::size_t DEFAULT_CAPACITY = 4096;
+
+      /// Constructor
+      explicit record_pool(const std::size_t capacity_ = DEFAULT_CAPACITY)
+        : _state_(std::make_shared<state_type>())
+      {
+        _state_->capacity = capacity_;
+        return;
+      }
+
+      /// Return the pool shared by all users of records of type T
+      static record_pool&
+      instance()
+      {
+        static record_pool pool;
+        return pool;
+      }
+
+      /// Return the maximum number of free records kept by the pool
+      std::size_t
+      get_capacity() const
+      {
+        return _state_->capacity;
+      }
+
+      /// Set the maximum number of free records kept by the pool (0: no
+      /// pooling)
+      void
+      set_capacity(const std::size_t capacity_)
+      {
+        _state_->capacity = capacity_;
+        _state_->shrink();
+        return;
+      }
+
+      /// Return the number of free records kept by the pool
+      std::size_t
+      size() const
+      {
+        std::lock_guard<std::mutex> lock(_state_->mutex);
+        return _state_->objects.size();
+      }
+
+      /// Return an invalid record
+      std::shared_ptr<T>
+      make()
+      {
+        if (_state_->capacity == 0) {
+          // Single allocation of the record and its control block:
+          _state_->object_allocations++;
+          return std::make_shared<T>();
+        }
+        T* obj = _state_->pop_object();
+        if (obj == nullptr) {
+          _state_->object_allocations++;
+          obj = new T;
+        } else {
+          _state_->object_reuses++;
+        }
+        // On failure, the shared pointer constructor recycles the record:
+        return std::shared_ptr<T>(
+          obj, recycler_type{_state_}, block_allocator<T>(_state_));
+      }
+
+      /// Return the allocation statistics
+      record_pool_statistics
+      get_statistics() const
+      {
+        record_pool_statistics stats;
+        stats.object_allocations = _state_->object_allocations;
+        stats.object_reuses = _state_->object_reuses;
+        stats.block_allocations = _state_->block_allocations;
+        stats.block_reuses = _state_->block_reuses;
+        return stats;
+      }
+
+      /// Reset the allocation statistics
+      void
+      reset_statistics()
+      {
+        _state_->object_allocations = 0;
+        _state_->object_reuses = 0;
+        _state_->block_allocations = 0;
+        _state_->block_reuses = 0;
+        return;
+      }
+
+    private:
+      /// \brief Free lists shared by the pool, the deleters and the
+      ///        allocators of the records (so that records may outlive the
+      ///        pool)
+      struct state_type {
+        ~state_type()
+        {
+          for (T* obj : objects) {
+            delete obj;
+          }
+          for (void* block : blocks) {
+            ::operator delete(block);
+          }
+          return;
+        }
+
+        T*
+        pop_object()
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (objects.empty()) {
+            return nullptr;
+          }
+          T* obj = objects.back();
+          objects.pop_back();
+          return obj;
+        }
+
+        void
+        push_object(T* obj_)
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (objects.size() < capacity) {
+              objects.push_back(obj_);
+              return;
+            }
+          }
+          delete obj_;
+          return;
+        }
+
+        void*
+        allocate_block(const std::size_t size_)
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (size_ == block_size and !blocks.empty()) {
+              void* block = blocks.back();
+              blocks.pop_back();
+              block_reuses++;
+              return block;
+            }
+            if (block_size == 0) {
+              block_size = size_;
+            }
+          }
+          block_allocations++;
+          return ::operator new(size_);
+        }
+
+        void
+        deallocate_block(void* block_, const std::size_t size_)
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (size_ == block_size and blocks.size() < capacity) {
+              blocks.push_back(block_);
+              return;
+            }
+          }
+          ::operator delete(block_);
+          return;
+        }
+
+        void
+        shrink()
+        {
+          std::vector<T*> extra_objects;
+          std::vector<void*> extra_blocks;
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (objects.size() > capacity) {
+              extra_objects.push_back(objects.back());
+              objects.pop_back();
+            }
+            while (blocks.size() > capacity) {
+              extra_blocks.push_back(blocks.back());
+              blocks.pop_back();
+            }
+          }
+          for (T* obj : extra_objects) {
+            delete obj;
+          }
+          for (void* block : extra_blocks) {
+            ::operator delete(block);
+          }
+          return;
+        }
+
+        std::atomic<std::size_t> capacity{0};
+        mutable std::mutex mutex;
+        std::vector<T*> objects;    ///< Free records
+        std::vector<void*> blocks;  ///< Free control blocks
+        std::size_t block_size = 0; ///< Size of the control blocks
+        std::atomic<std::size_t> object_allocations{0};
+        std::atomic<std::size_t> object_reuses{0};
+        std::atomic<std::size_t> block_allocations{0};
+        std::atomic<std::size_t> block_reuses{0};
+      };
+
+      /// \brief Deleter of the shared pointers: recycles the record
+      struct recycler_type {
+        void
+        operator()(T* obj_) const
+        {
+          obj_->invalidate();
+          state->push_object(obj_);
+          return;
+        }
+
+        std::shared_ptr<state_type> state;
+      };
+
+      /// \brief Allocator of the shared pointer control blocks
+      template <typename U>
+      struct block_allocator {
+        typedef U value_type;
+
+        explicit block_allocator(const std::shared_ptr<state_type>& state_)
+          : state(state_)
+        {
+          return;
+        }
+
+        template <typename V>
+        block_allocator(const block_allocator<V>& other_) : state(other_.state)
+        {
+          return;
+        }
+
+        U*
+        allocate(const std::size_t n_)
+        {
+          return static_cast<U*>(state->allocate_block(n_ * sizeof(U)));
+        }
+
+        void
+        deallocate(U* p_, const std::size_t n_)
+        {
+          state->deallocate_block(p_, n_ * sizeof(U));
+          return;
+        }
+
+        template <typename V>
+        bool
+        operator==(const block_allocator<V>& other_) const
+        {
+          return state == other_.state;
+        }
+
+        template <typename V>
+        bool
+        operator!=(const block_allocator<V>& other_) const
+        {
+          return state != other_.state;
+        }
+
+        std::shared_ptr<state_type> state;
+      };
+
+      std::shared_ptr<state_type> _state_; ///< Shared state
+    };
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_RECORD_POOL_H
@@ -16,6 +16,7 @@
 
 // This project:
 #include "builder.h"
+#include <snfee/io/metrics.h>
 #include <snfee/utils.h>
 
 struct app_params_type {
@@ -25,12 +26,18 @@ struct app_params_type {
   int32_t run_id = snfee::data::INVALID_RUN_ID;
   bool force_complete_rtd = false;
   std::size_t max_total_records = 0;
+  std::size_t number_of_encoders = 0;
+  bool with_trigger_index = false;
   uint32_t calo_rhd_buffer_capacity = 0;
   uint32_t tracker_rhd_buffer_capacity = 0;
+  std::size_t input_prefetch_depth = 0;
+  std::size_t input_sort_memory = 0;
+  std::size_t record_pool_capacity = 0;
   bool accept_unsorted_rhd = false;
   std::size_t unsorted_records_min_popping_safety_depth = 3;
   uint32_t skel_run_id = 100;
   uint32_t skel_nb_crates = 2;
+  snfee::io::metrics_dumper::config_type metrics_config;
 };
 
 int
@@ -91,6 +98,17 @@ main(int argc_, char** argv_)
        ->value_name("number"),
        "set the maximum number of RTD records to be generated (expert)")
 
+      ("output-encoders,E",
+       po::value<std::size_t>(&app_params.number_of_encoders)
+       ->value_name("number"),
+       "set the number of threads encoding the output RTD files in parallel (expert)")
+
+      ("output-trigger-index",
+       po::value<bool>(&app_params.with_trigger_index)
+       ->zero_tokens()
+       ->default_value(false),
+       "save a trigger ID index next to each output RTD file")
+
       ("calo-rhd-buffer-capacity",
        po::value<uint32_t>(&app_params.calo_rhd_buffer_capacity)
        ->value_name("number"),
@@ -101,6 +119,21 @@ main(int argc_, char** argv_)
        ->value_name("number"),
        "set the capacity of tracker RHD input buffers (expert)")
 
+      ("input-prefetch-depth",
+       po::value<std::size_t>(&app_params.input_prefetch_depth)
+       ->value_name("number"),
+       "set the number of RHD records decoded ahead by each input reader (expert)")
+
+      ("input-sort-memory",
+       po::value<std::size_t>(&app_params.input_sort_memory)
+       ->value_name("MB"),
+       "sort each RHD input with an external merge sort bounded to the given memory (expert)")
+
+      ("record-pool-capacity",
+       po::value<std::size_t>(&app_params.record_pool_capacity)
+       ->value_name("number"),
+       "set the number of free records kept for recycling per record type (0: no recycling, expert)")
+
       ("accept-unsorted-rhd,U",
        po::value<bool>(&app_params.accept_unsorted_rhd)
        ->zero_tokens()
@@ -109,7 +142,7 @@ main(int argc_, char** argv_)
 
     ; // end of options description
     // clang-format on
-    //
+    snfee::io::metrics_dumper::config_type::add_options(opts);
     // Describe command line arguments :
     po::variables_map vm;
     po::store(po::command_line_parser(argc_, argv_).options(opts).run(), vm);
@@ -178,6 +211,9 @@ main(int argc_, char** argv_)
                     << vm["logging"].as<std::string>() << "'!");
     }
 
+    // Run time metrics:
+    app_params.metrics_config.configure(vm);
+
     // Checks:
     DT_THROW_IF(app_params.config_filename.empty(),
                 std::logic_error,
@@ -219,6 +255,15 @@ main(int argc_, char** argv_)
         app_params.max_total_records;
     }
 
+    if (app_params.number_of_encoders != 0) {
+      rtdBuilderCfg.output_config.number_of_encoders =
+        app_params.number_of_encoders;
+    }
+
+    if (app_params.with_trigger_index) {
+      rtdBuilderCfg.output_config.with_trigger_index = true;
+    }
+
     if (app_params.calo_rhd_buffer_capacity != 0) {
       if (rtdBuilderCfg.calo_rhd_buffer_capacity != 0) {
         DT_LOG_WARNING(app_params.logging,
@@ -247,6 +292,19 @@ main(int argc_, char** argv_)
         app_params.tracker_rhd_buffer_capacity;
     }
 
+    if (app_params.input_prefetch_depth != 0) {
+      rtdBuilderCfg.input_prefetch_depth = app_params.input_prefetch_depth;
+    }
+
+    if (vm.count("record-pool-capacity")) {
+      rtdBuilderCfg.record_pool_capacity = app_params.record_pool_capacity;
+    }
+
+    if (app_params.input_sort_memory != 0) {
+      rtdBuilderCfg.input_sort_memory_size =
+        app_params.input_sort_memory * std::size_t(1048576);
+    }
+
     // Check the configuration:
     snfee::rtdb::builder_config::check(rtdBuilderCfg);
     {
@@ -256,6 +314,15 @@ main(int argc_, char** argv_)
       rtdBuilderCfg.print_tree(std::clog, options);
     }
 
+    // Run time metrics (enabled before building the pipeline):
+    std::unique_ptr<snfee::io::metrics_dumper> metricsDumper;
+    if (!app_params.metrics_config.filename.empty()) {
+      snfee::io::metrics_registry::global().set_enabled(true);
+      metricsDumper.reset(
+        new snfee::io::metrics_dumper(app_params.metrics_config));
+      metricsDumper->start();
+    }
+
     // The RTD builder:
     snfee::rtdb::builder rtdBuilder;
     rtdBuilder.set_logging(app_params.logging);
@@ -271,6 +338,9 @@ main(int argc_, char** argv_)
     rtdBuilder.initialize();
     rtdBuilder.run();
     rtdBuilder.terminate();
+    if (metricsDumper) {
+      metricsDumper->stop();
+    }
 
     {
       // Results:
@@ -311,6 +381,61 @@ main(int argc_, char** argv_)
         }
         i++;
       }
+      const auto& rtdBuilderQueueResults = rtdBuilder.get_queue_results();
+      i = 0;
+      *rtdBuilderResultsOut << "Queues :" << std::endl;
+      for (const auto& res : rtdBuilderQueueResults) {
+        *rtdBuilderResultsOut << "- Queue #" << i;
+        if (res.category == snfee::rtdb::builder::WORKER_INPUT_RHD) {
+          *rtdBuilderResultsOut << " (input RHD";
+          *rtdBuilderResultsOut
+            << ",crate=" << snfee::model::crate_model_label(res.crate_model);
+          *rtdBuilderResultsOut << ")";
+        } else if (res.category == snfee::rtdb::builder::WORKER_OUTPUT_RTD) {
+          *rtdBuilderResultsOut << " (output RTD)";
+        }
+        *rtdBuilderResultsOut << " : " << std::endl;
+        *rtdBuilderResultsOut << "   - Capacity          : " << res.capacity
+                              << std::endl;
+        *rtdBuilderResultsOut << "   - Pushed records    : " << res.pushed
+                              << std::endl;
+        *rtdBuilderResultsOut << "   - Popped records    : " << res.popped
+                              << std::endl;
+        *rtdBuilderResultsOut << "   - Max occupancy     : "
+                              << res.max_occupancy << std::endl;
+        *rtdBuilderResultsOut << "   - Mean occupancy    : "
+                              << res.mean_occupancy << std::endl;
+        *rtdBuilderResultsOut << "   - Full stalls       : " << res.full_stalls
+                              << std::endl;
+        *rtdBuilderResultsOut << "   - Empty stalls      : "
+                              << res.empty_stalls << std::endl;
+        i++;
+      }
+      *rtdBuilderResultsOut << "Record pools :" << std::endl;
+      for (const auto& res : rtdBuilder.get_pool_results()) {
+        *rtdBuilderResultsOut << "- Pool of " << res.record_type << " : "
+                              << std::endl;
+        *rtdBuilderResultsOut << "   - Allocated records : "
+                              << res.object_allocations << std::endl;
+        *rtdBuilderResultsOut << "   - Recycled records  : "
+                              << res.object_reuses << std::endl;
+        *rtdBuilderResultsOut << "   - Allocated blocks  : "
+                              << res.block_allocations << std::endl;
+        *rtdBuilderResultsOut << "   - Recycled blocks   : "
+                              << res.block_reuses << std::endl;
+      }
+      const auto& rtdBuilderTiming = rtdBuilder.get_timing_results();
+      *rtdBuilderResultsOut << "Timing :" << std::endl;
+      *rtdBuilderResultsOut << "   - Wall time (s)     : "
+                            << rtdBuilderTiming.wall_time << std::endl;
+      *rtdBuilderResultsOut << "   - CPU time (s)      : "
+                            << rtdBuilderTiming.cpu_time << std::endl;
+      if (rtdBuilderTiming.wall_time > 0.0) {
+        *rtdBuilderResultsOut << "   - CPU/wall ratio    : "
+                              << rtdBuilderTiming.cpu_time /
+                                   rtdBuilderTiming.wall_time
+                              << std::endl;
+      }
     }
   }
   catch (std::exception& x) {
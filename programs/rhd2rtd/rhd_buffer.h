@@ -0,0 +1,314 @@
+//! \file programs/rhd2rtd/rhd_buffer.h
+//! \brief Input buffer of RHD records bucketed by trigger ID
+
+#ifndef SNFEE_RTDB_RHD_BUFFER_H
+#define SNFEE_RTDB_RHD_BUFFER_H
+
+// Standard Library:
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <utility>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/logger.h>
+
+// This project:
+#include "rhd_record.h"
+#include <snfee/data/utils.h>
+
+namespace snfee {
+  namespace rtdb {
+
+    /// \brief RHD input buffer
+    ///
+    /// RHD records are grouped in buckets by trigger ID, the buckets being
+    /// sorted by increasing trigger ID:
+    ///
+    /// \code
+    /// min_popping_trig_ids = 2
+    /// front_trig_id        = 4
+    /// buckets              =
+    ///   [TRIGID=4] : [4][4][4]
+    ///   [TRIGID=5] : [5][5]
+    ///   [TRIGID=7] : [7]
+    ///   [TRIGID=8] : [8][8]
+    /// terminated           = false
+    /// \endcode
+    ///
+    /// A record is appended to the last bucket, or to a new last bucket,
+    /// in constant time when the input is sorted. An out of order record
+    /// is inserted in O(log N) where N is the number of stored trigger IDs.
+    /// Records with the same trigger ID are kept in their arrival order.
+    /// Popping a record and counting the stored trigger IDs are O(1).
+    struct rhd_buffer {
+      rhd_buffer(const int32_t id_,
+                 const uint32_t capacity_ = 0,
+                 const std::size_t min_popping_trig_ids_ = 2)
+      {
+        _id_ = id_;
+        _min_popping_trig_ids_ = min_popping_trig_ids_;
+        _capacity_ = capacity_;
+        return;
+      }
+
+      ~rhd_buffer()
+      {
+        // std::cerr << "[devel] **** RHD buffer #" << _id_ << " destroyed!" <<
+        // std::endl;
+        return;
+      }
+
+      std::size_t
+      size() const
+      {
+        return _size_;
+      }
+
+      std::size_t
+      get_capacity() const
+      {
+        return _capacity_;
+      }
+
+      /// Return the number of distinct trigger IDs in the buffer
+      std::size_t
+      get_number_of_trig_ids() const
+      {
+        return _buckets_.size();
+      }
+
+      /// Reset the RHD buffer
+      void
+      reset()
+      {
+        _buckets_.clear();
+        _size_ = 0;
+        _front_trig_id_ = snfee::data::INVALID_TRIGGER_ID;
+        return;
+      }
+
+      /// Check if the buffer is finished
+      bool
+      is_finished() const
+      {
+        return is_empty() and is_terminated();
+      }
+
+      /// Check if a given trigger ID is complete
+      bool
+      trig_id_is_finished(const int32_t test_trig_id_) const
+      {
+        if (is_finished()) {
+          // No more record is the buffer and no hope to get more:
+          return true;
+        }
+        if (_front_trig_id_ != snfee::data::INVALID_TRIGGER_ID and
+            test_trig_id_ < _front_trig_id_) {
+          // The current trigger ID in the buffer is newer than the tested
+          // value:
+          return true;
+        }
+        return false;
+      }
+
+      int32_t
+      get_front_trig_id() const
+      {
+        return _front_trig_id_;
+      }
+
+      bool
+      can_push() const
+      {
+        if (_capacity_ > 0 and _size_ >= _capacity_) {
+          return false;
+        }
+        return true;
+      }
+
+      /// Insert a new record in the buffer
+      void
+      insert_record(snfee::io::rhd_record&& rhd_rec_)
+      {
+        const int32_t new_trig_id = rhd_rec_.get_trigger_id();
+        bucket_dict_type::iterator bucket_iter = _buckets_.end();
+        if (_buckets_.empty() or new_trig_id > _buckets_.rbegin()->first) {
+          // Usual case:
+          // RHD records = [4][4][4][5][5][6][6][ ]
+          // New record  = [8]-------------------^
+          bucket_iter = _buckets_.emplace_hint(
+            _buckets_.end(), new_trig_id, bucket_type());
+        } else if (new_trig_id == _buckets_.rbegin()->first) {
+          // Usual case:
+          // RHD records = [4][4][4][5][5][6][6][ ]
+          // New record  = [6]-------------------^
+          bucket_iter = std::prev(_buckets_.end());
+        } else {
+          // Rare cases (new_trig_id < last trigger ID):
+          // RHD records =    [4][4][4][5][5][6][6][ ][7][7][7][9][9]
+          // New record  = [3]-^                    ^
+          // New record  = [6]----------------------'
+          DT_THROW_IF(_min_popping_trig_ids_ <= 1,
+                      std::logic_error,
+                      "Unsorted input RHD with trigger ID="
+                        << new_trig_id << " in buffer #" << _id_ << "!");
+          bucket_iter = _buckets_.lower_bound(new_trig_id);
+          if (bucket_iter == _buckets_.end() or
+              bucket_iter->first != new_trig_id) {
+            bucket_iter =
+              _buckets_.emplace_hint(bucket_iter, new_trig_id, bucket_type());
+          }
+        }
+        bucket_iter->second.push_back(std::move(rhd_rec_));
+        _size_++;
+        _front_trig_id_ = _buckets_.begin()->first;
+        return;
+      }
+
+      /// Pop a record from the buffer
+      snfee::io::rhd_record
+      pop_record()
+      {
+        DT_THROW_IF(
+          is_empty(), std::logic_error, "No more record in the RHD buffer!");
+        bucket_type& front_bucket = _buckets_.begin()->second;
+        snfee::io::rhd_record rec = std::move(front_bucket.front());
+        front_bucket.pop_front();
+        _size_--;
+        if (front_bucket.empty()) {
+          _buckets_.erase(_buckets_.begin());
+        }
+        _front_trig_id_ = snfee::data::INVALID_TRIGGER_ID;
+        if (!_buckets_.empty()) {
+          // Update the current trigger ID with the one from the next record:
+          _front_trig_id_ = _buckets_.begin()->first;
+        }
+        return rec;
+      }
+
+      void
+      terminate()
+      {
+        _terminated_ = true;
+        return;
+      }
+
+      bool
+      is_terminated() const
+      {
+        return _terminated_;
+      }
+
+      bool
+      is_empty() const
+      {
+        return _size_ == 0;
+      }
+
+      int32_t
+      get_next_poppable_trig_id() const
+      {
+        if (is_empty())
+          return snfee::data::INVALID_TRIGGER_ID;
+        if (is_terminated())
+          return _front_trig_id_;
+        if (_buckets_.size() >= _min_popping_trig_ids_)
+          return _front_trig_id_;
+        return snfee::data::INVALID_TRIGGER_ID;
+      }
+
+      bool
+      can_be_popped() const
+      {
+        if (is_empty())
+          return false;
+        if (is_terminated())
+          return true;
+        if (_buckets_.size() >= _min_popping_trig_ids_)
+          return true;
+        return false;
+      }
+
+      void
+      print(std::ostream& out_) const
+      {
+        std::ostringstream out;
+        out << "RHD buffer : " << std::endl;
+        out << "|-- ID : " << _id_ << std::endl;
+        out << "|-- Minimum popping trig. IDs : " << _min_popping_trig_ids_
+            << std::endl;
+        out << "|-- Capacity : " << _capacity_ << std::endl;
+        out << "|-- RHD records FIFO : " << _size_ << std::endl;
+        {
+          std::size_t counter = 0;
+          for (const auto& bucket : _buckets_) {
+            for (const auto& rhd_rec : bucket.second) {
+              out << "|   ";
+              if (counter + 1 == _size_) {
+                out << "`-- ";
+              } else {
+                out << "|-- ";
+              }
+              // out << "RHD";
+              out << rhd_rec;
+              out << std::endl;
+              counter++;
+            }
+          }
+        }
+        out << "|-- Front trigger ID : " << _front_trig_id_ << std::endl;
+        out << "|-- Embedded trigger IDs : " << _buckets_.size() << std::endl;
+        if (!_buckets_.empty()) {
+          out << "|   " << (_buckets_.size() == 1 ? "`-- " : "|-- ")
+              << _buckets_.begin()->first << std::endl;
+          if (_buckets_.size() >= 3) {
+            out << "|   "
+                << "|-- "
+                << "..." << std::endl;
+          }
+          if (_buckets_.size() >= 2) {
+            out << "|   "
+                << "`-- " << _buckets_.rbegin()->first << std::endl;
+          }
+        }
+        out << "|-- Terminated : " << std::boolalpha << _terminated_
+            << std::endl;
+        out << "`-- Finished : " << std::boolalpha << is_finished()
+            << std::endl;
+        out << std::endl;
+        out_ << out.str();
+        return;
+      }
+
+    private:
+      /// Records sharing the same trigger ID, in arrival order
+      typedef std::deque<snfee::io::rhd_record> bucket_type;
+
+      /// Buckets of records sorted by trigger ID
+      typedef std::map<int32_t, bucket_type> bucket_dict_type;
+
+      // Configuration:
+      datatools::logger::priority _logging_ = datatools::logger::PRIO_FATAL;
+      int32_t _id_ = -1;       ///< FIFO identifier
+      uint32_t _capacity_ = 0; ///< FIFO max capacity
+      std::size_t _min_popping_trig_ids_ =
+        1; ///< Minimal number of trigger IDs needed before popping
+      bucket_dict_type _buckets_; ///< Buckets of RHD records by trigger ID
+      std::size_t _size_ = 0;     ///< Number of stored RHD records
+      int32_t _front_trig_id_ =
+        snfee::data::INVALID_TRIGGER_ID; ///< Front record trigger ID
+      bool _terminated_ =
+        false; ///< Input source is terminated and cannot push more RHD records
+    };
+
+  } // namespace rtdb
+} // namespace snfee
+
+#endif // SNFEE_RTDB_RHD_BUFFER_H
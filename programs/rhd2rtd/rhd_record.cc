@@ -1,5 +1,6 @@
 // This project:
 #include "rhd_record.h"
+#include "record_pool.h"
 
 namespace snfee {
   namespace io {
@@ -31,7 +32,7 @@ namespace snfee {
     rhd_record::make_trig()
     {
       reset();
-      _trig_rec_ = std::make_shared<snfee::data::trigger_record>();
+      _trig_rec_ = record_pool<snfee::data::trigger_record>::instance().make();
       return;
     }
 
@@ -39,7 +40,8 @@ namespace snfee {
     rhd_record::make_calo_hit()
     {
       reset();
-      _calo_hit_rec_ = std::make_shared<snfee::data::calo_hit_record>();
+      _calo_hit_rec_ =
+        record_pool<snfee::data::calo_hit_record>::instance().make();
       return;
     }
 
@@ -47,7 +49,8 @@ namespace snfee {
     rhd_record::make_tracker_hit()
     {
       reset();
-      _tracker_hit_rec_ = std::make_shared<snfee::data::tracker_hit_record>();
+      _tracker_hit_rec_ =
+        record_pool<snfee::data::tracker_hit_record>::instance().make();
       return;
     }
 
@@ -104,6 +107,23 @@ namespace snfee {
       return tid;
     }
 
+    std::size_t
+    rhd_record::get_memory_size() const
+    {
+      // Wrapper and shared pointer control block:
+      std::size_t sz = sizeof(rhd_record) + 2 * sizeof(void*);
+      if (_calo_hit_rec_) {
+        sz += sizeof(snfee::data::calo_hit_record);
+        sz += 2 * sizeof(uint16_t) *
+              _calo_hit_rec_->get_waveforms().get_number_of_samples();
+      } else if (_tracker_hit_rec_) {
+        sz += sizeof(snfee::data::tracker_hit_record);
+      } else if (_trig_rec_) {
+        sz += sizeof(snfee::data::trigger_record);
+      }
+      return sz;
+    }
+
     const std::shared_ptr<snfee::data::trigger_record>&
     rhd_record::get_trig_rec() const
     {
@@ -35,13 +35,13 @@ namespace snfee {
       rhd_record(const std::shared_ptr<snfee::data::tracker_hit_record>&
                    tracker_hit_rec_);
 
-      /// Make this record a trigger record
+      /// Make this record a new trigger record (from the record pool)
       void make_trig();
 
-      /// Make this record a calo hit record
+      /// Make this record a new calo hit record (from the record pool)
       void make_calo_hit();
 
-      /// Make this record a tracker hit record
+      /// Make this record a new tracker hit record (from the record pool)
       void make_tracker_hit();
 
       /// Check if this record is a trigger record
@@ -62,6 +62,9 @@ namespace snfee {
       /// Get the trigger ID of the record
       int32_t get_trigger_id() const;
 
+      /// Return an estimate of the memory size of the record (bytes)
+      std::size_t get_memory_size() const;
+
       /// Return the embedded trigger record
       const std::shared_ptr<snfee::data::trigger_record>& get_trig_rec() const;
 
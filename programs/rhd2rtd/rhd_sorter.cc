@@ -2,29 +2,134 @@
 #include "rhd_sorter.h"
 
 // Standard Library:
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <deque>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+// - POSIX:
+#include <unistd.h>
 
 // Third party:
 // - Bayeux:
 #include <bayeux/datatools/exception.h>
 
+// This project:
+#include <snfee/io/native_data_reader.h>
+#include <snfee/io/native_data_writer.h>
+
 namespace snfee {
   namespace io {
 
-    struct trigger_id_buffer {
-      trigger_id_buffer(const int32_t trigger_id_) : trigger_id(trigger_id_)
+    namespace {
+
+      /// Store a RHD record in a native file
+      void
+      store_record(native_data_writer& writer_, const rhd_record& rec_)
       {
+        if (rec_.is_calo_hit()) {
+          writer_.store(*rec_.get_calo_hit_rec());
+        } else if (rec_.is_tracker_hit()) {
+          writer_.store(*rec_.get_tracker_hit_rec());
+        } else if (rec_.is_trig()) {
+          writer_.store(*rec_.get_trig_rec());
+        } else {
+          DT_THROW(std::logic_error, "Cannot store an empty RHD record!");
+        }
         return;
       }
 
-      int32_t trigger_id = snfee::data::INVALID_TRIGGER_ID;
-      std::deque<rhd_record> queue;
-    };
+      /// Load the next RHD record from a native file, return false at the
+      /// end of the file
+      bool
+      load_record(native_data_reader& reader_, rhd_record& rec_)
+      {
+        if (!reader_.has_record_tag()) {
+          return false;
+        }
+        if (reader_.record_tag_is(snfee::data::calo_hit_record::SERIAL_TAG)) {
+          rec_.make_calo_hit();
+          reader_.load(*rec_.get_calo_hit_rec());
+        } else if (reader_.record_tag_is(
+                     snfee::data::tracker_hit_record::SERIAL_TAG)) {
+          rec_.make_tracker_hit();
+          reader_.load(*rec_.get_tracker_hit_rec());
+        } else if (reader_.record_tag_is(
+                     snfee::data::trigger_record::SERIAL_TAG)) {
+          rec_.make_trig();
+          reader_.load(*rec_.get_trig_rec());
+        } else {
+          DT_THROW(std::logic_error,
+                   "Unexpected record '" << reader_.get_record_tag()
+                                         << "' in a sorter run file!");
+        }
+        return true;
+      }
+
+      /// Merge key of a run head: trigger ID, then run rank (input order)
+      typedef std::pair<int32_t, std::size_t> head_key_type;
+
+      /// Priority queue of run heads (smallest key on top)
+      typedef std::priority_queue<head_key_type,
+                                  std::vector<head_key_type>,
+                                  std::greater<head_key_type>>
+        head_queue_type;
+
+    } // namespace
 
     struct rhd_sorter::pimpl_type {
       pimpl_type(rhd_sorter&);
+      ~pimpl_type();
+
+      /// Memory used by the block of a run file writer or reader
+      std::size_t block_memory_size() const;
+
+      /// Memory used per run during a merge
+      std::size_t merge_memory_size_per_run() const;
+
+      /// Update the estimated memory size
+      void set_memory_size(const std::size_t);
+
+      /// Create a new temporary run file
+      std::string make_run_file();
+
+      /// Sort the current run and spill it to a temporary run file
+      void spill_run();
+
+      /// Open the readers of the first runs and load their heads
+      void open_runs(const std::size_t nruns_);
+
+      /// Pop the next record from the open runs
+      rhd_record pop_merged_record();
+
+      /// Merge the first runs in a new run, placed first
+      void merge_first_runs(const std::size_t nruns_);
 
       rhd_sorter& master;
+      bool input_terminated = false;
+      std::size_t number_of_records = 0;
+      std::size_t number_of_spilled_runs = 0;
+      std::size_t number_of_intermediate_merges = 0;
+      std::size_t max_record_memory_size = 0; ///< Largest pushed record
+      std::size_t memory_size = 0;            ///< Current estimated memory
+      std::size_t peak_memory_size = 0;       ///< Peak estimated memory
+
+      // Current run:
+      std::deque<rhd_record> run;
+      std::size_t run_memory_size = 0;
+      std::size_t run_position = 0; ///< Output position (in memory sort)
+
+      // Spilled runs, in input order:
+      std::deque<std::string> run_files;
+      std::vector<std::string> all_run_files; ///< For the final cleanup
+
+      // Merge of spilled runs:
+      std::vector<std::unique_ptr<native_data_reader>> run_readers;
+      std::vector<rhd_record> run_heads;
+      head_queue_type heads;
     };
 
     rhd_sorter::pimpl_type::pimpl_type(rhd_sorter& master_) : master(master_)
@@ -32,12 +137,163 @@ namespace snfee {
       return;
     }
 
+    rhd_sorter::pimpl_type::~pimpl_type()
+    {
+      run_readers.clear();
+      for (const auto& filename : all_run_files) {
+        std::remove(filename.c_str());
+      }
+      return;
+    }
+
+    std::size_t
+    rhd_sorter::pimpl_type::block_memory_size() const
+    {
+      // See the block reservation in native_data_writer:
+      return master._config_.run_block_size +
+             master._config_.run_block_size / 4;
+    }
+
+    std::size_t
+    rhd_sorter::pimpl_type::merge_memory_size_per_run() const
+    {
+      // Block of the reader (may exceed the block size by one record) and
+      // head record:
+      return block_memory_size() + 2 * max_record_memory_size;
+    }
+
+    void
+    rhd_sorter::pimpl_type::set_memory_size(const std::size_t sz_)
+    {
+      memory_size = sz_;
+      peak_memory_size = std::max(peak_memory_size, memory_size);
+      return;
+    }
+
+    std::string
+    rhd_sorter::pimpl_type::make_run_file()
+    {
+      std::string dir = master._config_.temporary_directory;
+      if (dir.empty()) {
+        const char* tmpdir = std::getenv("TMPDIR");
+        dir = (tmpdir != nullptr and tmpdir[0] != '\0') ? tmpdir : "/tmp";
+      }
+      std::string path = dir + "/snfee-rhd-sort-XXXXXX";
+      std::vector<char> path_buffer(path.begin(), path.end());
+      path_buffer.push_back('\0');
+      const int fd = mkstemp(path_buffer.data());
+      DT_THROW_IF(fd < 0,
+                  std::runtime_error,
+                  "Cannot create a temporary run file in '" << dir << "'!");
+      close(fd);
+      all_run_files.push_back(path_buffer.data());
+      return all_run_files.back();
+    }
+
+    void
+    rhd_sorter::pimpl_type::spill_run()
+    {
+      std::stable_sort(run.begin(), run.end(), rhd_record_less());
+      const std::string filename = make_run_file();
+      DT_LOG_DEBUG(master._logging_,
+                   "Spilling a run of " << run.size() << " records ("
+                                        << run_memory_size << " bytes) to '"
+                                        << filename << "'...");
+      set_memory_size(run_memory_size + block_memory_size());
+      {
+        native_data_writer writer(filename, master._config_.run_block_size);
+        for (const auto& rec : run) {
+          store_record(writer, rec);
+        }
+        writer.flush();
+      }
+      run.clear();
+      run_memory_size = 0;
+      set_memory_size(0);
+      run_files.push_back(filename);
+      number_of_spilled_runs++;
+      return;
+    }
+
+    void
+    rhd_sorter::pimpl_type::open_runs(const std::size_t nruns_)
+    {
+      run_readers.clear();
+      run_heads.assign(nruns_, rhd_record());
+      heads = head_queue_type();
+      for (std::size_t irun = 0; irun < nruns_; irun++) {
+        run_readers.emplace_back(new native_data_reader(run_files[irun]));
+        if (load_record(*run_readers.back(), run_heads[irun])) {
+          heads.emplace(run_heads[irun].get_trigger_id(), irun);
+        }
+      }
+      return;
+    }
+
+    rhd_record
+    rhd_sorter::pimpl_type::pop_merged_record()
+    {
+      const std::size_t irun = heads.top().second;
+      heads.pop();
+      rhd_record rec = std::move(run_heads[irun]);
+      run_heads[irun] = rhd_record();
+      if (load_record(*run_readers[irun], run_heads[irun])) {
+        heads.emplace(run_heads[irun].get_trigger_id(), irun);
+      }
+      return rec;
+    }
+
+    void
+    rhd_sorter::pimpl_type::merge_first_runs(const std::size_t nruns_)
+    {
+      DT_LOG_DEBUG(master._logging_,
+                   "Merging " << nruns_ << " runs out of " << run_files.size()
+                              << "...");
+      open_runs(nruns_);
+      set_memory_size(nruns_ * merge_memory_size_per_run() +
+                      block_memory_size());
+      const std::string filename = make_run_file();
+      {
+        native_data_writer writer(filename, master._config_.run_block_size);
+        while (!heads.empty()) {
+          store_record(writer, pop_merged_record());
+        }
+        writer.flush();
+      }
+      run_readers.clear();
+      run_heads.clear();
+      set_memory_size(0);
+      for (std::size_t irun = 0; irun < nruns_; irun++) {
+        std::remove(run_files.front().c_str());
+        run_files.pop_front();
+      }
+      // The merged run holds the earliest records:
+      run_files.push_front(filename);
+      number_of_intermediate_merges++;
+      return;
+    }
+
     rhd_sorter::rhd_sorter()
     {
       _pimpl_.reset(new pimpl_type(*this));
       return;
     }
 
+    rhd_sorter::rhd_sorter(const config_type& config_) : _config_(config_)
+    {
+      DT_THROW_IF(_config_.run_block_size == 0,
+                  std::logic_error,
+                  "Invalid block size of the sorter run files!");
+      _pimpl_.reset(new pimpl_type(*this));
+      DT_THROW_IF(_config_.max_memory_size < 4 * _pimpl_->block_memory_size(),
+                  std::logic_error,
+                  "Memory cap of the sorter ("
+                    << _config_.max_memory_size
+                    << " bytes) must hold at least 4 blocks of run files ("
+                    << _pimpl_->block_memory_size() << " bytes)!");
+      return;
+    }
+
     rhd_sorter::~rhd_sorter()
     {
       _pimpl_.reset();
@@ -57,21 +313,132 @@ namespace snfee {
       return;
     }
 
+    const rhd_sorter::config_type&
+    rhd_sorter::get_config() const
+    {
+      return _config_;
+    }
+
     void
     rhd_sorter::push_record(const snfee::io::rhd_record& rhd_rec_)
     {
+      DT_THROW_IF(
+        _pimpl_->input_terminated, std::logic_error, "Input is terminated!");
       int32_t trigid = rhd_rec_.get_trigger_id();
       DT_THROW_IF(trigid == snfee::data::INVALID_TRIGGER_ID,
                   std::logic_error,
                   "Invalid RHD record!");
+      // The sort of a run needs a temporary buffer of records:
+      const std::size_t rec_size =
+        rhd_rec_.get_memory_size() + sizeof(rhd_record);
+      _pimpl_->max_record_memory_size =
+        std::max(_pimpl_->max_record_memory_size, rec_size);
+      const std::size_t run_capacity =
+        _config_.max_memory_size - _pimpl_->block_memory_size();
+      if (!_pimpl_->run.empty() and
+          _pimpl_->run_memory_size + rec_size > run_capacity) {
+        _pimpl_->spill_run();
+      }
+      _pimpl_->run.push_back(rhd_rec_);
+      _pimpl_->run_memory_size += rec_size;
+      _pimpl_->set_memory_size(_pimpl_->run_memory_size);
+      _pimpl_->number_of_records++;
+      return;
+    }
 
+    void
+    rhd_sorter::terminate_input()
+    {
+      DT_THROW_IF(_pimpl_->input_terminated,
+                  std::logic_error,
+                  "Input is already terminated!");
+      _pimpl_->input_terminated = true;
+      if (_pimpl_->run_files.empty()) {
+        // In memory sort:
+        std::stable_sort(
+          _pimpl_->run.begin(), _pimpl_->run.end(), rhd_record_less());
+        _pimpl_->run_position = 0;
+        return;
+      }
+      if (!_pimpl_->run.empty()) {
+        _pimpl_->spill_run();
+      }
+      // Merge groups of runs until the final merge fits in memory:
+      const std::size_t per_run = _pimpl_->merge_memory_size_per_run();
+      const std::size_t final_fan_in = _config_.max_memory_size / per_run;
+      const std::size_t fan_in =
+        (_config_.max_memory_size - _pimpl_->block_memory_size()) / per_run;
+      DT_THROW_IF(fan_in < 2,
+                  std::logic_error,
+                  "Memory cap of the sorter (" << _config_.max_memory_size
+                                               << " bytes) is too small to "
+                                                  "merge the sorted runs!");
+      while (_pimpl_->run_files.size() > final_fan_in) {
+        _pimpl_->merge_first_runs(
+          std::min(fan_in, _pimpl_->run_files.size() - final_fan_in + 1));
+      }
+      _pimpl_->open_runs(_pimpl_->run_files.size());
+      _pimpl_->set_memory_size(_pimpl_->run_files.size() * per_run);
+      DT_LOG_DEBUG(_logging_,
+                   "Merging " << _pimpl_->run_files.size() << " sorted runs ("
+                              << _pimpl_->number_of_spilled_runs
+                              << " spilled runs)...");
       return;
     }
 
-    // snfee::io::rhd_record rhd_sorter::pop_next_record()
-    // {
-    //   return;
-    // }
+    bool
+    rhd_sorter::has_next_record() const
+    {
+      DT_THROW_IF(!_pimpl_->input_terminated,
+                  std::logic_error,
+                  "Input is not terminated!");
+      if (_pimpl_->run_files.empty()) {
+        return _pimpl_->run_position < _pimpl_->run.size();
+      }
+      return !_pimpl_->heads.empty();
+    }
+
+    snfee::io::rhd_record
+    rhd_sorter::pop_next_record()
+    {
+      DT_THROW_IF(!has_next_record(), std::logic_error, "No more record!");
+      if (_pimpl_->run_files.empty()) {
+        rhd_record rec = std::move(_pimpl_->run[_pimpl_->run_position]);
+        _pimpl_->run[_pimpl_->run_position].reset();
+        _pimpl_->run_position++;
+        if (_pimpl_->run_position == _pimpl_->run.size()) {
+          _pimpl_->run.clear();
+          _pimpl_->run_memory_size = 0;
+          _pimpl_->set_memory_size(0);
+        }
+        return rec;
+      }
+      return _pimpl_->pop_merged_record();
+    }
+
+    std::size_t
+    rhd_sorter::get_number_of_records() const
+    {
+      return _pimpl_->number_of_records;
+    }
+
+    std::size_t
+    rhd_sorter::get_number_of_runs() const
+    {
+      return _pimpl_->number_of_spilled_runs;
+    }
+
+    std::size_t
+    rhd_sorter::get_number_of_intermediate_merges() const
+    {
+      return _pimpl_->number_of_intermediate_merges;
+    }
+
+    std::size_t
+    rhd_sorter::get_peak_memory_size() const
+    {
+      return _pimpl_->peak_memory_size;
+    }
 
   } // namespace io
 } // namespace snfee
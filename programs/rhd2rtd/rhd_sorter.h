@@ -6,7 +6,13 @@
 #ifndef SNFEE_IO_RHD_SORTER_H
 #define SNFEE_IO_RHD_SORTER_H
 
+// Standard Library:
+#include <memory>
+#include <string>
+
 // Third party:
+// - Boost:
+#include <boost/utility.hpp>
 // - Bayeux:
 #include <bayeux/datatools/logger.h>
 
@@ -16,13 +22,56 @@
 namespace snfee {
   namespace io {
 
-    //! \brief Sorter algorithm for raw hit records
-    class rhd_sorter {
+    //! \brief External merge sort of raw hit records by trigger ID
+    //!
+    //! Records are pushed in any order, then popped sorted by trigger ID.
+    //! Records with the same trigger ID are popped in their push order.
+    //!
+    //! Pushed records are collected in a run until its estimated memory size
+    //! reaches the cap. A full run is sorted and spilled to a temporary file
+    //! (native binary format). Once the input is terminated, the runs are
+    //! merged back with a k-way merge, each run file being read sequentially
+    //! one block at a time. When there are too many runs to be merged within
+    //! the memory cap, groups of runs are first merged in intermediate runs.
+    //! If all records fit in a single run, nothing is written to disk.
+    //!
+    //! Usage:
+    //! \code
+    //! snfee::io::rhd_sorter sorter(cfg);
+    //! while (...) {
+    //!   sorter.push_record(rec);
+    //! }
+    //! sorter.terminate_input();
+    //! while (sorter.has_next_record()) {
+    //!   snfee::io::rhd_record rec = sorter.pop_next_record();
+    //! }
+    //! \endcode
+    class rhd_sorter : private boost::noncopyable {
     public:
+      /// Default memory cap (bytes)
+      static const std::size_t DEFAULT_MAX_MEMORY_SIZE = 268435456;
+
+      /// Default size of the blocks of the temporary run files (bytes)
+      static const std::size_t DEFAULT_RUN_BLOCK_SIZE = 262144;
+
+      /// \brief Configuration data
+      struct config_type {
+        std::size_t max_memory_size =
+          DEFAULT_MAX_MEMORY_SIZE; ///< Memory cap of the sorter (bytes)
+        std::size_t run_block_size =
+          DEFAULT_RUN_BLOCK_SIZE; ///< Size of the blocks of the run files
+        std::string
+          temporary_directory; ///< Directory of the temporary run files
+                               ///< (default: $TMPDIR or /tmp)
+      };
+
       //! Constructor
       rhd_sorter();
 
-      //! Destructor
+      //! Constructor
+      explicit rhd_sorter(const config_type& config_);
+
+      //! Destructor (temporary run files are removed)
       virtual ~rhd_sorter();
 
       //! Return logging priority
@@ -31,16 +80,41 @@ namespace snfee {
       //! Set logging priority
       void set_logging(const datatools::logger::priority);
 
+      //! Return the configuration
+      const config_type& get_config() const;
+
       //! Push a new RHD record
       void push_record(const snfee::io::rhd_record& rhd_rec_);
 
-      // //! Pop the next RHD record
-      // const snfee::io::rhd_record & pop_next_record();
+      //! Terminate the input and prepare the sorted output
+      void terminate_input();
+
+      //! Check if a sorted RHD record is available
+      bool has_next_record() const;
+
+      //! Pop the next sorted RHD record
+      snfee::io::rhd_record pop_next_record();
+
+      //! Return the number of pushed RHD records
+      std::size_t get_number_of_records() const;
+
+      //! Return the number of runs spilled to temporary files
+      std::size_t get_number_of_runs() const;
+
+      //! Return the number of intermediate merges of groups of runs
+      std::size_t get_number_of_intermediate_merges() const;
+
+      //! Return the peak estimated memory size used by the sorter (bytes)
+      std::size_t get_peak_memory_size() const;
 
     private:
       // Management:
       datatools::logger::priority _logging_ = datatools::logger::PRIO_FATAL;
 
+      // Configuration:
+      config_type _config_; ///< Configuration
+
+      // Working data:
       struct pimpl_type;
       std::unique_ptr<pimpl_type> _pimpl_;
     };
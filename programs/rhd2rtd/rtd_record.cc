@@ -1,5 +1,6 @@
 // This project:
 #include "rtd_record.h"
+#include "record_pool.h"
 
 namespace snfee {
   namespace io {
@@ -10,7 +11,9 @@ namespace snfee {
     rtd_record::make_record(const int32_t run_id_, const int32_t trigger_id_)
     {
       _trigger_id_ = trigger_id_;
-      _rtd_ = std::make_shared<snfee::data::raw_trigger_data>();
+      // A recycled RTD keeps the capacity of its collections of hits, so
+      // that installing the RHD records does not allocate:
+      _rtd_ = record_pool<snfee::data::raw_trigger_data>::instance().make();
       _rtd_->set_run_id(run_id_);
       _rtd_->set_trigger_id(_trigger_id_);
       return;
@@ -0,0 +1,244 @@
+//! \file programs/rhd2rtd/spsc_queue.h
+//! \brief Bounded lock-free single-producer/single-consumer queue
+
+#ifndef SNFEE_RTDB_SPSC_QUEUE_H
+#define SNFEE_RTDB_SPSC_QUEUE_H
+
+// Standard Library:
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/utility.hpp>
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+// This project:
+#include "wait_event.h"
+
+namespace snfee {
+  namespace rtdb {
+
+    /// \brief Bounded lock-free ring buffer linking one producer thread to
+    ///        one consumer thread
+    ///
+    /// The producer and the consumer each own one index. They only
+    /// synchronize through acquire/release operations on these indexes, so
+    /// that no lock is taken when a record is transfered. The producer
+    /// closes the queue once it has pushed its last item.
+    ///
+    /// Optional wait events let the threads sleep instead of spinning: the
+    /// consumer event is notified on each push and at closing, the producer
+    /// event is notified on each pop. An event may be shared by several
+    /// queues (ex: a consumer reading from several queues).
+    ///
+    /// Usage statistics are collected on each side without any
+    /// synchronization; they must be fetched once both threads are joined.
+    template <typename T>
+    class spsc_queue : private boost::noncopyable {
+    public:
+      /// \brief Usage statistics
+      struct statistics_type {
+        std::size_t capacity = 0;      ///< Maximum number of stored items
+        std::size_t pushed = 0;        ///< Number of pushed items
+        std::size_t popped = 0;        ///< Number of popped items
+        std::size_t max_occupancy = 0; ///< Maximum number of stored items
+        double mean_occupancy = 0.0;   ///< Mean number of stored items at push
+        std::size_t full_stalls = 0;   ///< Number of times the producer waited
+        std::size_t empty_stalls = 0;  ///< Number of times the consumer waited
+      };
+
+      /// Constructor
+      explicit spsc_queue(const std::size_t capacity_)
+        : _capacity_(capacity_)
+      {
+        DT_THROW_IF(capacity_ == 0, std::logic_error, "Invalid capacity!");
+        // Round the storage up to a power of two for cheap index wrapping:
+        std::size_t nslots = 1;
+        while (nslots < capacity_) {
+          nslots <<= 1;
+        }
+        _mask_ = nslots - 1;
+        _slots_.resize(nslots);
+        return;
+      }
+
+      /// Return the capacity
+      std::size_t
+      get_capacity() const
+      {
+        return _capacity_;
+      }
+
+      /// Set the event notified when an item is pushed or the queue is closed
+      void
+      set_consumer_event(wait_event* event_)
+      {
+        _consumer_event_ = event_;
+        return;
+      }
+
+      /// Set the event notified when an item is popped
+      void
+      set_producer_event(wait_event* event_)
+      {
+        _producer_event_ = event_;
+        return;
+      }
+
+      /// Return the number of stored items (approximative)
+      std::size_t
+      size() const
+      {
+        const uint64_t head = _head_.load(std::memory_order_acquire);
+        const uint64_t tail = _tail_.load(std::memory_order_acquire);
+        return static_cast<std::size_t>(tail - head);
+      }
+
+      /// Check if the queue is empty (approximative)
+      bool
+      is_empty() const
+      {
+        return size() == 0;
+      }
+
+      /// Push an item (producer side)
+      ///
+      /// The item is moved into the queue on success. It is left untouched
+      /// if the queue is full.
+      bool
+      try_push(T& item_)
+      {
+        const uint64_t tail = _tail_.load(std::memory_order_relaxed);
+        if (tail - _head_cache_ >= _capacity_) {
+          _head_cache_ = _head_.load(std::memory_order_acquire);
+          if (tail - _head_cache_ >= _capacity_) {
+            if (!_producer_stalled_) {
+              _producer_stalled_ = true;
+              _stats_.full_stalls++;
+            }
+            return false;
+          }
+        }
+        _slots_[tail & _mask_] = std::move(item_);
+        _tail_.store(tail + 1, std::memory_order_release);
+        _producer_stalled_ = false;
+        _stats_.pushed++;
+        const std::size_t occupancy = static_cast<std::size_t>(
+          tail + 1 - _head_.load(std::memory_order_relaxed));
+        if (occupancy > _stats_.max_occupancy) {
+          _stats_.max_occupancy = occupancy;
+        }
+        _occupancy_sum_ += occupancy;
+        if (_consumer_event_ != nullptr) {
+          _consumer_event_->notify();
+        }
+        return true;
+      }
+
+      /// Pop an item (consumer side)
+      bool
+      try_pop(T& item_)
+      {
+        const uint64_t head = _head_.load(std::memory_order_relaxed);
+        if (head == _tail_cache_) {
+          _tail_cache_ = _tail_.load(std::memory_order_acquire);
+          if (head == _tail_cache_) {
+            if (!_consumer_stalled_) {
+              _consumer_stalled_ = true;
+              _consumer_stalls_++;
+            }
+            return false;
+          }
+        }
+        T& slot = _slots_[head & _mask_];
+        item_ = std::move(slot);
+        // Release the resources of the moved-from item now:
+        slot = T();
+        _head_.store(head + 1, std::memory_order_release);
+        _consumer_stalled_ = false;
+        _popped_++;
+        if (_producer_event_ != nullptr) {
+          _producer_event_->notify();
+        }
+        return true;
+      }
+
+      /// Close the queue (producer side, after the last push)
+      void
+      close()
+      {
+        _closed_.store(true, std::memory_order_release);
+        if (_consumer_event_ != nullptr) {
+          _consumer_event_->notify();
+        }
+        return;
+      }
+
+      /// Check if the queue is closed
+      bool
+      is_closed() const
+      {
+        return _closed_.load(std::memory_order_acquire);
+      }
+
+      /// Check if the queue is closed and all its items have been popped
+      /// (consumer side)
+      bool
+      is_finished() const
+      {
+        // The closing flag must be checked first: all pushes happen before
+        // the closing of the queue.
+        if (!is_closed()) {
+          return false;
+        }
+        return _head_.load(std::memory_order_relaxed) ==
+               _tail_.load(std::memory_order_acquire);
+      }
+
+      /// Return the usage statistics (both threads must be stopped)
+      statistics_type
+      get_statistics() const
+      {
+        statistics_type stats = _stats_;
+        stats.capacity = _capacity_;
+        stats.popped = _popped_;
+        stats.empty_stalls = _consumer_stalls_;
+        if (stats.pushed > 0) {
+          stats.mean_occupancy = double(_occupancy_sum_) / stats.pushed;
+        }
+        return stats;
+      }
+
+    private:
+      // Configuration:
+      std::size_t _capacity_ = 0; ///< Maximum number of stored items
+      std::size_t _mask_ = 0;     ///< Index mask
+      std::vector<T> _slots_;     ///< Ring storage
+      std::atomic<bool> _closed_{false}; ///< Closing flag
+      wait_event* _consumer_event_ = nullptr; ///< Event notified at push
+      wait_event* _producer_event_ = nullptr; ///< Event notified at pop
+
+      // Producer side:
+      alignas(64) std::atomic<uint64_t> _tail_{0}; ///< Next slot to push
+      uint64_t _head_cache_ = 0; ///< Last consumer index seen by the producer
+      bool _producer_stalled_ = false; ///< Producer stall flag
+      statistics_type _stats_;         ///< Producer side statistics
+      uint64_t _occupancy_sum_ = 0;    ///< Sum of occupancies at push
+
+      // Consumer side:
+      alignas(64) std::atomic<uint64_t> _head_{0}; ///< Next slot to pop
+      uint64_t _tail_cache_ = 0; ///< Last producer index seen by the consumer
+      bool _consumer_stalled_ = false; ///< Consumer stall flag
+      std::size_t _popped_ = 0;         ///< Number of popped items
+      std::size_t _consumer_stalls_ = 0; ///< Number of consumer stalls
+    };
+
+  } // namespace rtdb
+} // namespace snfee
+
+#endif // SNFEE_RTDB_SPSC_QUEUE_H
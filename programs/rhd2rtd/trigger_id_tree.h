@@ -0,0 +1,156 @@
+//! \file programs/rhd2rtd/trigger_id_tree.h
+//! \brief Tournament tree of input streams keyed on trigger IDs
+
+#ifndef SNFEE_RTDB_TRIGGER_ID_TREE_H
+#define SNFEE_RTDB_TRIGGER_ID_TREE_H
+
+// Standard Library:
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snfee {
+  namespace rtdb {
+
+    /// \brief Tournament tree used for the k-way merge of input streams
+    ///
+    /// Each input stream (identified by its index) is a leaf of a complete
+    /// binary tree, keyed on the trigger ID at the front of the stream.
+    /// Each internal node holds the winner (smallest trigger ID) of its two
+    /// children, so the stream with the smallest trigger ID is found at the
+    /// root in O(1), and changing the trigger ID of any stream replays only
+    /// the O(log N) matches on the path of its leaf. Streams sharing the same
+    /// trigger ID are ordered by their index, so that a k-way merge visits
+    /// them in the same order as a linear scan would.
+    class trigger_id_tree {
+    public:
+      /// Key of a stream which is not competing
+      static const int32_t NO_TRIG_ID = std::numeric_limits<int32_t>::max();
+
+      /// Constructor
+      explicit trigger_id_tree(const std::size_t nstreams_ = 0)
+      {
+        resize(nstreams_);
+        return;
+      }
+
+      /// Set the number of streams (none of them competing)
+      void
+      resize(const std::size_t nstreams_)
+      {
+        _nstreams_ = nstreams_;
+        _nleaves_ = 1;
+        while (_nleaves_ < nstreams_) {
+          _nleaves_ <<= 1;
+        }
+        _keys_.assign(_nleaves_, int32_t(NO_TRIG_ID));
+        _winners_.assign(2 * _nleaves_, 0);
+        for (std::size_t i = 0; i < _nleaves_; i++) {
+          _winners_[_nleaves_ + i] = i;
+        }
+        for (std::size_t node = _nleaves_ - 1; node >= 1; node--) {
+          _winners_[node] =
+            _match_(_winners_[2 * node], _winners_[2 * node + 1]);
+        }
+        return;
+      }
+
+      /// Check if no stream is competing
+      bool
+      is_empty() const
+      {
+        return _keys_[_winners_[1]] == NO_TRIG_ID;
+      }
+
+      /// Check if a stream is competing
+      bool
+      contains(const std::size_t stream_) const
+      {
+        return _keys_[stream_] != NO_TRIG_ID;
+      }
+
+      /// Make a stream compete with a given trigger ID
+      void
+      update(const std::size_t stream_, const int32_t trig_id_)
+      {
+        DT_THROW_IF(stream_ >= _nstreams_,
+                    std::range_error,
+                    "Invalid stream index [" << stream_ << "]!");
+        DT_THROW_IF(trig_id_ == NO_TRIG_ID,
+                    std::range_error,
+                    "Invalid trigger ID [" << trig_id_ << "]!");
+        if (_keys_[stream_] != trig_id_) {
+          _keys_[stream_] = trig_id_;
+          _replay_(stream_);
+        }
+        return;
+      }
+
+      /// Withdraw a stream from the competition (no-op if absent)
+      void
+      remove(const std::size_t stream_)
+      {
+        if (_keys_[stream_] != NO_TRIG_ID) {
+          _keys_[stream_] = NO_TRIG_ID;
+          _replay_(stream_);
+        }
+        return;
+      }
+
+      /// Return the stream with the smallest trigger ID
+      std::size_t
+      top_stream() const
+      {
+        DT_THROW_IF(is_empty(), std::logic_error, "No competing stream!");
+        return _winners_[1];
+      }
+
+      /// Return the smallest trigger ID
+      int32_t
+      top_trig_id() const
+      {
+        DT_THROW_IF(is_empty(), std::logic_error, "No competing stream!");
+        return _keys_[_winners_[1]];
+      }
+
+    private:
+      /// Return the winner of two streams
+      std::size_t
+      _match_(const std::size_t stream1_, const std::size_t stream2_) const
+      {
+        const int32_t key1 = _keys_[stream1_];
+        const int32_t key2 = _keys_[stream2_];
+        if (key2 < key1 or (key2 == key1 and stream2_ < stream1_)) {
+          return stream2_;
+        }
+        return stream1_;
+      }
+
+      /// Replay the matches from the leaf of a stream up to the root
+      void
+      _replay_(const std::size_t stream_)
+      {
+        for (std::size_t node = (_nleaves_ + stream_) >> 1; node >= 1;
+             node >>= 1) {
+          _winners_[node] =
+            _match_(_winners_[2 * node], _winners_[2 * node + 1]);
+        }
+        return;
+      }
+
+    private:
+      std::size_t _nstreams_ = 0;         ///< Number of streams
+      std::size_t _nleaves_ = 1;          ///< Number of leaves (power of 2)
+      std::vector<int32_t> _keys_;        ///< Trigger IDs by stream
+      std::vector<std::size_t> _winners_; ///< Winner stream by tree node
+    };
+
+  } // namespace rtdb
+} // namespace snfee
+
+#endif // SNFEE_RTDB_TRIGGER_ID_TREE_H
@@ -0,0 +1,170 @@
+//! \file programs/rhd2rtd/wait_event.h
+//! \brief Event count used by the builder threads to sleep while idle
+
+#ifndef SNFEE_RTDB_WAIT_EVENT_H
+#define SNFEE_RTDB_WAIT_EVENT_H
+
+// Standard Library:
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Third party:
+// - Boost:
+#include <boost/utility.hpp>
+
+namespace snfee {
+  namespace rtdb {
+
+    /// \brief Event count with adaptive spin-then-park waiting
+    ///
+    /// A thread which finds nothing to do takes a ticket with prepare_wait()
+    /// before checking its work sources one last time, then calls wait()
+    /// with this ticket. Any notify() issued after the ticket was taken
+    /// makes wait() return, so that no wakeup can be lost between the check
+    /// and the wait.
+    ///
+    /// The waiting thread first spins for a short while (most wakeups come
+    /// within a few microseconds when the pipeline is busy), then parks on a
+    /// condition variable and does not use any CPU until it is notified.
+    /// The spinning budget adapts to the traffic: it is doubled each time a
+    /// wait ends while spinning and halved each time a wait ends parked, so
+    /// that an idle pipeline quickly stops spinning. The notifier
+    /// only takes the mutex when some thread is parked.
+    ///
+    /// Usage:
+    /// \code
+    /// // Consumer:
+    /// while (!done) {
+    ///   const uint64_t ticket = event.prepare_wait();
+    ///   if (!try_work()) {
+    ///     event.wait(ticket);
+    ///   }
+    /// }
+    /// // Producer:
+    /// push_work();
+    /// event.notify();
+    /// \endcode
+    class wait_event : private boost::noncopyable {
+    public:
+      /// Default maximum number of spinning iterations before parking
+      static const std::size_t DEFAULT_SPIN_COUNT = 256;
+
+      /// Minimum number of spinning iterations before parking
+      static const std::size_t MIN_SPIN_COUNT = 8;
+
+      /// Default maximum parking time before checking the event again
+      static const std::size_t DEFAULT_PARK_TIMEOUT_MS = 100;
+
+      /// \brief Usage statistics
+      struct statistics_type {
+        std::size_t notifications = 0; ///< Number of notifications
+        std::size_t waits = 0;          ///< Number of waits
+        std::size_t parks = 0;          ///< Number of waits ending parked
+      };
+
+      /// Constructor
+      explicit wait_event(const std::size_t spin_count_ = DEFAULT_SPIN_COUNT)
+        : _spin_count_(spin_count_)
+        , _spin_limit_(spin_count_)
+      {
+        if (_spin_count_ < MIN_SPIN_COUNT) {
+          _spin_count_ = MIN_SPIN_COUNT;
+          _spin_limit_ = _spin_count_;
+        }
+        return;
+      }
+
+      /// Return a ticket to be passed to a next wait
+      uint64_t
+      prepare_wait() const
+      {
+        return _epoch_.load(std::memory_order_seq_cst);
+      }
+
+      /// Wake up all threads waiting on the event
+      void
+      notify()
+      {
+        _epoch_.fetch_add(1, std::memory_order_seq_cst);
+        _notifications_.fetch_add(1, std::memory_order_relaxed);
+        if (_parked_.load(std::memory_order_seq_cst) > 0) {
+          // Taking the mutex ensures that a parking thread either sees the
+          // new epoch or is already waiting on the condition variable:
+          std::lock_guard<std::mutex> lock(_mutex_);
+          _cond_.notify_all();
+        }
+        return;
+      }
+
+      /// Wait for a notification issued after the ticket was taken
+      void
+      wait(const uint64_t ticket_)
+      {
+        _waits_.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t spin_limit =
+          _spin_limit_.load(std::memory_order_relaxed);
+        for (std::size_t ispin = 0; ispin < spin_limit; ispin++) {
+          if (_epoch_.load(std::memory_order_acquire) != ticket_) {
+            if (spin_limit < _spin_count_) {
+              _spin_limit_.store(spin_limit < _spin_count_ / 2
+                                   ? 2 * spin_limit + 1
+                                   : _spin_count_,
+                                 std::memory_order_relaxed);
+            }
+            return;
+          }
+          std::this_thread::yield();
+        }
+        if (spin_limit > MIN_SPIN_COUNT) {
+          _spin_limit_.store(spin_limit / 2, std::memory_order_relaxed);
+        }
+        _parks_.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(_mutex_);
+        _parked_.fetch_add(1, std::memory_order_seq_cst);
+        // The timeout is only a safety net against a missed notification:
+        const std::chrono::milliseconds timeout(
+          static_cast<long>(DEFAULT_PARK_TIMEOUT_MS));
+        _cond_.wait_for(lock, timeout, [this, ticket_] {
+          return _epoch_.load(std::memory_order_seq_cst) != ticket_;
+        });
+        _parked_.fetch_sub(1, std::memory_order_seq_cst);
+        return;
+      }
+
+      /// Return the usage statistics
+      statistics_type
+      get_statistics() const
+      {
+        statistics_type stats;
+        stats.notifications = _notifications_.load();
+        stats.waits = _waits_.load();
+        stats.parks = _parks_.load();
+        return stats;
+      }
+
+    private:
+      // Configuration:
+      std::size_t _spin_count_ = DEFAULT_SPIN_COUNT; ///< Spinning iterations
+
+      // Working data:
+      std::atomic<std::size_t> _spin_limit_{0}; ///< Current spinning budget
+      std::atomic<uint64_t> _epoch_{0}; ///< Counter of notifications
+      std::atomic<int> _parked_{0};     ///< Number of parked threads
+      std::mutex _mutex_;               ///< Parking mutex
+      std::condition_variable _cond_;   ///< Parking condition
+
+      // Statistics:
+      std::atomic<std::size_t> _notifications_{0};
+      std::atomic<std::size_t> _waits_{0};
+      std::atomic<std::size_t> _parks_{0};
+    };
+
+  } // namespace rtdb
+} // namespace snfee
+
+#endif // SNFEE_RTDB_WAIT_EVENT_H
@@ -16,11 +16,13 @@
 
 // This project:
 #include "rtd2root_converter.h"
+#include <snfee/io/metrics.h>
 #include <snfee/utils.h>
 
 struct app_params_type {
   datatools::logger::priority logging = datatools::logger::PRIO_FATAL;
   snfee::io::rtd2root_converter::config_type converter_cfg;
+  snfee::io::metrics_dumper::config_type metrics_config;
 };
 
 int
@@ -62,6 +64,22 @@ main(int argc_, char** argv_)
        ->value_name("number")->default_value(0),
        "set the maximum number of RTD records to be converted (default: 0, unused")
 
+      ("prefetch-depth",
+       po::value<std::size_t>(&app_params.converter_cfg.prefetch_depth)
+       ->value_name("number")->default_value(0),
+       "set the number of RTD records decoded ahead by a reading thread (default: 0, no prefetch)")
+
+      ("threads,T",
+       po::value<std::size_t>(&app_params.converter_cfg.number_of_threads)
+       ->value_name("number")->default_value(1),
+       "set the number of conversion threads (default: 1)")
+
+      ("preserve-order",
+       po::value<bool>(&app_params.converter_cfg.preserve_order)
+       ->zero_tokens()
+       ->default_value(false),
+       "keep the RTD records in the input order when using several threads")
+
 //      ("calo-select-crate,C",
 //       po::value<int16_t>(&app_params.converter_cfg.calo_sel_config.crate_num)
 //       ->value_name("id"),
@@ -84,6 +102,8 @@ main(int argc_, char** argv_)
 
     ; // end of options description
     // clang-format on
+    snfee::io::root_output_config::add_options(opts);
+    snfee::io::metrics_dumper::config_type::add_options(opts);
 
     // Describe command line arguments :
     po::variables_map vm;
@@ -126,6 +146,12 @@ main(int argc_, char** argv_)
                     << vm["logging"].as<std::string>() << "'!");
     }
 
+    // ROOT output tuning (configuration file and explicit options):
+    app_params.converter_cfg.root_output.configure(vm);
+
+    // Run time metrics:
+    app_params.metrics_config.configure(vm);
+
     // Checks:
     DT_THROW_IF(app_params.converter_cfg.input_rtd_listname.empty() and
                   app_params.converter_cfg.input_rtd_filenames.size() == 0,
@@ -135,6 +161,15 @@ main(int argc_, char** argv_)
                 std::logic_error,
                 "Missing output Root filename!");
 
+    // Run time metrics (enabled before building the pipeline):
+    std::unique_ptr<snfee::io::metrics_dumper> metricsDumper;
+    if (!app_params.metrics_config.filename.empty()) {
+      snfee::io::metrics_registry::global().set_enabled(true);
+      metricsDumper.reset(
+        new snfee::io::metrics_dumper(app_params.metrics_config));
+      metricsDumper->start();
+    }
+
     // The RTD builder:
     snfee::io::rtd2root_converter rtd2rootConverter;
     rtd2rootConverter.set_logging(app_params.logging);
@@ -144,6 +179,9 @@ main(int argc_, char** argv_)
     rtd2rootConverter.initialize();
     rtd2rootConverter.run();
     rtd2rootConverter.terminate();
+    if (metricsDumper) {
+      metricsDumper->stop();
+    }
   }
   catch (std::exception& x) {
     std::cerr << "error: " << x.what() << std::endl;
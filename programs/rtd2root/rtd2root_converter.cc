@@ -4,6 +4,15 @@
 #include "rtd2root_converter.h"
 #include "rtd2root_data.h"
 
+// Standard library:
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
 // Third party:
 // - Boost:
 #include <boost/algorithm/string.hpp>
@@ -11,25 +20,469 @@
 #include <bayeux/datatools/exception.h>
 #include <bayeux/datatools/utils.h>
 // - Root:
+#include <RVersion.h>
+#include <ROOT/TBufferMerger.hxx>
+#include <TBranch.h>
 #include <TFile.h>
+#include <TROOT.h>
 #include <TTree.h>
 
 // This project
 #include <snfee/data/raw_trigger_data.h>
+#include <snfee/io/metrics.h>
 #include <snfee/io/multifile_data_reader.h>
 
 namespace snfee {
   namespace io {
 
+    namespace {
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 26, 0)
+      typedef ROOT::TBufferMerger buffer_merger_type;
+#else
+      typedef ROOT::Experimental::TBufferMerger buffer_merger_type;
+#endif
+
+      /// Number of entries filled by a worker tree between two writes to the
+      /// buffer merger
+      const Long64_t MERGER_WRITE_PERIOD = 1000;
+
+      /// \brief Branches of a RTD tree bound to a rtd2root_data object
+      ///
+      /// The branch addresses follow the data object given to fill(), so
+      /// that entries exported by several threads can be filled in the same
+      /// tree.
+      struct rtd_tree_binding {
+        TTree* tree = nullptr;
+        /// Branches with the offset of their address in the data object
+        std::vector<std::pair<TBranch*, std::ptrdiff_t>> branches;
+        TBranch* waveform_branches[2] = {nullptr, nullptr};
+        const snfee::data::rtd2root_data* data = nullptr;
+        int16_t* waveform_addresses[2] = {nullptr, nullptr};
+
+        /// Create the branches in a tree, bound to a data object
+        void book(TTree* tree_, snfee::data::rtd2root_data& data_);
+
+        /// Fill the tree with the contents of a data object
+        void fill(snfee::data::rtd2root_data& data_);
+      };
+
+      void
+      rtd_tree_binding::book(TTree* tree_, snfee::data::rtd2root_data& data_)
+      {
+        tree = tree_;
+        data = &data_;
+        char* base = reinterpret_cast<char*>(&data_);
+        auto branch =
+          [&](const char* name_, void* address_, const char* leaflist_) {
+            TBranch* b = tree->Branch(name_, address_, leaflist_);
+            branches.push_back(
+              std::make_pair(b, static_cast<char*>(address_) - base));
+          };
+
+        /*
+          URL: https://root.cern.ch/root/html/tutorials/tree/tree3.C.html
+          ROOT currently supported types:
+          C : a character string terminated by the 0 character
+          B : an 8 bit signed integer   (Char_t)
+          b : an 8 bit unsigned integer (UChar_t)
+          S : a 16 bit signed integer   (Short_t)
+          s : a 16 bit unsigned integer (UShort_t)
+          I : a 32 bit signed integer   (Int_t)
+          i : a 32 bit unsigned integer (UInt_t)
+          F : a 32 bit floating point   (Float_t)
+          D : a 64 bit floating point   (Double_t)
+          L : a 64 bit signed integer   (Long64_t)
+          l : a 64 bit unsigned integer (ULong64_t)
+          O : a boolean (Bool_t)
+        */
+
+        // General:
+        branch("run_id", &data_.run_id, "run_id/I");
+        branch("trigger_id", &data_.trigger_id, "trigger_id/I");
+
+        // Trig record:
+        branch("has_trig", &data_.has_trig, "has_trig/O");
+
+        // Calo hit records:
+        branch("nb_calo_hits", &data_.nb_calo_hits, "nb_calo_hits/i");
+        branch("calo_tdc", data_.calo_tdc, "calo_tdc[nb_calo_hits]/S");
+        branch("calo_crate_num",
+               data_.calo_crate_num,
+               "calo_crate_num[nb_calo_hits]/S");
+        branch("calo_board_num",
+               data_.calo_board_num,
+               "calo_board_num[nb_calo_hits]/S");
+        branch("calo_chip_num",
+               data_.calo_chip_num,
+               "calo_chip_num[nb_calo_hits]/S");
+        branch("calo_event_id",
+               data_.calo_event_id,
+               "calo_event_id[nb_calo_hits]/s");
+        branch("calo_l2_id",
+               data_.calo_l2_id,
+               "calo_l2_id[nb_calo_hits]/s");
+        branch("calo_fcr", data_.calo_fcr, "calo_fcr[nb_calo_hits]/s");
+        branch("calo_has_waveforms",
+               data_.calo_has_waveforms,
+               "calo_has_waveforms[nb_calo_hits]/O");
+        branch("calo_waveform_start_sample",
+               data_.calo_waveform_start_sample,
+               "calo_waveform_start_sample[nb_calo_hits]/s");
+        branch("calo_waveform_number_of_samples",
+               data_.calo_waveform_number_of_samples,
+               "calo_waveform_number_of_samples[nb_calo_hits]/s");
+        branch("calo_waveform_offset",
+               data_.calo_waveform_offset,
+               "calo_waveform_offset[nb_calo_hits]/i");
+
+        branch("calo_ch0_lt",
+               data_.calo_ch0_lt,
+               "calo_ch0_lt[nb_calo_hits]/O");
+        branch("calo_ch0_ht",
+               data_.calo_ch0_ht,
+               "calo_ch0_ht[nb_calo_hits]/O");
+        branch("calo_ch0_underflow",
+               data_.calo_ch0_underflow,
+               "calo_ch0_underflow[nb_calo_hits]/O");
+        branch("calo_ch0_overflow",
+               data_.calo_ch0_overflow,
+               "calo_ch0_overflow[nb_calo_hits]/O");
+        branch("calo_ch0_baseline",
+               data_.calo_ch0_baseline,
+               "calo_ch0_baseline[nb_calo_hits]/S");
+        branch("calo_ch0_peak",
+               data_.calo_ch0_peak,
+               "calo_ch0_peak[nb_calo_hits]/S");
+        branch("calo_ch0_peak_cell",
+               data_.calo_ch0_peak_cell,
+               "calo_ch0_peak_cell[nb_calo_hits]/S");
+        branch("calo_ch0_charge",
+               data_.calo_ch0_charge,
+               "calo_ch0_charge[nb_calo_hits]/I");
+        branch("calo_ch0_rising_cell",
+               data_.calo_ch0_rising_cell,
+               "calo_ch0_rising_cell[nb_calo_hits]/I");
+        branch("calo_ch0_falling_cell",
+               data_.calo_ch0_falling_cell,
+               "calo_ch0_rising_falling[nb_calo_hits]/I");
+
+        branch("calo_ch1_lt",
+               data_.calo_ch1_lt,
+               "calo_ch1_lt[nb_calo_hits]/O");
+        branch("calo_ch1_ht",
+               data_.calo_ch1_ht,
+               "calo_ch1_ht[nb_calo_hits]/O");
+        branch("calo_ch1_underflow",
+               data_.calo_ch1_underflow,
+               "calo_ch1_underflow[nb_calo_hits]/O");
+        branch("calo_ch1_overflow",
+               data_.calo_ch1_overflow,
+               "calo_ch1_overflow[nb_calo_hits]/O");
+        branch("calo_ch1_baseline",
+               data_.calo_ch1_baseline,
+               "calo_ch1_baseline[nb_calo_hits]/S");
+        branch("calo_ch1_peak",
+               data_.calo_ch1_peak,
+               "calo_ch1_peak[nb_calo_hits]/S");
+        branch("calo_ch1_peak_cell",
+               data_.calo_ch1_peak_cell,
+               "calo_ch1_peak_cell[nb_calo_hits]/S");
+        branch("calo_ch1_charge",
+               data_.calo_ch1_charge,
+               "calo_ch1_charge[nb_calo_hits]/I");
+        branch("calo_ch1_rising_cell",
+               data_.calo_ch1_rising_cell,
+               "calo_ch1_rising_cell[nb_calo_hits]/I");
+        branch("calo_ch1_falling_cell",
+               data_.calo_ch1_falling_cell,
+               "calo_ch1_rising_falling[nb_calo_hits]/I");
+
+        // Waveforms of all hits, concatenated (see calo_waveform_offset and
+        // calo_waveform_number_of_samples):
+        branch("calo_nb_waveform_samples",
+               &data_.calo_nb_waveform_samples,
+               "calo_nb_waveform_samples/i");
+        waveform_branches[0] =
+          tree->Branch("calo_ch0_waveform",
+                       data_.waveforms_address(0),
+                       "calo_ch0_waveform[calo_nb_waveform_samples]/S");
+        waveform_branches[1] =
+          tree->Branch("calo_ch1_waveform",
+                       data_.waveforms_address(1),
+                       "calo_ch1_waveform[calo_nb_waveform_samples]/S");
+        waveform_addresses[0] = data_.waveforms_address(0);
+        waveform_addresses[1] = data_.waveforms_address(1);
+
+        // Tracker hit records:
+        branch("nb_tracker_hits",
+               &data_.nb_tracker_hits,
+               "nb_tracker_hits/i");
+        branch("tracker_crate_num",
+               data_.tracker_crate_num,
+               "tracker_crate_num[nb_tracker_hits]/S");
+        branch("tracker_board_num",
+               data_.tracker_board_num,
+               "tracker_board_num[nb_tracker_hits]/S");
+        branch("tracker_chip_num",
+               data_.tracker_chip_num,
+               "tracker_chip_num[nb_tracker_hits]/S");
+        branch("tracker_channel_num",
+               data_.tracker_channel_num,
+               "tracker_channel_num[nb_tracker_hits]/S");
+        branch("tracker_channel_category",
+               data_.tracker_channel_category,
+               "tracker_channel_category[nb_tracker_hits]/S");
+        branch("tracker_timestamp_category",
+               data_.tracker_timestamp_category,
+               "tracker_timestamp_category[nb_tracker_hits]/S");
+        branch("tracker_timestamp",
+               data_.tracker_timestamp,
+               "tracker_timestamp[nb_tracker_hits]/l");
+        return;
+      }
+
+      void
+      rtd_tree_binding::fill(snfee::data::rtd2root_data& data_)
+      {
+        if (&data_ != data) {
+          char* base = reinterpret_cast<char*>(&data_);
+          for (const auto& b : branches) {
+            b.first->SetAddress(base + b.second);
+          }
+          data = &data_;
+          waveform_addresses[0] = nullptr;
+          waveform_addresses[1] = nullptr;
+        }
+        // The waveform buffers may have moved since the last entry:
+        for (uint16_t ich = 0; ich < 2; ich++) {
+          int16_t* address = data_.waveforms_address(ich);
+          if (address != waveform_addresses[ich]) {
+            waveform_branches[ich]->SetAddress(address);
+            waveform_addresses[ich] = address;
+          }
+        }
+        tree->Fill();
+        return;
+      }
+
+    } // namespace
+
     struct rtd2root_converter::pimpl_type {
       std::unique_ptr<multifile_data_reader> reader;
       TFile* rfile = nullptr;
       TTree* rtree = nullptr;
+      rtd_tree_binding binding;
       snfee::data::rtd2root_data rtd2Root;
       std::size_t nb_processed_counter = 0;
       std::size_t nb_saved_counter = 0;
+
+      // Parallel conversion:
+      std::unique_ptr<buffer_merger_type> merger; ///< Unordered mode output
+      std::mutex reader_mutex;      ///< Lock on the reader and counters
+      std::mutex fill_mutex;        ///< Lock on the shared tree (ordered mode)
+      std::condition_variable fill_cond; ///< Fill turn notification
+      std::size_t next_fill_ticket = 0;  ///< Rank of the next entry to fill
+      std::atomic<bool> stop_request{false}; ///< Stop flag of the workers
+      std::exception_ptr error;          ///< First error of the workers
+
+      // Metrics (null if disabled):
+      metrics_counter* records_metrics = nullptr; ///< Saved RTD records
+      metrics_histogram* export_metrics =
+        nullptr; ///< Time of the export of a RTD record to the tree data
+      metrics_histogram* fill_metrics =
+        nullptr; ///< Time of the filling of the tree
+      metrics_histogram* reader_lock_metrics =
+        nullptr; ///< Waiting time for the reader lock
+      metrics_histogram* fill_lock_metrics =
+        nullptr; ///< Waiting time for the fill turn (ordered mode)
+
+      /// Create the metrics if the global registry is enabled
+      void init_metrics(const bool parallel_);
+
+      /// Count a saved RTD record
+      void
+      at_saved()
+      {
+        nb_saved_counter++;
+        if (records_metrics) {
+          records_metrics->add();
+        }
+        return;
+      }
+
+      /// Take the next RTD record, return false at the end of the input
+      bool take_record(snfee::data::raw_trigger_data& rtd_,
+                       std::size_t& ticket_,
+                       const std::size_t max_total_records_);
+
+      /// Store the error of a worker and stop the others
+      void abort_workers();
+
+      /// Worker of the ordered mode (fill the shared tree in input order)
+      void run_ordered_worker(const std::size_t max_total_records_);
+
+      /// Worker of the unordered mode (fill a tree in the buffer merger)
+      void run_merger_worker(const std::size_t max_total_records_,
+                             const root_output_config& root_output_);
     };
 
+    void
+    rtd2root_converter::pimpl_type::init_metrics(const bool parallel_)
+    {
+      metrics_registry& registry = metrics_registry::global();
+      if (!registry.is_enabled()) {
+        return;
+      }
+      records_metrics =
+        &registry.make_counter("snfee_rtd2root_records_total",
+                               "Number of RTD records saved in the Root tree");
+      export_metrics = &registry.make_histogram(
+        "snfee_rtd2root_export_seconds",
+        "Time spent exporting a RTD record to the data of the Root tree (s)");
+      fill_metrics =
+        &registry.make_histogram("snfee_rtd2root_fill_seconds",
+                                 "Time spent filling the Root tree (s)");
+      if (!parallel_) {
+        return;
+      }
+      reader_lock_metrics = &registry.make_histogram(
+        "snfee_rtd2root_lock_wait_seconds",
+        "Time spent by the conversion threads waiting for a lock (s)",
+        {{"lock", "reader"}});
+      fill_lock_metrics = &registry.make_histogram(
+        "snfee_rtd2root_lock_wait_seconds",
+        "Time spent by the conversion threads waiting for a lock (s)",
+        {{"lock", "fill"}});
+      return;
+    }
+
+    bool
+    rtd2root_converter::pimpl_type::take_record(
+      snfee::data::raw_trigger_data& rtd_,
+      std::size_t& ticket_,
+      const std::size_t max_total_records_)
+    {
+      std::unique_lock<std::mutex> lock(reader_mutex, std::defer_lock);
+      {
+        metrics_timer lock_timer(reader_lock_metrics);
+        lock.lock();
+      }
+      if (stop_request or !reader->has_record_tag()) {
+        return false;
+      }
+      if (max_total_records_ > 0 and
+          nb_processed_counter == max_total_records_) {
+        return false;
+      }
+      DT_THROW_IF(
+        !reader->record_tag_is(snfee::data::raw_trigger_data::SERIAL_TAG),
+        std::logic_error,
+        "Unexpected record tag!");
+      reader->load(rtd_);
+      ticket_ = nb_processed_counter++;
+      return true;
+    }
+
+    void
+    rtd2root_converter::pimpl_type::abort_workers()
+    {
+      {
+        std::lock_guard<std::mutex> lock(reader_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+      {
+        // Set under the fill lock not to miss a waiting worker:
+        std::lock_guard<std::mutex> lock(fill_mutex);
+        stop_request = true;
+      }
+      fill_cond.notify_all();
+      return;
+    }
+
+    void
+    rtd2root_converter::pimpl_type::run_ordered_worker(
+      const std::size_t max_total_records_)
+    {
+      try {
+        snfee::data::raw_trigger_data rtd;
+        snfee::data::rtd2root_data data;
+        std::size_t ticket = 0;
+        while (take_record(rtd, ticket, max_total_records_)) {
+          {
+            metrics_timer export_timer(export_metrics);
+            snfee::data::rtd2root_data::export_to_root(rtd, data);
+          }
+          std::unique_lock<std::mutex> lock(fill_mutex);
+          {
+            metrics_timer lock_timer(fill_lock_metrics);
+            fill_cond.wait(lock, [&] {
+              return stop_request or next_fill_ticket == ticket;
+            });
+          }
+          if (stop_request) {
+            break;
+          }
+          {
+            metrics_timer fill_timer(fill_metrics);
+            binding.fill(data);
+          }
+          next_fill_ticket++;
+          at_saved();
+          lock.unlock();
+          fill_cond.notify_all();
+        }
+      }
+      catch (...) {
+        abort_workers();
+      }
+      return;
+    }
+
+    void
+    rtd2root_converter::pimpl_type::run_merger_worker(
+      const std::size_t max_total_records_,
+      const root_output_config& root_output_)
+    {
+      try {
+        auto file = merger->GetFile();
+        file->cd();
+        TTree tree("RTD", "SuperNEMO RTD data");
+        // Do not register the tree in the global list of cleanups (lock):
+        tree.ResetBit(kMustCleanup);
+        snfee::data::rtd2root_data data;
+        rtd_tree_binding tree_binding;
+        tree_binding.book(&tree, data);
+        root_output_.apply(tree);
+        snfee::data::raw_trigger_data rtd;
+        std::size_t ticket = 0;
+        while (take_record(rtd, ticket, max_total_records_)) {
+          {
+            metrics_timer export_timer(export_metrics);
+            snfee::data::rtd2root_data::export_to_root(rtd, data);
+          }
+          {
+            metrics_timer fill_timer(fill_metrics);
+            tree_binding.fill(data);
+          }
+          {
+            std::lock_guard<std::mutex> lock(reader_mutex);
+            at_saved();
+          }
+          if (tree.GetEntries() % MERGER_WRITE_PERIOD == 0) {
+            file->Write();
+          }
+        }
+        file->Write();
+      }
+      catch (...) {
+        abort_workers();
+      }
+      return;
+    }
+
     rtd2root_converter::rtd2root_converter()
     {
       _pimpl_.reset(new pimpl_type);
@@ -71,6 +524,9 @@ namespace snfee {
       DT_THROW_IF(is_initialized(),
                   std::logic_error,
                   "Converter is already initialized!");
+      DT_THROW_IF(_config_.number_of_threads == 0,
+                  std::logic_error,
+                  "Invalid number of conversion threads!");
       // RTD reader:
       multifile_data_reader::config_type reader_cfg;
       if (!_config_.input_rtd_listname.empty()) {
@@ -101,167 +557,47 @@ namespace snfee {
            ifile++) {
         reader_cfg.filenames.push_back(_config_.input_rtd_filenames[ifile]);
       }
+      reader_cfg.prefetch_depth = _config_.prefetch_depth;
+      reader_cfg.metrics_label = "rtd";
+      if (_config_.number_of_threads > 1 and reader_cfg.prefetch_depth == 0) {
+        // Decode the RTD records ahead of the workers, so that the only
+        // serial step left under the reader lock is the hand-over:
+        reader_cfg.prefetch_depth = 2 * _config_.number_of_threads;
+      }
+      _pimpl_->init_metrics(_config_.number_of_threads > 1);
       _pimpl_->reader.reset(new multifile_data_reader(reader_cfg));
+      _pimpl_->reader->add_record_type<snfee::data::raw_trigger_data>();
 
       // Root output:
       std::string rfilename = _config_.output_root_filename;
       datatools::fetch_path_with_env(rfilename);
-      _pimpl_->rfile = new TFile(rfilename.c_str(), "RECREATE");
-      _pimpl_->rtree = new TTree("RTD", "SuperNEMO RTD data");
-
-      // Root tree:
-      TTree* tree = _pimpl_->rtree;
-
-      /*
-        URL: https://root.cern.ch/root/html/tutorials/tree/tree3.C.html
-        ROOT currently supported types:
-        C : a character string terminated by the 0 character
-        B : an 8 bit signed integer   (Char_t)
-        b : an 8 bit unsigned integer (UChar_t)
-        S : a 16 bit signed integer   (Short_t)
-        s : a 16 bit unsigned integer (UShort_t)
-        I : a 32 bit signed integer   (Int_t)
-        i : a 32 bit unsigned integer (UInt_t)
-        F : a 32 bit floating point   (Float_t)
-        D : a 64 bit floating point   (Double_t)
-        L : a 64 bit signed integer   (Long64_t)
-        l : a 64 bit unsigned integer (ULong64_t)
-        O : a boolean (Bool_t)
-      */
-
-      // General:
-      tree->Branch("run_id", &_pimpl_->rtd2Root.run_id, "run_id/I");
-      tree->Branch("trigger_id", &_pimpl_->rtd2Root.trigger_id, "trigger_id/I");
-
-      // Trig record:
-      tree->Branch("has_trig", &_pimpl_->rtd2Root.has_trig, "has_trig/O");
-
-      // Calo hit records:
-      tree->Branch(
-        "nb_calo_hits", &_pimpl_->rtd2Root.nb_calo_hits, "nb_calo_hits/i");
-      tree->Branch(
-        "calo_tdc", _pimpl_->rtd2Root.calo_tdc, "calo_tdc[nb_calo_hits]/S");
-      tree->Branch("calo_crate_num",
-                   _pimpl_->rtd2Root.calo_crate_num,
-                   "calo_crate_num[nb_calo_hits]/S");
-      tree->Branch("calo_board_num",
-                   _pimpl_->rtd2Root.calo_board_num,
-                   "calo_board_num[nb_calo_hits]/S");
-      tree->Branch("calo_chip_num",
-                   _pimpl_->rtd2Root.calo_chip_num,
-                   "calo_chip_num[nb_calo_hits]/S");
-      tree->Branch("calo_event_id",
-                   _pimpl_->rtd2Root.calo_event_id,
-                   "calo_event_id[nb_calo_hits]/s");
-      tree->Branch("calo_l2_id",
-                   _pimpl_->rtd2Root.calo_l2_id,
-                   "calo_l2_id[nb_calo_hits]/s");
-      tree->Branch(
-        "calo_fcr", _pimpl_->rtd2Root.calo_fcr, "calo_fcr[nb_calo_hits]/s");
-      tree->Branch("calo_has_waveforms",
-                   _pimpl_->rtd2Root.calo_has_waveforms,
-                   "calo_has_waveforms[nb_calo_hits]/O");
-      tree->Branch("calo_waveform_start_sample",
-                   _pimpl_->rtd2Root.calo_waveform_start_sample,
-                   "calo_waveform_start_sample[nb_calo_hits]/s");
-      tree->Branch("calo_waveform_number_of_samples",
-                   _pimpl_->rtd2Root.calo_waveform_number_of_samples,
-                   "calo_waveform_number_of_samples[nb_calo_hits]/s");
-
-      tree->Branch("calo_ch0_lt",
-                   _pimpl_->rtd2Root.calo_ch0_lt,
-                   "calo_ch0_lt[nb_calo_hits]/O");
-      tree->Branch("calo_ch0_ht",
-                   _pimpl_->rtd2Root.calo_ch0_ht,
-                   "calo_ch0_ht[nb_calo_hits]/O");
-      tree->Branch("calo_ch0_underflow",
-                   _pimpl_->rtd2Root.calo_ch0_underflow,
-                   "calo_ch0_underflow[nb_calo_hits]/O");
-      tree->Branch("calo_ch0_overflow",
-                   _pimpl_->rtd2Root.calo_ch0_overflow,
-                   "calo_ch0_overflow[nb_calo_hits]/O");
-      tree->Branch("calo_ch0_baseline",
-                   _pimpl_->rtd2Root.calo_ch0_baseline,
-                   "calo_ch0_baseline[nb_calo_hits]/S");
-      tree->Branch("calo_ch0_peak",
-                   _pimpl_->rtd2Root.calo_ch0_peak,
-                   "calo_ch0_peak[nb_calo_hits]/S");
-      tree->Branch("calo_ch0_peak_cell",
-                   _pimpl_->rtd2Root.calo_ch0_peak_cell,
-                   "calo_ch0_peak_cell[nb_calo_hits]/S");
-      tree->Branch("calo_ch0_charge",
-                   _pimpl_->rtd2Root.calo_ch0_charge,
-                   "calo_ch0_charge[nb_calo_hits]/I");
-      tree->Branch("calo_ch0_rising_cell",
-                   _pimpl_->rtd2Root.calo_ch0_rising_cell,
-                   "calo_ch0_rising_cell[nb_calo_hits]/I");
-      tree->Branch("calo_ch0_falling_cell",
-                   _pimpl_->rtd2Root.calo_ch0_falling_cell,
-                   "calo_ch0_rising_falling[nb_calo_hits]/I");
-
-      tree->Branch("calo_ch1_lt",
-                   _pimpl_->rtd2Root.calo_ch1_lt,
-                   "calo_ch1_lt[nb_calo_hits]/O");
-      tree->Branch("calo_ch1_ht",
-                   _pimpl_->rtd2Root.calo_ch1_ht,
-                   "calo_ch1_ht[nb_calo_hits]/O");
-      tree->Branch("calo_ch1_underflow",
-                   _pimpl_->rtd2Root.calo_ch1_underflow,
-                   "calo_ch1_underflow[nb_calo_hits]/O");
-      tree->Branch("calo_ch1_overflow",
-                   _pimpl_->rtd2Root.calo_ch1_overflow,
-                   "calo_ch1_overflow[nb_calo_hits]/O");
-      tree->Branch("calo_ch1_baseline",
-                   _pimpl_->rtd2Root.calo_ch1_baseline,
-                   "calo_ch1_baseline[nb_calo_hits]/S");
-      tree->Branch("calo_ch1_peak",
-                   _pimpl_->rtd2Root.calo_ch1_peak,
-                   "calo_ch1_peak[nb_calo_hits]/S");
-      tree->Branch("calo_ch1_peak_cell",
-                   _pimpl_->rtd2Root.calo_ch1_peak_cell,
-                   "calo_ch1_peak_cell[nb_calo_hits]/S");
-      tree->Branch("calo_ch1_charge",
-                   _pimpl_->rtd2Root.calo_ch1_charge,
-                   "calo_ch1_charge[nb_calo_hits]/I");
-      tree->Branch("calo_ch1_rising_cell",
-                   _pimpl_->rtd2Root.calo_ch1_rising_cell,
-                   "calo_ch1_rising_cell[nb_calo_hits]/I");
-      tree->Branch("calo_ch1_falling_cell",
-                   _pimpl_->rtd2Root.calo_ch1_falling_cell,
-                   "calo_ch1_rising_falling[nb_calo_hits]/I");
-
-      tree->Branch("calo_ch0_waveform",
-                   _pimpl_->rtd2Root.calo_ch0_waveform,
-                   "calo_ch0_waveform[nb_calo_hits][1024]/S");
-      tree->Branch("calo_ch1_waveform",
-                   _pimpl_->rtd2Root.calo_ch1_waveform,
-                   "calo_ch1_waveform[nb_calo_hits][1024]/S");
-
-      // Tracker hit records:
-      tree->Branch("nb_tracker_hits",
-                   &_pimpl_->rtd2Root.nb_tracker_hits,
-                   "nb_tracker_hits/i");
-      tree->Branch("tracker_crate_num",
-                   _pimpl_->rtd2Root.tracker_crate_num,
-                   "tracker_crate_num[nb_tracker_hits]/S");
-      tree->Branch("tracker_board_num",
-                   _pimpl_->rtd2Root.tracker_board_num,
-                   "tracker_board_num[nb_tracker_hits]/S");
-      tree->Branch("tracker_chip_num",
-                   _pimpl_->rtd2Root.tracker_chip_num,
-                   "tracker_chip_num[nb_tracker_hits]/S");
-      tree->Branch("tracker_channel_num",
-                   _pimpl_->rtd2Root.tracker_channel_num,
-                   "tracker_channel_num[nb_tracker_hits]/S");
-      tree->Branch("tracker_channel_category",
-                   _pimpl_->rtd2Root.tracker_channel_category,
-                   "tracker_channel_category[nb_tracker_hits]/S");
-      tree->Branch("tracker_timestamp_category",
-                   _pimpl_->rtd2Root.tracker_timestamp_category,
-                   "tracker_timestamp_category[nb_tracker_hits]/S");
-      tree->Branch("tracker_timestamp",
-                   _pimpl_->rtd2Root.tracker_timestamp,
-                   "tracker_timestamp[nb_tracker_hits]/l");
+      if (_config_.number_of_threads > 1) {
+        ROOT::EnableThreadSafety();
+      }
+      if (_config_.number_of_threads > 1 and !_config_.preserve_order) {
+        // Each worker fills its own tree, merged in the output file:
+        if (_config_.root_output.compression.is_set()) {
+          _pimpl_->merger.reset(new buffer_merger_type(
+            rfilename.c_str(),
+            "RECREATE",
+            _config_.root_output.compression.root_settings()));
+        } else {
+          _pimpl_->merger.reset(
+            new buffer_merger_type(rfilename.c_str(), "RECREATE"));
+        }
+      } else {
+#ifdef R__USE_IMT
+        if (_config_.number_of_threads > 1) {
+          // Compress the baskets of the shared tree in parallel:
+          ROOT::EnableImplicitMT(_config_.number_of_threads);
+        }
+#endif
+        _pimpl_->rfile = new TFile(rfilename.c_str(), "RECREATE");
+        _config_.root_output.apply(*_pimpl_->rfile);
+        _pimpl_->rtree = new TTree("RTD", "SuperNEMO RTD data");
+        _pimpl_->binding.book(_pimpl_->rtree, _pimpl_->rtd2Root);
+        _config_.root_output.apply(*_pimpl_->rtree);
+      }
 
       _initialized_ = true;
       return;
@@ -272,16 +608,26 @@ namespace snfee {
     {
       DT_THROW_IF(
         !is_initialized(), std::logic_error, "Converter is not initialized!");
+      _pimpl_->nb_processed_counter = 0;
+      _pimpl_->nb_saved_counter = 0;
+      if (_config_.number_of_threads > 1) {
+        _run_parallel_();
+      } else {
+        _run_sequential_();
+      }
+      if (datatools::logger::is_debug(_logging_) and _pimpl_->rtree) {
+        _pimpl_->rtree->Print();
+      }
+      return;
+    }
 
+    void
+    rtd2root_converter::_run_sequential_()
+    {
       // Working RTD object:
       snfee::data::raw_trigger_data rtd;
 
-      // Working RTD->ROOT conversion structure:
-      snfee::data::rtd2root_data rtd2Root;
-
       // Main loop on RTD input:
-      _pimpl_->nb_processed_counter = 0;
-      _pimpl_->nb_saved_counter = 0;
       while (_pimpl_->reader->has_record_tag()) {
         if (_pimpl_->reader->record_tag_is(
               snfee::data::raw_trigger_data::SERIAL_TAG)) {
@@ -296,9 +642,16 @@ namespace snfee {
           bool export_rtd = true;
           if (export_rtd) {
             // ROOT export:
-            snfee::data::rtd2root_data::export_to_root(rtd, _pimpl_->rtd2Root);
-            _pimpl_->rtree->Fill();
-            _pimpl_->nb_saved_counter++;
+            {
+              metrics_timer export_timer(_pimpl_->export_metrics);
+              snfee::data::rtd2root_data::export_to_root(rtd,
+                                                         _pimpl_->rtd2Root);
+            }
+            {
+              metrics_timer fill_timer(_pimpl_->fill_metrics);
+              _pimpl_->binding.fill(_pimpl_->rtd2Root);
+            }
+            _pimpl_->at_saved();
           }
         } else {
           DT_THROW(std::logic_error, "Unexpected record tag!");
@@ -307,9 +660,39 @@ namespace snfee {
           break;
         }
       }
-      if (datatools::logger::is_debug(_logging_)) {
-        _pimpl_->rtree->Print();
+      return;
+    }
+
+    void
+    rtd2root_converter::_run_parallel_()
+    {
+      _pimpl_->next_fill_ticket = 0;
+      _pimpl_->stop_request = false;
+      _pimpl_->error = nullptr;
+      std::vector<std::thread> workers;
+      for (std::size_t iworker = 0; iworker < _config_.number_of_threads;
+           iworker++) {
+        if (_config_.preserve_order) {
+          workers.push_back(std::thread(&pimpl_type::run_ordered_worker,
+                                        _pimpl_.get(),
+                                        _config_.max_total_records));
+        } else {
+          workers.push_back(std::thread(&pimpl_type::run_merger_worker,
+                                        _pimpl_.get(),
+                                        _config_.max_total_records,
+                                        std::cref(_config_.root_output)));
+        }
       }
+      for (auto& worker : workers) {
+        worker.join();
+      }
+      if (_pimpl_->error) {
+        std::rethrow_exception(_pimpl_->error);
+      }
+      DT_LOG_DEBUG(_logging_,
+                   "Converted " << _pimpl_->nb_saved_counter
+                                << " RTD records with "
+                                << _config_.number_of_threads << " threads.");
       return;
     }
 
@@ -319,8 +702,13 @@ namespace snfee {
       DT_THROW_IF(
         !is_initialized(), std::logic_error, "Converter is not initialized!");
       _initialized_ = false;
-      _pimpl_->rfile->Write();
-      _pimpl_->rfile->Close();
+      if (_pimpl_->merger) {
+        // Wait for the last buffers and write the output file:
+        _pimpl_->merger.reset();
+      } else {
+        _pimpl_->rfile->Write();
+        _pimpl_->rfile->Close();
+      }
       _pimpl_->reader.reset();
       return;
     }
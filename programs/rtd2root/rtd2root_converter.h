@@ -19,11 +19,18 @@
 
 // This project
 #include <snfee/io/multifile_data_reader.h>
+#include <snfee/io/root_output_config.h>
 
 namespace snfee {
   namespace io {
 
     //! \brief RTD to Root converter
+    //!
+    //! With several threads, the RTD records are exported concurrently. By
+    //! default each thread fills its own tree and the trees are merged in
+    //! the output file (ROOT::TBufferMerger), so the entries are not in the
+    //! order of the input. With the preserve_order option, the threads
+    //! fill a single tree in the order of the input.
     class rtd2root_converter : private boost::noncopyable {
     public:
       /// \brief Configuration data:
@@ -35,6 +42,13 @@ namespace snfee {
         std::string output_root_filename; ///< Output Root filename
         std::size_t max_total_records =
           0; ///< Max number of converted RTD records
+        std::size_t prefetch_depth =
+          0; ///< Number of RTD records decoded ahead (0: no prefetch)
+        std::size_t number_of_threads =
+          1; ///< Number of conversion threads (>1: parallel conversion)
+        bool preserve_order =
+          false; ///< Keep the input order of the RTD records (parallel mode)
+        root_output_config root_output; ///< Tuning of the Root output
       };
 
       //! Default constructor
@@ -61,6 +75,13 @@ namespace snfee {
       //! Reset the converter
       void terminate();
 
+    private:
+      /// Convert the RTD records in the calling thread
+      void _run_sequential_();
+
+      /// Convert the RTD records with several threads
+      void _run_parallel_();
+
     private:
       // Management:
       bool _initialized_ = false;
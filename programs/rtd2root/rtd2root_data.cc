@@ -1,6 +1,9 @@
 // This project:
 #include "rtd2root_data.h"
 
+// Standard library:
+#include <algorithm>
+
 // Third party:
 // - Bayeux:
 #include <bayeux/datatools/exception.h>
@@ -8,6 +11,14 @@
 namespace snfee {
   namespace data {
 
+    rtd2root_data::rtd2root_data()
+    {
+      // Room for a few full waveforms, buffers grow with the events:
+      calo_ch0_waveform.reserve(16 * MAX_WAVEFORM_SAMPLES);
+      calo_ch1_waveform.reserve(16 * MAX_WAVEFORM_SAMPLES);
+      return;
+    }
+
     void
     rtd2root_data::clear()
     {
@@ -15,10 +26,23 @@ namespace snfee {
       trigger_id = INVALID_TRIGGER_ID;
       has_trig = false;
       nb_calo_hits = 0;
+      calo_nb_waveform_samples = 0;
+      calo_ch0_waveform.clear();
+      calo_ch1_waveform.clear();
       nb_tracker_hits = 0;
       return;
     }
 
+    int16_t*
+    rtd2root_data::waveforms_address(const uint16_t channel_)
+    {
+      DT_THROW_IF(channel_ > 1,
+                  std::logic_error,
+                  "Invalid SAMLONG channel index [" << channel_ << "]!");
+      return channel_ == 0 ? calo_ch0_waveform.data()
+                           : calo_ch1_waveform.data();
+    }
+
     // static
     void
     rtd2root_data::export_to_root(const raw_trigger_data& in_,
@@ -35,6 +59,11 @@ namespace snfee {
       }
 
       // Calorimeter hit records:
+      DT_THROW_IF(in_.get_calo_hits().size() > MAX_CALO_HITS,
+                  std::logic_error,
+                  "Too many calorimeter hits ("
+                    << in_.get_calo_hits().size() << ") in RTD #"
+                    << in_.get_trigger_id() << "!");
       out_.nb_calo_hits = in_.get_calo_hits().size();
       int calo_count = 0;
       for (const auto& hchit : in_.get_calo_hits()) {
@@ -48,10 +77,13 @@ namespace snfee {
         out_.calo_l2_id[calo_count] = chit.get_l2_id();
         out_.calo_fcr[calo_count] = chit.get_fcr();
         out_.calo_has_waveforms[calo_count] = chit.has_waveforms();
+        // Same rule as in rtd_batch (the getter throws without waveforms):
         out_.calo_waveform_start_sample[calo_count] =
-          chit.get_waveform_start_sample();
-        out_.calo_waveform_number_of_samples[calo_count] =
-          chit.get_waveform_number_of_samples();
+          calo_hit_record::INVALID_WAVEFORM_START_SAMPLE;
+        if (chit.has_waveforms()) {
+          out_.calo_waveform_start_sample[calo_count] =
+            chit.get_waveform_start_sample();
+        }
 
         out_.calo_ch0_lt[calo_count] = chit.get_channel_data(0).is_lt();
         out_.calo_ch0_ht[calo_count] = chit.get_channel_data(0).is_ht();
@@ -91,18 +123,34 @@ namespace snfee {
 
         const snfee::data::calo_hit_record::waveforms_record& waveforms =
           chit.get_waveforms();
-        for (int isample = 0; isample < chit.get_waveform_number_of_samples();
-             isample++) {
-          out_.calo_ch0_waveform[calo_count][isample] =
-            waveforms.get_adc(isample, 0);
-          out_.calo_ch1_waveform[calo_count][isample] =
-            waveforms.get_adc(isample, 1);
-        }
+        const std::size_t nb_samples =
+          chit.has_waveforms()
+            ? std::min<std::size_t>(chit.get_waveform_number_of_samples(),
+                                    waveforms.get_number_of_samples())
+            : 0;
+        const snfee::data::calo_hit_record::waveforms_record::
+          const_samples_view ch0_samples = waveforms.channel_samples(0);
+        const snfee::data::calo_hit_record::waveforms_record::
+          const_samples_view ch1_samples = waveforms.channel_samples(1);
+        out_.calo_waveform_number_of_samples[calo_count] = nb_samples;
+        out_.calo_waveform_offset[calo_count] = out_.calo_nb_waveform_samples;
+        out_.calo_ch0_waveform.insert(out_.calo_ch0_waveform.end(),
+                                      ch0_samples.begin(),
+                                      ch0_samples.begin() + nb_samples);
+        out_.calo_ch1_waveform.insert(out_.calo_ch1_waveform.end(),
+                                      ch1_samples.begin(),
+                                      ch1_samples.begin() + nb_samples);
+        out_.calo_nb_waveform_samples += nb_samples;
 
         calo_count++;
       }
 
       // Tracker hit records:
+      DT_THROW_IF(in_.get_tracker_hits().size() > MAX_TRACKER_HITS,
+                  std::logic_error,
+                  "Too many tracker hits ("
+                    << in_.get_tracker_hits().size() << ") in RTD #"
+                    << in_.get_trigger_id() << "!");
       out_.nb_tracker_hits = in_.get_tracker_hits().size();
       int tracker_count = 0;
       for (const auto& hthit : in_.get_tracker_hits()) {
@@ -124,5 +172,151 @@ namespace snfee {
       return;
     }
 
+    namespace {
+
+      //! Copy the range of a column to a fixed size array
+      template <typename Column, typename Array>
+      void
+      copy_column(const Column& column_,
+                  const std::size_t first_,
+                  const std::size_t count_,
+                  Array& array_)
+      {
+        std::copy(column_.begin() + first_,
+                  column_.begin() + first_ + count_,
+                  array_);
+        return;
+      }
+
+    } // namespace
+
+    // static
+    void
+    rtd2root_data::export_to_root(const rtd_batch& in_,
+                                  const std::size_t event_,
+                                  rtd2root_data& out_)
+    {
+      DT_THROW_IF(event_ >= in_.size(),
+                  std::range_error,
+                  "Invalid event index [" << event_ << "]!");
+      out_.clear();
+
+      out_.run_id = in_.run_id[event_];
+      out_.trigger_id = in_.trigger_id[event_];
+      out_.has_trig = in_.has_trig[event_];
+
+      // Calorimeter hit records:
+      const std::size_t first_calo = in_.calo_hit_offset[event_];
+      const std::size_t nb_calo = in_.get_number_of_calo_hits(event_);
+      DT_THROW_IF(nb_calo > MAX_CALO_HITS,
+                  std::logic_error,
+                  "Too many calorimeter hits (" << nb_calo << ") in RTD #"
+                                                << out_.trigger_id << "!");
+      out_.nb_calo_hits = nb_calo;
+      copy_column(in_.calo_tdc, first_calo, nb_calo, out_.calo_tdc);
+      copy_column(
+        in_.calo_crate_num, first_calo, nb_calo, out_.calo_crate_num);
+      copy_column(
+        in_.calo_board_num, first_calo, nb_calo, out_.calo_board_num);
+      copy_column(in_.calo_chip_num, first_calo, nb_calo, out_.calo_chip_num);
+      copy_column(in_.calo_event_id, first_calo, nb_calo, out_.calo_event_id);
+      copy_column(in_.calo_l2_id, first_calo, nb_calo, out_.calo_l2_id);
+      copy_column(in_.calo_fcr, first_calo, nb_calo, out_.calo_fcr);
+      copy_column(in_.calo_has_waveforms,
+                  first_calo,
+                  nb_calo,
+                  out_.calo_has_waveforms);
+      copy_column(in_.calo_waveform_start_sample,
+                  first_calo,
+                  nb_calo,
+                  out_.calo_waveform_start_sample);
+      copy_column(in_.calo_waveform_number_of_samples,
+                  first_calo,
+                  nb_calo,
+                  out_.calo_waveform_number_of_samples);
+
+      const rtd_batch::calo_channel_columns& ch0 = in_.calo_channels[0];
+      copy_column(ch0.lt, first_calo, nb_calo, out_.calo_ch0_lt);
+      copy_column(ch0.ht, first_calo, nb_calo, out_.calo_ch0_ht);
+      copy_column(ch0.underflow, first_calo, nb_calo, out_.calo_ch0_underflow);
+      copy_column(ch0.overflow, first_calo, nb_calo, out_.calo_ch0_overflow);
+      copy_column(ch0.baseline, first_calo, nb_calo, out_.calo_ch0_baseline);
+      copy_column(ch0.peak, first_calo, nb_calo, out_.calo_ch0_peak);
+      copy_column(ch0.peak_cell, first_calo, nb_calo, out_.calo_ch0_peak_cell);
+      copy_column(ch0.charge, first_calo, nb_calo, out_.calo_ch0_charge);
+      copy_column(
+        ch0.rising_cell, first_calo, nb_calo, out_.calo_ch0_rising_cell);
+      copy_column(
+        ch0.falling_cell, first_calo, nb_calo, out_.calo_ch0_falling_cell);
+
+      const rtd_batch::calo_channel_columns& ch1 = in_.calo_channels[1];
+      copy_column(ch1.lt, first_calo, nb_calo, out_.calo_ch1_lt);
+      copy_column(ch1.ht, first_calo, nb_calo, out_.calo_ch1_ht);
+      copy_column(ch1.underflow, first_calo, nb_calo, out_.calo_ch1_underflow);
+      copy_column(ch1.overflow, first_calo, nb_calo, out_.calo_ch1_overflow);
+      copy_column(ch1.baseline, first_calo, nb_calo, out_.calo_ch1_baseline);
+      copy_column(ch1.peak, first_calo, nb_calo, out_.calo_ch1_peak);
+      copy_column(ch1.peak_cell, first_calo, nb_calo, out_.calo_ch1_peak_cell);
+      copy_column(ch1.charge, first_calo, nb_calo, out_.calo_ch1_charge);
+      copy_column(
+        ch1.rising_cell, first_calo, nb_calo, out_.calo_ch1_rising_cell);
+      copy_column(
+        ch1.falling_cell, first_calo, nb_calo, out_.calo_ch1_falling_cell);
+
+      // Waveforms (the channels of a hit are adjacent in the batch slab):
+      for (std::size_t ihit = 0; ihit < nb_calo; ihit++) {
+        const std::size_t nb_samples =
+          out_.calo_waveform_number_of_samples[ihit];
+        const int16_t* ch0_samples = in_.calo_waveform(first_calo + ihit, 0);
+        out_.calo_waveform_offset[ihit] = out_.calo_nb_waveform_samples;
+        out_.calo_ch0_waveform.insert(out_.calo_ch0_waveform.end(),
+                                      ch0_samples,
+                                      ch0_samples + nb_samples);
+        out_.calo_ch1_waveform.insert(out_.calo_ch1_waveform.end(),
+                                      ch0_samples + nb_samples,
+                                      ch0_samples + 2 * nb_samples);
+        out_.calo_nb_waveform_samples += nb_samples;
+      }
+
+      // Tracker hit records:
+      const std::size_t first_tracker = in_.tracker_hit_offset[event_];
+      const std::size_t nb_tracker = in_.get_number_of_tracker_hits(event_);
+      DT_THROW_IF(nb_tracker > MAX_TRACKER_HITS,
+                  std::logic_error,
+                  "Too many tracker hits (" << nb_tracker << ") in RTD #"
+                                            << out_.trigger_id << "!");
+      out_.nb_tracker_hits = nb_tracker;
+      copy_column(in_.tracker_crate_num,
+                  first_tracker,
+                  nb_tracker,
+                  out_.tracker_crate_num);
+      copy_column(in_.tracker_board_num,
+                  first_tracker,
+                  nb_tracker,
+                  out_.tracker_board_num);
+      copy_column(in_.tracker_chip_num,
+                  first_tracker,
+                  nb_tracker,
+                  out_.tracker_chip_num);
+      copy_column(in_.tracker_channel_num,
+                  first_tracker,
+                  nb_tracker,
+                  out_.tracker_channel_num);
+      copy_column(in_.tracker_channel_category,
+                  first_tracker,
+                  nb_tracker,
+                  out_.tracker_channel_category);
+      copy_column(in_.tracker_timestamp_category,
+                  first_tracker,
+                  nb_tracker,
+                  out_.tracker_timestamp_category);
+      copy_column(in_.tracker_timestamp,
+                  first_tracker,
+                  nb_tracker,
+                  out_.tracker_timestamp);
+
+      return;
+    }
+
   } // namespace data
 } // namespace snfee
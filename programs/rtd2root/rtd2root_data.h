@@ -23,19 +23,32 @@
 
 // Standard Library:
 #include <cstdint>
+#include <vector>
 
 // This project:
 #include <snfee/data/raw_trigger_data.h>
+#include <snfee/data/rtd_batch.h>
 #include <snfee/data/utils.h>
 
 namespace snfee {
   namespace data {
 
+    //! \brief Flat event buffer of the RTD to Root export
+    //!
+    //! The waveforms of all calorimeter hits of an event are concatenated
+    //! in growable buffers: the samples of hit #i start at index
+    //! calo_waveform_offset[i] and there are
+    //! calo_waveform_number_of_samples[i] of them (0 if the hit has no
+    //! waveforms). The Root branches of the waveforms must be bound again
+    //! to the buffers when their storage moves (see waveforms_address).
     struct rtd2root_data {
       static const uint16_t MAX_CALO_HITS = 800;
       static const uint16_t MAX_TRACKER_HITS = 15000;
       static const uint16_t MAX_WAVEFORM_SAMPLES = 1024;
 
+      /// Default constructor
+      rtd2root_data();
+
       // General:
       int32_t run_id = INVALID_RUN_ID;
       int32_t trigger_id = INVALID_TRIGGER_ID;
@@ -55,6 +68,7 @@ namespace snfee {
       bool calo_has_waveforms[MAX_CALO_HITS];
       uint16_t calo_waveform_start_sample[MAX_CALO_HITS];
       uint16_t calo_waveform_number_of_samples[MAX_CALO_HITS];
+      uint32_t calo_waveform_offset[MAX_CALO_HITS];
 
       bool calo_ch0_lt[MAX_CALO_HITS];
       bool calo_ch0_ht[MAX_CALO_HITS];
@@ -66,7 +80,6 @@ namespace snfee {
       int32_t calo_ch0_charge[MAX_CALO_HITS];
       int32_t calo_ch0_rising_cell[MAX_CALO_HITS];
       int32_t calo_ch0_falling_cell[MAX_CALO_HITS];
-      int16_t calo_ch0_waveform[MAX_CALO_HITS][MAX_WAVEFORM_SAMPLES];
 
       bool calo_ch1_lt[MAX_CALO_HITS];
       bool calo_ch1_ht[MAX_CALO_HITS];
@@ -78,7 +91,11 @@ namespace snfee {
       int32_t calo_ch1_charge[MAX_CALO_HITS];
       int32_t calo_ch1_rising_cell[MAX_CALO_HITS];
       int32_t calo_ch1_falling_cell[MAX_CALO_HITS];
-      int16_t calo_ch1_waveform[MAX_CALO_HITS][MAX_WAVEFORM_SAMPLES];
+
+      // Calo hit waveforms (concatenated):
+      uint32_t calo_nb_waveform_samples = 0;
+      std::vector<int16_t> calo_ch0_waveform;
+      std::vector<int16_t> calo_ch1_waveform;
 
       // Tracker hit records:
       uint32_t nb_tracker_hits = 0;
@@ -92,8 +109,17 @@ namespace snfee {
 
       void clear();
 
+      /// Return the address of the waveform buffer of a channel
+      int16_t* waveforms_address(const uint16_t channel_);
+
       static void export_to_root(const raw_trigger_data& in_,
                                  rtd2root_data& out_);
+
+      /// Export an event of a columnar batch (the hit columns are copied
+      /// in bulk)
+      static void export_to_root(const rtd_batch& in_,
+                                 const std::size_t event_,
+                                 rtd2root_data& out_);
     };
 
   } // namespace data
@@ -85,6 +85,38 @@ namespace snfee {
       return trackerRecords;
     }
 
+    void
+    RRawTriggerData::setRunID(const int32_t run)
+    {
+      runID = run;
+      return;
+    }
+
+    void
+    RRawTriggerData::setTriggerID(const int32_t trigger)
+    {
+      triggerID = trigger;
+      return;
+    }
+
+    trigger_record&
+    RRawTriggerData::grabTriggerRecord()
+    {
+      return trigger;
+    }
+
+    CaloRecordCollection&
+    RRawTriggerData::grabCaloRecords()
+    {
+      return caloRecords;
+    }
+
+    TrackerRecordCollection&
+    RRawTriggerData::grabTrackerRecords()
+    {
+      return trackerRecords;
+    }
+
     // virtual
     void
     RRawTriggerData::print_tree(
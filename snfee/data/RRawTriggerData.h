@@ -83,6 +83,21 @@ namespace snfee {
       //! Return the collection of tracker hit records
       const TrackerRecordCollection& getTrackerRecords() const;
 
+      //! Set the run ID
+      void setRunID(const int32_t run);
+
+      //! Set the trigger ID
+      void setTriggerID(const int32_t trigger);
+
+      //! Return the mutable trigger record
+      trigger_record& grabTriggerRecord();
+
+      //! Return the mutable collection of calorimeter hit records
+      CaloRecordCollection& grabCaloRecords();
+
+      //! Return the mutable collection of tracker hit records
+      TrackerRecordCollection& grabTrackerRecords();
+
       /// Smart print
       ///
       /// Usage:
@@ -0,0 +1,310 @@
+// snfee/data/adc12_codec.cc
+
+// Ourselves:
+#include <snfee/data/adc12_codec.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+  (defined(__GNUC__) || defined(__clang__))
+#define SNFEE_DATA_ADC12_CODEC_X86 1
+#include <immintrin.h>
+#endif
+
+namespace snfee {
+  namespace data {
+
+    const std::size_t adc12_codec::PACKED_SAMPLE_SIZE;
+
+    namespace {
+
+      //! Pack samples one at a time (also used for the tail of a waveform)
+      void
+      pack_scalar(const uint16_t* adc0_,
+                  const uint16_t* adc1_,
+                  const std::size_t nb_samples_,
+                  char* packed_)
+      {
+        for (std::size_t i = 0; i < nb_samples_; i++) {
+          const uint16_t adc0_12 = adc0_[i] % 4096;
+          const uint16_t adc1_12 = adc1_[i] % 4096;
+          packed_[3 * i] = adc0_12 / 16;
+          packed_[3 * i + 1] = (adc0_12 % 16) * 16 + adc1_12 / 256;
+          packed_[3 * i + 2] = adc1_12 % 256;
+        }
+        return;
+      }
+
+      //! Unpack samples one at a time (also used for the tail of a waveform)
+      void
+      unpack_scalar(const char* packed_,
+                    const std::size_t nb_samples_,
+                    uint16_t* adc0_,
+                    uint16_t* adc1_)
+      {
+        for (std::size_t i = 0; i < nb_samples_; i++) {
+          const uint8_t c0 = packed_[3 * i];
+          const uint8_t c1 = packed_[3 * i + 1];
+          const uint8_t c2 = packed_[3 * i + 2];
+          adc0_[i] = c0 * 16 + c1 / 16;
+          adc1_[i] = (c1 % 16) * 256 + c2;
+        }
+        return;
+      }
+
+#if defined(SNFEE_DATA_ADC12_CODEC_X86)
+
+      // Packing works on 32-bit lanes holding one sample each: the lane
+      // value (ADC0 << 12 | ADC1) has the 3 packed bytes in reverse order.
+      // Unpacking gathers the 16-bit words (W0 W1) of 4 samples in the low
+      // half of a 128-bit lane and their words (W1 W2) in the high half,
+      // then shifts the first ones (ADC0) and masks the second ones (ADC1).
+
+      __attribute__((target("ssse3"))) void
+      pack_ssse3(const uint16_t* adc0_,
+                 const uint16_t* adc1_,
+                 const std::size_t nb_samples_,
+                 char* packed_)
+      {
+        const __m128i adc_mask = _mm_set1_epi16(0x0FFF);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i order = _mm_setr_epi8(
+          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        std::size_t i = 0;
+        for (; i + 8 <= nb_samples_; i += 8) {
+          const __m128i a = _mm_and_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(adc0_ + i)),
+            adc_mask);
+          const __m128i b = _mm_and_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(adc1_ + i)),
+            adc_mask);
+          const __m128i v_lo =
+            _mm_or_si128(_mm_slli_epi32(_mm_unpacklo_epi16(a, zero), 12),
+                         _mm_unpacklo_epi16(b, zero));
+          const __m128i v_hi =
+            _mm_or_si128(_mm_slli_epi32(_mm_unpackhi_epi16(a, zero), 12),
+                         _mm_unpackhi_epi16(b, zero));
+          const __m128i p_lo = _mm_shuffle_epi8(v_lo, order);
+          const __m128i p_hi = _mm_shuffle_epi8(v_hi, order);
+          // 24 bytes: 12 + 4 bytes, then the last 8 bytes:
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(packed_ + 3 * i),
+                           _mm_or_si128(p_lo, _mm_slli_si128(p_hi, 12)));
+          _mm_storel_epi64(reinterpret_cast<__m128i*>(packed_ + 3 * i + 16),
+                           _mm_srli_si128(p_hi, 4));
+        }
+        pack_scalar(adc0_ + i, adc1_ + i, nb_samples_ - i, packed_ + 3 * i);
+        return;
+      }
+
+      __attribute__((target("ssse3"))) void
+      unpack_ssse3(const char* packed_,
+                   const std::size_t nb_samples_,
+                   uint16_t* adc0_,
+                   uint16_t* adc1_)
+      {
+        const __m128i gather = _mm_setr_epi8(
+          1, 0, 4, 3, 7, 6, 10, 9, 2, 1, 5, 4, 8, 7, 11, 10);
+        const __m128i adc0_mask = _mm_setr_epi16(
+          -1, -1, -1, -1, 0, 0, 0, 0);
+        const __m128i adc1_mask = _mm_setr_epi16(
+          0, 0, 0, 0, 0x0FFF, 0x0FFF, 0x0FFF, 0x0FFF);
+        std::size_t i = 0;
+        // 2 x 16 bytes are loaded for 8 samples (24 bytes):
+        for (; 3 * i + 28 <= 3 * nb_samples_; i += 8) {
+          const char* p = packed_ + 3 * i;
+          const __m128i x_lo = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), gather);
+          const __m128i x_hi = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12)), gather);
+          const __m128i r_lo =
+            _mm_or_si128(_mm_and_si128(_mm_srli_epi16(x_lo, 4), adc0_mask),
+                         _mm_and_si128(x_lo, adc1_mask));
+          const __m128i r_hi =
+            _mm_or_si128(_mm_and_si128(_mm_srli_epi16(x_hi, 4), adc0_mask),
+                         _mm_and_si128(x_hi, adc1_mask));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(adc0_ + i),
+                           _mm_unpacklo_epi64(r_lo, r_hi));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(adc1_ + i),
+                           _mm_unpackhi_epi64(r_lo, r_hi));
+        }
+        unpack_scalar(packed_ + 3 * i, nb_samples_ - i, adc0_ + i, adc1_ + i);
+        return;
+      }
+
+      __attribute__((target("avx2"))) void
+      pack_avx2(const uint16_t* adc0_,
+                const uint16_t* adc1_,
+                const std::size_t nb_samples_,
+                char* packed_)
+      {
+        const __m256i adc_mask = _mm256_set1_epi32(0x0FFF);
+        const __m256i order = _mm256_setr_epi8(
+          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        // Move the 12 packed bytes of the high lane next to the low ones:
+        const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+        std::size_t i = 0;
+        for (; i + 8 <= nb_samples_; i += 8) {
+          const __m256i a = _mm256_and_si256(
+            _mm256_cvtepu16_epi32(
+              _mm_loadu_si128(reinterpret_cast<const __m128i*>(adc0_ + i))),
+            adc_mask);
+          const __m256i b = _mm256_and_si256(
+            _mm256_cvtepu16_epi32(
+              _mm_loadu_si128(reinterpret_cast<const __m128i*>(adc1_ + i))),
+            adc_mask);
+          const __m256i v = _mm256_or_si256(_mm256_slli_epi32(a, 12), b);
+          const __m256i p = _mm256_permutevar8x32_epi32(
+            _mm256_shuffle_epi8(v, order), compact);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(packed_ + 3 * i),
+                           _mm256_castsi256_si128(p));
+          _mm_storel_epi64(reinterpret_cast<__m128i*>(packed_ + 3 * i + 16),
+                           _mm256_extracti128_si256(p, 1));
+        }
+        pack_scalar(adc0_ + i, adc1_ + i, nb_samples_ - i, packed_ + 3 * i);
+        return;
+      }
+
+      __attribute__((target("avx2"))) void
+      unpack_avx2(const char* packed_,
+                  const std::size_t nb_samples_,
+                  uint16_t* adc0_,
+                  uint16_t* adc1_)
+      {
+        const __m256i gather = _mm256_setr_epi8(
+          1, 0, 4, 3, 7, 6, 10, 9, 2, 1, 5, 4, 8, 7, 11, 10,
+          1, 0, 4, 3, 7, 6, 10, 9, 2, 1, 5, 4, 8, 7, 11, 10);
+        const __m256i adc0_mask = _mm256_setr_epi16(
+          -1, -1, -1, -1, 0, 0, 0, 0, -1, -1, -1, -1, 0, 0, 0, 0);
+        const __m256i adc1_mask = _mm256_setr_epi16(
+          0, 0, 0, 0, 0x0FFF, 0x0FFF, 0x0FFF, 0x0FFF,
+          0, 0, 0, 0, 0x0FFF, 0x0FFF, 0x0FFF, 0x0FFF);
+        std::size_t i = 0;
+        // 2 x 16 bytes are loaded for 8 samples (24 bytes):
+        for (; 3 * i + 28 <= 3 * nb_samples_; i += 8) {
+          const char* p = packed_ + 3 * i;
+          const __m128i lo =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+          const __m128i hi =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12));
+          const __m256i x = _mm256_shuffle_epi8(
+            _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1),
+            gather);
+          const __m256i r = _mm256_or_si256(
+            _mm256_and_si256(_mm256_srli_epi16(x, 4), adc0_mask),
+            _mm256_and_si256(x, adc1_mask));
+          // Lanes hold [ADC0 x 4 | ADC1 x 4], group the ADC0 words first:
+          const __m256i s = _mm256_permute4x64_epi64(r, 0xD8);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(adc0_ + i),
+                           _mm256_castsi256_si128(s));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(adc1_ + i),
+                           _mm256_extracti128_si256(s, 1));
+        }
+        unpack_scalar(packed_ + 3 * i, nb_samples_ - i, adc0_ + i, adc1_ + i);
+        return;
+      }
+
+#endif // defined(SNFEE_DATA_ADC12_CODEC_X86)
+
+    } // namespace
+
+    // static
+    adc12_codec::isa_type
+    adc12_codec::best_isa()
+    {
+#if defined(SNFEE_DATA_ADC12_CODEC_X86)
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+        return ISA_AVX2;
+      }
+      if (__builtin_cpu_supports("ssse3")) {
+        return ISA_SSSE3;
+      }
+#endif
+      return ISA_SCALAR;
+    }
+
+    // static
+    const char*
+    adc12_codec::isa_label(const isa_type isa_)
+    {
+      switch (isa_) {
+        case ISA_SSSE3:
+          return "ssse3";
+        case ISA_AVX2:
+          return "avx2";
+        default:
+          break;
+      }
+      return "scalar";
+    }
+
+    // static
+    const adc12_codec&
+    adc12_codec::instance()
+    {
+      static const adc12_codec _codec;
+      return _codec;
+    }
+
+    adc12_codec::adc12_codec()
+      : adc12_codec(best_isa())
+    {
+      return;
+    }
+
+    adc12_codec::adc12_codec(const isa_type isa_)
+      : _isa_(isa_)
+    {
+#if !defined(SNFEE_DATA_ADC12_CODEC_X86)
+      _isa_ = ISA_SCALAR;
+#endif
+      return;
+    }
+
+    adc12_codec::isa_type
+    adc12_codec::get_isa() const
+    {
+      return _isa_;
+    }
+
+    void
+    adc12_codec::pack(const uint16_t* adc0_,
+                      const uint16_t* adc1_,
+                      const std::size_t nb_samples_,
+                      char* packed_) const
+    {
+#if defined(SNFEE_DATA_ADC12_CODEC_X86)
+      if (_isa_ == ISA_AVX2) {
+        pack_avx2(adc0_, adc1_, nb_samples_, packed_);
+        return;
+      }
+      if (_isa_ == ISA_SSSE3) {
+        pack_ssse3(adc0_, adc1_, nb_samples_, packed_);
+        return;
+      }
+#endif
+      pack_scalar(adc0_, adc1_, nb_samples_, packed_);
+      return;
+    }
+
+    void
+    adc12_codec::unpack(const char* packed_,
+                        const std::size_t nb_samples_,
+                        uint16_t* adc0_,
+                        uint16_t* adc1_) const
+    {
+#if defined(SNFEE_DATA_ADC12_CODEC_X86)
+      if (_isa_ == ISA_AVX2) {
+        unpack_avx2(packed_, nb_samples_, adc0_, adc1_);
+        return;
+      }
+      if (_isa_ == ISA_SSSE3) {
+        unpack_ssse3(packed_, nb_samples_, adc0_, adc1_);
+        return;
+      }
+#endif
+      unpack_scalar(packed_, nb_samples_, adc0_, adc1_);
+      return;
+    }
+
+  } // namespace data
+} // namespace snfee
@@ -0,0 +1,87 @@
+//! \file snfee/data/adc12_codec.h
+//! \brief Packing of two-channel 12-bit SAMLONG ADC samples
+
+#ifndef SNFEE_DATA_ADC12_CODEC_H
+#define SNFEE_DATA_ADC12_CODEC_H
+
+// Standard library:
+#include <cstdint>
+#include <cstddef>
+
+namespace snfee {
+  namespace data {
+
+    //! \brief Codec of two-channel 12-bit ADC samples
+    //!
+    //! Each sample (two 12-bit ADC values stored in 16-bit words, taken
+    //! from the separate sample arrays of both channels) is packed in 3
+    //! bytes:
+    //! \code
+    //!  ADC0                 ADC1
+    //! [UUUU.6666.5555.4444][UUUU.2222.1111.0000]
+    //!
+    //!  W0         W1         W2
+    //! [6666.5555][4444.2222][1111.0000]
+    //! \endcode
+    //! where U means unused bits (ignored when packing). This is the layout
+    //! used by the serialization of calorimeter waveforms. The bulk of the
+    //! samples is processed with SSSE3 or AVX2 instructions when the CPU
+    //! supports them; all implementations produce the same bytes.
+    class adc12_codec {
+    public:
+      /// \brief Instruction set used for packing/unpacking
+      enum isa_type {
+        ISA_SCALAR = 0, ///< Portable code
+        ISA_SSSE3 = 1,  ///< SSSE3 (x86)
+        ISA_AVX2 = 2    ///< AVX2 (x86)
+      };
+
+      /// Number of bytes of a packed sample
+      static const std::size_t PACKED_SAMPLE_SIZE = 3;
+
+      //! Return the best instruction set supported by the running CPU
+      static isa_type best_isa();
+
+      //! Return the label associated to an instruction set
+      static const char* isa_label(const isa_type isa_);
+
+      //! Return the codec shared by the serialization code (best ISA)
+      static const adc12_codec& instance();
+
+      //! Constructor (the best instruction set is used by default)
+      adc12_codec();
+
+      //! Constructor with a forced instruction set (testing/benchmarking)
+      explicit adc12_codec(const isa_type isa_);
+
+      //! Return the instruction set in use
+      isa_type get_isa() const;
+
+      //! Pack samples
+      //! \param adc0_ the ADC values of channel #0
+      //! \param adc1_ the ADC values of channel #1
+      //! \param nb_samples_ the number of samples
+      //! \param packed_ the output buffer (3 bytes per sample)
+      void pack(const uint16_t* adc0_,
+                const uint16_t* adc1_,
+                const std::size_t nb_samples_,
+                char* packed_) const;
+
+      //! Unpack samples
+      //! \param packed_ the packed samples (3 bytes per sample)
+      //! \param nb_samples_ the number of samples
+      //! \param adc0_ the ADC values of channel #0
+      //! \param adc1_ the ADC values of channel #1
+      void unpack(const char* packed_,
+                  const std::size_t nb_samples_,
+                  uint16_t* adc0_,
+                  uint16_t* adc1_) const;
+
+    private:
+      isa_type _isa_ = ISA_SCALAR; //!< Instruction set in use
+    };
+
+  } // namespace data
+} // namespace snfee
+
+#endif // SNFEE_DATA_ADC12_CODEC_H
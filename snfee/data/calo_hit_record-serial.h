@@ -7,6 +7,9 @@
 // Ourselves:
 #include <snfee/data/calo_hit_record.h>
 
+// Standard library:
+#include <string>
+
 // Third party:
 // - Boost:
 #include <boost/serialization/base_object.hpp>
@@ -14,6 +17,9 @@
 #include <boost/serialization/nvp.hpp>
 #include <boost/serialization/vector.hpp>
 
+// This project:
+#include <snfee/data/adc12_codec.h>
+
 namespace snfee {
   namespace data {
 
@@ -28,39 +34,38 @@ namespace snfee {
     ///  W0         W1         W2
     /// [6666.5555][4444.2222][1111.0000]
     ///
+    /// The conversion is done by the vectorized adc12_codec, the in-memory
+    /// layout of the samples (one array per channel) does not show in the
+    /// archives.
     template <class Archive>
     void
     calo_hit_record::waveforms_record::serialize(
       Archive& ar_,
       const unsigned int /* version */)
     {
+      const adc12_codec& codec = adc12_codec::instance();
       if (Archive::is_saving::value) {
-        uint16_t bufsize = 3 * _samples_.size();
-        std::string tmp(bufsize, 0);
-        for (std::size_t i = 0; i < _samples_.size(); i++) {
-          uint16_t adc0_12 = _samples_[i]._adc_[0] % 4096;
-          uint16_t adc1_12 = _samples_[i]._adc_[1] % 4096;
-          // Portable formulas (do not use shift operators on 16-bit words but
-          // standard arithmetics):
-          tmp[3 * i] = adc0_12 / 16;
-          tmp[3 * i + 1] = (adc0_12 % 16) * 16 + adc1_12 / 256;
-          tmp[3 * i + 2] = adc1_12 % 256;
+        const std::size_t nb_samples = get_number_of_samples();
+        std::string tmp(adc12_codec::PACKED_SAMPLE_SIZE * nb_samples, 0);
+        if (nb_samples > 0) {
+          codec.pack(channel_samples(0).data(),
+                     channel_samples(1).data(),
+                     nb_samples,
+                     &tmp[0]);
         }
         ar_& boost::serialization::make_nvp("samples", tmp);
       } else {
-        uint16_t bufsize = 1024;
-        two_channel_adc_record null_record;
         std::string tmp;
-        tmp.reserve(bufsize);
         ar_& boost::serialization::make_nvp("samples", tmp);
-        _samples_.assign(tmp.length() / 3, null_record);
-        for (std::size_t i = 0; i < _samples_.size(); i++) {
-          two_channel_adc_record& rec = _samples_[i];
-          uint8_t c0 = tmp[3 * i];
-          uint8_t c1 = tmp[3 * i + 1];
-          uint8_t c2 = tmp[3 * i + 2];
-          rec._adc_[0] = c0 * 16 + c1 / 16;
-          rec._adc_[1] = (c1 % 16) * 256 + c2;
+        const std::size_t nb_samples =
+          tmp.length() / adc12_codec::PACKED_SAMPLE_SIZE;
+        _adc_.resize(snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS *
+                     nb_samples);
+        if (nb_samples > 0) {
+          codec.unpack(tmp.data(),
+                       nb_samples,
+                       channel_samples(0).data(),
+                       channel_samples(1).data());
         }
       }
       return;
@@ -2,6 +2,7 @@
 #include <snfee/data/calo_hit_record.h>
 
 // Standard Library:
+#include <algorithm>
 #include <random>
 
 // Third party:
@@ -18,6 +19,8 @@ namespace snfee {
     DATATOOLS_SERIALIZATION_IMPLEMENTATION(calo_hit_record,
                                            "snfee::data::calo_hit_record")
 
+    const uint16_t calo_hit_record::SAMPLE_ADC_DEFAULT;
+
     calo_hit_record::two_channel_adc_record::two_channel_adc_record()
     {
       for (int ich = 0;
@@ -63,27 +66,66 @@ namespace snfee {
     calo_hit_record::waveforms_record::waveforms_record(
       const uint16_t nb_samples_)
     {
-      _samples_.reserve(
-        snfee::model::feb_constants::SAMLONG_MAX_NUMBER_OF_SAMPLES);
-      two_channel_adc_record default_adc_record;
-      _samples_.assign(nb_samples_, default_adc_record);
+      _adc_.reserve(snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS *
+                    snfee::model::feb_constants::SAMLONG_MAX_NUMBER_OF_SAMPLES);
+      reset(nb_samples_);
       return;
     }
 
     void
     calo_hit_record::waveforms_record::reset(const uint16_t nb_samples_)
     {
-      _samples_.reserve(
-        snfee::model::feb_constants::SAMLONG_MAX_NUMBER_OF_SAMPLES);
-      two_channel_adc_record default_adc_record;
-      _samples_.assign(nb_samples_, default_adc_record);
+      _adc_.assign(snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS *
+                     nb_samples_,
+                   SAMPLE_ADC_DEFAULT);
       return;
     }
 
-    const std::vector<calo_hit_record::two_channel_adc_record>&
+    std::size_t
+    calo_hit_record::waveforms_record::get_number_of_samples() const
+    {
+      return _adc_.size() /
+             snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS;
+    }
+
+    std::vector<calo_hit_record::two_channel_adc_record>
     calo_hit_record::waveforms_record::get_samples() const
     {
-      return _samples_;
+      const std::size_t nb_samples = get_number_of_samples();
+      std::vector<two_channel_adc_record> samples(nb_samples);
+      for (uint16_t ich = 0;
+           ich < snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS;
+           ich++) {
+        const uint16_t* adc = _adc_.data() + ich * nb_samples;
+        for (std::size_t isample = 0; isample < nb_samples; isample++) {
+          samples[isample]._adc_[ich] = adc[isample];
+        }
+      }
+      return samples;
+    }
+
+    calo_hit_record::waveforms_record::const_samples_view
+    calo_hit_record::waveforms_record::channel_samples(
+      const uint16_t channel_) const
+    {
+      DT_THROW_IF(channel_ >=
+                    snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS,
+                  std::logic_error,
+                  "Invalid SAMLONG channel index [" << channel_ << "]!");
+      const std::size_t nb_samples = get_number_of_samples();
+      return const_samples_view(_adc_.data() + channel_ * nb_samples,
+                                nb_samples);
+    }
+
+    calo_hit_record::waveforms_record::samples_view
+    calo_hit_record::waveforms_record::channel_samples(const uint16_t channel_)
+    {
+      DT_THROW_IF(channel_ >=
+                    snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS,
+                  std::logic_error,
+                  "Invalid SAMLONG channel index [" << channel_ << "]!");
+      const std::size_t nb_samples = get_number_of_samples();
+      return samples_view(_adc_.data() + channel_ * nb_samples, nb_samples);
     }
 
     void
@@ -91,17 +133,15 @@ namespace snfee {
                                                const uint16_t channel_,
                                                const uint16_t adc_)
     {
-      DT_THROW_IF(sample_index_ >= _samples_.size(),
+      DT_THROW_IF(sample_index_ >= get_number_of_samples(),
                   std::logic_error,
                   "Invalid SAMLONG sample index [" << sample_index_ << "]!");
-      _samples_[sample_index_].set_adc(channel_, adc_);
-      // DT_LOG_DEBUG(datatools::logger::PRIO_DEBUG, "==> Write waveform ADC["
-      // << sample_index_ << "] = " << adc_); if
-      // (datatools::logger::is_debug(datatools::logger::PRIO_DEBUG)) {
-      //   uint16_t adc = get_adc(sample_index_, channel_);
-      //   DT_LOG_DEBUG(datatools::logger::PRIO_DEBUG, "==> Read  waveform ADC["
-      //   << sample_index_ << "] = " << adc);
-      // }
+      DT_THROW_IF(adc_ > SAMPLE_ADC_MAX,
+                  std::logic_error,
+                  "Invalid ADC value [" << adc_
+                                        << "] for SAMLONG channel index ["
+                                        << channel_ << "]!");
+      channel_samples(channel_)[sample_index_] = adc_;
       return;
     }
 
@@ -109,16 +149,39 @@ namespace snfee {
     calo_hit_record::waveforms_record::get_adc(const uint16_t sample_index_,
                                                const uint16_t channel_) const
     {
-      DT_THROW_IF(sample_index_ >= _samples_.size(),
+      DT_THROW_IF(sample_index_ >= get_number_of_samples(),
                   std::logic_error,
                   "Invalid SAMLONG sample index [" << sample_index_ << "]!");
-      return _samples_[sample_index_].get_adc(channel_);
+      return channel_samples(channel_)[sample_index_];
+    }
+
+    void
+    calo_hit_record::waveforms_record::resize(const uint16_t nb_samples_)
+    {
+      const std::size_t nb_samples = get_number_of_samples();
+      if (nb_samples_ == nb_samples) {
+        return;
+      }
+      const std::size_t nb_kept =
+        std::min<std::size_t>(nb_samples, nb_samples_);
+      std::vector<uint16_t> adc(
+        snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS * nb_samples_,
+        SAMPLE_ADC_DEFAULT);
+      for (uint16_t ich = 0;
+           ich < snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS;
+           ich++) {
+        std::copy(_adc_.begin() + ich * nb_samples,
+                  _adc_.begin() + ich * nb_samples + nb_kept,
+                  adc.begin() + ich * nb_samples_);
+      }
+      _adc_.swap(adc);
+      return;
     }
 
     void
     calo_hit_record::waveforms_record::invalidate()
     {
-      _samples_.clear();
+      _adc_.clear();
       return;
     }
 
@@ -158,7 +221,8 @@ namespace snfee {
           return false;
         if (_waveform_number_of_samples_ == INVALID_WAVEFORM_NUMBER_OF_SAMPLES)
           return false;
-        if (_waveforms_.get_samples().size() != _waveform_number_of_samples_)
+        if (_waveforms_.get_number_of_samples() !=
+            _waveform_number_of_samples_)
           return false;
       }
       return true;
@@ -399,7 +463,7 @@ namespace snfee {
              << get_waveform_number_of_samples() << std::endl;
 
         out_ << popts.indent << tag
-             << "Waveforms size : " << get_waveforms().get_samples().size()
+             << "Waveforms size : " << get_waveforms().get_number_of_samples()
              << std::endl;
 
         if (print_waveform_samples) {
@@ -408,10 +472,11 @@ namespace snfee {
           out_ << popts.indent << skip_tag << tag
                << "Channel 0 samples : " << std::endl;
           out_ << popts.indent << skip_tag << skip_tag << "+ ";
-          for (int isample = 0;
-               isample < (int)get_waveforms().get_samples().size();
+          const waveforms_record::const_samples_view ch0_samples =
+            get_waveforms().channel_samples(0);
+          for (std::size_t isample = 0; isample < ch0_samples.size();
                isample++) {
-            out_ << get_waveforms().get_adc(isample, 0) << ' ';
+            out_ << ch0_samples[isample] << ' ';
             if ((isample + 1) % 16 == 0) {
               out_ << std::endl << popts.indent << skip_tag << skip_tag << "+ ";
             }
@@ -420,10 +485,11 @@ namespace snfee {
           out_ << popts.indent << skip_tag << last_tag
                << "Channel 1 samples : " << std::endl;
           out_ << popts.indent << skip_tag << last_skip_tag << "+ ";
-          for (int isample = 0;
-               isample < (int)get_waveforms().get_samples().size();
+          const waveforms_record::const_samples_view ch1_samples =
+            get_waveforms().channel_samples(1);
+          for (std::size_t isample = 0; isample < ch1_samples.size();
                isample++) {
-            out_ << get_waveforms().get_adc(isample, 1) << ' ';
+            out_ << ch1_samples[isample] << ' ';
             if ((isample + 1) % 16 == 0) {
               out_ << std::endl
                    << popts.indent << skip_tag << last_skip_tag << "+ ";
@@ -752,11 +818,11 @@ namespace snfee {
           std::logic_error,
           "Overflow waveform number of samples!");
         _waveform_number_of_samples_ = waveform_number_of_samples_;
-        if (!preserve_waveforms_ or _waveforms_.get_samples().size() == 0) {
+        if (!preserve_waveforms_ or _waveforms_.get_number_of_samples() == 0) {
           _waveforms_.reset(_waveform_number_of_samples_);
         } else {
           DT_THROW_IF(
-            _waveforms_.get_samples().size() != _waveform_number_of_samples_,
+            _waveforms_.get_number_of_samples() != _waveform_number_of_samples_,
             std::logic_error,
             "Waveforms current depth does not match the number of samples!");
         }
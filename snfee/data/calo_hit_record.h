@@ -23,6 +23,7 @@
 #define SNFEE_DATA_CALO_HIT_RECORD_H
 
 // Standard Library:
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -62,9 +63,21 @@ namespace snfee {
       /// Default constructor
       calo_hit_record();
 
+      /// Copy constructor
+      calo_hit_record(const calo_hit_record&) = default;
+
+      /// Move constructor (the waveforms are moved, not copied)
+      calo_hit_record(calo_hit_record&&) = default;
+
       /// Destructor
       virtual ~calo_hit_record();
 
+      /// Copy assignment (the storage of the waveforms is reused)
+      calo_hit_record& operator=(const calo_hit_record&) = default;
+
+      /// Move assignment
+      calo_hit_record& operator=(calo_hit_record&&) = default;
+
       /// Check if the record is complete
       bool is_complete() const;
 
@@ -112,21 +125,104 @@ namespace snfee {
         uint16_t _adc_[snfee::model::feb_constants::SAMLONG_NUMBER_OF_CHANNELS];
 
         friend class calo_hit_record;
+        friend struct waveforms_record;
+      };
+
+      /// \brief Contiguous view on the ADC samples of a channel
+      ///
+      /// The view does not own the samples and is invalidated by any
+      /// change of the number of samples of the waveforms record.
+      template <typename Adc>
+      class channel_samples_view {
+      public:
+        /// Constructor
+        channel_samples_view(Adc* data_, const std::size_t size_)
+          : _data_(data_), _size_(size_)
+        {
+          return;
+        }
+
+        /// Return the address of the first sample
+        Adc*
+        data() const
+        {
+          return _data_;
+        }
+
+        /// Return the number of samples
+        std::size_t
+        size() const
+        {
+          return _size_;
+        }
+
+        /// Check if the view is empty
+        bool
+        empty() const
+        {
+          return _size_ == 0;
+        }
+
+        /// Return the first sample
+        Adc*
+        begin() const
+        {
+          return _data_;
+        }
+
+        /// Return past the last sample
+        Adc*
+        end() const
+        {
+          return _data_ + _size_;
+        }
+
+        /// Return the ADC value at a given sample (no range check)
+        Adc& operator[](const std::size_t sample_index_) const
+        {
+          return _data_[sample_index_];
+        }
+
+      private:
+        Adc* _data_ = nullptr;  ///< First sample
+        std::size_t _size_ = 0; ///< Number of samples
       };
 
       /// \brief Waveforms record for the SAMLONG ASIC (2-channels waveforms
       /// data)
       ///
-      /// Up to 1024 records of type \t two_channel_adc_record_type
+      /// Up to 1024 samples per channel. The samples of each channel are
+      /// stored contiguously so that they can be processed in bulk through
+      /// the views returned by channel_samples.
       struct waveforms_record {
       public:
+        /// Read-only view on the samples of a channel
+        typedef channel_samples_view<const uint16_t> const_samples_view;
+
+        /// Mutable view on the samples of a channel
+        typedef channel_samples_view<uint16_t> samples_view;
+
         /// Constructor
         waveforms_record(
           const uint16_t nb_samples_ =
             snfee::model::feb_constants::SAMLONG_MAX_NUMBER_OF_SAMPLES);
 
-        /// Return the vector of ADC samples
-        const std::vector<two_channel_adc_record>& get_samples() const;
+        /// Return the number of samples per channel
+        std::size_t get_number_of_samples() const;
+
+        /// Return a copy of the ADC samples as two-channel records
+        ///
+        /// Prefer channel_samples which does not copy the samples.
+        std::vector<two_channel_adc_record> get_samples() const;
+
+        /// Return the read-only view on the samples of a given channel
+        const_samples_view channel_samples(const uint16_t channel_) const;
+
+        /// Return the mutable view on the samples of a given channel
+        ///
+        /// No range check is done on values written through the view, it
+        /// is meant for bulk decoders.
+        samples_view channel_samples(const uint16_t channel_);
 
         /// Set a ADC value at a given sample and channel
         void set_adc(const uint16_t sample_index_,
@@ -140,12 +236,15 @@ namespace snfee {
         /// Reset the vector of ADC samples
         void reset(const uint16_t nb_samples_);
 
+        /// Resize the vector of ADC samples, keeping the first ADC values
+        void resize(const uint16_t nb_samples_);
+
         /// Invalidate the record
         void invalidate();
 
       private:
-        /// Vector of two-channel ADC samples
-        std::vector<two_channel_adc_record> _samples_;
+        /// ADC samples of channel #0 followed by the ones of channel #1
+        std::vector<uint16_t> _adc_;
 
         BOOST_SERIALIZATION_BASIC_DECLARATION()
       };
@@ -28,6 +28,10 @@ namespace snfee {
       ar_& boost::serialization::make_nvp("trig", _trig_);
       ar_& boost::serialization::make_nvp("calo_hits", _calo_hits_);
       ar_& boost::serialization::make_nvp("tracker_hits", _tracker_hits_);
+      if (Archive::is_loading::value) {
+        // Loaded hit records are created modifiable:
+        _modifiable_hits_ = true;
+      }
       return;
     }
 
@@ -60,6 +60,7 @@ namespace snfee {
       _trig_.reset();
       _calo_hits_.clear();
       _tracker_hits_.clear();
+      _modifiable_hits_ = true;
       return;
     }
 
@@ -223,6 +224,18 @@ namespace snfee {
 
     void
     raw_trigger_data::append_calo_hit(const const_calo_hit_record_ptr& chrp_)
+    {
+      DT_THROW_IF(!chrp_ or !chrp_->is_complete(),
+                  std::logic_error,
+                  "Calo hit record is not complete!");
+      _calo_hits_.push_back(chrp_);
+      // The hit record may have been created const:
+      _modifiable_hits_ = false;
+      return;
+    }
+
+    void
+    raw_trigger_data::append_calo_hit(const calo_hit_record_ptr& chrp_)
     {
       DT_THROW_IF(!chrp_ or !chrp_->is_complete(),
                   std::logic_error,
@@ -240,6 +253,18 @@ namespace snfee {
     void
     raw_trigger_data::append_tracker_hit(
       const const_tracker_hit_record_ptr& thrp_)
+    {
+      DT_THROW_IF(!thrp_ or !thrp_->is_complete(),
+                  std::logic_error,
+                  "Tracker hit record is not complete!");
+      _tracker_hits_.push_back(thrp_);
+      // The hit record may have been created const:
+      _modifiable_hits_ = false;
+      return;
+    }
+
+    void
+    raw_trigger_data::append_tracker_hit(const tracker_hit_record_ptr& thrp_)
     {
       DT_THROW_IF(!thrp_ or !thrp_->is_complete(),
                   std::logic_error,
@@ -254,6 +279,31 @@ namespace snfee {
       return _tracker_hits_;
     }
 
+    bool
+    raw_trigger_data::has_modifiable_hits() const
+    {
+      return _modifiable_hits_;
+    }
+
+    calo_hit_record_ptr
+    raw_trigger_data::grab_calo_hit(const std::size_t index_)
+    {
+      DT_THROW_IF(!_modifiable_hits_,
+                  std::logic_error,
+                  "Hit records are not modifiable!");
+      return std::const_pointer_cast<calo_hit_record>(_calo_hits_.at(index_));
+    }
+
+    tracker_hit_record_ptr
+    raw_trigger_data::grab_tracker_hit(const std::size_t index_)
+    {
+      DT_THROW_IF(!_modifiable_hits_,
+                  std::logic_error,
+                  "Hit records are not modifiable!");
+      return std::const_pointer_cast<tracker_hit_record>(
+        _tracker_hits_.at(index_));
+    }
+
     // friend
     std::ostream&
     operator<<(std::ostream& out_, const raw_trigger_data& rtd_)
@@ -102,15 +102,34 @@ namespace snfee {
       //! Append a new calo hit record
       void append_calo_hit(const const_calo_hit_record_ptr&);
 
+      //! Append a new modifiable calo hit record
+      void append_calo_hit(const calo_hit_record_ptr&);
+
       //! Return the collection of calorimeter hit records
       const std::vector<const_calo_hit_record_ptr>& get_calo_hits() const;
 
       //! Append a new tracker hit record
       void append_tracker_hit(const const_tracker_hit_record_ptr&);
 
+      //! Append a new modifiable tracker hit record
+      void append_tracker_hit(const tracker_hit_record_ptr&);
+
       //! Return the collection of tracker hit records
       const std::vector<const_tracker_hit_record_ptr>& get_tracker_hits() const;
 
+      //! Check if the hit records are all modifiable
+      //!
+      //! The hit records loaded from a file or appended through modifiable
+      //! handles are modifiable, so that the consumer of the record can move
+      //! their content.
+      bool has_modifiable_hits() const;
+
+      //! Return a modifiable handle for a calorimeter hit record
+      calo_hit_record_ptr grab_calo_hit(const std::size_t index_);
+
+      //! Return a modifiable handle for a tracker hit record
+      tracker_hit_record_ptr grab_tracker_hit(const std::size_t index_);
+
       //! Print
       friend std::ostream& operator<<(std::ostream& out_,
                                       const raw_trigger_data& rtd_);
@@ -123,6 +142,7 @@ namespace snfee {
         _calo_hits_; ///< Collection of handles for calorimeter hit records
       std::vector<const_tracker_hit_record_ptr>
         _tracker_hits_; ///< Collection of handles for tracker hit records
+      bool _modifiable_hits_ = true; ///< Flag for modifiable hit records
 
       DATATOOLS_SERIALIZATION_DECLARATION()
     };
@@ -1,35 +1,134 @@
 #include "snfee/data/rtdReformater.h"
 
+// Standard library:
+#include <algorithm>
+#include <memory>
+#include <utility>
+
 namespace snfee {
   namespace data {
 
-    snfee::data::RRawTriggerData
-    rtdOnlineToOffline(const snfee::data::raw_trigger_data& rawRTD)
-    {
-      int32_t runID{rawRTD.get_run_id()};
-      int32_t triggerID{rawRTD.get_trigger_id()};
+    namespace {
 
-      snfee::data::TriggerRecord triggerRec{};
-      if (rawRTD.has_trig()) {
-        triggerRec = *(rawRTD.get_trig());
+      //! Overwrite a record of a collection of records, or append it
+      template <typename Record, typename Value>
+      void
+      assignRecord(std::vector<Record>& output,
+                   const std::size_t index,
+                   Value&& record)
+      {
+        if (index < output.size()) {
+          output[index] = std::forward<Value>(record);
+        } else {
+          output.push_back(std::forward<Value>(record));
+        }
+        return;
       }
 
-      const auto& inputCaloRec = rawRTD.get_calo_hits();
-      snfee::data::CaloRecordCollection outputCaloRec{};
-
-      for (const auto& crec : inputCaloRec) {
-        outputCaloRec.push_back(*crec);
+      //! Copy the records of a collection of handles to a collection of
+      //! records, overwriting its first elements
+      template <typename Record>
+      void
+      copyRecords(const std::vector<std::shared_ptr<const Record>>& input,
+                  std::vector<Record>& output)
+      {
+        output.reserve(input.size());
+        for (std::size_t i = 0; i < input.size(); i++) {
+          assignRecord(output, i, *input[i]);
+        }
+        output.erase(output.begin() + input.size(), output.end());
+        return;
       }
 
-      const auto& inputTrackerRec = rawRTD.get_tracker_hits();
-      snfee::data::TrackerRecordCollection outputTrackerRec;
+      //! Move or copy the records of a collection of handles to a
+      //! collection of records, overwriting its first elements
+      //!
+      //! The modifiable handle of a record is returned by grab.
+      template <typename Record, typename Grab>
+      void
+      moveRecords(const std::vector<std::shared_ptr<const Record>>& input,
+                  Grab grab,
+                  std::vector<Record>& output)
+      {
+        output.reserve(input.size());
+        for (std::size_t i = 0; i < input.size(); i++) {
+          // A record held by the input handle only cannot be seen from
+          // elsewhere, it is moved:
+          if (input[i].use_count() == 1) {
+            assignRecord(output, i, std::move(*grab(i)));
+          } else {
+            assignRecord(output, i, *input[i]);
+          }
+        }
+        output.erase(output.begin() + input.size(), output.end());
+        return;
+      }
 
-      for (const auto& crec : inputTrackerRec) {
-        outputTrackerRec.push_back(*crec);
+      //! Convert the identifiers and the trigger record of an "online" RTD
+      //! record to an existing "offline" record
+      void
+      convertTrigger(const snfee::data::raw_trigger_data& rawRTD,
+                     snfee::data::RRawTriggerData& offlineRTD)
+      {
+        offlineRTD.setRunID(rawRTD.get_run_id());
+        offlineRTD.setTriggerID(rawRTD.get_trigger_id());
+        if (rawRTD.has_trig()) {
+          offlineRTD.grabTriggerRecord() = *(rawRTD.get_trig());
+        } else {
+          offlineRTD.grabTriggerRecord() = snfee::data::TriggerRecord{};
+        }
+        return;
       }
 
-      return snfee::data::RRawTriggerData{
-        runID, triggerID, triggerRec, outputCaloRec, outputTrackerRec};
+    } // namespace
+
+    snfee::data::RRawTriggerData
+    rtdOnlineToOffline(const snfee::data::raw_trigger_data& rawRTD)
+    {
+      snfee::data::RRawTriggerData offlineRTD;
+      rtdOnlineToOffline(rawRTD, offlineRTD);
+      return offlineRTD;
+    }
+
+    snfee::data::RRawTriggerData
+    rtdOnlineToOffline(snfee::data::raw_trigger_data&& rawRTD)
+    {
+      snfee::data::RRawTriggerData offlineRTD;
+      rtdOnlineToOffline(std::move(rawRTD), offlineRTD);
+      return offlineRTD;
+    }
+
+    void
+    rtdOnlineToOffline(const snfee::data::raw_trigger_data& rawRTD,
+                       snfee::data::RRawTriggerData& offlineRTD)
+    {
+      convertTrigger(rawRTD, offlineRTD);
+      copyRecords(rawRTD.get_calo_hits(), offlineRTD.grabCaloRecords());
+      copyRecords(rawRTD.get_tracker_hits(), offlineRTD.grabTrackerRecords());
+      return;
+    }
+
+    void
+    rtdOnlineToOffline(snfee::data::raw_trigger_data&& rawRTD,
+                       snfee::data::RRawTriggerData& offlineRTD)
+    {
+      if (!rawRTD.has_modifiable_hits()) {
+        // Some hit records may have been created const, none is moved:
+        rtdOnlineToOffline(rawRTD, offlineRTD);
+        rawRTD.invalidate();
+        return;
+      }
+      convertTrigger(rawRTD, offlineRTD);
+      moveRecords(
+        rawRTD.get_calo_hits(),
+        [&rawRTD](const std::size_t i) { return rawRTD.grab_calo_hit(i); },
+        offlineRTD.grabCaloRecords());
+      moveRecords(
+        rawRTD.get_tracker_hits(),
+        [&rawRTD](const std::size_t i) { return rawRTD.grab_tracker_hit(i); },
+        offlineRTD.grabTrackerRecords());
+      rawRTD.invalidate();
+      return;
     }
 
   } // namespace data
@@ -13,6 +13,43 @@ namespace snfee {
     snfee::data::RRawTriggerData rtdOnlineToOffline(
       const snfee::data::raw_trigger_data& rawRTD);
 
+    //! Convert input "online" RTD record to "offline" format, consuming
+    //! the input record (see below)
+    snfee::data::RRawTriggerData rtdOnlineToOffline(
+      snfee::data::raw_trigger_data&& rawRTD);
+
+    //! Convert input "online" RTD record to an existing "offline" record
+    //!
+    //! The hit collections of the output record and the waveforms of its
+    //! calorimeter hits are overwritten in place, so that an output record
+    //! reused from one event to the next needs no new allocation once it
+    //! has seen the largest event.
+    void rtdOnlineToOffline(const snfee::data::raw_trigger_data& rawRTD,
+                            snfee::data::RRawTriggerData& offlineRTD);
+
+    //! Convert input "online" RTD record to an existing "offline" record,
+    //! consuming the input record
+    //!
+    //! The hits only held by the input record are moved (with their
+    //! waveforms) instead of copied, the others are copied. No hit is moved
+    //! if one may have been created const, i.e. appended to the input
+    //! record through a const handle (see
+    //! raw_trigger_data::has_modifiable_hits). The input record is
+    //! invalidated.
+    //!
+    //! Usage:
+    //! \code
+    //! snfee::data::raw_trigger_data onlineRTD;
+    //! snfee::data::RRawTriggerData offlineRTD;
+    //! while (reader.has_record_tag()) {
+    //!   reader.load(onlineRTD);
+    //!   snfee::data::rtdOnlineToOffline(std::move(onlineRTD), offlineRTD);
+    //!   ...
+    //! }
+    //! \endcode
+    void rtdOnlineToOffline(snfee::data::raw_trigger_data&& rawRTD,
+                            snfee::data::RRawTriggerData& offlineRTD);
+
   } // namespace data
 } // namespace snfee
 
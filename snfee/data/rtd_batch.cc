@@ -0,0 +1,318 @@
+// snfee/data/rtd_batch.cc
+
+// Ourselves:
+#include <snfee/data/rtd_batch.h>
+
+// Standard library:
+#include <algorithm>
+#include <limits>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snfee {
+  namespace data {
+
+    namespace {
+
+      //! Reserve the columns of a SAMLONG channel
+      void
+      reserve_channel(rtd_batch::calo_channel_columns& columns_,
+                      const std::size_t nb_hits_)
+      {
+        columns_.lt.reserve(nb_hits_);
+        columns_.ht.reserve(nb_hits_);
+        columns_.underflow.reserve(nb_hits_);
+        columns_.overflow.reserve(nb_hits_);
+        columns_.baseline.reserve(nb_hits_);
+        columns_.peak.reserve(nb_hits_);
+        columns_.peak_cell.reserve(nb_hits_);
+        columns_.charge.reserve(nb_hits_);
+        columns_.rising_cell.reserve(nb_hits_);
+        columns_.falling_cell.reserve(nb_hits_);
+        return;
+      }
+
+      //! Clear the columns of a SAMLONG channel
+      void
+      clear_channel(rtd_batch::calo_channel_columns& columns_)
+      {
+        columns_.lt.clear();
+        columns_.ht.clear();
+        columns_.underflow.clear();
+        columns_.overflow.clear();
+        columns_.baseline.clear();
+        columns_.peak.clear();
+        columns_.peak_cell.clear();
+        columns_.charge.clear();
+        columns_.rising_cell.clear();
+        columns_.falling_cell.clear();
+        return;
+      }
+
+      //! Append the data of a SAMLONG channel
+      void
+      append_channel(
+        rtd_batch::calo_channel_columns& columns_,
+        const calo_hit_record::channel_data_record& channel_data_)
+      {
+        columns_.lt.push_back(channel_data_.is_lt());
+        columns_.ht.push_back(channel_data_.is_ht());
+        columns_.underflow.push_back(channel_data_.is_underflow());
+        columns_.overflow.push_back(channel_data_.is_overflow());
+        columns_.baseline.push_back(channel_data_.get_baseline());
+        columns_.peak.push_back(channel_data_.get_peak());
+        columns_.peak_cell.push_back(channel_data_.get_peak_cell());
+        columns_.charge.push_back(channel_data_.get_charge());
+        columns_.rising_cell.push_back(channel_data_.get_rising_cell());
+        columns_.falling_cell.push_back(channel_data_.get_falling_cell());
+        return;
+      }
+
+    } // namespace
+
+    rtd_batch::rtd_batch()
+    {
+      calo_hit_offset.push_back(0);
+      tracker_hit_offset.push_back(0);
+      return;
+    }
+
+    void
+    rtd_batch::clear()
+    {
+      run_id.clear();
+      trigger_id.clear();
+      has_trig.clear();
+      calo_hit_offset.assign(1, 0);
+      tracker_hit_offset.assign(1, 0);
+      calo_tdc.clear();
+      calo_crate_num.clear();
+      calo_board_num.clear();
+      calo_chip_num.clear();
+      calo_event_id.clear();
+      calo_l2_id.clear();
+      calo_fcr.clear();
+      calo_has_waveforms.clear();
+      calo_waveform_start_sample.clear();
+      calo_waveform_number_of_samples.clear();
+      calo_waveform_offset.clear();
+      clear_channel(calo_channels[0]);
+      clear_channel(calo_channels[1]);
+      calo_waveforms.clear();
+      tracker_crate_num.clear();
+      tracker_board_num.clear();
+      tracker_chip_num.clear();
+      tracker_channel_num.clear();
+      tracker_channel_category.clear();
+      tracker_timestamp_category.clear();
+      tracker_timestamp.clear();
+      return;
+    }
+
+    void
+    rtd_batch::reserve(const std::size_t nb_events_,
+                       const std::size_t nb_calo_hits_,
+                       const std::size_t nb_tracker_hits_,
+                       const std::size_t nb_waveform_samples_)
+    {
+      run_id.reserve(nb_events_);
+      trigger_id.reserve(nb_events_);
+      has_trig.reserve(nb_events_);
+      calo_hit_offset.reserve(nb_events_ + 1);
+      tracker_hit_offset.reserve(nb_events_ + 1);
+      calo_tdc.reserve(nb_calo_hits_);
+      calo_crate_num.reserve(nb_calo_hits_);
+      calo_board_num.reserve(nb_calo_hits_);
+      calo_chip_num.reserve(nb_calo_hits_);
+      calo_event_id.reserve(nb_calo_hits_);
+      calo_l2_id.reserve(nb_calo_hits_);
+      calo_fcr.reserve(nb_calo_hits_);
+      calo_has_waveforms.reserve(nb_calo_hits_);
+      calo_waveform_start_sample.reserve(nb_calo_hits_);
+      calo_waveform_number_of_samples.reserve(nb_calo_hits_);
+      calo_waveform_offset.reserve(nb_calo_hits_);
+      reserve_channel(calo_channels[0], nb_calo_hits_);
+      reserve_channel(calo_channels[1], nb_calo_hits_);
+      calo_waveforms.reserve(nb_waveform_samples_);
+      tracker_crate_num.reserve(nb_tracker_hits_);
+      tracker_board_num.reserve(nb_tracker_hits_);
+      tracker_chip_num.reserve(nb_tracker_hits_);
+      tracker_channel_num.reserve(nb_tracker_hits_);
+      tracker_channel_category.reserve(nb_tracker_hits_);
+      tracker_timestamp_category.reserve(nb_tracker_hits_);
+      tracker_timestamp.reserve(nb_tracker_hits_);
+      return;
+    }
+
+    std::size_t
+    rtd_batch::size() const
+    {
+      return trigger_id.size();
+    }
+
+    bool
+    rtd_batch::empty() const
+    {
+      return trigger_id.empty();
+    }
+
+    std::size_t
+    rtd_batch::get_number_of_calo_hits() const
+    {
+      return calo_tdc.size();
+    }
+
+    std::size_t
+    rtd_batch::get_number_of_tracker_hits() const
+    {
+      return tracker_timestamp.size();
+    }
+
+    std::size_t
+    rtd_batch::get_number_of_calo_hits(const std::size_t event_) const
+    {
+      DT_THROW_IF(event_ >= size(),
+                  std::range_error,
+                  "Invalid event index [" << event_ << "]!");
+      return calo_hit_offset[event_ + 1] - calo_hit_offset[event_];
+    }
+
+    std::size_t
+    rtd_batch::get_number_of_tracker_hits(const std::size_t event_) const
+    {
+      DT_THROW_IF(event_ >= size(),
+                  std::range_error,
+                  "Invalid event index [" << event_ << "]!");
+      return tracker_hit_offset[event_ + 1] - tracker_hit_offset[event_];
+    }
+
+    const int16_t*
+    rtd_batch::calo_waveform(const std::size_t hit_,
+                             const uint16_t channel_) const
+    {
+      DT_THROW_IF(hit_ >= get_number_of_calo_hits(),
+                  std::range_error,
+                  "Invalid calorimeter hit index [" << hit_ << "]!");
+      DT_THROW_IF(channel_ > 1,
+                  std::logic_error,
+                  "Invalid SAMLONG channel index [" << channel_ << "]!");
+      return calo_waveforms.data() + calo_waveform_offset[hit_] +
+             channel_ * calo_waveform_number_of_samples[hit_];
+    }
+
+    void
+    rtd_batch::append(const raw_trigger_data& rtd_)
+    {
+      _append_event_(
+        rtd_.get_run_id(), rtd_.get_trigger_id(), rtd_.has_trig());
+      for (const auto& hchit : rtd_.get_calo_hits()) {
+        _append_calo_hit_(*hchit);
+      }
+      for (const auto& hthit : rtd_.get_tracker_hits()) {
+        _append_tracker_hit_(*hthit);
+      }
+      _close_event_();
+      return;
+    }
+
+    void
+    rtd_batch::append(const RRawTriggerData& rtd_)
+    {
+      _append_event_(rtd_.getRunID(),
+                     rtd_.getTriggerID(),
+                     rtd_.getTriggerRecord().is_complete());
+      for (const auto& chit : rtd_.getCaloRecords()) {
+        _append_calo_hit_(chit);
+      }
+      for (const auto& thit : rtd_.getTrackerRecords()) {
+        _append_tracker_hit_(thit);
+      }
+      _close_event_();
+      return;
+    }
+
+    void
+    rtd_batch::_append_event_(const int32_t run_id_,
+                              const int32_t trigger_id_,
+                              const bool has_trig_)
+    {
+      run_id.push_back(run_id_);
+      trigger_id.push_back(trigger_id_);
+      has_trig.push_back(has_trig_);
+      return;
+    }
+
+    void
+    rtd_batch::_append_calo_hit_(const calo_hit_record& hit_)
+    {
+      calo_tdc.push_back(hit_.get_tdc());
+      calo_crate_num.push_back(hit_.get_crate_num());
+      calo_board_num.push_back(hit_.get_board_num());
+      calo_chip_num.push_back(hit_.get_chip_num());
+      calo_event_id.push_back(hit_.get_event_id());
+      calo_l2_id.push_back(hit_.get_l2_id());
+      calo_fcr.push_back(hit_.get_fcr());
+      calo_has_waveforms.push_back(hit_.has_waveforms());
+      append_channel(calo_channels[0], hit_.get_channel_data(0));
+      append_channel(calo_channels[1], hit_.get_channel_data(1));
+
+      // Waveforms (channel #0 then channel #1):
+      const calo_hit_record::waveforms_record& waveforms =
+        hit_.get_waveforms();
+      std::size_t nb_samples = 0;
+      uint16_t start_sample = calo_hit_record::INVALID_WAVEFORM_START_SAMPLE;
+      if (hit_.has_waveforms()) {
+        start_sample = hit_.get_waveform_start_sample();
+        nb_samples =
+          std::min<std::size_t>(hit_.get_waveform_number_of_samples(),
+                                waveforms.get_number_of_samples());
+      }
+      calo_waveform_start_sample.push_back(start_sample);
+      calo_waveform_number_of_samples.push_back(nb_samples);
+      calo_waveform_offset.push_back(calo_waveforms.size());
+      const calo_hit_record::waveforms_record::const_samples_view
+        ch0_samples = waveforms.channel_samples(0);
+      const calo_hit_record::waveforms_record::const_samples_view
+        ch1_samples = waveforms.channel_samples(1);
+      calo_waveforms.insert(calo_waveforms.end(),
+                            ch0_samples.begin(),
+                            ch0_samples.begin() + nb_samples);
+      calo_waveforms.insert(calo_waveforms.end(),
+                            ch1_samples.begin(),
+                            ch1_samples.begin() + nb_samples);
+      return;
+    }
+
+    void
+    rtd_batch::_append_tracker_hit_(const tracker_hit_record& hit_)
+    {
+      tracker_crate_num.push_back(hit_.get_crate_num());
+      tracker_board_num.push_back(hit_.get_board_num());
+      tracker_chip_num.push_back(hit_.get_chip_num());
+      tracker_channel_num.push_back(hit_.get_channel_num());
+      tracker_channel_category.push_back(
+        (int16_t)hit_.get_channel_category());
+      tracker_timestamp_category.push_back(
+        (int16_t)hit_.get_timestamp_category());
+      tracker_timestamp.push_back(hit_.get_timestamp());
+      return;
+    }
+
+    void
+    rtd_batch::_close_event_()
+    {
+      DT_THROW_IF(
+        get_number_of_calo_hits() > std::numeric_limits<uint32_t>::max() or
+          get_number_of_tracker_hits() >
+            std::numeric_limits<uint32_t>::max(),
+        std::logic_error,
+        "Too many hits in the batch!");
+      calo_hit_offset.push_back(get_number_of_calo_hits());
+      tracker_hit_offset.push_back(get_number_of_tracker_hits());
+      return;
+    }
+
+  } // namespace data
+} // namespace snfee
@@ -0,0 +1,153 @@
+//! \file snfee/data/rtd_batch.h
+//! \brief Columnar batch of raw trigger data records
+
+#ifndef SNFEE_DATA_RTD_BATCH_H
+#define SNFEE_DATA_RTD_BATCH_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// This project:
+#include <snfee/data/RRawTriggerData.h>
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/data/tracker_hit_record.h>
+
+namespace snfee {
+  namespace data {
+
+    //! \brief Columnar (structure of arrays) batch of RTD records
+    //!
+    //! Each field of the hits of all the events of the batch is stored in
+    //! its own contiguous array, so that a selection or an export runs
+    //! through dense arrays instead of chasing the handles of the
+    //! raw_trigger_data records. The hits of event #i are the entries
+    //! [calo_hit_offset[i], calo_hit_offset[i+1]) of the calorimeter
+    //! columns, and the same with tracker_hit_offset for the tracker
+    //! columns. The waveform samples of all the calorimeter hits are
+    //! concatenated in a single slab: the samples of channel #c of hit #j
+    //! start at calo_waveform_offset[j] + c * N, where N is
+    //! calo_waveform_number_of_samples[j] (0 if the hit has no waveforms).
+    //!
+    //! Flags are stored as bytes (not as std::vector<bool>) so that they
+    //! can be scanned in bulk.
+    //!
+    //! Usage:
+    //! \code
+    //! snfee::data::rtd_batch batch;
+    //! while (batch.size() < 1000 and reader.has_record_tag()) {
+    //!   reader.load(rtd);
+    //!   batch.append(rtd);
+    //! }
+    //! int64_t charge = 0;
+    //! const auto& ch0 = batch.calo_channels[0];
+    //! for (std::size_t ihit = 0; ihit < batch.get_number_of_calo_hits();
+    //!      ihit++) {
+    //!   charge += ch0.ht[ihit] ? ch0.charge[ihit] : 0;
+    //! }
+    //! \endcode
+    struct rtd_batch {
+      /// \brief Columns of the data of a SAMLONG channel of the calorimeter
+      /// hits
+      struct calo_channel_columns {
+        std::vector<uint8_t> lt;
+        std::vector<uint8_t> ht;
+        std::vector<uint8_t> underflow;
+        std::vector<uint8_t> overflow;
+        std::vector<int16_t> baseline;
+        std::vector<int16_t> peak;
+        std::vector<int16_t> peak_cell;
+        std::vector<int32_t> charge;
+        std::vector<int32_t> rising_cell;
+        std::vector<int32_t> falling_cell;
+      };
+
+      /// Default constructor
+      rtd_batch();
+
+      /// Remove all the events (the capacity of the columns is kept)
+      void clear();
+
+      /// Reserve the columns for a given number of events, hits and
+      /// waveform samples (both channels)
+      void reserve(const std::size_t nb_events_,
+                   const std::size_t nb_calo_hits_,
+                   const std::size_t nb_tracker_hits_,
+                   const std::size_t nb_waveform_samples_ = 0);
+
+      /// Return the number of events
+      std::size_t size() const;
+
+      /// Check if the batch has no event
+      bool empty() const;
+
+      /// Return the number of calorimeter hits of all the events
+      std::size_t get_number_of_calo_hits() const;
+
+      /// Return the number of tracker hits of all the events
+      std::size_t get_number_of_tracker_hits() const;
+
+      /// Return the number of calorimeter hits of an event
+      std::size_t get_number_of_calo_hits(const std::size_t event_) const;
+
+      /// Return the number of tracker hits of an event
+      std::size_t get_number_of_tracker_hits(const std::size_t event_) const;
+
+      /// Return the first waveform sample of a channel of a calorimeter hit
+      const int16_t* calo_waveform(const std::size_t hit_,
+                                   const uint16_t channel_) const;
+
+      /// Append an "online" RTD record
+      void append(const raw_trigger_data& rtd_);
+
+      /// Append an "offline" RTD record
+      void append(const RRawTriggerData& rtd_);
+
+      // Events:
+      std::vector<int32_t> run_id;
+      std::vector<int32_t> trigger_id;
+      std::vector<uint8_t> has_trig;
+      std::vector<uint32_t> calo_hit_offset;    ///< size() + 1 entries
+      std::vector<uint32_t> tracker_hit_offset; ///< size() + 1 entries
+
+      // Calo hit records:
+      std::vector<uint64_t> calo_tdc;
+      std::vector<int16_t> calo_crate_num;
+      std::vector<int16_t> calo_board_num;
+      std::vector<int16_t> calo_chip_num;
+      std::vector<uint16_t> calo_event_id;
+      std::vector<uint16_t> calo_l2_id;
+      std::vector<uint16_t> calo_fcr;
+      std::vector<uint8_t> calo_has_waveforms;
+      std::vector<uint16_t> calo_waveform_start_sample;
+      std::vector<uint16_t> calo_waveform_number_of_samples;
+      std::vector<uint64_t> calo_waveform_offset;
+      calo_channel_columns calo_channels[2];
+
+      // Calo hit waveforms (both channels of all the hits):
+      std::vector<int16_t> calo_waveforms;
+
+      // Tracker hit records:
+      std::vector<int16_t> tracker_crate_num;
+      std::vector<int16_t> tracker_board_num;
+      std::vector<int16_t> tracker_chip_num;
+      std::vector<int16_t> tracker_channel_num;
+      std::vector<int16_t> tracker_channel_category;
+      std::vector<int16_t> tracker_timestamp_category;
+      std::vector<uint64_t> tracker_timestamp;
+
+    private:
+      void _append_event_(const int32_t run_id_,
+                          const int32_t trigger_id_,
+                          const bool has_trig_);
+      void _append_calo_hit_(const calo_hit_record& hit_);
+      void _append_tracker_hit_(const tracker_hit_record& hit_);
+      void _close_event_();
+    };
+
+  } // namespace data
+} // namespace snfee
+
+#endif // SNFEE_DATA_RTD_BATCH_H
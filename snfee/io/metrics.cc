@@ -0,0 +1,599 @@
+// snfee/io/metrics.cc
+
+// Ourselves:
+#include <snfee/io/metrics.h>
+
+// Standard library:
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/logger.h>
+#include <bayeux/datatools/utils.h>
+
+namespace snfee {
+  namespace io {
+
+    namespace {
+
+      /// Upper bound of the first bucket of the histograms (s)
+      const double FIRST_BUCKET_BOUND = 1.0e-6;
+
+      /// Number of significant digits of the exported values
+      const int EXPORT_PRECISION = 15;
+
+      /// Return the name of a type of metric
+      const char*
+      kind_label(const metrics_registry::kind_type kind_)
+      {
+        switch (kind_) {
+          case metrics_registry::KIND_GAUGE:
+            return "gauge";
+          case metrics_registry::KIND_HISTOGRAM:
+            return "histogram";
+          default:
+            return "counter";
+        }
+      }
+
+      /// Return a string with the special characters escaped
+      std::string
+      escape_string(const std::string& str_, const bool json_)
+      {
+        std::string escaped;
+        escaped.reserve(str_.size());
+        for (const char c : str_) {
+          if (c == '\\' or c == '"') {
+            escaped += '\\';
+            escaped += c;
+          } else if (c == '\n') {
+            escaped += "\\n";
+          } else if (json_ and static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code,
+                          sizeof(code),
+                          "\\u%04x",
+                          static_cast<unsigned int>(c));
+            escaped += code;
+          } else {
+            escaped += c;
+          }
+        }
+        return escaped;
+      }
+
+      /// Return the labels of a sample in the Prometheus format, with an
+      /// optional extra label
+      std::string
+      prometheus_labels(const metrics_registry::labels_type& labels_,
+                        const std::string& extra_name_ = "",
+                        const std::string& extra_value_ = "")
+      {
+        metrics_registry::labels_type labels = labels_;
+        if (!extra_name_.empty()) {
+          labels.push_back(std::make_pair(extra_name_, extra_value_));
+        }
+        if (labels.empty()) {
+          return "";
+        }
+        std::ostringstream out;
+        out << '{';
+        for (std::size_t i = 0; i < labels.size(); i++) {
+          if (i > 0) {
+            out << ',';
+          }
+          out << labels[i].first << "=\""
+              << escape_string(labels[i].second, false) << '"';
+        }
+        out << '}';
+        return out.str();
+      }
+
+      /// Return the name of the rate metric associated to a counter
+      std::string
+      rate_name(const std::string& counter_name_)
+      {
+        const std::string suffix = "_total";
+        if (counter_name_.size() > suffix.size() and
+            counter_name_.compare(counter_name_.size() - suffix.size(),
+                                  suffix.size(),
+                                  suffix) == 0) {
+          return counter_name_.substr(0,
+                                      counter_name_.size() - suffix.size()) +
+                 "_rate";
+        }
+        return counter_name_ + "_rate";
+      }
+
+      /// Return the key identifying a sample between two snapshots
+      std::string
+      sample_key(const metrics_registry::sample_type& sample_)
+      {
+        return sample_.name + prometheus_labels(sample_.labels);
+      }
+
+    } // namespace
+
+    // Definitions of the static constants:
+    const std::size_t metrics_histogram::NUMBER_OF_BOUNDS;
+
+    // static
+    double
+    metrics_histogram::bucket_bound(const std::size_t ibucket_)
+    {
+      return std::ldexp(FIRST_BUCKET_BOUND, static_cast<int>(ibucket_));
+    }
+
+    void
+    metrics_histogram::observe(const double seconds_)
+    {
+      std::size_t ibucket = 0;
+      while (ibucket < NUMBER_OF_BOUNDS and seconds_ > bucket_bound(ibucket)) {
+        ibucket++;
+      }
+      _buckets_[ibucket].fetch_add(1, std::memory_order_relaxed);
+      _count_.fetch_add(1, std::memory_order_relaxed);
+      if (seconds_ > 0.0) {
+        _sum_ns_.fetch_add(static_cast<uint64_t>(seconds_ * 1.0e9),
+                           std::memory_order_relaxed);
+      }
+      return;
+    }
+
+    uint64_t
+    metrics_histogram::get_count() const
+    {
+      return _count_.load(std::memory_order_relaxed);
+    }
+
+    double
+    metrics_histogram::get_sum() const
+    {
+      return 1.0e-9 * _sum_ns_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t
+    metrics_histogram::get_bucket_count(const std::size_t ibucket_) const
+    {
+      DT_THROW_IF(ibucket_ > NUMBER_OF_BOUNDS,
+                  std::range_error,
+                  "Invalid bucket index " << ibucket_ << "!");
+      return _buckets_[ibucket_].load(std::memory_order_relaxed);
+    }
+
+    // static
+    metrics_registry&
+    metrics_registry::global()
+    {
+      static metrics_registry registry;
+      return registry;
+    }
+
+    // static
+    metrics_registry::format_type
+    metrics_registry::format_from_label(const std::string& label_)
+    {
+      if (label_ == "prometheus") {
+        return FORMAT_PROMETHEUS;
+      }
+      DT_THROW_IF(label_ != "json",
+                  std::logic_error,
+                  "Invalid metrics format '" << label_ << "'!");
+      return FORMAT_JSON;
+    }
+
+    metrics_registry::metrics_registry() { return; }
+
+    bool
+    metrics_registry::is_enabled() const
+    {
+      return _enabled_.load();
+    }
+
+    void
+    metrics_registry::set_enabled(const bool enabled_)
+    {
+      _enabled_.store(enabled_);
+      return;
+    }
+
+    metrics_registry::family_type&
+    metrics_registry::_family_(const std::string& name_,
+                               const std::string& help_,
+                               const kind_type kind_)
+    {
+      DT_THROW_IF(name_.empty(), std::logic_error, "Missing metric name!");
+      auto found = _families_.find(name_);
+      if (found == _families_.end()) {
+        found = _families_.emplace(name_, family_type()).first;
+        found->second.help = help_;
+        found->second.kind = kind_;
+      }
+      DT_THROW_IF(found->second.kind != kind_,
+                  std::logic_error,
+                  "Metric '" << name_ << "' is a "
+                             << kind_label(found->second.kind) << "!");
+      return found->second;
+    }
+
+    metrics_counter&
+    metrics_registry::make_counter(const std::string& name_,
+                                   const std::string& help_,
+                                   const labels_type& labels_)
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      family_type& family = _family_(name_, help_, KIND_COUNTER);
+      std::unique_ptr<metrics_counter>& counter = family.counters[labels_];
+      if (!counter) {
+        counter.reset(new metrics_counter);
+      }
+      return *counter;
+    }
+
+    metrics_gauge&
+    metrics_registry::make_gauge(const std::string& name_,
+                                 const std::string& help_,
+                                 const labels_type& labels_)
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      family_type& family = _family_(name_, help_, KIND_GAUGE);
+      std::unique_ptr<metrics_gauge>& gauge = family.gauges[labels_];
+      if (!gauge) {
+        gauge.reset(new metrics_gauge);
+      }
+      return *gauge;
+    }
+
+    metrics_histogram&
+    metrics_registry::make_histogram(const std::string& name_,
+                                     const std::string& help_,
+                                     const labels_type& labels_)
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      family_type& family = _family_(name_, help_, KIND_HISTOGRAM);
+      std::unique_ptr<metrics_histogram>& histogram =
+        family.histograms[labels_];
+      if (!histogram) {
+        histogram.reset(new metrics_histogram);
+      }
+      return *histogram;
+    }
+
+    metrics_registry::snapshot_type
+    metrics_registry::make_snapshot() const
+    {
+      snapshot_type snapshot;
+      const std::chrono::duration<double> since_epoch =
+        std::chrono::system_clock::now().time_since_epoch();
+      snapshot.timestamp = since_epoch.count();
+      std::lock_guard<std::mutex> lock(_mutex_);
+      for (const auto& family_entry : _families_) {
+        const family_type& family = family_entry.second;
+        sample_type sample;
+        sample.name = family_entry.first;
+        sample.help = family.help;
+        sample.kind = family.kind;
+        for (const auto& counter : family.counters) {
+          sample.labels = counter.first;
+          sample.value = counter.second->get();
+          snapshot.samples.push_back(sample);
+        }
+        for (const auto& gauge : family.gauges) {
+          sample.labels = gauge.first;
+          sample.value = gauge.second->get();
+          snapshot.samples.push_back(sample);
+        }
+        for (const auto& histogram : family.histograms) {
+          const metrics_histogram& h = *histogram.second;
+          sample.labels = histogram.first;
+          sample.buckets.assign(metrics_histogram::NUMBER_OF_BOUNDS + 1, 0);
+          uint64_t cumulated = 0;
+          for (std::size_t ibucket = 0; ibucket < sample.buckets.size();
+               ibucket++) {
+            cumulated += h.get_bucket_count(ibucket);
+            sample.buckets[ibucket] = cumulated;
+          }
+          // Concurrent observations may not be fully accounted for in the
+          // buckets yet:
+          sample.count = cumulated;
+          sample.sum = h.get_sum();
+          snapshot.samples.push_back(sample);
+        }
+      }
+      return snapshot;
+    }
+
+    // static
+    void
+    metrics_registry::export_prometheus(const snapshot_type& snapshot_,
+                                        std::ostream& out_)
+    {
+      std::ostringstream out;
+      out << std::setprecision(EXPORT_PRECISION);
+      std::size_t family_start = 0;
+      for (std::size_t isample = 0; isample < snapshot_.samples.size();
+           isample++) {
+        const sample_type& sample = snapshot_.samples[isample];
+        const bool first_of_family =
+          isample == 0 or snapshot_.samples[isample - 1].name != sample.name;
+        const bool last_of_family =
+          isample + 1 == snapshot_.samples.size() or
+          snapshot_.samples[isample + 1].name != sample.name;
+        if (first_of_family) {
+          family_start = isample;
+          out << "# HELP " << sample.name << ' '
+              << escape_string(sample.help, false) << '\n';
+          out << "# TYPE " << sample.name << ' ' << kind_label(sample.kind)
+              << '\n';
+        }
+        if (sample.kind == KIND_HISTOGRAM) {
+          for (std::size_t ibucket = 0; ibucket < sample.buckets.size();
+               ibucket++) {
+            std::ostringstream bound;
+            bound << std::setprecision(EXPORT_PRECISION);
+            if (ibucket < metrics_histogram::NUMBER_OF_BOUNDS) {
+              bound << metrics_histogram::bucket_bound(ibucket);
+            } else {
+              bound << "+Inf";
+            }
+            out << sample.name << "_bucket"
+                << prometheus_labels(sample.labels, "le", bound.str()) << ' '
+                << sample.buckets[ibucket] << '\n';
+          }
+          out << sample.name << "_sum" << prometheus_labels(sample.labels)
+              << ' ' << sample.sum << '\n';
+          out << sample.name << "_count" << prometheus_labels(sample.labels)
+              << ' ' << sample.count << '\n';
+        } else {
+          out << sample.name << prometheus_labels(sample.labels) << ' '
+              << sample.value << '\n';
+        }
+        if (last_of_family and sample.kind == KIND_COUNTER) {
+          // Rates of the counters of the family, as a separate gauge:
+          bool rate_header = false;
+          for (std::size_t irate = family_start; irate <= isample; irate++) {
+            const sample_type& counter = snapshot_.samples[irate];
+            if (!counter.has_rate) {
+              continue;
+            }
+            if (!rate_header) {
+              out << "# HELP " << rate_name(sample.name) << " Rate of "
+                  << sample.name << " over the last period (per second)\n";
+              out << "# TYPE " << rate_name(sample.name) << " gauge\n";
+              rate_header = true;
+            }
+            out << rate_name(sample.name) << prometheus_labels(counter.labels)
+                << ' ' << counter.rate << '\n';
+          }
+        }
+      }
+      out_ << out.str();
+      return;
+    }
+
+    // static
+    void
+    metrics_registry::export_json(const snapshot_type& snapshot_,
+                                  std::ostream& out_)
+    {
+      std::ostringstream out;
+      out << std::setprecision(EXPORT_PRECISION);
+      out << "{\n";
+      out << "  \"timestamp\": " << std::fixed << std::setprecision(3)
+          << snapshot_.timestamp << ",\n";
+      out.unsetf(std::ios_base::floatfield);
+      out << std::setprecision(EXPORT_PRECISION);
+      out << "  \"metrics\": [";
+      for (std::size_t isample = 0; isample < snapshot_.samples.size();
+           isample++) {
+        const sample_type& sample = snapshot_.samples[isample];
+        out << (isample == 0 ? "\n" : ",\n");
+        out << "    {\"name\": \"" << escape_string(sample.name, true)
+            << "\", \"type\": \"" << kind_label(sample.kind)
+            << "\", \"help\": \"" << escape_string(sample.help, true)
+            << "\", \"labels\": {";
+        for (std::size_t ilabel = 0; ilabel < sample.labels.size();
+             ilabel++) {
+          if (ilabel > 0) {
+            out << ", ";
+          }
+          out << '"' << escape_string(sample.labels[ilabel].first, true)
+              << "\": \"" << escape_string(sample.labels[ilabel].second, true)
+              << '"';
+        }
+        out << "}";
+        if (sample.kind == KIND_HISTOGRAM) {
+          out << ", \"count\": " << sample.count
+              << ", \"sum\": " << sample.sum << ", \"buckets\": [";
+          for (std::size_t ibucket = 0; ibucket < sample.buckets.size();
+               ibucket++) {
+            if (ibucket > 0) {
+              out << ", ";
+            }
+            out << "{\"le\": ";
+            if (ibucket < metrics_histogram::NUMBER_OF_BOUNDS) {
+              out << metrics_histogram::bucket_bound(ibucket);
+            } else {
+              out << "\"+Inf\"";
+            }
+            out << ", \"count\": " << sample.buckets[ibucket] << "}";
+          }
+          out << "]";
+        } else {
+          out << ", \"value\": " << sample.value;
+          if (sample.has_rate) {
+            out << ", \"rate\": " << sample.rate;
+          }
+        }
+        out << "}";
+      }
+      out << (snapshot_.samples.empty() ? "]\n" : "\n  ]\n");
+      out << "}\n";
+      out_ << out.str();
+      return;
+    }
+
+    void
+    metrics_dumper::config_type::add_options(
+      boost::program_options::options_description& opts_)
+    {
+      namespace po = boost::program_options;
+      // clang-format off
+      opts_.add_options()
+        ("metrics-file",
+         po::value<std::string>()->value_name("path"),
+         "periodically save the run time metrics in a file")
+
+        ("metrics-format",
+         po::value<std::string>()->value_name("format"),
+         "set the format of the metrics file (prometheus, json)")
+
+        ("metrics-period",
+         po::value<double>()->value_name("seconds"),
+         "set the period of the saving of the metrics (default: 10)")
+        ;
+      // clang-format on
+      return;
+    }
+
+    void
+    metrics_dumper::config_type::configure(
+      const boost::program_options::variables_map& vm_)
+    {
+      if (vm_.count("metrics-file")) {
+        filename = vm_["metrics-file"].as<std::string>();
+      }
+      if (vm_.count("metrics-format")) {
+        format = metrics_registry::format_from_label(
+          vm_["metrics-format"].as<std::string>());
+      }
+      if (vm_.count("metrics-period")) {
+        period = vm_["metrics-period"].as<double>();
+      }
+      return;
+    }
+
+    metrics_dumper::metrics_dumper(const config_type& config_,
+                                   metrics_registry& registry_)
+      : _config_(config_), _registry_(registry_)
+    {
+      DT_THROW_IF(_config_.filename.empty(),
+                  std::logic_error,
+                  "Missing metrics output filename!");
+      DT_THROW_IF(!(_config_.period > 0.0),
+                  std::logic_error,
+                  "Invalid metrics dump period!");
+      datatools::fetch_path_with_env(_config_.filename);
+      return;
+    }
+
+    metrics_dumper::~metrics_dumper()
+    {
+      try {
+        stop();
+      }
+      catch (std::exception& error) {
+        DT_LOG_ERROR(datatools::logger::PRIO_ERROR, error.what());
+      }
+      return;
+    }
+
+    void
+    metrics_dumper::start()
+    {
+      DT_THROW_IF(
+        _thread_.joinable(), std::logic_error, "Dumper is already started!");
+      // Check the output file before the run:
+      dump();
+      _stop_request_ = false;
+      _thread_ = std::thread(&metrics_dumper::_run_, this);
+      return;
+    }
+
+    void
+    metrics_dumper::stop()
+    {
+      if (_thread_.joinable()) {
+        {
+          std::lock_guard<std::mutex> lock(_mutex_);
+          _stop_request_ = true;
+        }
+        _cond_.notify_all();
+        _thread_.join();
+        dump();
+      }
+      return;
+    }
+
+    void
+    metrics_dumper::_run_()
+    {
+      const std::chrono::duration<double> period(_config_.period);
+      std::unique_lock<std::mutex> lock(_mutex_);
+      while (!_stop_request_) {
+        if (_cond_.wait_for(lock, period, [this] { return _stop_request_; })) {
+          break;
+        }
+        lock.unlock();
+        try {
+          dump();
+        }
+        catch (std::exception& error) {
+          // A failed dump must not stop the processing:
+          DT_LOG_ERROR(datatools::logger::PRIO_ERROR, error.what());
+        }
+        lock.lock();
+      }
+      return;
+    }
+
+    void
+    metrics_dumper::dump()
+    {
+      std::lock_guard<std::mutex> lock(_dump_mutex_);
+      metrics_registry::snapshot_type snapshot = _registry_.make_snapshot();
+      const double elapsed = snapshot.timestamp - _previous_timestamp_;
+      for (auto& sample : snapshot.samples) {
+        if (sample.kind != metrics_registry::KIND_COUNTER) {
+          continue;
+        }
+        const std::string key = sample_key(sample);
+        auto found = _previous_values_.find(key);
+        if (found != _previous_values_.end() and elapsed > 0.0) {
+          sample.has_rate = true;
+          sample.rate = (sample.value - found->second) / elapsed;
+        }
+        _previous_values_[key] = sample.value;
+      }
+      _previous_timestamp_ = snapshot.timestamp;
+      // The file is written aside then renamed, so that it is never seen
+      // partially written:
+      const std::string tmp_filename = _config_.filename + ".tmp";
+      {
+        std::ofstream fout(tmp_filename.c_str());
+        DT_THROW_IF(!fout,
+                    std::logic_error,
+                    "Cannot open metrics file '" << tmp_filename << "'!");
+        if (_config_.format == metrics_registry::FORMAT_JSON) {
+          metrics_registry::export_json(snapshot, fout);
+        } else {
+          metrics_registry::export_prometheus(snapshot, fout);
+        }
+        DT_THROW_IF(!fout,
+                    std::logic_error,
+                    "Cannot write metrics file '" << tmp_filename << "'!");
+      }
+      DT_THROW_IF(
+        std::rename(tmp_filename.c_str(), _config_.filename.c_str()) != 0,
+        std::logic_error,
+        "Cannot rename metrics file '" << tmp_filename << "'!");
+      return;
+    }
+
+  } // namespace io
+} // namespace snfee
@@ -0,0 +1,331 @@
+//! \file snfee/io/metrics.h
+//! \brief Run time metrics of the processing pipelines
+
+#ifndef SNFEE_IO_METRICS_H
+#define SNFEE_IO_METRICS_H
+
+// Standard library:
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/program_options.hpp>
+#include <boost/utility.hpp>
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Monotonic counter (ex: number of processed records)
+    class metrics_counter : private boost::noncopyable {
+    public:
+      //! Increment the counter
+      void
+      add(const uint64_t n_ = 1)
+      {
+        _value_.fetch_add(n_, std::memory_order_relaxed);
+        return;
+      }
+
+      //! Return the current value
+      uint64_t
+      get() const
+      {
+        return _value_.load(std::memory_order_relaxed);
+      }
+
+    private:
+      std::atomic<uint64_t> _value_{0};
+    };
+
+    //! \brief Instantaneous value (ex: number of records in a buffer)
+    class metrics_gauge : private boost::noncopyable {
+    public:
+      //! Set the value
+      void
+      set(const int64_t value_)
+      {
+        _value_.store(value_, std::memory_order_relaxed);
+        return;
+      }
+
+      //! Add to the value
+      void
+      add(const int64_t delta_)
+      {
+        _value_.fetch_add(delta_, std::memory_order_relaxed);
+        return;
+      }
+
+      //! Return the current value
+      int64_t
+      get() const
+      {
+        return _value_.load(std::memory_order_relaxed);
+      }
+
+    private:
+      std::atomic<int64_t> _value_{0};
+    };
+
+    //! \brief Histogram of durations (ex: decoding or waiting time)
+    //!
+    //! The upper bounds of the buckets are fixed and grow by a factor 2
+    //! from 1 us to about 17 s, the last bucket collecting longer
+    //! durations. Observing a duration only costs a few relaxed atomic
+    //! increments.
+    class metrics_histogram : private boost::noncopyable {
+    public:
+      /// Number of buckets with a finite upper bound
+      static const std::size_t NUMBER_OF_BOUNDS = 25;
+
+      /// Return the upper bound of a bucket (s)
+      static double bucket_bound(const std::size_t ibucket_);
+
+      //! Add a duration (s)
+      void observe(const double seconds_);
+
+      //! Return the number of observed durations
+      uint64_t get_count() const;
+
+      //! Return the sum of the observed durations (s)
+      double get_sum() const;
+
+      //! Return the number of durations in a bucket (not cumulative)
+      uint64_t get_bucket_count(const std::size_t ibucket_) const;
+
+    private:
+      std::array<std::atomic<uint64_t>, NUMBER_OF_BOUNDS + 1> _buckets_{};
+      std::atomic<uint64_t> _count_{0};
+      std::atomic<uint64_t> _sum_ns_{0}; ///< Sum of the durations (ns)
+    };
+
+    //! \brief Measure the lifetime of a scope in a histogram
+    //!
+    //! Nothing is measured if the histogram is null, so that an
+    //! instrumented component can run without metrics at no cost.
+    class metrics_timer : private boost::noncopyable {
+    public:
+      //! Constructor
+      explicit metrics_timer(metrics_histogram* histogram_)
+        : _histogram_(histogram_)
+      {
+        if (_histogram_ != nullptr) {
+          _start_ = std::chrono::steady_clock::now();
+        }
+        return;
+      }
+
+      //! Destructor
+      ~metrics_timer()
+      {
+        if (_histogram_ != nullptr) {
+          const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - _start_;
+          _histogram_->observe(elapsed.count());
+        }
+        return;
+      }
+
+    private:
+      metrics_histogram* _histogram_ = nullptr;
+      std::chrono::steady_clock::time_point _start_;
+    };
+
+    //! \brief Registry of the metrics of a process
+    //!
+    //! Metrics are identified by a name and a set of labels (ex:
+    //! snfee_reader_records_total{stream="CaloCrate0"}). A metric lives as
+    //! long as the registry, so that components may keep a pointer to it.
+    //!
+    //! The components create their metrics at construction, and only if
+    //! the global registry is enabled. The programs must then enable it
+    //! before building their pipeline.
+    //!
+    //! Usage:
+    //! \code
+    //! snfee::io::metrics_registry& registry =
+    //!   snfee::io::metrics_registry::global();
+    //! snfee::io::metrics_counter* records = nullptr;
+    //! if (registry.is_enabled()) {
+    //!   records = &registry.make_counter("snfee_records_total",
+    //!                                    "Number of processed records",
+    //!                                    {{"stream", "calo"}});
+    //! }
+    //! ...
+    //! if (records) records->add();
+    //! \endcode
+    class metrics_registry : private boost::noncopyable {
+    public:
+      /// \brief Type of metric
+      enum kind_type { KIND_COUNTER = 0, KIND_GAUGE = 1, KIND_HISTOGRAM = 2 };
+
+      /// \brief Format of the exported metrics
+      enum format_type {
+        FORMAT_PROMETHEUS = 0, ///< Prometheus text exposition format
+        FORMAT_JSON = 1        ///< JSON document
+      };
+
+      /// Labels of a metric (name, value)
+      typedef std::vector<std::pair<std::string, std::string>> labels_type;
+
+      /// \brief Value of a metric at a given time
+      struct sample_type {
+        std::string name;         ///< Name of the metric
+        std::string help;         ///< Description of the metric
+        kind_type kind = KIND_COUNTER; ///< Type of metric
+        labels_type labels;       ///< Labels
+        double value = 0.0;       ///< Value (counter, gauge)
+        bool has_rate = false;    ///< Rate availability flag (counter)
+        double rate = 0.0;        ///< Increase per second since last sample
+        uint64_t count = 0;       ///< Number of durations (histogram)
+        double sum = 0.0;         ///< Sum of the durations (histogram)
+        std::vector<uint64_t> buckets; ///< Cumulative counts (histogram)
+      };
+
+      /// \brief Values of all the metrics at a given time
+      struct snapshot_type {
+        double timestamp = 0.0; ///< Time since the epoch (s)
+        std::vector<sample_type> samples; ///< Sorted by name and labels
+      };
+
+      /// Return the registry of the process
+      static metrics_registry& global();
+
+      /// Return the format associated to a label ("prometheus", "json")
+      static format_type format_from_label(const std::string& label_);
+
+      //! Constructor
+      metrics_registry();
+
+      //! Check if the components should record their metrics
+      bool is_enabled() const;
+
+      //! Set the enabled flag
+      void set_enabled(const bool enabled_);
+
+      //! Return the counter with a given name and labels (create it if
+      //! needed)
+      metrics_counter& make_counter(const std::string& name_,
+                                    const std::string& help_,
+                                    const labels_type& labels_ = {});
+
+      //! Return the gauge with a given name and labels (create it if needed)
+      metrics_gauge& make_gauge(const std::string& name_,
+                                const std::string& help_,
+                                const labels_type& labels_ = {});
+
+      //! Return the histogram with a given name and labels (create it if
+      //! needed)
+      metrics_histogram& make_histogram(const std::string& name_,
+                                        const std::string& help_,
+                                        const labels_type& labels_ = {});
+
+      //! Return the current values of all the metrics
+      snapshot_type make_snapshot() const;
+
+      //! Print a snapshot in the Prometheus text format
+      static void export_prometheus(const snapshot_type& snapshot_,
+                                    std::ostream& out_);
+
+      //! Print a snapshot in JSON format
+      static void export_json(const snapshot_type& snapshot_,
+                              std::ostream& out_);
+
+    private:
+      /// \brief Metrics sharing the same name
+      struct family_type {
+        std::string help;
+        kind_type kind = KIND_COUNTER;
+        std::map<labels_type, std::unique_ptr<metrics_counter>> counters;
+        std::map<labels_type, std::unique_ptr<metrics_gauge>> gauges;
+        std::map<labels_type, std::unique_ptr<metrics_histogram>> histograms;
+      };
+
+      /// Return the family of a metric, check its type
+      family_type& _family_(const std::string& name_,
+                            const std::string& help_,
+                            const kind_type kind_);
+
+    private:
+      std::atomic<bool> _enabled_{false}; ///< Enabled flag
+      mutable std::mutex _mutex_;         ///< Protection of the families
+      std::map<std::string, family_type> _families_; ///< Families by name
+    };
+
+    //! \brief Periodic dump of the metrics to a local file
+    //!
+    //! A background thread writes a snapshot of the registry each period,
+    //! and a last one when the dumper is stopped. The file is replaced
+    //! atomically (written aside then renamed), so that it can be scraped
+    //! at any time (ex: by the textfile collector of the Prometheus node
+    //! exporter). The rates of the counters are computed between two
+    //! consecutive dumps.
+    class metrics_dumper : private boost::noncopyable {
+    public:
+      /// \brief Configuration data
+      struct config_type {
+        std::string filename; ///< Output file
+        metrics_registry::format_type format =
+          metrics_registry::FORMAT_PROMETHEUS; ///< Output format
+        double period = 10.0;                  ///< Dump period (s)
+
+        /// Add the command line options (--metrics-file, --metrics-format,
+        /// --metrics-period)
+        static void add_options(boost::program_options::options_description&);
+
+        /// Configure from the command line options
+        void configure(const boost::program_options::variables_map& vm_);
+      };
+
+      //! Constructor
+      metrics_dumper(const config_type& config_,
+                     metrics_registry& registry_ = metrics_registry::global());
+
+      //! Destructor (stop the dumper)
+      ~metrics_dumper();
+
+      //! Start the periodic dump
+      void start();
+
+      //! Stop the periodic dump and write the last values
+      void stop();
+
+      //! Write the current values
+      void dump();
+
+    private:
+      /// Periodic dump loop
+      void _run_();
+
+    private:
+      // Configuration:
+      config_type _config_;         ///< Configuration
+      metrics_registry& _registry_; ///< Dumped registry
+
+      // Working data:
+      std::thread _thread_;            ///< Dump thread
+      std::mutex _mutex_;              ///< Protection of the stop flag
+      std::condition_variable _cond_;  ///< Stop notification
+      bool _stop_request_ = false;     ///< Stop flag
+      std::mutex _dump_mutex_;         ///< Protection of the previous values
+      double _previous_timestamp_ = 0.0; ///< Time of the previous dump
+      std::map<std::string, double>
+        _previous_values_; ///< Counter values at the previous dump
+    };
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_METRICS_H
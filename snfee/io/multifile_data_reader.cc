@@ -3,12 +3,26 @@
 // Ourselves:
 #include <snfee/io/multifile_data_reader.h>
 
+// Standard library:
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+
 // Third party:
+// - Boost:
+#include <boost/filesystem.hpp>
 // - Bayeux:
 #include <bayeux/datatools/exception.h>
 #include <bayeux/datatools/io_factory.h>
 #include <bayeux/datatools/utils.h>
 
+// This project:
+#include <snfee/io/trigger_index.h>
+
 namespace snfee {
   namespace io {
 
@@ -17,10 +31,72 @@ namespace snfee {
       pimpl_type(multifile_data_reader& master_) : master(master_) { return; }
       multifile_data_reader& master;
       std::unique_ptr<datatools::data_reader> reader;
+      std::unique_ptr<native_data_reader> native_reader;
       int _current_file_index_ = -1;
+      std::size_t _record_index_ = 0; ///< Rank of the next record in the file
       // std::string record_tag;
+      void _open_reader_(const int file_index_);
       void _next_reader_();
       void _destroy_reader_();
+      bool _has_open_reader_() const;
+      bool _has_record_tag_() const;
+      std::string _get_record_tag_() const;
+      bool _record_tag_is_(const std::string& tag_) const;
+
+      /// \brief Record decoded ahead of the calls to load()
+      struct prefetched_record_type {
+        std::string tag;            ///< Serialization tag
+        std::shared_ptr<void> data; ///< Decoded record (null if no decoder)
+        position_type position;     ///< Position in the input files
+      };
+
+      /// \brief Factory and decoding functions of a type of record
+      struct record_type_entry {
+        factory_type make;                     ///< Record factory
+        decoder_type decode;                   ///< Deserialization
+        trigger_id_getter_type get_trigger_id; ///< Trigger ID accessor
+      };
+
+      // Record types:
+      std::map<std::string, record_type_entry> record_types; ///< By tag
+
+      // Trigger ID indexes:
+      bool indexes_loaded = false;         ///< Index loading flag
+      std::vector<trigger_index> indexes;  ///< Indexes of the input files
+      void _load_indexes_();
+      bool _goto_(const position_type& position_);
+      prefetched_record_type _decode_next_();
+      void _skip_next_();
+
+      // Prefetch (records decoded by the prefetch thread or while seeking):
+      std::deque<prefetched_record_type> prefetched; ///< Records decoded ahead
+      bool prefetch_started = false; ///< Prefetch thread start flag
+      bool prefetch_done = false;    ///< End of the input (or error) flag
+      bool prefetch_stop = false;    ///< Prefetch thread stop request
+      std::exception_ptr prefetch_error; ///< Error met by the prefetch thread
+      std::thread prefetch_thread;       ///< Prefetch thread
+      std::mutex prefetch_mutex;         ///< Protection of the prefetch queue
+      std::condition_variable prefetch_not_empty; ///< Consumer wake-up
+      std::condition_variable prefetch_not_full;  ///< Producer wake-up
+
+      void _prefetch_run_();
+      void _start_prefetch_();
+      void _stop_prefetch_();
+      void _reset_prefetch_();
+      const prefetched_record_type* _front_prefetched_();
+
+      // Metrics (null if disabled):
+      metrics_counter* records_metrics = nullptr; ///< Loaded records
+      metrics_counter* bytes_metrics = nullptr;   ///< Size of the read files
+      metrics_gauge* prefetch_fill_metrics =
+        nullptr; ///< Records in the prefetch queue
+      metrics_histogram* consumer_wait_metrics =
+        nullptr; ///< Waiting time for a prefetched record
+      metrics_histogram* producer_wait_metrics =
+        nullptr; ///< Waiting time for room in the prefetch queue
+      int _last_accounted_file_index_ = -1; ///< Last file counted in bytes
+      void _init_metrics_();
+      void _account_file_(const int file_index_);
     };
 
     multifile_data_reader::multifile_data_reader(const config_type& cfg_)
@@ -30,6 +106,7 @@ namespace snfee {
       DT_THROW_IF(_config_.filenames.size() == 0,
                   std::logic_error,
                   "Missing input filenames for the multiple data reader!");
+      _pimpl_->_init_metrics_();
       _pimpl_->_next_reader_();
       return;
     }
@@ -38,31 +115,152 @@ namespace snfee {
     multifile_data_reader::~multifile_data_reader()
     {
       if (_pimpl_) {
+        _pimpl_->_stop_prefetch_();
+        if (_pimpl_->bytes_metrics and _pimpl_->_has_open_reader_() and
+            !_pimpl_->_has_record_tag_()) {
+          // The last open file has been read through:
+          _pimpl_->_account_file_(_pimpl_->_current_file_index_);
+        }
         _pimpl_->_destroy_reader_();
         _pimpl_.reset();
       }
       return;
     }
 
+    void
+    multifile_data_reader::pimpl_type::_init_metrics_()
+    {
+      metrics_registry& registry = metrics_registry::global();
+      if (!registry.is_enabled()) {
+        return;
+      }
+      const metrics_registry::labels_type labels = {
+        {"stream", master._config_.metrics_label}};
+      records_metrics = &registry.make_counter(
+        "snfee_reader_records_total",
+        "Number of records loaded by the multifile data readers",
+        labels);
+      bytes_metrics = &registry.make_counter(
+        "snfee_reader_bytes_total",
+        "Size of the input files read through by the multifile data readers",
+        labels);
+      master._decode_time_ = &registry.make_histogram(
+        "snfee_reader_decode_seconds",
+        "Time spent deserializing the input records (s)",
+        labels);
+      if (master.is_prefetching()) {
+        prefetch_fill_metrics = &registry.make_gauge(
+          "snfee_reader_prefetch_records",
+          "Number of records decoded ahead of the consumer",
+          labels);
+        consumer_wait_metrics = &registry.make_histogram(
+          "snfee_reader_wait_seconds",
+          "Time spent waiting on the prefetch queue (s)",
+          {{"stream", master._config_.metrics_label}, {"side", "consumer"}});
+        producer_wait_metrics = &registry.make_histogram(
+          "snfee_reader_wait_seconds",
+          "Time spent waiting on the prefetch queue (s)",
+          {{"stream", master._config_.metrics_label}, {"side", "producer"}});
+      }
+      return;
+    }
+
+    void
+    multifile_data_reader::pimpl_type::_account_file_(const int file_index_)
+    {
+      // Files reopened after a seek are only counted once:
+      if (bytes_metrics == nullptr or
+          file_index_ <= _last_accounted_file_index_) {
+        return;
+      }
+      _last_accounted_file_index_ = file_index_;
+      std::string filename = master._config_.filenames[file_index_];
+      datatools::fetch_path_with_env(filename);
+      boost::system::error_code ec;
+      const boost::uintmax_t file_size =
+        boost::filesystem::file_size(filename, ec);
+      if (!ec) {
+        bytes_metrics->add(file_size);
+      }
+      return;
+    }
+
     void
     multifile_data_reader::pimpl_type::_destroy_reader_()
     {
       if (reader) {
         reader.reset();
       }
+      if (native_reader) {
+        native_reader.reset();
+      }
       return;
     }
 
+    bool
+    multifile_data_reader::pimpl_type::_has_open_reader_() const
+    {
+      return reader or native_reader;
+    }
+
+    bool
+    multifile_data_reader::pimpl_type::_has_record_tag_() const
+    {
+      if (native_reader) {
+        return native_reader->has_record_tag();
+      }
+      return reader->has_record_tag();
+    }
+
+    std::string
+    multifile_data_reader::pimpl_type::_get_record_tag_() const
+    {
+      if (native_reader) {
+        return native_reader->get_record_tag();
+      }
+      return reader->get_record_tag();
+    }
+
+    bool
+    multifile_data_reader::pimpl_type::_record_tag_is_(
+      const std::string& tag_) const
+    {
+      if (native_reader) {
+        return native_reader->record_tag_is(tag_);
+      }
+      return reader->record_tag_is(tag_);
+    }
+
     void
     multifile_data_reader::pimpl_type::_next_reader_()
     {
-      _destroy_reader_();
-      _current_file_index_++;
-      DT_THROW_IF(_current_file_index_ == (int)master._config_.filenames.size(),
+      DT_THROW_IF((_current_file_index_ + 1) ==
+                    (int)master._config_.filenames.size(),
                   std::logic_error,
                   "Multiple data reader has no more input file!");
+      if (_current_file_index_ >= 0) {
+        _account_file_(_current_file_index_);
+      }
+      _open_reader_(_current_file_index_ + 1);
+      return;
+    }
+
+    void
+    multifile_data_reader::pimpl_type::_open_reader_(const int file_index_)
+    {
+      _destroy_reader_();
+      _current_file_index_ = file_index_;
+      _record_index_ = 0;
       std::string in_filename = master._config_.filenames[_current_file_index_];
       datatools::fetch_path_with_env(in_filename);
+      if (native_format::is_native_filename(in_filename)) {
+        native_reader.reset(new native_data_reader(in_filename));
+        DT_THROW_IF(!native_reader->is_initialized(),
+                    std::logic_error,
+                    "Multiple data reader is not initialized from '"
+                      << in_filename << "'!");
+        return;
+      }
       reader.reset(new datatools::data_reader(in_filename,
                                               datatools::using_multi_archives));
       DT_THROW_IF(!reader->is_initialized(),
@@ -74,10 +272,205 @@ namespace snfee {
       return;
     }
 
+    void
+    multifile_data_reader::pimpl_type::_prefetch_run_()
+    {
+      try {
+        while (true) {
+          // Find the next record, opening the next input files if needed:
+          bool found_tag = false;
+          while (!found_tag) {
+            if (_has_record_tag_()) {
+              found_tag = true;
+            } else if ((_current_file_index_ + 1) ==
+                       (int)master._config_.filenames.size()) {
+              // No more input file:
+              break;
+            } else {
+              _next_reader_();
+            }
+          }
+          if (!found_tag) {
+            break;
+          }
+          prefetched_record_type rec;
+          rec.tag = _get_record_tag_();
+          rec.position.file_index = _current_file_index_;
+          rec.position.record_index = _record_index_;
+          auto found = record_types.find(rec.tag);
+          if (found != record_types.end()) {
+            rec.data = found->second.decode(master);
+            _record_index_++;
+          }
+          {
+            std::unique_lock<std::mutex> lock(prefetch_mutex);
+            auto has_room = [this] {
+              return prefetch_stop or
+                     prefetched.size() < master._config_.prefetch_depth;
+            };
+            if (!has_room()) {
+              metrics_timer wait_timer(producer_wait_metrics);
+              prefetch_not_full.wait(lock, has_room);
+            }
+            if (prefetch_stop) {
+              return;
+            }
+            prefetched.push_back(rec);
+            if (prefetch_fill_metrics) {
+              prefetch_fill_metrics->set(prefetched.size());
+            }
+          }
+          prefetch_not_empty.notify_one();
+          if (!rec.data) {
+            // The consumer may still inspect the tag of an unknown record
+            // but it cannot be read any further:
+            break;
+          }
+        }
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> lock(prefetch_mutex);
+        prefetch_error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock(prefetch_mutex);
+        prefetch_done = true;
+      }
+      prefetch_not_empty.notify_all();
+      return;
+    }
+
+    void
+    multifile_data_reader::pimpl_type::_start_prefetch_()
+    {
+      if (!prefetch_started) {
+        prefetch_started = true;
+        prefetch_thread =
+          std::thread(&multifile_data_reader::pimpl_type::_prefetch_run_, this);
+      }
+      return;
+    }
+
+    void
+    multifile_data_reader::pimpl_type::_stop_prefetch_()
+    {
+      if (prefetch_thread.joinable()) {
+        {
+          std::lock_guard<std::mutex> lock(prefetch_mutex);
+          prefetch_stop = true;
+        }
+        prefetch_not_full.notify_all();
+        prefetch_thread.join();
+      }
+      return;
+    }
+
+    void
+    multifile_data_reader::pimpl_type::_reset_prefetch_()
+    {
+      // The prefetch thread must be stopped:
+      prefetched.clear();
+      prefetch_started = false;
+      prefetch_done = false;
+      prefetch_stop = false;
+      prefetch_error = nullptr;
+      return;
+    }
+
+    const multifile_data_reader::pimpl_type::prefetched_record_type*
+    multifile_data_reader::pimpl_type::_front_prefetched_()
+    {
+      if (!master.is_prefetching()) {
+        // Only records decoded while seeking:
+        return prefetched.empty() ? nullptr : &prefetched.front();
+      }
+      _start_prefetch_();
+      std::unique_lock<std::mutex> lock(prefetch_mutex);
+      auto is_ready = [this] { return !prefetched.empty() or prefetch_done; };
+      if (!is_ready()) {
+        metrics_timer wait_timer(consumer_wait_metrics);
+        prefetch_not_empty.wait(lock, is_ready);
+      }
+      if (!prefetched.empty()) {
+        return &prefetched.front();
+      }
+      if (prefetch_error) {
+        std::rethrow_exception(prefetch_error);
+      }
+      return nullptr;
+    }
+
+    bool
+    multifile_data_reader::is_prefetching() const
+    {
+      return _config_.prefetch_depth > 0;
+    }
+
+    void
+    multifile_data_reader::_add_record_type_(
+      const std::string& tag_,
+      const factory_type& factory_,
+      const decoder_type& decoder_,
+      const trigger_id_getter_type& get_trigger_id_)
+    {
+      DT_THROW_IF(_pimpl_->prefetch_started,
+                  std::logic_error,
+                  "Prefetch thread is already running!");
+      pimpl_type::record_type_entry& entry = _pimpl_->record_types[tag_];
+      entry.make = factory_;
+      entry.decode = decoder_;
+      entry.get_trigger_id = get_trigger_id_;
+      return;
+    }
+
+    std::shared_ptr<void>
+    multifile_data_reader::_make_record_(const std::string& tag_) const
+    {
+      auto found = _pimpl_->record_types.find(tag_);
+      if (found == _pimpl_->record_types.end()) {
+        return std::shared_ptr<void>();
+      }
+      return found->second.make();
+    }
+
+    bool
+    multifile_data_reader::_has_decoded_record_() const
+    {
+      return !_pimpl_->prefetched.empty();
+    }
+
+    std::shared_ptr<void>
+    multifile_data_reader::_pop_prefetched_(const std::string& tag_)
+    {
+      DT_THROW_IF(is_terminated(), std::logic_error, "No reader!");
+      const pimpl_type::prefetched_record_type* front =
+        _pimpl_->_front_prefetched_();
+      DT_THROW_IF(front == nullptr, std::logic_error, "No more record!");
+      DT_THROW_IF(front->tag != tag_,
+                  std::logic_error,
+                  "Next record '" << front->tag << "' is not a '" << tag_
+                                  << "'!");
+      DT_THROW_IF(!front->data,
+                  std::logic_error,
+                  "No decoder for record '" << front->tag << "'!");
+      std::shared_ptr<void> data;
+      {
+        std::lock_guard<std::mutex> lock(_pimpl_->prefetch_mutex);
+        data = _pimpl_->prefetched.front().data;
+        _pimpl_->prefetched.pop_front();
+        if (_pimpl_->prefetch_fill_metrics) {
+          _pimpl_->prefetch_fill_metrics->set(_pimpl_->prefetched.size());
+        }
+      }
+      _pimpl_->prefetch_not_full.notify_one();
+      return data;
+    }
+
     void
     multifile_data_reader::terminate()
     {
       _terminated_ = true;
+      _pimpl_->_stop_prefetch_();
       return;
     }
 
@@ -87,9 +480,12 @@ namespace snfee {
       if (is_terminated()) {
         return false;
       }
+      if (is_prefetching() or _has_decoded_record_()) {
+        return _pimpl_->_front_prefetched_() != nullptr;
+      }
       bool found_tag = false;
       while (!found_tag) {
-        if (_pimpl_->reader->has_record_tag()) {
+        if (_pimpl_->_has_record_tag_()) {
           found_tag = true;
           // record_tag = _pimpl_->reader->get_record_tag();
           break;
@@ -114,8 +510,13 @@ namespace snfee {
       if (is_terminated()) {
         return false;
       }
-      if (_pimpl_->reader) {
-        return _pimpl_->reader->record_tag_is(tag_);
+      if (is_prefetching() or _has_decoded_record_()) {
+        const pimpl_type::prefetched_record_type* front =
+          _pimpl_->_front_prefetched_();
+        return front != nullptr and front->tag == tag_;
+      }
+      if (_pimpl_->_has_open_reader_()) {
+        return _pimpl_->_record_tag_is_(tag_);
       }
       return false;
       // multifile_data_reader * mutable_this = const_cast<multifile_data_reader
@@ -125,8 +526,16 @@ namespace snfee {
     std::string
     multifile_data_reader::get_record_tag() const
     {
-      if (_pimpl_->reader) {
-        return _pimpl_->reader->get_record_tag();
+      if (is_prefetching() or _has_decoded_record_()) {
+        if (is_terminated()) {
+          return "";
+        }
+        const pimpl_type::prefetched_record_type* front =
+          _pimpl_->_front_prefetched_();
+        return front != nullptr ? front->tag : "";
+      }
+      if (_pimpl_->_has_open_reader_()) {
+        return _pimpl_->_get_record_tag_();
       }
       return "";
     }
@@ -142,6 +551,10 @@ namespace snfee {
     {
       if (_terminated_)
         return true;
+      if (is_prefetching()) {
+        // The input files are managed by the prefetch thread:
+        return false;
+      }
       if ((_pimpl_->_current_file_index_) >= (int)_config_.filenames.size()) {
         return true;
       }
@@ -151,16 +564,224 @@ namespace snfee {
     datatools::data_reader&
     multifile_data_reader::_reader_()
     {
-      DT_THROW_IF(is_terminated(), std::logic_error, "No reader!");
+      // No termination check: also used by the prefetch thread
+      DT_THROW_IF(!_pimpl_->reader, std::logic_error, "No reader!");
       return *_pimpl_->reader;
     }
 
+    native_data_reader*
+    multifile_data_reader::_native_reader_()
+    {
+      return _pimpl_->native_reader.get();
+    }
+
     void
     multifile_data_reader::_at_load_()
     {
       _counter_++;
+      if (_pimpl_->records_metrics) {
+        _pimpl_->records_metrics->add();
+      }
+      return;
+    }
+
+    void
+    multifile_data_reader::_at_reader_load_()
+    {
+      _pimpl_->_record_index_++;
+      return;
+    }
+
+    bool
+    multifile_data_reader::position_type::operator<(
+      const position_type& other_) const
+    {
+      if (file_index != other_.file_index) {
+        return file_index < other_.file_index;
+      }
+      return record_index < other_.record_index;
+    }
+
+    bool
+    multifile_data_reader::has_trigger_index() const
+    {
+      for (const auto& filename : _config_.filenames) {
+        std::string index_filename = trigger_index::index_filename(filename);
+        datatools::fetch_path_with_env(index_filename);
+        std::ifstream fin(index_filename.c_str());
+        if (!fin) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void
+    multifile_data_reader::pimpl_type::_load_indexes_()
+    {
+      if (indexes_loaded) {
+        return;
+      }
+      const std::vector<std::string>& filenames = master._config_.filenames;
+      std::vector<trigger_index> loaded(filenames.size());
+      for (std::size_t ifile = 0; ifile < filenames.size(); ifile++) {
+        loaded[ifile].load(trigger_index::index_filename(filenames[ifile]));
+      }
+      indexes = std::move(loaded);
+      indexes_loaded = true;
+      return;
+    }
+
+    bool
+    multifile_data_reader::pimpl_type::_goto_(const position_type& position_)
+    {
+      if (!_has_open_reader_() or
+          position_.file_index != _current_file_index_ or
+          position_.record_index < _record_index_) {
+        _open_reader_(position_.file_index);
+      }
+      while (_record_index_ < position_.record_index) {
+        if (!_has_record_tag_()) {
+          return false;
+        }
+        _skip_next_();
+      }
+      return true;
+    }
+
+    multifile_data_reader::pimpl_type::prefetched_record_type
+    multifile_data_reader::pimpl_type::_decode_next_()
+    {
+      prefetched_record_type rec;
+      rec.tag = _get_record_tag_();
+      rec.position.file_index = _current_file_index_;
+      rec.position.record_index = _record_index_;
+      auto found = record_types.find(rec.tag);
+      DT_THROW_IF(found == record_types.end(),
+                  std::logic_error,
+                  "No decoder for record '" << rec.tag << "'!");
+      rec.data = found->second.decode(master);
+      _record_index_++;
+      return rec;
+    }
+
+    void
+    multifile_data_reader::pimpl_type::_skip_next_()
+    {
+      if (native_reader) {
+        // Native records can be skipped without decoding:
+        native_reader->skip_record();
+        _record_index_++;
+        return;
+      }
+      _decode_next_();
       return;
     }
 
+    bool
+    multifile_data_reader::seek_to_trigger(const int32_t trigger_id_)
+    {
+      return _seek_(trigger_id_, trigger_id_);
+    }
+
+    bool
+    multifile_data_reader::_seek_(const int32_t first_, const int32_t last_)
+    {
+      DT_THROW_IF(_terminated_, std::logic_error, "Reader is terminated!");
+      _pimpl_->_load_indexes_();
+      const std::vector<trigger_index>& indexes = _pimpl_->indexes;
+      // Search the first block of records which may contain the range:
+      position_type start;
+      for (std::size_t ifile = 0; ifile < indexes.size(); ifile++) {
+        for (const auto& block : indexes[ifile].get_blocks()) {
+          if (block.overlaps(first_, last_)) {
+            start.file_index = ifile;
+            start.record_index = block.first_record;
+            break;
+          }
+        }
+        if (start.file_index >= 0) {
+          break;
+        }
+      }
+      if (start.file_index < 0) {
+        return false;
+      }
+      // From now, the reader is moved (its position is restored on a miss):
+      const position_type saved = _next_position_();
+      _pimpl_->_stop_prefetch_();
+      _pimpl_->_reset_prefetch_();
+      // Scan the blocks which may contain the range:
+      for (std::size_t ifile = start.file_index; ifile < indexes.size();
+           ifile++) {
+        for (const auto& block : indexes[ifile].get_blocks()) {
+          if (!block.overlaps(first_, last_)) {
+            continue;
+          }
+          position_type block_start;
+          block_start.file_index = ifile;
+          block_start.record_index = block.first_record;
+          if (block_start < start) {
+            continue;
+          }
+          DT_THROW_IF(!_pimpl_->_goto_(block_start),
+                      std::logic_error,
+                      "Input file '" << _config_.filenames[ifile]
+                                     << "' does not match its index!");
+          for (std::size_t irec = 0; irec < block.number_of_records;
+               irec++) {
+            pimpl_type::prefetched_record_type rec = _pimpl_->_decode_next_();
+            const int32_t trigger_id =
+              _pimpl_->record_types[rec.tag].get_trigger_id(rec.data.get());
+            if (trigger_id >= first_ and trigger_id <= last_) {
+              // The next loaded record:
+              _pimpl_->prefetched.push_back(rec);
+              return true;
+            }
+          }
+        }
+      }
+      // Back to the next record before the seek (the prefetch thread
+      // restarts from there on the next access):
+      _pimpl_->_reset_prefetch_();
+      DT_THROW_IF(!_pimpl_->_goto_(saved),
+                  std::logic_error,
+                  "Cannot restore the position of the reader in '"
+                    << _config_.filenames[saved.file_index] << "'!");
+      return false;
+    }
+
+    multifile_data_reader::position_type
+    multifile_data_reader::_range_end_(const int32_t first_,
+                                       const int32_t last_) const
+    {
+      _pimpl_->_load_indexes_();
+      const std::vector<trigger_index>& indexes = _pimpl_->indexes;
+      position_type end;
+      for (std::size_t ifile = 0; ifile < indexes.size(); ifile++) {
+        for (const auto& block : indexes[ifile].get_blocks()) {
+          if (block.overlaps(first_, last_)) {
+            end.file_index = ifile;
+            end.record_index = block.first_record + block.number_of_records;
+          }
+        }
+      }
+      return end;
+    }
+
+    multifile_data_reader::position_type
+    multifile_data_reader::_next_position_() const
+    {
+      const pimpl_type::prefetched_record_type* front =
+        _pimpl_->_front_prefetched_();
+      if (front != nullptr) {
+        return front->position;
+      }
+      position_type next;
+      next.file_index = _pimpl_->_current_file_index_;
+      next.record_index = _pimpl_->_record_index_;
+      return next;
+    }
+
   } // namespace io
 } // namespace snfee
@@ -7,26 +7,68 @@
 #define SNFEE_IO_MULTIFILE_DATA_READER_H
 
 // Standard library:
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 // Third party:
 // - Boost:
 #include <boost/utility.hpp>
 // - Bayeux:
+#include <bayeux/datatools/exception.h>
 #include <bayeux/datatools/io_factory.h>
 
+// This project:
+#include <snfee/io/metrics.h>
+#include <snfee/io/native_data_reader.h>
+
 namespace snfee {
   namespace io {
 
     //! \brief Multifile data reader
+    //!
+    //! In prefetch mode, a background thread deserializes the next records
+    //! (and opens the next input files) ahead of the calls to load(). All
+    //! the types of records expected in the input files must then be
+    //! declared with add_record_type() before the first access to the
+    //! records.
+    //!
+    //! Input files with the native_format::file_extension() extension are
+    //! read with the native binary format, the other ones as Boost archives.
+    //!
+    //! If the input files have a trigger ID index (see trigger_index), the
+    //! reader can jump to the records with a given trigger ID without
+    //! deserializing the blocks of records located before. The declared
+    //! types of records are used to skip the records within a block.
+    //!
+    //! If the global metrics registry is enabled when the reader is built,
+    //! the reader records the number of loaded records, the size of the
+    //! read input files, the decoding time, and the fill level of and the
+    //! waiting time on the prefetch queue (see metrics_registry).
     class multifile_data_reader : private boost::noncopyable {
     public:
       /// \brief Configuration data:
       struct config_type {
         std::vector<std::string> filenames; ///< Sequence of input filenames
+        std::size_t prefetch_depth =
+          0; ///< Number of records decoded ahead (0: no prefetch)
+        std::string metrics_label =
+          "default"; ///< Value of the "stream" label of the metrics
       };
 
+      /// Function which makes a new record to be loaded
+      typedef std::function<std::shared_ptr<void>()> factory_type;
+
+      /// Function which deserializes the next record of the current file
+      typedef std::function<std::shared_ptr<void>(multifile_data_reader&)>
+        decoder_type;
+
+      /// Function which returns the trigger ID of a deserialized record
+      typedef std::function<int32_t(const void*)> trigger_id_getter_type;
+
       //! Default constructor
       multifile_data_reader(const config_type&);
 
@@ -45,16 +87,124 @@ namespace snfee {
       //! Return the current record tag
       std::string get_record_tag() const;
 
+      //! Check if records are decoded ahead by a background thread
+      bool is_prefetching() const;
+
+      //! Declare a type of record to be decoded ahead or skipped
+      template <typename Data>
+      void
+      add_record_type()
+      {
+        add_record_type<Data>([]() { return std::make_shared<Data>(); });
+        return;
+      }
+
+      //! Declare a type of record to be decoded ahead or skipped, the
+      //! records being made by a factory (ex: the make() method of a
+      //! record_pool)
+      //!
+      //! The records made by the factory are the ones returned by
+      //! load_shared(), in prefetch mode or not.
+      template <typename Data>
+      void
+      add_record_type(const std::function<std::shared_ptr<Data>()>& make_)
+      {
+        _add_record_type_(
+          Data::SERIAL_TAG,
+          [make_]() { return std::shared_ptr<void>(make_()); },
+          [make_](multifile_data_reader& reader_) {
+            std::shared_ptr<Data> data = make_();
+            reader_._load_current_(*data);
+            return std::shared_ptr<void>(data);
+          },
+          [](const void* data_) {
+            return static_cast<const Data*>(data_)->get_trigger_id();
+          });
+        return;
+      }
+
       //! Load an arbitrary serialization records
       template <typename Data>
       void
       load(Data& data_)
       {
-        _reader_().load(data_);
+        if (is_prefetching() or _has_decoded_record_()) {
+          std::shared_ptr<void> data =
+            _pop_prefetched_(data_.get_serial_tag());
+          data_ = std::move(*std::static_pointer_cast<Data>(data));
+        } else {
+          DT_THROW_IF(is_terminated(), std::logic_error, "No reader!");
+          _load_current_(data_);
+          _at_reader_load_();
+        }
         _at_load_();
         return;
       }
 
+      //! Load the next record in a new record made by the factory of its
+      //! type (see add_record_type())
+      //!
+      //! Unlike load(), a record decoded ahead is handed out as is, without
+      //! being moved to another record.
+      template <typename Data>
+      std::shared_ptr<Data>
+      load_shared()
+      {
+        std::shared_ptr<Data> data;
+        if (is_prefetching() or _has_decoded_record_()) {
+          data =
+            std::static_pointer_cast<Data>(_pop_prefetched_(Data::SERIAL_TAG));
+        } else {
+          DT_THROW_IF(is_terminated(), std::logic_error, "No reader!");
+          data =
+            std::static_pointer_cast<Data>(_make_record_(Data::SERIAL_TAG));
+          if (!data) {
+            // Undeclared type of record:
+            data = std::make_shared<Data>();
+          }
+          _load_current_(*data);
+          _at_reader_load_();
+        }
+        _at_load_();
+        return data;
+      }
+
+      //! Check if all the input files have a trigger ID index
+      bool has_trigger_index() const;
+
+      //! Move to the first record with a given trigger ID
+      //!
+      //! Return false if no record has this trigger ID. The position of the
+      //! reader is then unchanged.
+      bool seek_to_trigger(const int32_t trigger_id_);
+
+      //! Load all the records with a trigger ID in [first_, last_]
+      //!
+      //! The records are returned in their order in the input files. All the
+      //! records in the indexed blocks which cover this range must be of
+      //! type Data. Return the number of loaded records.
+      template <typename Data>
+      std::size_t
+      read_range(const int32_t first_,
+                 const int32_t last_,
+                 std::vector<Data>& records_)
+      {
+        records_.clear();
+        if (!_seek_(first_, last_)) {
+          return 0;
+        }
+        const position_type end = _range_end_(first_, last_);
+        while (has_record_tag() and _next_position_() < end) {
+          Data data;
+          load(data);
+          const int32_t trigger_id = data.get_trigger_id();
+          if (trigger_id >= first_ and trigger_id <= last_) {
+            records_.push_back(std::move(data));
+          }
+        }
+        return records_.size();
+      }
+
       /// Force termination of the reader
       void terminate();
 
@@ -62,11 +212,63 @@ namespace snfee {
       std::size_t get_counter() const;
 
     private:
+      /// \brief Position of a record in the input files
+      struct position_type {
+        int file_index = -1;          ///< Index of the input file
+        std::size_t record_index = 0; ///< Rank of the record in the file
+        bool operator<(const position_type& other_) const;
+      };
+
       void _at_load_(); //!< At load action
 
+      void _at_reader_load_(); //!< At load from the current reader action
+
+      //! Register the factory and the decoding functions of a type of record
+      void _add_record_type_(const std::string& tag_,
+                             const factory_type& factory_,
+                             const decoder_type& decoder_,
+                             const trigger_id_getter_type& get_trigger_id_);
+
+      //! Make a new record of a declared type (null if not declared)
+      std::shared_ptr<void> _make_record_(const std::string& tag_) const;
+
+      //! Check if some records have already been decoded
+      bool _has_decoded_record_() const;
+
+      //! Move to the first record with a trigger ID in [first_, last_]
+      bool _seek_(const int32_t first_, const int32_t last_);
+
+      //! Return the position after the last block covering [first_, last_]
+      position_type _range_end_(const int32_t first_,
+                                const int32_t last_) const;
+
+      //! Return the position of the next record
+      position_type _next_position_() const;
+
+      //! Pop the next prefetched record (with a given tag)
+      std::shared_ptr<void> _pop_prefetched_(const std::string& tag_);
+
       datatools::data_reader&
       _reader_(); //!< Return a ref to the current reader
 
+      //! Return the current native reader (null for a Boost archive)
+      native_data_reader* _native_reader_();
+
+      //! Load the next record from the current input file
+      template <typename Data>
+      void
+      _load_current_(Data& data_)
+      {
+        metrics_timer timer(_decode_time_);
+        native_data_reader* native_reader = _native_reader_();
+        if (native_reader != nullptr) {
+          native_reader->load(data_);
+        } else {
+          _reader_().load(data_);
+        }
+        return;
+      }
+
     private:
       // Configuration::
       config_type _config_; ///< Configuration
@@ -75,6 +277,9 @@ namespace snfee {
       bool _terminated_ = false; ///< Forced termination flag
       std::size_t _counter_ = 0; ///< Record counter
 
+      // Metrics (null if disabled):
+      metrics_histogram* _decode_time_ = nullptr; ///< Decoding time
+
       struct pimpl_type;
       std::unique_ptr<pimpl_type> _pimpl_; ///< Private working data
     };
@@ -4,6 +4,8 @@
 #include <snfee/io/multifile_data_writer.h>
 
 // Third party:
+// - Boost:
+#include <boost/filesystem.hpp>
 // - Bayeux:
 #include <bayeux/datatools/exception.h>
 #include <bayeux/datatools/io_factory.h>
@@ -17,11 +19,19 @@ namespace snfee {
       pimpl_type(multifile_data_writer& master_) : master(master_) { return; }
       multifile_data_writer& master;
       std::unique_ptr<datatools::data_writer> writer;
+      std::unique_ptr<native_data_writer> native_writer;
       int current_file_index = -1;
       std::size_t _nrecords_in_file_ = 0;
+      std::string current_filename;   ///< Name of the current output file
+      std::unique_ptr<trigger_index> index; ///< Index of the current file
       // std::string record_tag;
       void _next_writer_();
       void _destroy_writer_();
+
+      // Metrics (null if disabled):
+      metrics_counter* records_metrics = nullptr; ///< Stored records
+      metrics_counter* bytes_metrics = nullptr;   ///< Size of the closed files
+      void _init_metrics_();
     };
 
     std::size_t
@@ -54,6 +64,7 @@ namespace snfee {
       DT_THROW_IF(_config_.filenames.size() == 0,
                   std::logic_error,
                   "Missing output filenames for the multiple data writer!");
+      _pimpl_->_init_metrics_();
       _pimpl_->_next_writer_();
       return;
     }
@@ -62,17 +73,62 @@ namespace snfee {
     multifile_data_writer::~multifile_data_writer()
     {
       if (_pimpl_) {
-        _pimpl_->_destroy_writer_();
+        try {
+          _pimpl_->_destroy_writer_();
+        }
+        catch (std::exception& error) {
+          DT_LOG_ERROR(_logging_, error.what());
+        }
         _pimpl_.reset();
       }
       return;
     }
 
+    void
+    multifile_data_writer::pimpl_type::_init_metrics_()
+    {
+      metrics_registry& registry = metrics_registry::global();
+      if (!registry.is_enabled()) {
+        return;
+      }
+      const metrics_registry::labels_type labels = {
+        {"stream", master._config_.metrics_label}};
+      records_metrics = &registry.make_counter(
+        "snfee_writer_records_total",
+        "Number of records stored by the multifile data writers",
+        labels);
+      bytes_metrics = &registry.make_counter(
+        "snfee_writer_bytes_total",
+        "Size of the output files closed by the multifile data writers",
+        labels);
+      master._encode_time_ = &registry.make_histogram(
+        "snfee_writer_encode_seconds",
+        "Time spent serializing the output records (s)",
+        labels);
+      return;
+    }
+
     void
     multifile_data_writer::pimpl_type::_destroy_writer_()
     {
-      if (writer) {
+      if (writer or native_writer) {
         writer.reset();
+        if (native_writer) {
+          native_writer->flush();
+          native_writer.reset();
+        }
+        if (index) {
+          index->store(trigger_index::index_filename(current_filename));
+          index.reset();
+        }
+        if (bytes_metrics) {
+          boost::system::error_code ec;
+          const boost::uintmax_t file_size =
+            boost::filesystem::file_size(current_filename, ec);
+          if (!ec) {
+            bytes_metrics->add(file_size);
+          }
+        }
       }
       return;
     }
@@ -104,12 +160,25 @@ namespace snfee {
         std::string out_filename =
           master._config_.filenames[current_file_index];
         datatools::fetch_path_with_env(out_filename);
-        writer.reset(new datatools::data_writer(
-          out_filename, datatools::using_multi_archives));
-        DT_THROW_IF(!writer->is_initialized(),
-                    std::logic_error,
-                    "Multiple data writer is not initialized from '"
-                      << out_filename << "'!");
+        if (native_format::is_native_filename(out_filename)) {
+          native_writer.reset(new native_data_writer(out_filename));
+          DT_THROW_IF(!native_writer->is_initialized(),
+                      std::logic_error,
+                      "Multiple data writer is not initialized from '"
+                        << out_filename << "'!");
+        } else {
+          writer.reset(new datatools::data_writer(
+            out_filename, datatools::using_multi_archives));
+          DT_THROW_IF(!writer->is_initialized(),
+                      std::logic_error,
+                      "Multiple data writer is not initialized from '"
+                        << out_filename << "'!");
+        }
+        current_filename = out_filename;
+        if (master._config_.with_trigger_index) {
+          index.reset(
+            new trigger_index(master._config_.trigger_index_block_size));
+        }
       }
       DT_LOG_TRACE_EXITING(master._logging_);
       return;
@@ -143,9 +212,17 @@ namespace snfee {
     multifile_data_writer::_writer_()
     {
       DT_THROW_IF(is_terminated(), std::logic_error, "No writer!");
+      DT_THROW_IF(!_pimpl_->writer, std::logic_error, "No writer!");
       return *_pimpl_->writer;
     }
 
+    native_data_writer*
+    multifile_data_writer::_native_writer_()
+    {
+      DT_THROW_IF(is_terminated(), std::logic_error, "No writer!");
+      return _pimpl_->native_writer.get();
+    }
+
     void
     multifile_data_writer::_pre_store_()
     {
@@ -167,10 +244,20 @@ namespace snfee {
       return;
     }
 
+    void
+    multifile_data_writer::_index_record_(const int32_t trigger_id_)
+    {
+      _pimpl_->index->add_record(trigger_id_);
+      return;
+    }
+
     void
     multifile_data_writer::_post_store_()
     {
       _counter_++;
+      if (_pimpl_->records_metrics) {
+        _pimpl_->records_metrics->add();
+      }
       _pimpl_->_nrecords_in_file_++;
       if (_config_.max_total_records > 0) {
         if (_counter_ == _config_.max_total_records) {
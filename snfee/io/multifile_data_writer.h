@@ -17,10 +17,27 @@
 #include <bayeux/datatools/io_factory.h>
 #include <bayeux/datatools/logger.h>
 
+// This project:
+#include <snfee/io/metrics.h>
+#include <snfee/io/native_data_writer.h>
+#include <snfee/io/trigger_index.h>
+
 namespace snfee {
   namespace io {
 
     //! \brief Multifile data writer
+    //!
+    //! Output files with the native_format::file_extension() extension are
+    //! written with the native binary format, the other ones as Boost
+    //! archives.
+    //!
+    //! If requested, a trigger ID index is built for each output file and
+    //! saved next to it when the file is closed (see trigger_index). The
+    //! stored records must then provide a get_trigger_id() method.
+    //!
+    //! If the global metrics registry is enabled when the writer is built,
+    //! the writer records the number of stored records, the size of the
+    //! closed output files and the encoding time (see metrics_registry).
     class multifile_data_writer : private boost::noncopyable {
     public:
       /// \brief Configuration data:
@@ -32,6 +49,12 @@ namespace snfee {
         bool terminate_on_overrun =
           false; ///< Soft terminate at file overrun (to many records w/r to the
                  ///< file capacity)
+        bool with_trigger_index =
+          false; ///< Save a trigger ID index next to each output file
+        std::size_t trigger_index_block_size =
+          trigger_index::DEFAULT_BLOCK_SIZE; ///< Records per index block
+        std::string metrics_label =
+          "default"; ///< Value of the "stream" label of the metrics
       };
 
       //! Default constructor
@@ -67,7 +90,18 @@ namespace snfee {
       {
         _pre_store_();
         if (!_terminated_) {
-          _writer_().store(data_);
+          native_data_writer* native_writer = _native_writer_();
+          {
+            metrics_timer timer(_encode_time_);
+            if (native_writer != nullptr) {
+              native_writer->store(data_);
+            } else {
+              _writer_().store(data_);
+            }
+          }
+          if (_config_.with_trigger_index) {
+            _index_record_(data_.get_trigger_id());
+          }
           _post_store_();
         }
         return;
@@ -78,9 +112,15 @@ namespace snfee {
 
       void _post_store_(); //!< Post-store action
 
+      //! Add the last stored record to the index of the current file
+      void _index_record_(const int32_t trigger_id_);
+
       datatools::data_writer&
       _writer_(); //!< Return a ref to the current writer
 
+      //! Return the current native writer (null for a Boost archive)
+      native_data_writer* _native_writer_();
+
     private:
       // Configuration:
       datatools::logger::priority _logging_ = datatools::logger::PRIO_FATAL;
@@ -90,6 +130,9 @@ namespace snfee {
       bool _terminated_ = false; ///< Forced termination flag
       std::size_t _counter_ = 0; ///< Record counter
 
+      // Metrics (null if disabled):
+      metrics_histogram* _encode_time_ = nullptr; ///< Encoding time
+
       struct pimpl_type;
       std::unique_ptr<pimpl_type> _pimpl_; ///< Private working data
     };
@@ -0,0 +1,360 @@
+//! \file snfee/io/native_archive.h
+//! \brief Archives of the native binary data format
+
+#ifndef SNFEE_IO_NATIVE_ARCHIVE_H
+#define SNFEE_IO_NATIVE_ARCHIVE_H
+
+// Standard library:
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/nvp.hpp>
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/i_serializable.h>
+
+// This project:
+#include <snfee/io/native_format.h>
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Output archive of the native binary data format
+    //!
+    //! The archive runs the Boost serialization methods of the data classes
+    //! but writes their members with a fixed layout: arithmetic values as
+    //! little-endian fixed-width integers (booleans on 1 byte, enumerations
+    //! on 4 bytes), strings and vectors with a 32-bit size prefix, shared
+    //! pointers with a 1-byte presence flag followed by the pointee. There
+    //! is no class nor object tracking: shared pointers are expected to be
+    //! owned by a single record (this is the case of all raw data classes).
+    class native_oarchive {
+    public:
+      typedef std::true_type is_saving;
+      typedef std::false_type is_loading;
+
+      /// Constructor (records are appended to a buffer)
+      explicit native_oarchive(std::string& buffer_) : _buffer_(buffer_)
+      {
+        return;
+      }
+
+      template <typename T>
+      native_oarchive&
+      operator&(const T& value_)
+      {
+        save(value_);
+        return *this;
+      }
+
+      template <typename T>
+      native_oarchive&
+      operator<<(const T& value_)
+      {
+        save(value_);
+        return *this;
+      }
+
+      template <typename T>
+      void
+      save(const boost::serialization::nvp<T>& value_)
+      {
+        save(value_.const_value());
+        return;
+      }
+
+      /// The serializable interface has no state
+      void
+      save(const datatools::i_serializable&)
+      {
+        return;
+      }
+
+      void
+      save(const bool value_)
+      {
+        _buffer_.push_back(value_ ? 1 : 0);
+        return;
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_integral<T>::value>::type
+      save(const T value_)
+      {
+        typedef typename std::make_unsigned<T>::type unsigned_type;
+        native_format::put(_buffer_, static_cast<unsigned_type>(value_));
+        return;
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_floating_point<T>::value>::type
+      save(const T value_)
+      {
+        typedef typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::
+          type bits_type;
+        static_assert(sizeof(T) == sizeof(bits_type), "Unsupported float");
+        bits_type bits;
+        std::memcpy(&bits, &value_, sizeof(T));
+        native_format::put(_buffer_, bits);
+        return;
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_enum<T>::value>::type
+      save(const T value_)
+      {
+        native_format::put(_buffer_,
+                           static_cast<uint32_t>(static_cast<int32_t>(value_)));
+        return;
+      }
+
+      void
+      save(const std::string& value_)
+      {
+        native_format::put(_buffer_, static_cast<uint32_t>(value_.size()));
+        _buffer_.append(value_);
+        return;
+      }
+
+      template <typename T, std::size_t N>
+      void
+      save(const T (&values_)[N])
+      {
+        for (std::size_t i = 0; i < N; i++) {
+          save(values_[i]);
+        }
+        return;
+      }
+
+      template <typename T>
+      void
+      save(const std::vector<T>& values_)
+      {
+        native_format::put(_buffer_, static_cast<uint32_t>(values_.size()));
+        for (const auto& value : values_) {
+          save(value);
+        }
+        return;
+      }
+
+      template <typename T>
+      void
+      save(const std::shared_ptr<T>& pointer_)
+      {
+        save(static_cast<bool>(pointer_));
+        if (pointer_) {
+          save(*pointer_);
+        }
+        return;
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_class<T>::value>::type
+      save(const T& value_)
+      {
+        boost::serialization::access::serialize(
+          *this, const_cast<T&>(value_), 0);
+        return;
+      }
+
+    private:
+      std::string& _buffer_; ///< Output buffer
+    };
+
+    //! \brief Input archive of the native binary data format
+    //!
+    //! Decodes a record encoded by native_oarchive from a memory buffer.
+    class native_iarchive {
+    public:
+      typedef std::false_type is_saving;
+      typedef std::true_type is_loading;
+
+      /// Constructor (from a memory buffer)
+      native_iarchive(const char* data_, const std::size_t size_)
+        : _current_(data_), _end_(data_ + size_)
+      {
+        return;
+      }
+
+      /// Check if the whole buffer has been decoded
+      bool
+      is_at_end() const
+      {
+        return _current_ == _end_;
+      }
+
+      template <typename T>
+      native_iarchive&
+      operator&(T& value_)
+      {
+        load(value_);
+        return *this;
+      }
+
+      template <typename T>
+      native_iarchive&
+      operator&(const boost::serialization::nvp<T>& value_)
+      {
+        load(value_.value());
+        return *this;
+      }
+
+      template <typename T>
+      native_iarchive&
+      operator>>(T& value_)
+      {
+        load(value_);
+        return *this;
+      }
+
+      template <typename T>
+      void
+      load(const boost::serialization::nvp<T>& value_)
+      {
+        load(value_.value());
+        return;
+      }
+
+      /// The serializable interface has no state
+      void
+      load(datatools::i_serializable&)
+      {
+        return;
+      }
+
+      void
+      load(bool& value_)
+      {
+        value_ = (*_take_(1) != 0);
+        return;
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_integral<T>::value>::type
+      load(T& value_)
+      {
+        typedef typename std::make_unsigned<T>::type unsigned_type;
+        value_ = static_cast<T>(
+          native_format::peek<unsigned_type>(_take_(sizeof(T))));
+        return;
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_floating_point<T>::value>::type
+      load(T& value_)
+      {
+        typedef typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::
+          type bits_type;
+        static_assert(sizeof(T) == sizeof(bits_type), "Unsupported float");
+        const bits_type bits =
+          native_format::peek<bits_type>(_take_(sizeof(T)));
+        std::memcpy(&value_, &bits, sizeof(T));
+        return;
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_enum<T>::value>::type
+      load(T& value_)
+      {
+        value_ = static_cast<T>(
+          static_cast<int32_t>(native_format::peek<uint32_t>(_take_(4))));
+        return;
+      }
+
+      void
+      load(std::string& value_)
+      {
+        const uint32_t size = native_format::peek<uint32_t>(_take_(4));
+        value_.assign(_take_(size), size);
+        return;
+      }
+
+      template <typename T, std::size_t N>
+      void
+      load(T (&values_)[N])
+      {
+        for (std::size_t i = 0; i < N; i++) {
+          load(values_[i]);
+        }
+        return;
+      }
+
+      template <typename T>
+      void
+      load(std::vector<T>& values_)
+      {
+        const uint32_t size = native_format::peek<uint32_t>(_take_(4));
+        // Each item is encoded on at least one byte:
+        DT_THROW_IF(static_cast<std::size_t>(_end_ - _current_) < size,
+                    std::runtime_error,
+                    "Truncated native record!");
+        values_.clear();
+        values_.resize(size);
+        for (auto& value : values_) {
+          load(value);
+        }
+        return;
+      }
+
+      template <typename T>
+      void
+      load(std::shared_ptr<T>& pointer_)
+      {
+        bool present = false;
+        load(present);
+        if (present) {
+          typedef typename std::remove_const<T>::type value_type;
+          std::shared_ptr<value_type> pointer = std::make_shared<value_type>();
+          load(*pointer);
+          pointer_ = pointer;
+        } else {
+          pointer_.reset();
+        }
+        return;
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_class<T>::value>::type
+      load(T& value_)
+      {
+        boost::serialization::access::serialize(*this, value_, 0);
+        return;
+      }
+
+    private:
+      /// Consume some bytes from the buffer
+      const char*
+      _take_(const std::size_t size_)
+      {
+        DT_THROW_IF(static_cast<std::size_t>(_end_ - _current_) < size_,
+                    std::runtime_error,
+                    "Truncated native record!");
+        const char* data = _current_;
+        _current_ += size_;
+        return data;
+      }
+
+    private:
+      const char* _current_; ///< Current position in the buffer
+      const char* _end_;     ///< End of the buffer
+    };
+
+  } // namespace io
+} // namespace snfee
+
+/// Instantiate the serialization method of a class for the native archives
+#define SNFEE_IO_NATIVE_SERIALIZE_INSTANTIATE(Class)                          \
+  template void Class::serialize<snfee::io::native_oarchive>(                 \
+    snfee::io::native_oarchive&, const unsigned int);                         \
+  template void Class::serialize<snfee::io::native_iarchive>(                 \
+    snfee::io::native_iarchive&, const unsigned int)
+
+#endif // SNFEE_IO_NATIVE_ARCHIVE_H
@@ -0,0 +1,141 @@
+// snfee/io/native_data_reader.cc
+
+// Ourselves:
+#include <snfee/io/native_data_reader.h>
+
+namespace snfee {
+  namespace io {
+
+    native_data_reader::native_data_reader(const std::string& filename_)
+      : _filename_(filename_), _fin_(filename_.c_str(), std::ios::binary)
+    {
+      DT_THROW_IF(!_fin_,
+                  std::runtime_error,
+                  "Cannot open native data file '" << _filename_ << "'!");
+      char header[native_format::MAGIC_SIZE + 4];
+      _fin_.read(header, sizeof(header));
+      DT_THROW_IF(!_fin_ or
+                    std::string(header, native_format::MAGIC_SIZE) !=
+                      std::string(native_format::magic(),
+                                  native_format::MAGIC_SIZE),
+                  std::runtime_error,
+                  "File '" << _filename_ << "' is not a native data file!");
+      const uint32_t version =
+        native_format::peek<uint32_t>(header + native_format::MAGIC_SIZE);
+      DT_THROW_IF(version != native_format::VERSION,
+                  std::runtime_error,
+                  "Unsupported version " << version << " of native data file '"
+                                         << _filename_ << "'!");
+      _next_record_();
+      return;
+    }
+
+    bool
+    native_data_reader::is_initialized() const
+    {
+      return _fin_.is_open();
+    }
+
+    bool
+    native_data_reader::has_record_tag() const
+    {
+      return _has_record_;
+    }
+
+    std::string
+    native_data_reader::get_record_tag() const
+    {
+      if (!_has_record_) {
+        return "";
+      }
+      return _tags_[_record_type_id_];
+    }
+
+    bool
+    native_data_reader::record_tag_is(const std::string& tag_) const
+    {
+      return _has_record_ and _tags_[_record_type_id_] == tag_;
+    }
+
+    void
+    native_data_reader::skip_record()
+    {
+      DT_THROW_IF(!_has_record_, std::logic_error, "No more record!");
+      _next_record_();
+      return;
+    }
+
+    bool
+    native_data_reader::_read_block_()
+    {
+      char header[12];
+      _fin_.read(header, sizeof(header));
+      const std::size_t header_bytes = _fin_.gcount();
+      if (header_bytes == 0 and _fin_.eof()) {
+        return false;
+      }
+      DT_THROW_IF(header_bytes != sizeof(header) or
+                    native_format::peek<uint32_t>(header) !=
+                      native_format::BLOCK_MAGIC,
+                  std::runtime_error,
+                  "Corrupted block in native data file '" << _filename_
+                                                         << "'!");
+      const uint32_t payload_size = native_format::peek<uint32_t>(header + 4);
+      _block_entries_ = native_format::peek<uint32_t>(header + 8);
+      _block_.resize(payload_size);
+      _fin_.read(_block_.data(), payload_size);
+      const std::size_t payload_bytes = _fin_.gcount();
+      DT_THROW_IF(payload_bytes != payload_size,
+                  std::runtime_error,
+                  "Truncated block in native data file '" << _filename_
+                                                         << "'!");
+      _block_position_ = 0;
+      return true;
+    }
+
+    void
+    native_data_reader::_next_record_()
+    {
+      _has_record_ = false;
+      while (true) {
+        if (_block_entries_ == 0) {
+          DT_THROW_IF(_block_position_ != _block_.size(),
+                      std::runtime_error,
+                      "Corrupted block in native data file '" << _filename_
+                                                             << "'!");
+          if (!_read_block_()) {
+            return;
+          }
+          continue;
+        }
+        DT_THROW_IF(_block_.size() - _block_position_ < 6,
+                    std::runtime_error,
+                    "Truncated entry in native data file '" << _filename_
+                                                           << "'!");
+        const char* entry = _block_.data() + _block_position_;
+        const uint16_t type_id = native_format::peek<uint16_t>(entry);
+        const uint32_t size = native_format::peek<uint32_t>(entry + 2);
+        DT_THROW_IF(_block_.size() - _block_position_ - 6 < size,
+                    std::runtime_error,
+                    "Truncated entry in native data file '" << _filename_
+                                                           << "'!");
+        _block_position_ += 6 + size;
+        _block_entries_--;
+        if (type_id == native_format::TAG_DECLARATION) {
+          _tags_.push_back(std::string(entry + 6, size));
+          continue;
+        }
+        DT_THROW_IF(type_id >= _tags_.size(),
+                    std::runtime_error,
+                    "Undeclared type of record in native data file '"
+                      << _filename_ << "'!");
+        _record_type_id_ = type_id;
+        _record_data_ = entry + 6;
+        _record_size_ = size;
+        _has_record_ = true;
+        return;
+      }
+    }
+
+  } // namespace io
+} // namespace snfee
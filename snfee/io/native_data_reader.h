@@ -0,0 +1,91 @@
+//! \file snfee/io/native_data_reader.h
+//! \brief Reader of native binary data files
+
+#ifndef SNFEE_IO_NATIVE_DATA_READER_H
+#define SNFEE_IO_NATIVE_DATA_READER_H
+
+// Standard library:
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/utility.hpp>
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+// This project:
+#include <snfee/io/native_archive.h>
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Reader of native binary data files (see native_format)
+    //!
+    //! The interface mimics the one of datatools::data_reader. The file is
+    //! read one block at a time.
+    class native_data_reader : private boost::noncopyable {
+    public:
+      //! Constructor
+      native_data_reader(const std::string& filename_);
+
+      //! Check if the input file is open
+      bool is_initialized() const;
+
+      //! Check if a next record is available
+      bool has_record_tag() const;
+
+      //! Return the serialization tag of the next record
+      std::string get_record_tag() const;
+
+      //! Check if the next record has a given serialization tag
+      bool record_tag_is(const std::string& tag_) const;
+
+      //! Load the next record
+      template <typename Data>
+      void
+      load(Data& data_)
+      {
+        DT_THROW_IF(!has_record_tag(), std::logic_error, "No more record!");
+        DT_THROW_IF(!record_tag_is(data_.get_serial_tag()),
+                    std::logic_error,
+                    "Next record '" << get_record_tag() << "' is not a '"
+                                    << data_.get_serial_tag() << "'!");
+        native_iarchive archive(_record_data_, _record_size_);
+        archive >> data_;
+        DT_THROW_IF(!archive.is_at_end(),
+                    std::runtime_error,
+                    "Corrupted native record '" << get_record_tag() << "'!");
+        _next_record_();
+        return;
+      }
+
+      //! Skip the next record without decoding it
+      void skip_record();
+
+    private:
+      /// Move to the next record (decode tag declarations, read blocks)
+      void _next_record_();
+
+      /// Read the next block, return false at the end of the file
+      bool _read_block_();
+
+    private:
+      std::string _filename_;            ///< Name of the input file
+      std::ifstream _fin_;               ///< Input file
+      std::vector<std::string> _tags_;   ///< Serialization tags by type ID
+      std::vector<char> _block_;         ///< Payload of the current block
+      std::size_t _block_position_ = 0;  ///< Position in the current block
+      uint32_t _block_entries_ = 0;      ///< Entries left in the block
+      bool _has_record_ = false;         ///< Next record flag
+      uint16_t _record_type_id_ = 0;     ///< Type ID of the next record
+      const char* _record_data_ = nullptr; ///< Encoded next record
+      std::size_t _record_size_ = 0;       ///< Size of the next record
+    };
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_NATIVE_DATA_READER_H
@@ -0,0 +1,110 @@
+// snfee/io/native_data_writer.cc
+
+// Ourselves:
+#include <snfee/io/native_data_writer.h>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snfee {
+  namespace io {
+
+    native_data_writer::native_data_writer(const std::string& filename_,
+                                           const std::size_t block_size_)
+      : _fout_(filename_.c_str(), std::ios::binary | std::ios::trunc),
+        _block_size_(block_size_)
+    {
+      DT_THROW_IF(!_fout_,
+                  std::runtime_error,
+                  "Cannot open native data file '" << filename_ << "'!");
+      std::string header(native_format::magic(), native_format::MAGIC_SIZE);
+      native_format::put(header, native_format::VERSION);
+      _fout_.write(header.data(), header.size());
+      _block_.reserve(_block_size_ + _block_size_ / 4);
+      return;
+    }
+
+    native_data_writer::~native_data_writer()
+    {
+      if (_fout_.is_open()) {
+        try {
+          flush();
+        }
+        catch (...) {
+          // Errors are reported by explicit calls to flush()
+        }
+        _fout_.close();
+      }
+      return;
+    }
+
+    bool
+    native_data_writer::is_initialized() const
+    {
+      return _fout_.is_open() and _fout_.good();
+    }
+
+    void
+    native_data_writer::flush()
+    {
+      if (_block_entries_ == 0) {
+        return;
+      }
+      std::string header;
+      native_format::put(header, native_format::BLOCK_MAGIC);
+      native_format::put(header, static_cast<uint32_t>(_block_.size()));
+      native_format::put(header, _block_entries_);
+      _fout_.write(header.data(), header.size());
+      _fout_.write(_block_.data(), _block_.size());
+      DT_THROW_IF(!_fout_, std::runtime_error, "Cannot write native block!");
+      _block_.clear();
+      _block_entries_ = 0;
+      return;
+    }
+
+    uint16_t
+    native_data_writer::_type_id_(const std::string& tag_)
+    {
+      auto found = _type_ids_.find(tag_);
+      if (found != _type_ids_.end()) {
+        return found->second;
+      }
+      DT_THROW_IF(_type_ids_.size() == native_format::TAG_DECLARATION,
+                  std::logic_error,
+                  "Too many types of records!");
+      const uint16_t type_id = _type_ids_.size();
+      const std::size_t entry_start =
+        _begin_entry_(native_format::TAG_DECLARATION);
+      _block_.append(tag_);
+      _end_entry_(entry_start);
+      _type_ids_[tag_] = type_id;
+      return type_id;
+    }
+
+    std::size_t
+    native_data_writer::_begin_entry_(const uint16_t type_id_)
+    {
+      const std::size_t entry_start = _block_.size();
+      native_format::put(_block_, type_id_);
+      // Placeholder for the size of the record:
+      native_format::put(_block_, uint32_t(0));
+      return entry_start;
+    }
+
+    void
+    native_data_writer::_end_entry_(const std::size_t entry_start_)
+    {
+      const std::size_t record_start = entry_start_ + 2 + 4;
+      const std::size_t record_size = _block_.size() - record_start;
+      native_format::poke(&_block_[entry_start_ + 2],
+                          static_cast<uint32_t>(record_size));
+      _block_entries_++;
+      if (_block_.size() >= _block_size_) {
+        flush();
+      }
+      return;
+    }
+
+  } // namespace io
+} // namespace snfee
@@ -0,0 +1,79 @@
+//! \file snfee/io/native_data_writer.h
+//! \brief Writer of native binary data files
+
+#ifndef SNFEE_IO_NATIVE_DATA_WRITER_H
+#define SNFEE_IO_NATIVE_DATA_WRITER_H
+
+// Standard library:
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+
+// Third party:
+// - Boost:
+#include <boost/utility.hpp>
+
+// This project:
+#include <snfee/io/native_archive.h>
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Writer of native binary data files (see native_format)
+    //!
+    //! Records are encoded in a memory block which is written to the file
+    //! once it reaches a given size, and when the writer is destroyed.
+    class native_data_writer : private boost::noncopyable {
+    public:
+      /// Default size of the blocks (bytes)
+      static const std::size_t DEFAULT_BLOCK_SIZE = 1048576;
+
+      //! Constructor
+      native_data_writer(const std::string& filename_,
+                         const std::size_t block_size_ = DEFAULT_BLOCK_SIZE);
+
+      //! Destructor
+      ~native_data_writer();
+
+      //! Check if the output file is open
+      bool is_initialized() const;
+
+      //! Store a record
+      template <typename Data>
+      void
+      store(const Data& data_)
+      {
+        const std::size_t entry_start =
+          _begin_entry_(_type_id_(data_.get_serial_tag()));
+        native_oarchive archive(_block_);
+        archive << data_;
+        _end_entry_(entry_start);
+        return;
+      }
+
+      //! Write the current block
+      void flush();
+
+    private:
+      /// Return the type ID of a serialization tag (declare it if needed)
+      uint16_t _type_id_(const std::string& tag_);
+
+      /// Start a new entry in the block, return its offset
+      std::size_t _begin_entry_(const uint16_t type_id_);
+
+      /// Complete the entry which starts at a given offset
+      void _end_entry_(const std::size_t entry_start_);
+
+    private:
+      std::ofstream _fout_;               ///< Output file
+      std::size_t _block_size_;           ///< Size of the blocks (bytes)
+      std::string _block_;                ///< Payload of the current block
+      uint32_t _block_entries_ = 0;       ///< Entries in the current block
+      std::map<std::string, uint16_t> _type_ids_; ///< Declared types
+    };
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_NATIVE_DATA_WRITER_H
@@ -0,0 +1,41 @@
+// snfee/io/native_format.cc
+
+// Ourselves:
+#include <snfee/io/native_format.h>
+
+namespace snfee {
+  namespace io {
+
+    // Definitions of the static constants:
+    const std::size_t native_format::MAGIC_SIZE;
+    const uint32_t native_format::VERSION;
+    const uint32_t native_format::BLOCK_MAGIC;
+    const uint16_t native_format::TAG_DECLARATION;
+
+    // static
+    const char*
+    native_format::magic()
+    {
+      return "SNFEENAT";
+    }
+
+    // static
+    const char*
+    native_format::file_extension()
+    {
+      return ".snraw";
+    }
+
+    // static
+    bool
+    native_format::is_native_filename(const std::string& filename_)
+    {
+      const std::string extension = file_extension();
+      return filename_.size() >= extension.size() and
+             filename_.compare(filename_.size() - extension.size(),
+                               extension.size(),
+                               extension) == 0;
+    }
+
+  } // namespace io
+} // namespace snfee
@@ -0,0 +1,94 @@
+//! \file snfee/io/native_format.h
+//! \brief Constants and helpers of the native binary data format
+
+#ifndef SNFEE_IO_NATIVE_FORMAT_H
+#define SNFEE_IO_NATIVE_FORMAT_H
+
+// Standard library:
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Native binary data format
+    //!
+    //! Layout of a native data file (all integers are little-endian):
+    //! \code
+    //! File   : MAGIC (8 bytes) | VERSION (u32) | Block*
+    //! Block  : BLOCK_MAGIC (u32) | payload size (u32) | entries (u32)
+    //!          | Entry*
+    //! Entry  : type ID (u16) | record size (u32) | record
+    //! \endcode
+    //! An entry with the TAG_DECLARATION type ID declares the serialization
+    //! tag of the next type ID (the record is the tag). Records are encoded
+    //! by the native archives (see native_archive.h), without class nor
+    //! object tracking information.
+    struct native_format {
+      /// Magic string at the beginning of a native data file
+      static const char* magic();
+
+      /// Length of the magic string
+      static const std::size_t MAGIC_SIZE = 8;
+
+      /// Version of the format
+      static const uint32_t VERSION = 1;
+
+      /// Magic number at the beginning of a block
+      static const uint32_t BLOCK_MAGIC = 0x4B4C4253; // "SBLK"
+
+      /// Type ID of the entries declaring a new serialization tag
+      static const uint16_t TAG_DECLARATION = 0xFFFF;
+
+      /// File extension of native data files
+      static const char* file_extension();
+
+      /// Check if a filename refers to a native data file
+      static bool is_native_filename(const std::string& filename_);
+
+      /// Append an unsigned integer (little-endian) to a buffer
+      template <typename UInt>
+      static void
+      put(std::string& buffer_, const UInt value_)
+      {
+        static_assert(std::is_unsigned<UInt>::value, "Unsigned type expected");
+        char bytes[sizeof(UInt)];
+        for (std::size_t i = 0; i < sizeof(UInt); i++) {
+          bytes[i] = static_cast<char>((value_ >> (8 * i)) & 0xFF);
+        }
+        buffer_.append(bytes, sizeof(UInt));
+        return;
+      }
+
+      /// Write an unsigned integer (little-endian) at a given address
+      template <typename UInt>
+      static void
+      poke(char* address_, const UInt value_)
+      {
+        static_assert(std::is_unsigned<UInt>::value, "Unsigned type expected");
+        for (std::size_t i = 0; i < sizeof(UInt); i++) {
+          address_[i] = static_cast<char>((value_ >> (8 * i)) & 0xFF);
+        }
+        return;
+      }
+
+      /// Read an unsigned integer (little-endian) at a given address
+      template <typename UInt>
+      static UInt
+      peek(const char* address_)
+      {
+        static_assert(std::is_unsigned<UInt>::value, "Unsigned type expected");
+        UInt value = 0;
+        for (std::size_t i = 0; i < sizeof(UInt); i++) {
+          value |= static_cast<UInt>(static_cast<unsigned char>(address_[i]))
+                   << (8 * i);
+        }
+        return value;
+      }
+    };
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_NATIVE_FORMAT_H
@@ -0,0 +1,369 @@
+// snfee/io/root_output_config.cc
+
+// Ourselves:
+#include <snfee/io/root_output_config.h>
+
+// Standard library:
+#include <sstream>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/algorithm/string.hpp>
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/utils.h>
+// - Root:
+#include <TBranch.h>
+#include <TFile.h>
+#include <TLeaf.h>
+#include <TObjArray.h>
+#include <TRegexp.h>
+#include <TString.h>
+#include <TTree.h>
+
+namespace snfee {
+  namespace io {
+
+    namespace {
+
+      /// Split a "NAME=VALUE" representation
+      void
+      split_branch_repr(const std::string& repr_,
+                        std::string& name_,
+                        std::string& value_)
+      {
+        const std::size_t pos = repr_.find('=');
+        DT_THROW_IF(pos == std::string::npos or pos == 0 or
+                      pos + 1 == repr_.size(),
+                    std::logic_error,
+                    "Invalid branch setting '" << repr_
+                                               << "' (expected NAME=VALUE)!");
+        name_ = boost::trim_copy(repr_.substr(0, pos));
+        value_ = boost::trim_copy(repr_.substr(pos + 1));
+        return;
+      }
+
+    } // namespace
+
+    // static
+    std::string
+    root_output_config::compression_algorithm_label(
+      const compression_algorithm_type a_)
+    {
+      switch (a_) {
+        case COMPRESSION_NONE:
+          return "NONE";
+        case COMPRESSION_ZLIB:
+          return "ZLIB";
+        case COMPRESSION_LZMA:
+          return "LZMA";
+        case COMPRESSION_LZ4:
+          return "LZ4";
+        case COMPRESSION_ZSTD:
+          return "ZSTD";
+        default:
+          break;
+      }
+      return "";
+    }
+
+    // static
+    root_output_config::compression_algorithm_type
+    root_output_config::compression_algorithm_from(const std::string& label_)
+    {
+      const std::string label = boost::to_upper_copy(label_);
+      for (int a = COMPRESSION_NONE; a <= COMPRESSION_ZSTD; a++) {
+        const compression_algorithm_type algo =
+          static_cast<compression_algorithm_type>(a);
+        if (label == compression_algorithm_label(algo)) {
+          return algo;
+        }
+      }
+      DT_THROW(std::logic_error,
+               "Unknown compression algorithm '" << label_ << "'!");
+    }
+
+    // static
+    int
+    root_output_config::default_compression_level(
+      const compression_algorithm_type a_)
+    {
+      // Same defaults as ROOT::RCompressionSetting:
+      switch (a_) {
+        case COMPRESSION_ZLIB:
+          return 1;
+        case COMPRESSION_LZMA:
+          return 7;
+        case COMPRESSION_LZ4:
+          return 4;
+        case COMPRESSION_ZSTD:
+          return 5;
+        default:
+          break;
+      }
+      return 0;
+    }
+
+    bool
+    root_output_config::compression_type::is_set() const
+    {
+      return algorithm != COMPRESSION_UNDEF;
+    }
+
+    int
+    root_output_config::compression_type::root_settings() const
+    {
+      // ROOT algorithm codes (see ROOT::RCompressionSetting::EAlgorithm):
+      int root_algorithm = 0;
+      switch (algorithm) {
+        case COMPRESSION_ZLIB:
+          root_algorithm = 1;
+          break;
+        case COMPRESSION_LZMA:
+          root_algorithm = 2;
+          break;
+        case COMPRESSION_LZ4:
+          root_algorithm = 4;
+          break;
+        case COMPRESSION_ZSTD:
+          root_algorithm = 5;
+          break;
+        default:
+          return 0;
+      }
+      const int lvl = level < 0 ? default_compression_level(algorithm) : level;
+      return 100 * root_algorithm + lvl;
+    }
+
+    void
+    root_output_config::compression_type::parse(const std::string& repr_)
+    {
+      std::vector<std::string> tokens;
+      boost::split(tokens, repr_, boost::is_any_of(":"));
+      DT_THROW_IF(tokens.size() > 2,
+                  std::logic_error,
+                  "Invalid compression '" << repr_
+                                          << "' (expected ALGORITHM[:LEVEL])!");
+      const compression_algorithm_type algo =
+        compression_algorithm_from(boost::trim_copy(tokens[0]));
+      int lvl = -1;
+      if (tokens.size() == 2) {
+        std::istringstream level_in(boost::trim_copy(tokens[1]));
+        level_in >> lvl;
+        DT_THROW_IF(level_in.fail() or !level_in.eof() or lvl < 0 or lvl > 9,
+                    std::logic_error,
+                    "Invalid compression level in '" << repr_ << "'!");
+      }
+      algorithm = algo;
+      level = lvl;
+      return;
+    }
+
+    std::string
+    root_output_config::compression_type::to_string() const
+    {
+      if (!is_set()) {
+        return "";
+      }
+      std::ostringstream out;
+      out << compression_algorithm_label(algorithm);
+      if (algorithm != COMPRESSION_NONE) {
+        out << ':' << root_settings() % 100;
+      }
+      return out.str();
+    }
+
+    void
+    root_output_config::set_branch_basket_size(const std::string& repr_)
+    {
+      std::string name;
+      std::string value;
+      split_branch_repr(repr_, name, value);
+      std::istringstream value_in(value);
+      int32_t size = 0;
+      value_in >> size;
+      DT_THROW_IF(value_in.fail() or !value_in.eof() or size <= 0,
+                  std::logic_error,
+                  "Invalid basket size in '" << repr_ << "'!");
+      branch_configs[name].basket_size = size;
+      return;
+    }
+
+    void
+    root_output_config::set_branch_compression(const std::string& repr_)
+    {
+      std::string name;
+      std::string value;
+      split_branch_repr(repr_, name, value);
+      branch_configs[name].compression.parse(value);
+      return;
+    }
+
+    void
+    root_output_config::configure(const datatools::properties& config_)
+    {
+      if (config_.has_key("compression")) {
+        compression.parse(config_.fetch_string("compression"));
+      }
+      if (config_.has_key("basket_size")) {
+        basket_size = config_.fetch_positive_integer("basket_size");
+      }
+      if (config_.has_key("auto_flush")) {
+        auto_flush = config_.fetch_integer("auto_flush");
+      }
+      if (config_.has_key("auto_save")) {
+        auto_save = config_.fetch_integer("auto_save");
+      }
+      std::vector<std::string> branches;
+      if (config_.has_key("branches")) {
+        config_.fetch("branches", branches);
+      }
+      for (const auto& branch_name : branches) {
+        branch_config_type& bcfg = branch_configs[branch_name];
+        const std::string prefix = "branches." + branch_name + ".";
+        if (config_.has_key(prefix + "basket_size")) {
+          bcfg.basket_size =
+            config_.fetch_positive_integer(prefix + "basket_size");
+        }
+        if (config_.has_key(prefix + "compression")) {
+          bcfg.compression.parse(config_.fetch_string(prefix + "compression"));
+        }
+      }
+      return;
+    }
+
+    void
+    root_output_config::load(const std::string& filename_)
+    {
+      std::string filename = filename_;
+      datatools::fetch_path_with_env(filename);
+      datatools::properties config;
+      datatools::properties::read_config(filename, config);
+      configure(config);
+      return;
+    }
+
+    void
+    root_output_config::apply(TFile& file_) const
+    {
+      if (compression.is_set()) {
+        file_.SetCompressionSettings(compression.root_settings());
+      }
+      return;
+    }
+
+    void
+    root_output_config::apply(TTree& tree_) const
+    {
+      if (basket_size > 0) {
+        tree_.SetBasketSize("*", basket_size);
+      }
+      if (auto_flush != 0) {
+        tree_.SetAutoFlush(auto_flush);
+      }
+      if (auto_save != 0) {
+        tree_.SetAutoSave(auto_save);
+      }
+      for (const auto& bcfg : branch_configs) {
+        if (bcfg.second.basket_size > 0) {
+          tree_.SetBasketSize(bcfg.first.c_str(), bcfg.second.basket_size);
+        }
+        if (!bcfg.second.compression.is_set()) {
+          continue;
+        }
+        // Apply to all branches matching the name (possibly a wildcard):
+        const TRegexp pattern(bcfg.first.c_str(), kTRUE);
+        const int settings = bcfg.second.compression.root_settings();
+        TObjArray* leaves = tree_.GetListOfLeaves();
+        for (Int_t ileaf = 0; ileaf < leaves->GetEntriesFast(); ileaf++) {
+          TBranch* branch = static_cast<TLeaf*>(leaves->At(ileaf))->GetBranch();
+          TString branch_name(branch->GetName());
+          if (branch_name == bcfg.first.c_str() or
+              branch_name.Index(pattern) != kNPOS) {
+            branch->SetCompressionSettings(settings);
+          }
+        }
+      }
+      return;
+    }
+
+    // static
+    void
+    root_output_config::add_options(
+      boost::program_options::options_description& opts_)
+    {
+      namespace po = boost::program_options;
+      // clang-format off
+      opts_.add_options()
+        ("root-config",
+         po::value<std::string>()->value_name("path"),
+         "load the ROOT output tuning from a configuration file")
+
+        ("compression",
+         po::value<std::string>()->value_name("algo[:level]"),
+         "set the compression of the ROOT output file "
+         "(NONE, ZLIB, LZMA, LZ4, ZSTD, ex: ZSTD:5)")
+
+        ("basket-size",
+         po::value<int32_t>()->value_name("bytes"),
+         "set the basket size of all branches")
+
+        ("auto-flush",
+         po::value<int64_t>()->value_name("number"),
+         "set the auto-flush of the trees (>0: entries, <0: bytes)")
+
+        ("auto-save",
+         po::value<int64_t>()->value_name("number"),
+         "set the auto-save of the trees (>0: entries, <0: bytes)")
+
+        ("branch-basket-size",
+         po::value<std::vector<std::string>>()->value_name("name=bytes"),
+         "set the basket size of a branch (repeatable, wildcards allowed)")
+
+        ("branch-compression",
+         po::value<std::vector<std::string>>()->value_name("name=algo[:level]"),
+         "set the compression of a branch (repeatable, wildcards allowed)")
+        ;
+      // clang-format on
+      return;
+    }
+
+    void
+    root_output_config::configure(
+      const boost::program_options::variables_map& vm_)
+    {
+      if (vm_.count("root-config")) {
+        load(vm_["root-config"].as<std::string>());
+      }
+      if (vm_.count("compression")) {
+        compression.parse(vm_["compression"].as<std::string>());
+      }
+      if (vm_.count("basket-size")) {
+        basket_size = vm_["basket-size"].as<int32_t>();
+        DT_THROW_IF(
+          basket_size <= 0, std::logic_error, "Invalid basket size!");
+      }
+      if (vm_.count("auto-flush")) {
+        auto_flush = vm_["auto-flush"].as<int64_t>();
+      }
+      if (vm_.count("auto-save")) {
+        auto_save = vm_["auto-save"].as<int64_t>();
+      }
+      if (vm_.count("branch-basket-size")) {
+        for (const auto& repr :
+             vm_["branch-basket-size"].as<std::vector<std::string>>()) {
+          set_branch_basket_size(repr);
+        }
+      }
+      if (vm_.count("branch-compression")) {
+        for (const auto& repr :
+             vm_["branch-compression"].as<std::vector<std::string>>()) {
+          set_branch_compression(repr);
+        }
+      }
+      return;
+    }
+
+  } // namespace io
+} // namespace snfee
@@ -0,0 +1,132 @@
+//! \file snfee/io/root_output_config.h
+//! \brief Tuning of ROOT output files and trees
+
+#ifndef SNFEE_IO_ROOT_OUTPUT_CONFIG_H
+#define SNFEE_IO_ROOT_OUTPUT_CONFIG_H
+
+// Standard library:
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Third party:
+// - Boost:
+#include <boost/program_options.hpp>
+// - Bayeux:
+#include <bayeux/datatools/properties.h>
+
+class TFile;
+class TTree;
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Tuning of ROOT output files and trees
+    //!
+    //! All parameters default to the ROOT defaults. The compression applies
+    //! to the file and must be set before the trees are created, the other
+    //! parameters apply to a tree once its branches are created:
+    //! \code
+    //! TFile file(filename.c_str(), "RECREATE");
+    //! cfg.apply(file);
+    //! TTree tree("T", "Title");
+    //! tree.Branch(...);
+    //! cfg.apply(tree);
+    //! \endcode
+    //!
+    //! Configuration file (datatools::properties format):
+    //! \code
+    //! compression : string = "ZSTD:5"
+    //! basket_size : integer = 256000
+    //! auto_flush  : integer = -30000000
+    //! auto_save   : integer = -300000000
+    //! branches : string[2] = "calo_ch0_waveform" "calo_ch1_waveform"
+    //! branches.calo_ch0_waveform.basket_size : integer = 1024000
+    //! branches.calo_ch0_waveform.compression : string = "LZ4:4"
+    //! \endcode
+    class root_output_config {
+    public:
+      /// \brief Compression algorithm
+      enum compression_algorithm_type {
+        COMPRESSION_UNDEF = 0, ///< ROOT default (inherited settings)
+        COMPRESSION_NONE = 1,  ///< No compression
+        COMPRESSION_ZLIB = 2,  ///< ZLIB
+        COMPRESSION_LZMA = 3,  ///< LZMA
+        COMPRESSION_LZ4 = 4,   ///< LZ4
+        COMPRESSION_ZSTD = 5   ///< ZSTD (ROOT >= 6.20)
+      };
+
+      /// Return the label associated to a compression algorithm
+      static std::string compression_algorithm_label(
+        const compression_algorithm_type);
+
+      /// Return the compression algorithm associated to a label
+      static compression_algorithm_type compression_algorithm_from(
+        const std::string& label_);
+
+      /// Return the default compression level of an algorithm
+      static int default_compression_level(const compression_algorithm_type);
+
+      /// \brief Compression settings
+      struct compression_type {
+        compression_algorithm_type algorithm = COMPRESSION_UNDEF;
+        int level = -1; ///< Compression level (-1: algorithm default)
+
+        /// Check if the compression is set
+        bool is_set() const;
+
+        /// Return the ROOT compression settings (100 * algorithm + level)
+        int root_settings() const;
+
+        /// Set from a "ALGORITHM[:LEVEL]" representation (ex: "ZSTD:5")
+        void parse(const std::string& repr_);
+
+        /// Return the "ALGORITHM:LEVEL" representation
+        std::string to_string() const;
+      };
+
+      /// \brief Per-branch overrides
+      struct branch_config_type {
+        compression_type compression; ///< Compression
+        int32_t basket_size = 0;      ///< Basket size (0: tree default)
+      };
+
+      /// Set the basket size of a branch from a "NAME=SIZE" representation
+      void set_branch_basket_size(const std::string& repr_);
+
+      /// Set the compression of a branch from a "NAME=ALGORITHM[:LEVEL]"
+      /// representation
+      void set_branch_compression(const std::string& repr_);
+
+      /// Configure from a set of properties
+      void configure(const datatools::properties& config_);
+
+      /// Load from a configuration file
+      void load(const std::string& filename_);
+
+      /// Apply the file settings (compression)
+      void apply(TFile& file_) const;
+
+      /// Apply the tree settings (basket sizes, auto-flush/save, branches)
+      void apply(TTree& tree_) const;
+
+      /// Add the command line options of the ROOT output tuning
+      static void add_options(boost::program_options::options_description&);
+
+      /// Configure from the command line options (a configuration file given
+      /// with --root-config is loaded first, explicit options override it)
+      void configure(const boost::program_options::variables_map& vm_);
+
+    public:
+      compression_type compression; ///< Compression of the file
+      int32_t basket_size = 0;      ///< Basket size of all branches (0: ROOT)
+      int64_t auto_flush = 0; ///< Auto-flush (>0: entries, <0: bytes, 0: ROOT)
+      int64_t auto_save = 0;  ///< Auto-save (>0: entries, <0: bytes, 0: ROOT)
+      std::map<std::string, branch_config_type>
+        branch_configs; ///< Per-branch overrides (wildcards allowed)
+    };
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_ROOT_OUTPUT_CONFIG_H
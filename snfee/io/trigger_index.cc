@@ -0,0 +1,220 @@
+// snfee/io/trigger_index.cc
+
+// Ourselves:
+#include <snfee/io/trigger_index.h>
+
+// Standard library:
+#include <fstream>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/utils.h>
+
+namespace snfee {
+  namespace io {
+
+    namespace {
+      /// Magic header of the index files
+      const std::string INDEX_MAGIC = "#@snfee::io::trigger_index";
+
+      /// Version of the format of the index files
+      const int INDEX_VERSION = 1;
+    } // namespace
+
+    // Definitions of the static constants:
+    const std::size_t trigger_index::DEFAULT_BLOCK_SIZE;
+    const int32_t trigger_index::INVALID_TRIGGER_ID;
+
+    bool
+    trigger_index::block_type::overlaps(const int32_t first_trigger_id_,
+                                        const int32_t last_trigger_id_) const
+    {
+      if (number_of_records == 0) {
+        return false;
+      }
+      return min_trigger_id <= last_trigger_id_ and
+             max_trigger_id >= first_trigger_id_;
+    }
+
+    // static
+    std::string
+    trigger_index::index_filename(const std::string& data_filename_)
+    {
+      return data_filename_ + ".tidx";
+    }
+
+    trigger_index::trigger_index(const std::size_t block_size_)
+      : _block_size_(block_size_)
+    {
+      DT_THROW_IF(
+        _block_size_ == 0, std::logic_error, "Invalid index block size!");
+      return;
+    }
+
+    std::size_t
+    trigger_index::get_block_size() const
+    {
+      return _block_size_;
+    }
+
+    std::size_t
+    trigger_index::get_number_of_records() const
+    {
+      return _number_of_records_;
+    }
+
+    const std::vector<trigger_index::block_type>&
+    trigger_index::get_blocks() const
+    {
+      return _blocks_;
+    }
+
+    bool
+    trigger_index::is_sorted() const
+    {
+      return _sorted_;
+    }
+
+    void
+    trigger_index::add_record(const int32_t trigger_id_)
+    {
+      if (_blocks_.empty() or
+          _blocks_.back().number_of_records == _block_size_) {
+        block_type new_block;
+        new_block.first_record = _number_of_records_;
+        new_block.min_trigger_id = trigger_id_;
+        new_block.max_trigger_id = trigger_id_;
+        _blocks_.push_back(new_block);
+      }
+      block_type& block = _blocks_.back();
+      block.number_of_records++;
+      if (trigger_id_ < block.min_trigger_id) {
+        block.min_trigger_id = trigger_id_;
+      }
+      if (trigger_id_ > block.max_trigger_id) {
+        block.max_trigger_id = trigger_id_;
+      }
+      if (_number_of_records_ > 0 and trigger_id_ < _last_trigger_id_) {
+        _sorted_ = false;
+      }
+      _last_trigger_id_ = trigger_id_;
+      _number_of_records_++;
+      return;
+    }
+
+    void
+    trigger_index::reset()
+    {
+      _number_of_records_ = 0;
+      _sorted_ = true;
+      _last_trigger_id_ = INVALID_TRIGGER_ID;
+      _blocks_.clear();
+      return;
+    }
+
+    void
+    trigger_index::store(const std::string& filename_) const
+    {
+      std::string filename = filename_;
+      datatools::fetch_path_with_env(filename);
+      std::ofstream fout(filename.c_str());
+      DT_THROW_IF(!fout,
+                  std::runtime_error,
+                  "Cannot open index file '" << filename << "'!");
+      fout << INDEX_MAGIC << '\n';
+      fout << "version " << INDEX_VERSION << '\n';
+      fout << "block_size " << _block_size_ << '\n';
+      fout << "number_of_records " << _number_of_records_ << '\n';
+      fout << "sorted " << (_sorted_ ? 1 : 0) << '\n';
+      fout << "last_trigger_id " << _last_trigger_id_ << '\n';
+      fout << "number_of_blocks " << _blocks_.size() << '\n';
+      for (const auto& block : _blocks_) {
+        fout << block.first_record << ' ' << block.number_of_records << ' '
+             << block.min_trigger_id << ' ' << block.max_trigger_id << '\n';
+      }
+      DT_THROW_IF(!fout,
+                  std::runtime_error,
+                  "Cannot write index file '" << filename << "'!");
+      return;
+    }
+
+    void
+    trigger_index::load(const std::string& filename_)
+    {
+      std::string filename = filename_;
+      datatools::fetch_path_with_env(filename);
+      std::ifstream fin(filename.c_str());
+      DT_THROW_IF(!fin,
+                  std::runtime_error,
+                  "Cannot open index file '" << filename << "'!");
+      std::string magic;
+      std::getline(fin, magic);
+      DT_THROW_IF(magic != INDEX_MAGIC,
+                  std::runtime_error,
+                  "File '" << filename << "' is not a trigger ID index!");
+      std::string key;
+      int version = 0;
+      std::size_t block_size = 0;
+      std::size_t number_of_records = 0;
+      int sorted = 0;
+      int32_t last_trigger_id = INVALID_TRIGGER_ID;
+      std::size_t number_of_blocks = 0;
+      fin >> key >> version;
+      DT_THROW_IF(!fin or key != "version" or version != INDEX_VERSION,
+                  std::runtime_error,
+                  "Unsupported version of index file '" << filename << "'!");
+      fin >> key >> block_size >> key >> number_of_records >> key >> sorted >>
+        key >> last_trigger_id >> key >> number_of_blocks;
+      DT_THROW_IF(!fin or block_size == 0,
+                  std::runtime_error,
+                  "Invalid header in index file '" << filename << "'!");
+      std::vector<block_type> blocks;
+      blocks.reserve(number_of_blocks);
+      std::size_t next_record = 0;
+      for (std::size_t iblock = 0; iblock < number_of_blocks; iblock++) {
+        block_type block;
+        fin >> block.first_record >> block.number_of_records >>
+          block.min_trigger_id >> block.max_trigger_id;
+        DT_THROW_IF(!fin or block.first_record != next_record,
+                    std::runtime_error,
+                    "Invalid block #" << iblock << " in index file '"
+                                      << filename << "'!");
+        next_record += block.number_of_records;
+        blocks.push_back(block);
+      }
+      DT_THROW_IF(next_record != number_of_records,
+                  std::runtime_error,
+                  "Inconsistent number of records in index file '"
+                    << filename << "'!");
+      _block_size_ = block_size;
+      _number_of_records_ = number_of_records;
+      _sorted_ = (sorted != 0);
+      _last_trigger_id_ = last_trigger_id;
+      _blocks_ = std::move(blocks);
+      return;
+    }
+
+    void
+    trigger_index::print(std::ostream& out_, const std::string& indent_) const
+    {
+      out_ << indent_ << "|-- Block size : " << _block_size_ << std::endl;
+      out_ << indent_ << "|-- Number of records : " << _number_of_records_
+           << std::endl;
+      out_ << indent_ << "|-- Sorted : " << std::boolalpha << _sorted_
+           << std::endl;
+      out_ << indent_ << "`-- Blocks : " << _blocks_.size() << std::endl;
+      for (std::size_t iblock = 0; iblock < _blocks_.size(); iblock++) {
+        const block_type& block = _blocks_[iblock];
+        const bool last = (iblock + 1 == _blocks_.size());
+        out_ << indent_ << "    " << (last ? "`-- " : "|-- ") << "Records ["
+             << block.first_record << ", "
+             << block.first_record + block.number_of_records
+             << ") : trigger IDs [" << block.min_trigger_id << ", "
+             << block.max_trigger_id << "]" << std::endl;
+      }
+      return;
+    }
+
+  } // namespace io
+} // namespace snfee
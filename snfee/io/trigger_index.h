@@ -0,0 +1,89 @@
+//! \file snfee/io/trigger_index.h
+//! \brief Trigger ID index of a data file
+
+#ifndef SNFEE_IO_TRIGGER_INDEX_H
+#define SNFEE_IO_TRIGGER_INDEX_H
+
+// Standard library:
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace snfee {
+  namespace io {
+
+    //! \brief Trigger ID index of a data file
+    //!
+    //! The records of a data file are grouped in blocks of consecutive
+    //! records. For each block, the index stores the rank of its first record
+    //! in the file and the range of the trigger IDs of its records. The
+    //! index is saved in a sidecar text file, next to the data file.
+    //!
+    //! Trigger IDs need not be sorted: all the records with a given trigger
+    //! ID are found in the blocks which range contains this trigger ID.
+    class trigger_index {
+    public:
+      /// Default number of records per block
+      static const std::size_t DEFAULT_BLOCK_SIZE = 100;
+
+      /// Invalid trigger ID
+      static const int32_t INVALID_TRIGGER_ID = -1;
+
+      /// \brief Block of consecutive records
+      struct block_type {
+        std::size_t first_record = 0; ///< Rank of the first record in the file
+        std::size_t number_of_records = 0; ///< Number of records
+        int32_t min_trigger_id = INVALID_TRIGGER_ID; ///< Min. trigger ID
+        int32_t max_trigger_id = INVALID_TRIGGER_ID; ///< Max. trigger ID
+
+        /// Check if the block may contain some trigger IDs in a range
+        bool overlaps(const int32_t first_trigger_id_,
+                      const int32_t last_trigger_id_) const;
+      };
+
+      /// Return the name of the index file associated to a data file
+      static std::string index_filename(const std::string& data_filename_);
+
+      //! Default constructor
+      trigger_index(const std::size_t block_size_ = DEFAULT_BLOCK_SIZE);
+
+      //! Return the number of records per block
+      std::size_t get_block_size() const;
+
+      //! Return the number of indexed records
+      std::size_t get_number_of_records() const;
+
+      //! Return the blocks
+      const std::vector<block_type>& get_blocks() const;
+
+      //! Check if the trigger IDs of the records are never decreasing
+      bool is_sorted() const;
+
+      //! Index the next record of the file
+      void add_record(const int32_t trigger_id_);
+
+      //! Reset the index
+      void reset();
+
+      //! Store the index in a file
+      void store(const std::string& filename_) const;
+
+      //! Load the index from a file
+      void load(const std::string& filename_);
+
+      //! Smart print
+      void print(std::ostream& out_, const std::string& indent_ = "") const;
+
+    private:
+      std::size_t _block_size_ = DEFAULT_BLOCK_SIZE; ///< Records per block
+      std::size_t _number_of_records_ = 0;           ///< Indexed records
+      bool _sorted_ = true;                 ///< Sorted trigger IDs flag
+      int32_t _last_trigger_id_ = INVALID_TRIGGER_ID; ///< Last trigger ID
+      std::vector<block_type> _blocks_;     ///< Blocks of records
+    };
+
+  } // namespace io
+} // namespace snfee
+
+#endif // SNFEE_IO_TRIGGER_INDEX_H
@@ -0,0 +1,32 @@
+// snfee/native_dict.cc
+//
+// Instantiation of the serialization methods of the raw data classes for
+// the native binary archives (see snfee/io/native_archive.h)
+
+// Third party:
+// - Boost:
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#endif
+#include <boost/serialization/base_object.hpp>
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+
+// This project:
+#include <snfee/io/native_archive.h>
+
+// clang-format off
+
+#include <snfee/data/calo_hit_record-serial.h>
+SNFEE_IO_NATIVE_SERIALIZE_INSTANTIATE(snfee::data::calo_hit_record);
+
+#include <snfee/data/tracker_hit_record-serial.h>
+SNFEE_IO_NATIVE_SERIALIZE_INSTANTIATE(snfee::data::tracker_hit_record);
+
+#include <snfee/data/trigger_record-serial.h>
+SNFEE_IO_NATIVE_SERIALIZE_INSTANTIATE(snfee::data::trigger_record);
+
+#include <snfee/data/raw_trigger_data-serial.h>
+SNFEE_IO_NATIVE_SERIALIZE_INSTANTIATE(snfee::data::raw_trigger_data);
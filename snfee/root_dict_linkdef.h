@@ -38,9 +38,27 @@
 #pragma link C++ class snfee::data::tracker_hit_record+;
 #pragma link C++ class std::vector<snfee::data::tracker_hit_record>+;
 
+// Version 1 of waveforms_record stored the samples of both channels in a
+// vector of two_channel_adc_record (_samples_), version 2 stores the samples
+// of channel #0 followed by the ones of channel #1 (_adc_). Files written
+// with version 1 are converted on reading by the rule below, which needs the
+// dictionary of two_channel_adc_record.
 #pragma link C++ class snfee::data::calo_hit_record::two_channel_adc_record+;
 #pragma link C++ class std::vector<snfee::data::calo_hit_record::two_channel_adc_record>+;
-#pragma link C++ class snfee::data::calo_hit_record::waveforms_record+;
+#pragma link C++ options=version(2) class snfee::data::calo_hit_record::waveforms_record+;
+#pragma read sourceClass="snfee::data::calo_hit_record::waveforms_record" \
+  version="[-1]" \
+  targetClass="snfee::data::calo_hit_record::waveforms_record" \
+  source="std::vector<snfee::data::calo_hit_record::two_channel_adc_record> _samples_" \
+  target="_adc_" \
+  code="{ \
+    const std::size_t nb_samples = onfile._samples_.size(); \
+    _adc_.resize(2 * nb_samples); \
+    for (std::size_t isample = 0; isample < nb_samples; isample++) { \
+      _adc_[isample] = onfile._samples_[isample].get_adc(0); \
+      _adc_[nb_samples + isample] = onfile._samples_[isample].get_adc(1); \
+    } \
+  }"
 #pragma link C++ class snfee::data::calo_hit_record::channel_data_record+;
 #pragma link C++ class snfee::data::calo_hit_record+;
 #pragma link C++ class std::vector<snfee::data::calo_hit_record>+;
@@ -0,0 +1,12 @@
+// Dictionary of the version 1 of waveforms_record, for the writer of the
+// legacy Root file only
+#include "waveforms_record_v1.h"
+
+// clang-format off
+#pragma link C++ nestedclass;
+#pragma link C++ namespace snfee;
+#pragma link C++ namespace snfee::data;
+
+#pragma link C++ class snfee::data::calo_hit_record::two_channel_adc_record+;
+#pragma link C++ class std::vector<snfee::data::calo_hit_record::two_channel_adc_record>+;
+#pragma link C++ class snfee::data::calo_hit_record::waveforms_record+;
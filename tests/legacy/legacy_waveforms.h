@@ -0,0 +1,47 @@
+// tests/legacy/legacy_waveforms.h
+//
+// Content of the Root file of waveform records written with the former
+// layout of waveforms_record, shared by its writer and its reader.
+
+#ifndef SNFEE_TEST_LEGACY_WAVEFORMS_H
+#define SNFEE_TEST_LEGACY_WAVEFORMS_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+
+namespace snfee {
+  namespace test {
+    namespace legacy {
+
+      /// Name of the tree of waveform records
+      const char* const TREE_NAME = "waveforms";
+
+      /// Name of the branch of split waveform records
+      const char* const SPLIT_BRANCH_NAME = "split";
+
+      /// Name of the branch of unsplit waveform records
+      const char* const UNSPLIT_BRANCH_NAME = "unsplit";
+
+      /// Number of samples per channel of the successive entries
+      const uint16_t NUMBER_OF_SAMPLES[] = {0, 17, 1024, 1};
+
+      /// Number of entries of the tree
+      const std::size_t NUMBER_OF_ENTRIES =
+        sizeof(NUMBER_OF_SAMPLES) / sizeof(NUMBER_OF_SAMPLES[0]);
+
+      //! Return the ADC value stored at a given entry, sample and channel
+      inline uint16_t
+      adc(const std::size_t entry_,
+          const uint16_t sample_,
+          const uint16_t channel_)
+      {
+        // Cover the 12 bits of the ADC and tell the channels apart:
+        return (entry_ * 131 + sample_ * 7 + channel_ * 2048) % 4096;
+      }
+
+    } // namespace legacy
+  }   // namespace test
+} // namespace snfee
+
+#endif // SNFEE_TEST_LEGACY_WAVEFORMS_H
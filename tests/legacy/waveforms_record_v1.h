@@ -0,0 +1,34 @@
+// tests/legacy/waveforms_record_v1.h
+//
+// Version 1 of the Root layout of the waveforms of the calorimeter hits,
+// where the samples of both channels were stored as a vector of
+// two_channel_adc_record. Only the persistent members are declared.
+//
+// These declarations clash with snfee/data/calo_hit_record.h: they are only
+// used by the writer of the legacy file, which does not link with the
+// SNRawDataProducts library.
+
+#ifndef SNFEE_TEST_LEGACY_WAVEFORMS_RECORD_V1_H
+#define SNFEE_TEST_LEGACY_WAVEFORMS_RECORD_V1_H
+
+// Standard library:
+#include <cstdint>
+#include <vector>
+
+namespace snfee {
+  namespace data {
+
+    struct calo_hit_record {
+      struct two_channel_adc_record {
+        uint16_t _adc_[2];
+      };
+
+      struct waveforms_record {
+        std::vector<two_channel_adc_record> _samples_;
+      };
+    };
+
+  } // namespace data
+} // namespace snfee
+
+#endif // SNFEE_TEST_LEGACY_WAVEFORMS_RECORD_V1_H
@@ -0,0 +1,55 @@
+// tests/legacy/write_legacy_waveforms.cxx
+//
+// Write a Root file of waveform records with the version 1 of their layout,
+// in a split and an unsplit branch, for test_root_schema_evolution.
+//
+// Usage: write_legacy_waveforms <output Root file>
+
+// Standard library:
+#include <cstdlib>
+#include <iostream>
+
+// Third party:
+// - Root:
+#include <TFile.h>
+#include <TTree.h>
+
+// This project:
+#include "legacy_waveforms.h"
+#include "waveforms_record_v1.h"
+
+int
+main(int argc_, char** argv_)
+{
+  if (argc_ != 2) {
+    std::cerr << "usage: write_legacy_waveforms <output Root file>"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  namespace legacy = snfee::test::legacy;
+  TFile file(argv_[1], "RECREATE");
+  if (file.IsZombie()) {
+    std::cerr << "write_legacy_waveforms: cannot create '" << argv_[1] << "'"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  TTree tree(legacy::TREE_NAME, "Waveforms of calorimeter hits (version 1)");
+  auto* waveforms = new snfee::data::calo_hit_record::waveforms_record;
+  tree.Branch(legacy::SPLIT_BRANCH_NAME, &waveforms, 32000, 99);
+  tree.Branch(legacy::UNSPLIT_BRANCH_NAME, &waveforms, 32000, 0);
+  for (std::size_t ientry = 0; ientry < legacy::NUMBER_OF_ENTRIES; ientry++) {
+    const uint16_t nb_samples = legacy::NUMBER_OF_SAMPLES[ientry];
+    waveforms->_samples_.resize(nb_samples);
+    for (uint16_t isample = 0; isample < nb_samples; isample++) {
+      for (uint16_t ichannel = 0; ichannel < 2; ichannel++) {
+        waveforms->_samples_[isample]._adc_[ichannel] =
+          legacy::adc(ientry, isample, ichannel);
+      }
+    }
+    tree.Fill();
+  }
+  file.Write();
+  file.Close();
+  delete waveforms;
+  return EXIT_SUCCESS;
+}
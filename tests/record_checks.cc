@@ -0,0 +1,131 @@
+// tests/record_checks.cc
+
+// Ourselves:
+#include "record_checks.h"
+
+// Standard library:
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+namespace snfee {
+  namespace test {
+
+    void
+    expect_same(const snfee::data::trigger_record& expected_,
+                const snfee::data::trigger_record& actual_)
+    {
+      EXPECT_EQ(expected_.get_trigger_id(), actual_.get_trigger_id());
+      EXPECT_EQ(expected_.get_trigger_mode(), actual_.get_trigger_mode());
+      EXPECT_EQ(expected_.get_l2_clocktick_1600ns(),
+                actual_.get_l2_clocktick_1600ns());
+      return;
+    }
+
+    void
+    expect_same(const snfee::data::tracker_hit_record& expected_,
+                const snfee::data::tracker_hit_record& actual_)
+    {
+      EXPECT_EQ(expected_.get_hit_num(), actual_.get_hit_num());
+      EXPECT_EQ(expected_.get_trigger_id(), actual_.get_trigger_id());
+      EXPECT_EQ(expected_.get_crate_num(), actual_.get_crate_num());
+      EXPECT_EQ(expected_.get_board_num(), actual_.get_board_num());
+      EXPECT_EQ(expected_.get_chip_num(), actual_.get_chip_num());
+      EXPECT_EQ(expected_.get_channel_num(), actual_.get_channel_num());
+      EXPECT_EQ(expected_.get_channel_category(),
+                actual_.get_channel_category());
+      EXPECT_EQ(expected_.get_timestamp_category(),
+                actual_.get_timestamp_category());
+      EXPECT_EQ(expected_.get_timestamp(), actual_.get_timestamp());
+      return;
+    }
+
+    void
+    expect_same(const snfee::data::calo_hit_record::channel_data_record& e_,
+                const snfee::data::calo_hit_record::channel_data_record& a_)
+    {
+      EXPECT_EQ(e_.is_lt(), a_.is_lt());
+      EXPECT_EQ(e_.is_ht(), a_.is_ht());
+      EXPECT_EQ(e_.is_underflow(), a_.is_underflow());
+      EXPECT_EQ(e_.is_overflow(), a_.is_overflow());
+      EXPECT_EQ(e_.get_baseline(), a_.get_baseline());
+      EXPECT_EQ(e_.get_peak(), a_.get_peak());
+      EXPECT_EQ(e_.get_peak_cell(), a_.get_peak_cell());
+      EXPECT_EQ(e_.get_charge(), a_.get_charge());
+      EXPECT_EQ(e_.get_rising_cell(), a_.get_rising_cell());
+      EXPECT_EQ(e_.get_falling_cell(), a_.get_falling_cell());
+      return;
+    }
+
+    void
+    expect_same(const snfee::data::calo_hit_record& expected_,
+                const snfee::data::calo_hit_record& actual_)
+    {
+      EXPECT_EQ(expected_.get_hit_num(), actual_.get_hit_num());
+      EXPECT_EQ(expected_.get_trigger_id(), actual_.get_trigger_id());
+      EXPECT_EQ(expected_.get_tdc(), actual_.get_tdc());
+      EXPECT_EQ(expected_.get_crate_num(), actual_.get_crate_num());
+      EXPECT_EQ(expected_.get_board_num(), actual_.get_board_num());
+      EXPECT_EQ(expected_.get_chip_num(), actual_.get_chip_num());
+      EXPECT_EQ(expected_.get_event_id(), actual_.get_event_id());
+      EXPECT_EQ(expected_.get_l2_id(), actual_.get_l2_id());
+      EXPECT_EQ(expected_.get_fcr(), actual_.get_fcr());
+      ASSERT_EQ(expected_.has_waveforms(), actual_.has_waveforms());
+      if (expected_.has_waveforms()) {
+        EXPECT_EQ(expected_.get_waveform_start_sample(),
+                  actual_.get_waveform_start_sample());
+        EXPECT_EQ(expected_.get_waveform_number_of_samples(),
+                  actual_.get_waveform_number_of_samples());
+        const snfee::data::calo_hit_record::waveforms_record& e_wf =
+          expected_.get_waveforms();
+        const snfee::data::calo_hit_record::waveforms_record& a_wf =
+          actual_.get_waveforms();
+        ASSERT_EQ(e_wf.get_number_of_samples(), a_wf.get_number_of_samples());
+        for (uint16_t ichannel = 0; ichannel < 2; ichannel++) {
+          const std::vector<uint16_t> e_samples(
+            e_wf.channel_samples(ichannel).begin(),
+            e_wf.channel_samples(ichannel).end());
+          const std::vector<uint16_t> a_samples(
+            a_wf.channel_samples(ichannel).begin(),
+            a_wf.channel_samples(ichannel).end());
+          EXPECT_EQ(e_samples, a_samples) << "channel #" << ichannel;
+        }
+      }
+      for (uint16_t ichannel = 0; ichannel < 2; ichannel++) {
+        expect_same(expected_.get_channel_data(ichannel),
+                    actual_.get_channel_data(ichannel));
+      }
+      return;
+    }
+
+    void
+    expect_same(const snfee::data::raw_trigger_data& expected_,
+                const snfee::data::raw_trigger_data& actual_)
+    {
+      EXPECT_EQ(expected_.get_run_id(), actual_.get_run_id());
+      EXPECT_EQ(expected_.get_trigger_id(), actual_.get_trigger_id());
+      ASSERT_EQ(expected_.has_trig(), actual_.has_trig());
+      if (expected_.has_trig()) {
+        expect_same(*expected_.get_trig(), *actual_.get_trig());
+      }
+      ASSERT_EQ(expected_.get_calo_hits().size(),
+                actual_.get_calo_hits().size());
+      for (std::size_t ihit = 0; ihit < expected_.get_calo_hits().size();
+           ihit++) {
+        expect_same(*expected_.get_calo_hits()[ihit],
+                    *actual_.get_calo_hits()[ihit]);
+      }
+      ASSERT_EQ(expected_.get_tracker_hits().size(),
+                actual_.get_tracker_hits().size());
+      for (std::size_t ihit = 0; ihit < expected_.get_tracker_hits().size();
+           ihit++) {
+        expect_same(*expected_.get_tracker_hits()[ihit],
+                    *actual_.get_tracker_hits()[ihit]);
+      }
+      return;
+    }
+
+  } // namespace test
+} // namespace snfee
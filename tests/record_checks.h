@@ -0,0 +1,40 @@
+//! \file tests/record_checks.h
+//! \brief Field by field comparisons of raw data records for the unit tests
+
+#ifndef SNFEE_TEST_RECORD_CHECKS_H
+#define SNFEE_TEST_RECORD_CHECKS_H
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/data/tracker_hit_record.h>
+#include <snfee/data/trigger_record.h>
+
+namespace snfee {
+  namespace test {
+
+    //! Check that two trigger records are equal
+    void expect_same(const snfee::data::trigger_record& expected_,
+                     const snfee::data::trigger_record& actual_);
+
+    //! Check that two tracker hits are equal
+    void expect_same(const snfee::data::tracker_hit_record& expected_,
+                     const snfee::data::tracker_hit_record& actual_);
+
+    //! Check that the data of two SAMLONG channels are equal
+    void expect_same(
+      const snfee::data::calo_hit_record::channel_data_record& e_,
+      const snfee::data::calo_hit_record::channel_data_record& a_);
+
+    //! Check that two calorimeter hits, waveforms included, are equal
+    void expect_same(const snfee::data::calo_hit_record& expected_,
+                     const snfee::data::calo_hit_record& actual_);
+
+    //! Check that two RTD records and all their hits are equal
+    void expect_same(const snfee::data::raw_trigger_data& expected_,
+                     const snfee::data::raw_trigger_data& actual_);
+
+  } // namespace test
+} // namespace snfee
+
+#endif // SNFEE_TEST_RECORD_CHECKS_H
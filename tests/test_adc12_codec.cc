@@ -0,0 +1,158 @@
+// tests/test_adc12_codec.cc
+//
+// Exhaustive round trip of the 12-bit ADC codec of the calorimeter
+// waveforms, with all the instruction sets supported by the CPU, checked
+// against the former per-sample packing formulas (bit compatibility with
+// the existing archives).
+
+// Standard library:
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include <snfee/data/adc12_codec.h>
+
+namespace {
+
+  /// Number of 12-bit ADC values
+  const uint32_t NUMBER_OF_ADC_VALUES = 4096;
+
+  //! Pack samples with the former per-sample formulas
+  std::string
+  reference_pack(const std::vector<uint16_t>& adc0_,
+                 const std::vector<uint16_t>& adc1_)
+  {
+    std::string packed(3 * adc0_.size(), 0);
+    for (std::size_t i = 0; i < adc0_.size(); i++) {
+      const uint16_t adc0_12 = adc0_[i] % 4096;
+      const uint16_t adc1_12 = adc1_[i] % 4096;
+      packed[3 * i] = adc0_12 / 16;
+      packed[3 * i + 1] = (adc0_12 % 16) * 16 + adc1_12 / 256;
+      packed[3 * i + 2] = adc1_12 % 256;
+    }
+    return packed;
+  }
+
+  //! Return the instruction sets supported by the CPU
+  std::vector<snfee::data::adc12_codec::isa_type>
+  supported_isas()
+  {
+    std::vector<snfee::data::adc12_codec::isa_type> isas;
+    const snfee::data::adc12_codec::isa_type best =
+      snfee::data::adc12_codec::best_isa();
+    for (int isa = snfee::data::adc12_codec::ISA_SCALAR; isa <= best;
+         isa++) {
+      isas.push_back(static_cast<snfee::data::adc12_codec::isa_type>(isa));
+    }
+    return isas;
+  }
+
+  //! Check the packing of samples against the former formulas and their
+  //! unpacking, from buffers starting at a given offset
+  void
+  expect_round_trip(const snfee::data::adc12_codec& codec_,
+                    const std::vector<uint16_t>& adc0_,
+                    const std::vector<uint16_t>& adc1_,
+                    const std::size_t offset_ = 0)
+  {
+    const std::size_t nb_samples = adc0_.size();
+    const std::string expected = reference_pack(adc0_, adc1_);
+    // Unaligned buffers, with guard bytes after the end:
+    std::vector<char> packed(offset_ + 3 * nb_samples + 64, 'G');
+    codec_.pack(adc0_.data(), adc1_.data(), nb_samples, &packed[offset_]);
+    ASSERT_EQ(expected,
+              std::string(&packed[offset_], &packed[offset_] + 3 * nb_samples))
+      << snfee::data::adc12_codec::isa_label(codec_.get_isa());
+    for (std::size_t i = offset_ + 3 * nb_samples; i < packed.size(); i++) {
+      ASSERT_EQ('G', packed[i]) << "byte #" << i << " overwritten";
+    }
+    std::vector<uint16_t> adc0(offset_ + nb_samples + 32, 0xFFFF);
+    std::vector<uint16_t> adc1(offset_ + nb_samples + 32, 0xFFFF);
+    codec_.unpack(
+      &packed[offset_], nb_samples, &adc0[offset_], &adc1[offset_]);
+    for (std::size_t i = 0; i < nb_samples; i++) {
+      ASSERT_EQ(adc0_[i] % 4096, adc0[offset_ + i]) << "sample #" << i;
+      ASSERT_EQ(adc1_[i] % 4096, adc1[offset_ + i]) << "sample #" << i;
+    }
+    for (std::size_t i = offset_ + nb_samples; i < adc0.size(); i++) {
+      ASSERT_EQ(0xFFFF, adc0[i]) << "sample #" << i << " overwritten";
+      ASSERT_EQ(0xFFFF, adc1[i]) << "sample #" << i << " overwritten";
+    }
+    return;
+  }
+
+} // namespace
+
+TEST(adc12_codec, all_adc_pairs)
+{
+  // Every pair of 12-bit values, 4096 samples at a time:
+  std::vector<uint16_t> adc0(NUMBER_OF_ADC_VALUES);
+  std::vector<uint16_t> adc1(NUMBER_OF_ADC_VALUES);
+  for (const auto isa : supported_isas()) {
+    const snfee::data::adc12_codec codec(isa);
+    for (uint32_t value0 = 0; value0 < NUMBER_OF_ADC_VALUES; value0++) {
+      for (uint32_t value1 = 0; value1 < NUMBER_OF_ADC_VALUES; value1++) {
+        adc0[value1] = value0;
+        adc1[value1] = value1;
+      }
+      expect_round_trip(codec, adc0, adc1);
+      // The channels swapped:
+      expect_round_trip(codec, adc1, adc0);
+      if (HasFatalFailure()) {
+        return;
+      }
+    }
+  }
+}
+
+TEST(adc12_codec, unused_bits_ignored)
+{
+  std::mt19937 random(4096);
+  std::vector<uint16_t> adc0(1024);
+  std::vector<uint16_t> adc1(1024);
+  for (std::size_t i = 0; i < adc0.size(); i++) {
+    adc0[i] = random();
+    adc1[i] = random();
+  }
+  for (const auto isa : supported_isas()) {
+    expect_round_trip(snfee::data::adc12_codec(isa), adc0, adc1);
+  }
+}
+
+TEST(adc12_codec, all_sizes_and_alignments)
+{
+  // The vectorized bulk and the scalar tail, from any alignment:
+  std::mt19937 random(1024);
+  std::uniform_int_distribution<int> adc(0, NUMBER_OF_ADC_VALUES - 1);
+  for (const auto isa : supported_isas()) {
+    const snfee::data::adc12_codec codec(isa);
+    for (std::size_t nb_samples = 0; nb_samples <= 130; nb_samples++) {
+      std::vector<uint16_t> adc0(nb_samples);
+      std::vector<uint16_t> adc1(nb_samples);
+      for (std::size_t i = 0; i < nb_samples; i++) {
+        adc0[i] = adc(random);
+        adc1[i] = adc(random);
+      }
+      for (std::size_t offset = 0; offset < 4; offset++) {
+        SCOPED_TRACE("samples: " + std::to_string(nb_samples) +
+                     ", offset: " + std::to_string(offset));
+        expect_round_trip(codec, adc0, adc1, offset);
+        if (HasFatalFailure()) {
+          return;
+        }
+      }
+    }
+  }
+}
+
+TEST(adc12_codec, shared_instance_uses_best_isa)
+{
+  EXPECT_EQ(snfee::data::adc12_codec::best_isa(),
+            snfee::data::adc12_codec::instance().get_isa());
+}
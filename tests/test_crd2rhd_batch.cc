@@ -0,0 +1,164 @@
+// tests/test_crd2rhd_batch.cc
+//
+// Conversion of the CRD files of several crates by crd2rhd: the RHD files
+// written by the crate-parallel batch mode (--batch-list) must be byte for
+// byte the ones written by a sequential run of crd2rhd per crate.
+
+// Standard library:
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include "synthetic_generator.h"
+#include "test_records.h"
+
+namespace {
+
+  /// Path of the crd2rhd program (argument of the test)
+  std::string crd2rhd_path;
+
+  /// Number of crates
+  const int16_t NUMBER_OF_CRATES = 3;
+
+  /// Number of CRD files per crate
+  const std::size_t NUMBER_OF_CRD_FILES = 2;
+
+  //! Return the paths of the CRD files of the crates, written on first use
+  const std::vector<std::vector<std::string>>&
+  get_crd_paths()
+  {
+    static std::vector<std::vector<std::string>> paths;
+    if (paths.empty()) {
+      paths.resize(NUMBER_OF_CRATES);
+      for (int16_t icrate = 0; icrate < NUMBER_OF_CRATES; icrate++) {
+        for (std::size_t ifile = 0; ifile < NUMBER_OF_CRD_FILES; ifile++) {
+          snfee::bench::synthetic_generator::config_type config;
+          config.seed = 1000 + icrate * NUMBER_OF_CRD_FILES + ifile;
+          config.crate_num = icrate;
+          config.number_of_triggers = 150;
+          config.mean_calo_hits = 3.0;
+          snfee::bench::synthetic_generator generator(config);
+          const std::string path = snfee::test::make_temp_path(
+            "crd2rhd_batch_crate-" + std::to_string(icrate) + "_" +
+            std::to_string(ifile) + ".crd");
+          generator.write_crd(path);
+          paths[icrate].push_back(path);
+        }
+      }
+    }
+    return paths;
+  }
+
+  //! Run crd2rhd with some options (return false on failure)
+  bool
+  run_crd2rhd(const std::string& options_)
+  {
+    const std::string command =
+      "\"" + crd2rhd_path + "\" " + options_ + " > /dev/null 2>&1";
+    return std::system(command.c_str()) == 0;
+  }
+
+  //! Return the content of a file
+  std::string
+  read_file(const std::string& path_)
+  {
+    std::ifstream fin(path_.c_str(), std::ios::binary);
+    EXPECT_TRUE(fin.good()) << "Cannot open '" << path_ << "'";
+    return std::string(std::istreambuf_iterator<char>(fin),
+                       std::istreambuf_iterator<char>());
+  }
+
+  /// \brief Parameters of the conversions (RHD file extension, number of
+  /// parsing threads of the batch mode)
+  struct conversion_params {
+    std::string extension;
+    std::size_t nb_threads;
+  };
+
+  class crd2rhd_batch : public ::testing::TestWithParam<conversion_params> {
+  };
+
+} // namespace
+
+TEST_P(crd2rhd_batch, same_as_sequential)
+{
+  const conversion_params& params = GetParam();
+  const std::vector<std::vector<std::string>>& crd_paths = get_crd_paths();
+  std::vector<std::string> sequential_paths;
+  std::vector<std::string> batch_paths;
+  for (int16_t icrate = 0; icrate < NUMBER_OF_CRATES; icrate++) {
+    const std::string suffix =
+      "_crate-" + std::to_string(icrate) + params.extension;
+    sequential_paths.push_back(
+      snfee::test::make_temp_path("crd2rhd_sequential" + suffix));
+    batch_paths.push_back(
+      snfee::test::make_temp_path("crd2rhd_batch" + suffix));
+  }
+
+  // One sequential run per crate:
+  for (int16_t icrate = 0; icrate < NUMBER_OF_CRATES; icrate++) {
+    std::string options = "--crate-number " + std::to_string(icrate) +
+                          " --output-file \"" + sequential_paths[icrate] +
+                          "\"";
+    for (const auto& crd_path : crd_paths[icrate]) {
+      options += " --input-file \"" + crd_path + "\"";
+    }
+    ASSERT_TRUE(run_crd2rhd(options)) << "crate #" << icrate;
+  }
+
+  // All the crates at once:
+  const std::string listname =
+    snfee::test::make_temp_path("crd2rhd_batch.lis");
+  {
+    std::ofstream flist(listname.c_str());
+    flist << "# Crate number, RHD output file, CRD input files\n";
+    for (int16_t icrate = 0; icrate < NUMBER_OF_CRATES; icrate++) {
+      flist << icrate << ' ' << batch_paths[icrate];
+      for (const auto& crd_path : crd_paths[icrate]) {
+        flist << ' ' << crd_path;
+      }
+      flist << '\n';
+    }
+  }
+  ASSERT_TRUE(run_crd2rhd("--parser-threads " +
+                          std::to_string(params.nb_threads) +
+                          " --batch-list \"" + listname + "\""));
+
+  for (int16_t icrate = 0; icrate < NUMBER_OF_CRATES; icrate++) {
+    SCOPED_TRACE("crate #" + std::to_string(icrate));
+    const std::string sequential_rhd = read_file(sequential_paths[icrate]);
+    EXPECT_FALSE(sequential_rhd.empty());
+    // Not EXPECT_EQ, that would print the whole files on failure:
+    EXPECT_TRUE(read_file(batch_paths[icrate]) == sequential_rhd)
+      << "'" << batch_paths[icrate] << "' differs from '"
+      << sequential_paths[icrate] << "'";
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  formats_and_threads,
+  crd2rhd_batch,
+  ::testing::Values(conversion_params{".xml", 1},
+                    conversion_params{".xml", 4},
+                    conversion_params{".data.gz", 4},
+                    conversion_params{".snraw", 8}));
+
+int
+main(int argc_, char** argv_)
+{
+  ::testing::InitGoogleTest(&argc_, argv_);
+  if (argc_ != 2) {
+    std::cerr << "usage: test_crd2rhd_batch <crd2rhd program>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  crd2rhd_path = argv_[1];
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,160 @@
+// tests/test_crd_parsing.cc
+//
+// Parsing of a CRD file on a pool of threads: whatever the number of
+// threads and the size of the chunks, the hits must be the ones of the
+// sequential parsing, in the same order.
+
+// Standard library:
+#include <string>
+#include <thread>
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/tracker_hit_record.h>
+
+#include "raw_hit_reader.h"
+#include "record_checks.h"
+#include "synthetic_generator.h"
+#include "test_records.h"
+#include "thread_pool.h"
+
+namespace {
+
+  /// Crate number of the CRD file
+  const int16_t CRATE_NUM = 0;
+
+  /// \brief Hits parsed from a CRD file, in the order of the file
+  struct parsed_hits_type {
+    std::vector<snfee::io::raw_record_parser::record_type> record_types;
+    std::vector<snfee::data::calo_hit_record> calo_hits;
+    std::vector<snfee::data::tracker_hit_record> tracker_hits;
+  };
+
+  //! Return the path of the CRD file, written on first use
+  const std::string&
+  get_crd_path()
+  {
+    static std::string path;
+    if (path.empty()) {
+      snfee::bench::synthetic_generator::config_type config;
+      config.crate_num = CRATE_NUM;
+      config.number_of_triggers = 200;
+      config.mean_calo_hits = 3.0;
+      config.mean_tracker_cells = 6.0;
+      snfee::bench::synthetic_generator generator(config);
+      path = snfee::test::make_temp_path("crd_parsing.crd");
+      generator.write_crd(path);
+    }
+    return path;
+  }
+
+  //! Parse the CRD file
+  parsed_hits_type
+  parse(const std::size_t nb_threads_,
+        const std::size_t chunk_size_,
+        const bool with_calo_waveforms_,
+        snfee::io::thread_pool* pool_ = nullptr)
+  {
+    snfee::io::raw_hit_reader::config_type reader_config;
+    reader_config.input_filename = get_crd_path();
+    reader_config.crate_num = CRATE_NUM;
+    reader_config.with_calo_waveforms = with_calo_waveforms_;
+    reader_config.number_of_parser_threads = nb_threads_;
+    reader_config.parser_chunk_size = chunk_size_;
+    reader_config.parser_pool = pool_;
+    parsed_hits_type hits;
+    snfee::data::calo_hit_record calo_hit;
+    snfee::data::tracker_hit_record tracker_hit;
+    snfee::io::raw_hit_reader reader;
+    reader.set_config(reader_config);
+    reader.initialize();
+    while (reader.has_next_hit()) {
+      const snfee::io::raw_record_parser::record_type record_type =
+        reader.load_next_hit(calo_hit, tracker_hit);
+      hits.record_types.push_back(record_type);
+      if (record_type == snfee::io::raw_record_parser::RECORD_CALO) {
+        hits.calo_hits.push_back(calo_hit);
+      } else if (record_type == snfee::io::raw_record_parser::RECORD_TRACKER) {
+        hits.tracker_hits.push_back(tracker_hit);
+      }
+    }
+    reader.reset();
+    return hits;
+  }
+
+  //! Check that the hits of two parsings are the same
+  void
+  expect_same_hits(const parsed_hits_type& expected_,
+                   const parsed_hits_type& actual_)
+  {
+    ASSERT_EQ(expected_.record_types, actual_.record_types);
+    ASSERT_EQ(expected_.calo_hits.size(), actual_.calo_hits.size());
+    for (std::size_t ihit = 0; ihit < expected_.calo_hits.size(); ihit++) {
+      SCOPED_TRACE("calo hit #" + std::to_string(ihit));
+      snfee::test::expect_same(expected_.calo_hits[ihit],
+                               actual_.calo_hits[ihit]);
+    }
+    ASSERT_EQ(expected_.tracker_hits.size(), actual_.tracker_hits.size());
+    for (std::size_t ihit = 0; ihit < expected_.tracker_hits.size();
+         ihit++) {
+      SCOPED_TRACE("tracker hit #" + std::to_string(ihit));
+      snfee::test::expect_same(expected_.tracker_hits[ihit],
+                               actual_.tracker_hits[ihit]);
+    }
+    return;
+  }
+
+  //! Check the parallel parsings against the sequential one
+  void
+  expect_parallel_same_as_sequential(const bool with_calo_waveforms_)
+  {
+    const parsed_hits_type sequential =
+      parse(1,
+            snfee::io::parallel_hit_parser::DEFAULT_CHUNK_SIZE,
+            with_calo_waveforms_);
+    ASSERT_FALSE(sequential.calo_hits.empty());
+    ASSERT_FALSE(sequential.tracker_hits.empty());
+    // From chunks smaller than a waveform line to a single chunk:
+    for (const std::size_t nb_threads : {2, 4}) {
+      for (const std::size_t chunk_size : {512, 4096, 65536, 1 << 24}) {
+        SCOPED_TRACE("threads: " + std::to_string(nb_threads) +
+                     ", chunk size: " + std::to_string(chunk_size));
+        expect_same_hits(
+          sequential, parse(nb_threads, chunk_size, with_calo_waveforms_));
+      }
+    }
+    return;
+  }
+
+} // namespace
+
+TEST(crd_parsing, parallel_same_as_sequential)
+{
+  expect_parallel_same_as_sequential(true);
+}
+
+TEST(crd_parsing, parallel_same_as_sequential_without_waveforms)
+{
+  expect_parallel_same_as_sequential(false);
+}
+
+TEST(crd_parsing, shared_pool_same_as_sequential)
+{
+  const parsed_hits_type sequential =
+    parse(1, snfee::io::parallel_hit_parser::DEFAULT_CHUNK_SIZE, true);
+  snfee::io::thread_pool pool(3);
+  // Two readers run concurrently on the same pool:
+  parsed_hits_type first;
+  parsed_hits_type second;
+  std::thread first_reader([&] { first = parse(0, 4096, true, &pool); });
+  std::thread second_reader([&] { second = parse(0, 65536, true, &pool); });
+  first_reader.join();
+  second_reader.join();
+  expect_same_hits(sequential, first);
+  expect_same_hits(sequential, second);
+}
@@ -0,0 +1,211 @@
+// tests/test_crd_sample.cc
+//
+// Parsing of a known CRD sample without decoding the calorimeter
+// waveforms: the raw waveform data lines must be skipped when the file has
+// some, and nothing must be skipped when it has none.
+
+// Standard library:
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/tracker_hit_record.h>
+
+#include "raw_hit_reader.h"
+#include "test_records.h"
+
+namespace {
+
+  /// Crate number of the CRD sample
+  const int16_t CRATE_NUM = 0;
+
+  /// \brief Hits parsed from a CRD file, in the order of the file
+  struct parsed_hits_type {
+    std::vector<snfee::data::calo_hit_record> calo_hits;
+    std::vector<snfee::data::tracker_hit_record> tracker_hits;
+  };
+
+  //! Write the CRD sample: a calorimeter and a tracker hit in trigger #5,
+  //! then a calorimeter hit in trigger #6 closing the file
+  std::string
+  write_sample(const std::string& name_, const bool with_waveform_lines_)
+  {
+    const std::string path = snfee::test::make_temp_path(name_);
+    std::ofstream fout(path.c_str());
+    fout << "=== DATA FILE SAVED WITH SN CRATE SOFTWARE VERSION: V2.4 == "
+            "DATE OF RUN: UnixTime = 1530000000.000 date = 26/6/2018 "
+            "time = 10h0m0s ===\n"
+         << "=== Known sample ===\n"
+         << "=== DATA TYPE : RAW DATA ===\n";
+    for (int iline = 3; iline < 9; iline++) {
+      fout << "=== Known sample ===\n";
+    }
+    const char* channel_lines[4] = {
+      "Slot 3 Ch 4 LTO 1 HT 1 EvtID 5 RawTDC 1000 TDC 6250.000 "
+      "TrigCount 0 Timecount 0 RawBaseline 12 Baseline 0.750 "
+      "RawPeak -300 Peak -37.500 PeakCell 20 RawCharge -2000 "
+      "Charge -1.953 Overflow 0 RisingCell 1 RisingOffset 10 "
+      "RisingTime 1.039 FallingCell 2 FallingOffset 20 FallingTime 2.078 "
+      "FCR 100 UnixTime 1530000000.000000",
+      "Slot 3 Ch 5 LTO 0 HT 0 EvtID 5 RawTDC 1000 TDC 6250.000 "
+      "TrigCount 0 Timecount 0 RawBaseline -4 Baseline -0.250 "
+      "RawPeak -8 Peak -1.000 PeakCell 3 RawCharge -50 "
+      "Charge -0.049 Overflow 1 RisingCell 0 RisingOffset 0 "
+      "RisingTime 0.000 FallingCell 0 FallingOffset 0 FallingTime 0.000 "
+      "FCR 100 UnixTime 1530000000.000000",
+      "Slot 7 Ch 0 LTO 1 HT 0 EvtID 6 RawTDC 2000 TDC 12500.000 "
+      "TrigCount 0 Timecount 0 RawBaseline 2 Baseline 0.125 "
+      "RawPeak -100 Peak -12.500 PeakCell 30 RawCharge -900 "
+      "Charge -0.879 Overflow 0 RisingCell 3 RisingOffset 5 "
+      "RisingTime 3.020 FallingCell 4 FallingOffset 6 FallingTime 4.023 "
+      "FCR 200 UnixTime 1530000000.001000",
+      "Slot 7 Ch 1 LTO 0 HT 0 EvtID 6 RawTDC 2000 TDC 12500.000 "
+      "TrigCount 0 Timecount 0 RawBaseline 1 Baseline 0.063 "
+      "RawPeak -2 Peak -0.250 PeakCell 31 RawCharge -10 "
+      "Charge -0.010 Overflow 0 RisingCell 0 RisingOffset 0 "
+      "RisingTime 0.000 FallingCell 0 FallingOffset 0 FallingTime 0.000 "
+      "FCR 200 UnixTime 1530000000.001000"};
+    const char* waveform_line = "2048 2047 2040 2046 2048 2049 2048 2048";
+    for (int ihit = 0; ihit < 2; ihit++) {
+      fout << "= HIT " << ihit << " = CALO = TRIG_ID 5 =\n"
+           << channel_lines[ihit] << '\n';
+      if (with_waveform_lines_) {
+        fout << waveform_line << '\n';
+      }
+    }
+    fout << "= HIT 2 = TRACKER = TRIG_ID 5 =\n"
+         << "Slot 10 Feast 1 Ch 22 AN R0 123456 1543.2000 "
+            "UnixTime 1530000000.000\n";
+    for (int ihit = 3; ihit < 5; ihit++) {
+      fout << "= HIT " << ihit << " = CALO = TRIG_ID 6 =\n"
+           << channel_lines[ihit - 1] << '\n';
+      if (with_waveform_lines_) {
+        fout << waveform_line << '\n';
+      }
+    }
+    fout << '\n';
+    fout.close();
+    return path;
+  }
+
+  //! Parse a CRD file
+  parsed_hits_type
+  parse(const std::string& path_, const bool with_calo_waveforms_)
+  {
+    snfee::io::raw_hit_reader::config_type reader_config;
+    reader_config.input_filename = path_;
+    reader_config.crate_num = CRATE_NUM;
+    reader_config.with_calo_waveforms = with_calo_waveforms_;
+    parsed_hits_type hits;
+    snfee::data::calo_hit_record calo_hit;
+    snfee::data::tracker_hit_record tracker_hit;
+    snfee::io::raw_hit_reader reader;
+    reader.set_config(reader_config);
+    reader.initialize();
+    while (reader.has_next_hit()) {
+      const snfee::io::raw_record_parser::record_type record_type =
+        reader.load_next_hit(calo_hit, tracker_hit);
+      if (record_type == snfee::io::raw_record_parser::RECORD_CALO) {
+        hits.calo_hits.push_back(calo_hit);
+      } else if (record_type == snfee::io::raw_record_parser::RECORD_TRACKER) {
+        hits.tracker_hits.push_back(tracker_hit);
+      }
+    }
+    reader.reset();
+    return hits;
+  }
+
+  //! Check the hits of the CRD sample
+  void
+  expect_sample_hits(const parsed_hits_type& hits_,
+                     const bool with_calo_waveforms_)
+  {
+    ASSERT_EQ(2u, hits_.calo_hits.size());
+    ASSERT_EQ(1u, hits_.tracker_hits.size());
+
+    const snfee::data::calo_hit_record& calo0 = hits_.calo_hits[0];
+    EXPECT_EQ(0, calo0.get_hit_num());
+    EXPECT_EQ(5, calo0.get_trigger_id());
+    EXPECT_EQ(CRATE_NUM, calo0.get_crate_num());
+    EXPECT_EQ(3, calo0.get_board_num());
+    EXPECT_EQ(2, calo0.get_chip_num());
+    EXPECT_EQ(1000u, calo0.get_tdc());
+    EXPECT_EQ(100u, calo0.get_fcr());
+    EXPECT_EQ(with_calo_waveforms_, calo0.has_waveforms());
+    const auto& ch00 = calo0.get_channel_data(0);
+    EXPECT_TRUE(ch00.is_lt());
+    EXPECT_TRUE(ch00.is_ht());
+    EXPECT_FALSE(ch00.is_overflow());
+    EXPECT_EQ(12, ch00.get_baseline());
+    EXPECT_EQ(-300, ch00.get_peak());
+    EXPECT_EQ(20, ch00.get_peak_cell());
+    EXPECT_EQ(-2000, ch00.get_charge());
+    EXPECT_EQ(1 * 256 + 10, ch00.get_rising_cell());
+    EXPECT_EQ(2 * 256 + 20, ch00.get_falling_cell());
+    const auto& ch01 = calo0.get_channel_data(1);
+    EXPECT_FALSE(ch01.is_lt());
+    EXPECT_FALSE(ch01.is_ht());
+    EXPECT_TRUE(ch01.is_overflow());
+    EXPECT_EQ(-4, ch01.get_baseline());
+    EXPECT_EQ(-8, ch01.get_peak());
+    EXPECT_EQ(-50, ch01.get_charge());
+
+    const snfee::data::tracker_hit_record& tracker = hits_.tracker_hits[0];
+    EXPECT_EQ(2, tracker.get_hit_num());
+    EXPECT_EQ(5, tracker.get_trigger_id());
+    EXPECT_EQ(10, tracker.get_board_num());
+    EXPECT_EQ(1, tracker.get_chip_num());
+    EXPECT_EQ(22, tracker.get_channel_num());
+    EXPECT_EQ(snfee::data::tracker_hit_record::CHANNEL_ANODE,
+              tracker.get_channel_category());
+    EXPECT_EQ(snfee::data::tracker_hit_record::TIMESTAMP_ANODE_R0,
+              tracker.get_timestamp_category());
+    EXPECT_EQ(123456u, tracker.get_timestamp());
+
+    const snfee::data::calo_hit_record& calo1 = hits_.calo_hits[1];
+    EXPECT_EQ(3, calo1.get_hit_num());
+    EXPECT_EQ(6, calo1.get_trigger_id());
+    EXPECT_EQ(7, calo1.get_board_num());
+    EXPECT_EQ(0, calo1.get_chip_num());
+    EXPECT_EQ(2000u, calo1.get_tdc());
+    EXPECT_EQ(200u, calo1.get_fcr());
+    const auto& ch10 = calo1.get_channel_data(0);
+    EXPECT_TRUE(ch10.is_lt());
+    EXPECT_FALSE(ch10.is_ht());
+    EXPECT_EQ(-100, ch10.get_peak());
+    EXPECT_EQ(30, ch10.get_peak_cell());
+    EXPECT_EQ(3 * 256 + 5, ch10.get_rising_cell());
+    EXPECT_EQ(-2, calo1.get_channel_data(1).get_peak());
+    return;
+  }
+
+} // namespace
+
+TEST(crd_sample, waveform_lines_are_decoded)
+{
+  const std::string path = write_sample("sample_waveforms.crd", true);
+  const parsed_hits_type hits = parse(path, true);
+  expect_sample_hits(hits, true);
+  const auto& waveforms = hits.calo_hits[0].get_waveforms();
+  ASSERT_EQ(8u, waveforms.get_number_of_samples());
+  EXPECT_EQ(2048, waveforms.get_adc(0, 0));
+  EXPECT_EQ(2040, waveforms.get_adc(2, 1));
+}
+
+TEST(crd_sample, waveform_lines_are_skipped)
+{
+  const std::string path = write_sample("sample_skipped.crd", true);
+  expect_sample_hits(parse(path, false), false);
+}
+
+TEST(crd_sample, no_waveform_lines)
+{
+  const std::string path = write_sample("sample_no_waveforms.crd", false);
+  expect_sample_hits(parse(path, false), false);
+}
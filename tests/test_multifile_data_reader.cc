@@ -0,0 +1,217 @@
+// tests/test_multifile_data_reader.cc
+//
+// Seeking to trigger IDs in indexed files with the multifile data reader,
+// and loading records made by a factory, in both formats and with or
+// without prefetch. Appending records to a loaded trigger ID index.
+
+// Standard library:
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/io/multifile_data_reader.h>
+#include <snfee/io/multifile_data_writer.h>
+#include <snfee/io/trigger_index.h>
+
+#include "test_records.h"
+
+namespace {
+
+  /// Number of records per file
+  const int32_t RECORDS_PER_FILE = 10;
+
+  /// Number of records per index block
+  const std::size_t INDEX_BLOCK_SIZE = 4;
+
+  /// Trigger ID of the record with a given rank (only even trigger IDs)
+  int32_t
+  trigger_id_of(const int32_t rank_)
+  {
+    return 2 * rank_;
+  }
+
+  //! Indexed RTD files (parameters: file extension, prefetch depth)
+  class multifile_data_reader_seek
+    : public ::testing::TestWithParam<std::tuple<std::string, std::size_t>> {
+  protected:
+    void
+    SetUp() override
+    {
+      const std::string extension = std::get<0>(GetParam());
+      snfee::io::multifile_data_writer::config_type writer_config;
+      for (int ifile = 0; ifile < 2; ifile++) {
+        writer_config.filenames.push_back(snfee::test::make_temp_path(
+          "seek_" + std::to_string(ifile) + extension));
+      }
+      writer_config.max_records_per_file = RECORDS_PER_FILE;
+      writer_config.with_trigger_index = true;
+      writer_config.trigger_index_block_size = INDEX_BLOCK_SIZE;
+      {
+        snfee::io::multifile_data_writer writer(writer_config);
+        for (int32_t irec = 0; irec < 2 * RECORDS_PER_FILE; irec++) {
+          snfee::data::raw_trigger_data rtd;
+          snfee::test::make_rtd(rtd, trigger_id_of(irec), 1, 2, 16);
+          writer.store(rtd);
+        }
+      }
+      reader_config.filenames = writer_config.filenames;
+      reader_config.prefetch_depth = std::get<1>(GetParam());
+      return;
+    }
+
+    //! Load the next record and return its trigger ID
+    static int32_t
+    load_next(snfee::io::multifile_data_reader& reader_)
+    {
+      if (!reader_.has_record_tag()) {
+        return snfee::data::INVALID_TRIGGER_ID;
+      }
+      snfee::data::raw_trigger_data rtd;
+      reader_.load(rtd);
+      return rtd.get_trigger_id();
+    }
+
+    //! Check that the next records are the ones from a given rank
+    static void
+    expect_records_from(snfee::io::multifile_data_reader& reader_,
+                        const int32_t rank_)
+    {
+      for (int32_t irec = rank_; irec < 2 * RECORDS_PER_FILE; irec++) {
+        ASSERT_TRUE(reader_.has_record_tag()) << "record #" << irec;
+        EXPECT_EQ(trigger_id_of(irec), load_next(reader_));
+      }
+      EXPECT_FALSE(reader_.has_record_tag());
+      return;
+    }
+
+    snfee::io::multifile_data_reader::config_type reader_config;
+  };
+
+} // namespace
+
+TEST_P(multifile_data_reader_seek, hit)
+{
+  snfee::io::multifile_data_reader reader(reader_config);
+  reader.add_record_type<snfee::data::raw_trigger_data>();
+  ASSERT_TRUE(reader.has_trigger_index());
+  // Forward, across files, then backward:
+  ASSERT_TRUE(reader.seek_to_trigger(trigger_id_of(5)));
+  EXPECT_EQ(trigger_id_of(5), load_next(reader));
+  ASSERT_TRUE(reader.seek_to_trigger(trigger_id_of(13)));
+  EXPECT_EQ(trigger_id_of(13), load_next(reader));
+  ASSERT_TRUE(reader.seek_to_trigger(trigger_id_of(2)));
+  expect_records_from(reader, 2);
+}
+
+TEST_P(multifile_data_reader_seek, miss_inside_block_range)
+{
+  snfee::io::multifile_data_reader reader(reader_config);
+  reader.add_record_type<snfee::data::raw_trigger_data>();
+  for (int32_t irec = 0; irec < 3; irec++) {
+    ASSERT_EQ(trigger_id_of(irec), load_next(reader));
+  }
+  // Odd trigger IDs are within the range of some blocks but not stored:
+  EXPECT_FALSE(reader.seek_to_trigger(trigger_id_of(1) + 1));
+  EXPECT_FALSE(reader.seek_to_trigger(trigger_id_of(15) + 1));
+  expect_records_from(reader, 3);
+}
+
+TEST_P(multifile_data_reader_seek, miss_after_hit)
+{
+  snfee::io::multifile_data_reader reader(reader_config);
+  reader.add_record_type<snfee::data::raw_trigger_data>();
+  ASSERT_TRUE(reader.seek_to_trigger(trigger_id_of(12)));
+  EXPECT_FALSE(reader.seek_to_trigger(trigger_id_of(4) + 1));
+  expect_records_from(reader, 12);
+}
+
+TEST_P(multifile_data_reader_seek, miss_outside_every_block)
+{
+  snfee::io::multifile_data_reader reader(reader_config);
+  reader.add_record_type<snfee::data::raw_trigger_data>();
+  ASSERT_EQ(trigger_id_of(0), load_next(reader));
+  EXPECT_FALSE(reader.seek_to_trigger(trigger_id_of(2 * RECORDS_PER_FILE)));
+  EXPECT_FALSE(reader.seek_to_trigger(1000000));
+  expect_records_from(reader, 1);
+}
+
+TEST_P(multifile_data_reader_seek, miss_at_end_of_input)
+{
+  snfee::io::multifile_data_reader reader(reader_config);
+  reader.add_record_type<snfee::data::raw_trigger_data>();
+  expect_records_from(reader, 0);
+  EXPECT_FALSE(reader.seek_to_trigger(trigger_id_of(5) + 1));
+  EXPECT_FALSE(reader.has_record_tag());
+}
+
+TEST_P(multifile_data_reader_seek, load_shared_from_factory)
+{
+  std::mutex made_mutex;
+  std::set<const snfee::data::raw_trigger_data*> made;
+  snfee::io::multifile_data_reader reader(reader_config);
+  // The factory may be called from the prefetch thread:
+  reader.add_record_type<snfee::data::raw_trigger_data>([&]() {
+    auto rtd = std::make_shared<snfee::data::raw_trigger_data>();
+    std::lock_guard<std::mutex> lock(made_mutex);
+    made.insert(rtd.get());
+    return rtd;
+  });
+  std::vector<std::shared_ptr<snfee::data::raw_trigger_data>> loaded;
+  ASSERT_TRUE(reader.seek_to_trigger(trigger_id_of(13)));
+  for (int32_t irec = 13; irec < 2 * RECORDS_PER_FILE; irec++) {
+    ASSERT_TRUE(reader.has_record_tag()) << "record #" << irec;
+    loaded.push_back(reader.load_shared<snfee::data::raw_trigger_data>());
+    EXPECT_EQ(trigger_id_of(irec), loaded.back()->get_trigger_id());
+  }
+  EXPECT_FALSE(reader.has_record_tag());
+  std::lock_guard<std::mutex> lock(made_mutex);
+  for (const auto& rtd : loaded) {
+    EXPECT_EQ(1u, made.count(rtd.get()));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  formats,
+  multifile_data_reader_seek,
+  ::testing::Combine(::testing::Values(std::string(".data.gz"),
+                                       std::string(".snraw")),
+                     ::testing::Values(std::size_t(0), std::size_t(3))));
+
+TEST(trigger_index, append_to_loaded_index)
+{
+  // Unsorted trigger IDs, the last one is not the maximum of its block:
+  const std::vector<int32_t> trigger_ids = {4, 8, 2, 6, 9, 7};
+  snfee::io::trigger_index index(INDEX_BLOCK_SIZE);
+  for (const int32_t trigger_id : trigger_ids) {
+    index.add_record(trigger_id);
+  }
+  const std::string path = snfee::test::make_temp_path("append.tidx");
+  index.store(path);
+  snfee::io::trigger_index loaded;
+  loaded.load(path);
+  index.add_record(7);
+  loaded.add_record(7);
+  const std::string path1 = snfee::test::make_temp_path("append_1.tidx");
+  const std::string path2 = snfee::test::make_temp_path("append_2.tidx");
+  index.store(path1);
+  loaded.store(path2);
+  std::ifstream fin1(path1.c_str());
+  std::ifstream fin2(path2.c_str());
+  const std::string content1((std::istreambuf_iterator<char>(fin1)),
+                             std::istreambuf_iterator<char>());
+  const std::string content2((std::istreambuf_iterator<char>(fin2)),
+                             std::istreambuf_iterator<char>());
+  EXPECT_FALSE(content1.empty());
+  EXPECT_EQ(content1, content2);
+}
@@ -0,0 +1,164 @@
+// tests/test_multifile_prefetch.cc
+//
+// Reading of a multi-file set of RHD records with read-ahead prefetch: the
+// records must be the ones read without prefetch, in the same order.
+
+// Standard library:
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/tracker_hit_record.h>
+#include <snfee/data/trigger_record.h>
+#include <snfee/io/multifile_data_reader.h>
+#include <snfee/io/multifile_data_writer.h>
+
+#include "record_checks.h"
+#include "test_records.h"
+
+namespace {
+
+  /// Number of files of the set
+  const std::size_t NUMBER_OF_FILES = 3;
+
+  /// Number of records per file (the last file is not full)
+  const std::size_t RECORDS_PER_FILE = 7;
+
+  /// Number of records of the set
+  const std::size_t NUMBER_OF_RECORDS = 2 * RECORDS_PER_FILE + 3;
+
+  //! Multi-file set of RHD records of all types (parameters: file
+  //! extension, prefetch depth)
+  class multifile_prefetch
+    : public ::testing::TestWithParam<std::tuple<std::string, std::size_t>> {
+  protected:
+    void
+    SetUp() override
+    {
+      const std::string extension = std::get<0>(GetParam());
+      snfee::io::multifile_data_writer::config_type writer_config;
+      for (std::size_t ifile = 0; ifile < NUMBER_OF_FILES; ifile++) {
+        writer_config.filenames.push_back(snfee::test::make_temp_path(
+          "prefetch_part-" + std::to_string(ifile) + extension));
+      }
+      writer_config.max_records_per_file = RECORDS_PER_FILE;
+      snfee::io::multifile_data_writer writer(writer_config);
+      for (std::size_t irec = 0; irec < NUMBER_OF_RECORDS; irec++) {
+        // Triggers, calorimeter hits and tracker hits in turn:
+        const int32_t trigger_id = irec / 3;
+        if (irec % 3 == 0) {
+          snfee::data::trigger_record trig;
+          snfee::test::make_trigger(trig, trigger_id);
+          triggers.push_back(trig);
+          writer.store(trig);
+        } else if (irec % 3 == 1) {
+          snfee::data::calo_hit_record calo_hit;
+          snfee::test::make_calo_hit(calo_hit, irec, trigger_id, 64);
+          calo_hits.push_back(calo_hit);
+          writer.store(calo_hit);
+        } else {
+          snfee::data::tracker_hit_record tracker_hit;
+          snfee::test::make_tracker_hit(tracker_hit, irec, trigger_id);
+          tracker_hits.push_back(tracker_hit);
+          writer.store(tracker_hit);
+        }
+      }
+      reader_config.filenames = writer_config.filenames;
+      reader_config.prefetch_depth = std::get<1>(GetParam());
+      return;
+    }
+
+    //! Return a reader of the set which decodes all the record types
+    std::unique_ptr<snfee::io::multifile_data_reader>
+    make_reader() const
+    {
+      std::unique_ptr<snfee::io::multifile_data_reader> reader(
+        new snfee::io::multifile_data_reader(reader_config));
+      reader->add_record_type<snfee::data::trigger_record>();
+      reader->add_record_type<snfee::data::calo_hit_record>();
+      reader->add_record_type<snfee::data::tracker_hit_record>();
+      return reader;
+    }
+
+    snfee::io::multifile_data_reader::config_type reader_config;
+    std::vector<snfee::data::trigger_record> triggers;
+    std::vector<snfee::data::calo_hit_record> calo_hits;
+    std::vector<snfee::data::tracker_hit_record> tracker_hits;
+  };
+
+} // namespace
+
+TEST_P(multifile_prefetch, all_records_in_order)
+{
+  std::unique_ptr<snfee::io::multifile_data_reader> reader = make_reader();
+  EXPECT_EQ(reader_config.prefetch_depth > 0, reader->is_prefetching());
+  std::size_t itrig = 0;
+  std::size_t icalo = 0;
+  std::size_t itracker = 0;
+  for (std::size_t irec = 0; irec < NUMBER_OF_RECORDS; irec++) {
+    SCOPED_TRACE("record #" + std::to_string(irec));
+    ASSERT_TRUE(reader->has_record_tag());
+    if (irec % 3 == 0) {
+      ASSERT_TRUE(
+        reader->record_tag_is(snfee::data::trigger_record::SERIAL_TAG));
+      snfee::data::trigger_record trig;
+      reader->load(trig);
+      snfee::test::expect_same(triggers[itrig++], trig);
+    } else if (irec % 3 == 1) {
+      ASSERT_TRUE(
+        reader->record_tag_is(snfee::data::calo_hit_record::SERIAL_TAG));
+      snfee::data::calo_hit_record calo_hit;
+      reader->load(calo_hit);
+      snfee::test::expect_same(calo_hits[icalo++], calo_hit);
+    } else {
+      ASSERT_TRUE(
+        reader->record_tag_is(snfee::data::tracker_hit_record::SERIAL_TAG));
+      snfee::data::tracker_hit_record tracker_hit;
+      reader->load(tracker_hit);
+      snfee::test::expect_same(tracker_hits[itracker++], tracker_hit);
+    }
+  }
+  EXPECT_FALSE(reader->has_record_tag());
+  EXPECT_EQ(NUMBER_OF_RECORDS, reader->get_counter());
+}
+
+TEST_P(multifile_prefetch, early_stop)
+{
+  // The prefetch thread may be ahead by several records or files when
+  // the reader is destroyed:
+  for (std::size_t nloaded = 0; nloaded < NUMBER_OF_RECORDS;
+       nloaded += RECORDS_PER_FILE / 2) {
+    std::unique_ptr<snfee::io::multifile_data_reader> reader = make_reader();
+    for (std::size_t irec = 0; irec < nloaded; irec++) {
+      ASSERT_TRUE(reader->has_record_tag());
+      if (irec % 3 == 0) {
+        snfee::data::trigger_record trig;
+        reader->load(trig);
+      } else if (irec % 3 == 1) {
+        snfee::data::calo_hit_record calo_hit;
+        reader->load(calo_hit);
+      } else {
+        snfee::data::tracker_hit_record tracker_hit;
+        reader->load(tracker_hit);
+      }
+    }
+    reader.reset();
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  formats,
+  multifile_prefetch,
+  ::testing::Combine(::testing::Values(std::string(".data.gz"),
+                                       std::string(".snraw")),
+                     ::testing::Values(std::size_t(0),
+                                       std::size_t(1),
+                                       std::size_t(4),
+                                       std::size_t(64))));
@@ -0,0 +1,163 @@
+// tests/test_native_format.cc
+//
+// Round trip of all the raw data records through the native binary format
+// and through Boost archives: both must give back the stored records.
+
+// Standard library:
+#include <memory>
+#include <string>
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/data/tracker_hit_record.h>
+#include <snfee/data/trigger_record.h>
+#include <snfee/io/multifile_data_reader.h>
+#include <snfee/io/multifile_data_writer.h>
+#include <snfee/io/native_format.h>
+
+#include "record_checks.h"
+#include "test_records.h"
+
+namespace {
+
+  /// Extension of the files written as Boost archives
+  const char* BOOST_EXTENSION = ".data.gz";
+
+  //! Store records in a file then load them back
+  template <typename Data>
+  std::vector<Data>
+  round_trip(const std::vector<Data>& records_,
+             const std::string& name_,
+             const std::string& extension_)
+  {
+    snfee::io::multifile_data_writer::config_type writer_config;
+    writer_config.filenames.push_back(
+      snfee::test::make_temp_path(name_ + extension_));
+    {
+      snfee::io::multifile_data_writer writer(writer_config);
+      for (const auto& record : records_) {
+        writer.store(record);
+      }
+    }
+    std::vector<Data> loaded;
+    snfee::io::multifile_data_reader::config_type reader_config;
+    reader_config.filenames = writer_config.filenames;
+    snfee::io::multifile_data_reader reader(reader_config);
+    while (reader.has_record_tag()) {
+      EXPECT_TRUE(reader.record_tag_is(Data::SERIAL_TAG));
+      loaded.emplace_back();
+      reader.load(loaded.back());
+    }
+    return loaded;
+  }
+
+  //! Check the round trip of records through both formats
+  template <typename Data>
+  void
+  expect_round_trip(const std::vector<Data>& records_,
+                    const std::string& name_)
+  {
+    const std::vector<Data> from_native = round_trip(
+      records_, name_, snfee::io::native_format::file_extension());
+    const std::vector<Data> from_boost =
+      round_trip(records_, name_, BOOST_EXTENSION);
+    ASSERT_EQ(records_.size(), from_native.size());
+    ASSERT_EQ(records_.size(), from_boost.size());
+    for (std::size_t i = 0; i < records_.size(); i++) {
+      SCOPED_TRACE(i);
+      snfee::test::expect_same(records_[i], from_native[i]);
+      snfee::test::expect_same(records_[i], from_boost[i]);
+      snfee::test::expect_same(from_boost[i], from_native[i]);
+    }
+    return;
+  }
+
+  //! Make a calorimeter hit whose samples span the 12-bit ADC range
+  void
+  make_edge_calo_hit(snfee::data::calo_hit_record& hit_,
+                     const int32_t hit_num_,
+                     const uint16_t nb_samples_)
+  {
+    snfee::test::make_calo_hit(hit_, hit_num_, hit_num_, nb_samples_);
+    for (uint16_t isample = 0; isample < nb_samples_; isample++) {
+      // Both edges on each channel, in both positions of a packed pair:
+      const uint16_t edge =
+        (isample / 2) % 2 == 0
+          ? 0
+          : snfee::data::calo_hit_record::SAMPLE_ADC_MAX;
+      hit_.set_waveform_adc(0, isample, edge);
+      hit_.set_waveform_adc(
+        1,
+        isample,
+        snfee::data::calo_hit_record::SAMPLE_ADC_MAX - edge);
+    }
+    return;
+  }
+
+} // namespace
+
+TEST(native_format, trigger_record_round_trip)
+{
+  std::vector<snfee::data::trigger_record> records(3);
+  for (std::size_t i = 0; i < records.size(); i++) {
+    snfee::test::make_trigger(records[i], 1000 * i);
+  }
+  expect_round_trip(records, "trigger_records");
+}
+
+TEST(native_format, tracker_hit_record_round_trip)
+{
+  std::vector<snfee::data::tracker_hit_record> records(5);
+  for (std::size_t i = 0; i < records.size(); i++) {
+    snfee::test::make_tracker_hit(records[i], i, 7 * i);
+  }
+  expect_round_trip(records, "tracker_hit_records");
+}
+
+TEST(native_format, calo_hit_record_round_trip)
+{
+  std::vector<snfee::data::calo_hit_record> records(4);
+  snfee::test::make_calo_hit(records[0], 0, 0, 1024);
+  snfee::test::make_calo_hit(records[1], 1, 1, 0);
+  snfee::test::make_calo_hit(records[2], 2, 2, 64);
+  snfee::test::make_calo_hit(records[3], 3, 3, 1);
+  expect_round_trip(records, "calo_hit_records");
+}
+
+TEST(native_format, calo_waveforms_12bit_edges)
+{
+  std::vector<snfee::data::calo_hit_record> records(3);
+  make_edge_calo_hit(records[0], 0, 1024);
+  make_edge_calo_hit(records[1], 1, 17);
+  make_edge_calo_hit(records[2], 2, 2);
+  const uint16_t adc_max = snfee::data::calo_hit_record::SAMPLE_ADC_MAX;
+  ASSERT_EQ(4095, adc_max);
+  expect_round_trip(records, "calo_hit_records_edges");
+
+  const std::vector<snfee::data::calo_hit_record> loaded =
+    round_trip(records,
+               "calo_hit_records_edges",
+               snfee::io::native_format::file_extension());
+  ASSERT_EQ(records.size(), loaded.size());
+  const auto& waveforms = loaded[0].get_waveforms();
+  EXPECT_EQ(0, waveforms.get_adc(0, 0));
+  EXPECT_EQ(adc_max, waveforms.get_adc(0, 1));
+  EXPECT_EQ(adc_max, waveforms.get_adc(2, 0));
+  EXPECT_EQ(0, waveforms.get_adc(2, 1));
+}
+
+TEST(native_format, raw_trigger_data_round_trip)
+{
+  std::vector<snfee::data::raw_trigger_data> records(4);
+  snfee::test::make_rtd(records[0], 0, 2, 5, 1024);
+  snfee::test::make_rtd(records[1], 1, 0, 3, 0);
+  snfee::test::make_rtd(records[2], 2, 3, 0, 16);
+  snfee::test::make_rtd(records[3], 3, 0, 0, 0);
+  expect_round_trip(records, "raw_trigger_data");
+}
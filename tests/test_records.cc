@@ -0,0 +1,106 @@
+// tests/test_records.cc
+
+// Ourselves:
+#include "test_records.h"
+
+// Standard library:
+#include <memory>
+
+// Third party:
+// - Boost:
+#include <boost/filesystem.hpp>
+
+namespace snfee {
+  namespace test {
+
+    void
+    make_calo_hit(snfee::data::calo_hit_record& hit_,
+                  const int32_t hit_num_,
+                  const int32_t trigger_id_,
+                  const uint16_t nb_samples_)
+    {
+      const bool has_waveforms = nb_samples_ > 0;
+      snfee::data::calo_hit_record::populate_mock_hit(
+        hit_,
+        true,
+        false,
+        hit_num_,
+        trigger_id_,
+        1000 + hit_num_,
+        0,
+        hit_num_ % 20,
+        hit_num_ % 8,
+        hit_num_ % 0x10000,
+        hit_num_ % 0x20,
+        hit_num_ % 0x400,
+        has_waveforms,
+        0,
+        nb_samples_);
+      return;
+    }
+
+    void
+    make_tracker_hit(snfee::data::tracker_hit_record& hit_,
+                     const int32_t hit_num_,
+                     const int32_t trigger_id_)
+    {
+      hit_.make(hit_num_,
+                trigger_id_,
+                0,
+                hit_num_ % 20,
+                hit_num_ % 2,
+                hit_num_ % 54,
+                snfee::data::tracker_hit_record::CHANNEL_ANODE,
+                snfee::data::tracker_hit_record::TIMESTAMP_ANODE_R0,
+                5000 + hit_num_);
+      return;
+    }
+
+    void
+    make_trigger(snfee::data::trigger_record& trig_,
+                 const int32_t trigger_id_)
+    {
+      trig_.make(trigger_id_,
+                 snfee::data::trigger_record::TRIGGER_MODE_CALO_ONLY,
+                 10 * trigger_id_ + 1);
+      return;
+    }
+
+    void
+    make_rtd(snfee::data::raw_trigger_data& rtd_,
+             const int32_t trigger_id_,
+             const std::size_t nb_calo_hits_,
+             const std::size_t nb_tracker_hits_,
+             const uint16_t nb_samples_)
+    {
+      rtd_.invalidate();
+      rtd_.set_run_id(TEST_RUN_ID);
+      rtd_.set_trigger_id(trigger_id_);
+      auto trig = std::make_shared<snfee::data::trigger_record>();
+      make_trigger(*trig, trigger_id_);
+      rtd_.set_trig(trig);
+      for (std::size_t ihit = 0; ihit < nb_calo_hits_; ihit++) {
+        auto hit = std::make_shared<snfee::data::calo_hit_record>();
+        make_calo_hit(*hit, ihit, trigger_id_, nb_samples_);
+        rtd_.append_calo_hit(hit);
+      }
+      for (std::size_t ihit = 0; ihit < nb_tracker_hits_; ihit++) {
+        auto hit = std::make_shared<snfee::data::tracker_hit_record>();
+        make_tracker_hit(*hit, ihit, trigger_id_);
+        rtd_.append_tracker_hit(hit);
+      }
+      return;
+    }
+
+    std::string
+    make_temp_path(const std::string& name_)
+    {
+      boost::filesystem::path path =
+        boost::filesystem::current_path() / "snfee_test_data" / name_;
+      boost::filesystem::create_directories(path.parent_path());
+      boost::filesystem::remove(path);
+      return path.string();
+    }
+
+  } // namespace test
+} // namespace snfee
@@ -0,0 +1,53 @@
+//! \file tests/test_records.h
+//! \brief Builders of raw data records for the unit tests
+
+#ifndef SNFEE_TEST_TEST_RECORDS_H
+#define SNFEE_TEST_TEST_RECORDS_H
+
+// Standard library:
+#include <cstdint>
+#include <string>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/data/tracker_hit_record.h>
+#include <snfee/data/trigger_record.h>
+
+namespace snfee {
+  namespace test {
+
+    /// Run ID of the test records
+    const int32_t TEST_RUN_ID = 100;
+
+    //! Make a calorimeter hit (signal on channel #0, with waveforms of
+    //! nb_samples_ samples if nb_samples_ > 0)
+    void make_calo_hit(snfee::data::calo_hit_record& hit_,
+                       const int32_t hit_num_,
+                       const int32_t trigger_id_,
+                       const uint16_t nb_samples_);
+
+    //! Make a tracker hit (anode timestamp R0)
+    void make_tracker_hit(snfee::data::tracker_hit_record& hit_,
+                          const int32_t hit_num_,
+                          const int32_t trigger_id_);
+
+    //! Make a trigger record
+    void make_trigger(snfee::data::trigger_record& trig_,
+                      const int32_t trigger_id_);
+
+    //! Make a RTD record (a trigger record and some hits)
+    void make_rtd(snfee::data::raw_trigger_data& rtd_,
+                  const int32_t trigger_id_,
+                  const std::size_t nb_calo_hits_,
+                  const std::size_t nb_tracker_hits_,
+                  const uint16_t nb_samples_);
+
+    //! Return the path of a temporary file in the working directory of the
+    //! tests (removed if it exists)
+    std::string make_temp_path(const std::string& name_);
+
+  } // namespace test
+} // namespace snfee
+
+#endif // SNFEE_TEST_TEST_RECORDS_H
@@ -0,0 +1,249 @@
+// tests/test_rhd_buffer.cc
+//
+// Input buffer of the RTD builder: RHD records are popped by increasing
+// trigger ID, records with the same trigger ID in their arrival order,
+// from sorted, unsorted and duplicate trigger ID streams.
+
+// Standard library:
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include <snfee/data/tracker_hit_record.h>
+#include <snfee/data/utils.h>
+
+#include "rhd_buffer.h"
+#include "rhd_record.h"
+#include "test_records.h"
+
+namespace {
+
+  /// \brief Identification of a record: its trigger ID and its hit number
+  ///        (the arrival order)
+  struct record_id_type {
+    int32_t trigger_id;
+    int32_t hit_num;
+
+    bool
+    operator==(const record_id_type& other_) const
+    {
+      return trigger_id == other_.trigger_id and hit_num == other_.hit_num;
+    }
+  };
+
+  std::ostream&
+  operator<<(std::ostream& out_, const record_id_type& id_)
+  {
+    out_ << "[trigger #" << id_.trigger_id << ", hit #" << id_.hit_num
+         << "]";
+    return out_;
+  }
+
+  //! Make a tracker hit RHD record
+  snfee::io::rhd_record
+  make_record(const record_id_type& id_)
+  {
+    auto hit = std::make_shared<snfee::data::tracker_hit_record>();
+    snfee::test::make_tracker_hit(*hit, id_.hit_num, id_.trigger_id);
+    return snfee::io::rhd_record(hit);
+  }
+
+  //! Make the records of a list of trigger IDs (the hit number is the
+  //! index in the list)
+  std::vector<record_id_type>
+  make_ids(const std::vector<int32_t>& trigger_ids_)
+  {
+    std::vector<record_id_type> ids;
+    for (std::size_t i = 0; i < trigger_ids_.size(); i++) {
+      ids.push_back(record_id_type{trigger_ids_[i], int32_t(i)});
+    }
+    return ids;
+  }
+
+  //! Insert records in a buffer
+  void
+  insert(snfee::rtdb::rhd_buffer& buffer_,
+         const std::vector<record_id_type>& ids_)
+  {
+    for (const auto& id : ids_) {
+      buffer_.insert_record(make_record(id));
+    }
+    return;
+  }
+
+  //! Pop all the records of a buffer
+  std::vector<record_id_type>
+  pop_all(snfee::rtdb::rhd_buffer& buffer_)
+  {
+    std::vector<record_id_type> ids;
+    while (!buffer_.is_empty()) {
+      const snfee::io::rhd_record rec = buffer_.pop_record();
+      ids.push_back(record_id_type{rec.get_trigger_id(),
+                                   rec.get_tracker_hit_rec()->get_hit_num()});
+    }
+    return ids;
+  }
+
+  //! Return the records in the expected popping order
+  std::vector<record_id_type>
+  expected_order(std::vector<record_id_type> ids_)
+  {
+    std::stable_sort(ids_.begin(),
+                     ids_.end(),
+                     [](const record_id_type& a_, const record_id_type& b_) {
+                       return a_.trigger_id < b_.trigger_id;
+                     });
+    return ids_;
+  }
+
+} // namespace
+
+TEST(rhd_buffer, empty)
+{
+  snfee::rtdb::rhd_buffer buffer(0);
+  EXPECT_TRUE(buffer.is_empty());
+  EXPECT_EQ(0U, buffer.size());
+  EXPECT_EQ(0U, buffer.get_number_of_trig_ids());
+  EXPECT_EQ(snfee::data::INVALID_TRIGGER_ID, buffer.get_front_trig_id());
+  EXPECT_FALSE(buffer.can_be_popped());
+  EXPECT_FALSE(buffer.is_finished());
+  EXPECT_THROW(buffer.pop_record(), std::logic_error);
+  buffer.terminate();
+  EXPECT_TRUE(buffer.is_finished());
+  EXPECT_TRUE(buffer.trig_id_is_finished(0));
+}
+
+TEST(rhd_buffer, sorted_stream)
+{
+  snfee::rtdb::rhd_buffer buffer(0, 0, 2);
+  const std::vector<record_id_type> ids = make_ids({1, 1, 2, 3, 3, 3});
+  insert(buffer, ids);
+  EXPECT_EQ(6U, buffer.size());
+  EXPECT_EQ(3U, buffer.get_number_of_trig_ids());
+  EXPECT_EQ(1, buffer.get_front_trig_id());
+  EXPECT_EQ(1, buffer.get_next_poppable_trig_id());
+  EXPECT_TRUE(buffer.trig_id_is_finished(0));
+  EXPECT_FALSE(buffer.trig_id_is_finished(1));
+
+  // Pop the records of trigger #1 and #2:
+  for (std::size_t i = 0; i < 3; i++) {
+    ASSERT_TRUE(buffer.can_be_popped());
+    const snfee::io::rhd_record rec = buffer.pop_record();
+    EXPECT_EQ(ids[i].trigger_id, rec.get_trigger_id());
+    EXPECT_EQ(ids[i].hit_num, rec.get_tracker_hit_rec()->get_hit_num());
+  }
+  EXPECT_EQ(1U, buffer.get_number_of_trig_ids());
+  EXPECT_EQ(3, buffer.get_front_trig_id());
+  EXPECT_TRUE(buffer.trig_id_is_finished(2));
+  // The last trigger ID may still get records:
+  EXPECT_FALSE(buffer.can_be_popped());
+  EXPECT_EQ(snfee::data::INVALID_TRIGGER_ID,
+            buffer.get_next_poppable_trig_id());
+  buffer.terminate();
+  EXPECT_TRUE(buffer.can_be_popped());
+  EXPECT_EQ(3, buffer.get_next_poppable_trig_id());
+  const std::vector<record_id_type> rest = pop_all(buffer);
+  EXPECT_EQ(std::vector<record_id_type>(ids.begin() + 3, ids.end()), rest);
+  EXPECT_TRUE(buffer.is_finished());
+  EXPECT_EQ(snfee::data::INVALID_TRIGGER_ID, buffer.get_front_trig_id());
+}
+
+TEST(rhd_buffer, unsorted_stream)
+{
+  snfee::rtdb::rhd_buffer buffer(0, 0, 3);
+  const std::vector<record_id_type> ids = make_ids({5, 3, 7, 3, 5, 1, 6});
+  insert(buffer, ids);
+  EXPECT_EQ(ids.size(), buffer.size());
+  EXPECT_EQ(5U, buffer.get_number_of_trig_ids());
+  EXPECT_EQ(1, buffer.get_front_trig_id());
+  // Each record is stored once:
+  buffer.terminate();
+  EXPECT_EQ(expected_order(ids), pop_all(buffer));
+}
+
+TEST(rhd_buffer, unsorted_stream_rejected)
+{
+  // A single trigger ID before popping requires sorted records:
+  snfee::rtdb::rhd_buffer buffer(0, 0, 1);
+  insert(buffer, make_ids({2, 3}));
+  EXPECT_THROW(buffer.insert_record(make_record(record_id_type{1, 2})),
+               std::logic_error);
+  EXPECT_EQ(2U, buffer.size());
+  EXPECT_NO_THROW(buffer.insert_record(make_record(record_id_type{3, 3})));
+}
+
+TEST(rhd_buffer, duplicate_ids)
+{
+  snfee::rtdb::rhd_buffer buffer(0, 0, 2);
+  const std::vector<record_id_type> ids =
+    make_ids({4, 4, 4, 2, 4, 2, 2, 9, 4, 9});
+  insert(buffer, ids);
+  EXPECT_EQ(3U, buffer.get_number_of_trig_ids());
+  buffer.terminate();
+  EXPECT_EQ(expected_order(ids), pop_all(buffer));
+}
+
+TEST(rhd_buffer, capacity)
+{
+  snfee::rtdb::rhd_buffer buffer(0, 3, 2);
+  EXPECT_EQ(3U, buffer.get_capacity());
+  insert(buffer, make_ids({1, 2}));
+  EXPECT_TRUE(buffer.can_push());
+  insert(buffer, make_ids({3}));
+  EXPECT_FALSE(buffer.can_push());
+  buffer.pop_record();
+  EXPECT_TRUE(buffer.can_push());
+}
+
+TEST(rhd_buffer, random_streams)
+{
+  std::mt19937 random(161803);
+  // From a sorted stream to a fully shuffled one, with duplicate IDs:
+  for (const std::size_t window : {1, 4, 64, 1000}) {
+    SCOPED_TRACE(window);
+    std::vector<int32_t> trigger_ids;
+    for (int32_t trigger_id = 0; trigger_id < 300; trigger_id++) {
+      const std::size_t nrecords = random() % 4;
+      trigger_ids.insert(trigger_ids.end(), nrecords, trigger_id);
+    }
+    for (std::size_t first = 0; first < trigger_ids.size(); first += window) {
+      const std::size_t last = std::min(first + window, trigger_ids.size());
+      std::shuffle(
+        trigger_ids.begin() + first, trigger_ids.begin() + last, random);
+    }
+    const std::vector<record_id_type> ids = make_ids(trigger_ids);
+    snfee::rtdb::rhd_buffer buffer(0, 0, 2);
+    insert(buffer, ids);
+    ASSERT_EQ(ids.size(), buffer.size());
+    buffer.terminate();
+    EXPECT_EQ(expected_order(ids), pop_all(buffer));
+  }
+}
+
+TEST(rhd_buffer, interleaved_insert_and_pop)
+{
+  // The merger pops records as soon as the buffer allows it:
+  snfee::rtdb::rhd_buffer buffer(0, 0, 2);
+  const std::vector<record_id_type> ids =
+    make_ids({0, 0, 1, 2, 2, 2, 3, 5, 5, 6, 8, 8, 8, 9});
+  std::vector<record_id_type> popped;
+  for (const auto& id : ids) {
+    buffer.insert_record(make_record(id));
+    while (buffer.can_be_popped()) {
+      const snfee::io::rhd_record rec = buffer.pop_record();
+      popped.push_back(record_id_type{
+        rec.get_trigger_id(), rec.get_tracker_hit_rec()->get_hit_num()});
+    }
+  }
+  buffer.terminate();
+  const std::vector<record_id_type> rest = pop_all(buffer);
+  popped.insert(popped.end(), rest.begin(), rest.end());
+  EXPECT_EQ(ids, popped);
+}
@@ -0,0 +1,159 @@
+// tests/test_rhd_sorter.cc
+//
+// External merge sort of RHD records by trigger ID, in memory and with a
+// memory cap small enough to spill many runs and merge them in several
+// passes.
+
+// Standard library:
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/filesystem.hpp>
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+
+#include "rhd_record.h"
+#include "rhd_sorter.h"
+#include "test_records.h"
+
+namespace {
+
+  /// Number of sorted records
+  const int32_t NUMBER_OF_RECORDS = 3000;
+
+  /// Size of the blocks of the run files (bytes)
+  const std::size_t SMALL_RUN_BLOCK_SIZE = 1024;
+
+  /// Memory cap which spills many runs and merges them in several passes
+  const std::size_t SMALL_MAX_MEMORY_SIZE = 16 * 1024;
+
+  /// Order of the input trigger IDs
+  enum input_order_type {
+    INPUT_REVERSE,       ///< Decreasing trigger IDs
+    INPUT_BLOCK_SHUFFLED, ///< Shuffled blocks of shuffled trigger IDs
+    INPUT_ALL_EQUAL      ///< Same trigger ID for all the records
+  };
+
+  //! Return the input trigger IDs
+  std::vector<int32_t>
+  make_trigger_ids(const input_order_type order_)
+  {
+    std::vector<int32_t> trigger_ids;
+    if (order_ == INPUT_ALL_EQUAL) {
+      trigger_ids.assign(NUMBER_OF_RECORDS, 42);
+    } else if (order_ == INPUT_REVERSE) {
+      for (int32_t i = NUMBER_OF_RECORDS - 1; i >= 0; i--) {
+        // Pairs of equal trigger IDs check the stability:
+        trigger_ids.push_back(i / 2);
+      }
+    } else {
+      const int32_t block_size = 50;
+      std::mt19937 random(271828);
+      std::vector<int32_t> blocks;
+      for (int32_t i = 0; i < NUMBER_OF_RECORDS / block_size; i++) {
+        blocks.push_back(i);
+      }
+      std::shuffle(blocks.begin(), blocks.end(), random);
+      for (int32_t block : blocks) {
+        std::vector<int32_t> ids;
+        for (int32_t i = 0; i < block_size; i++) {
+          ids.push_back((block * block_size + i) / 3);
+        }
+        std::shuffle(ids.begin(), ids.end(), random);
+        trigger_ids.insert(trigger_ids.end(), ids.begin(), ids.end());
+      }
+    }
+    return trigger_ids;
+  }
+
+  //! Sort records (parameters: input order, spill to run files)
+  class rhd_sorter_order
+    : public ::testing::TestWithParam<std::tuple<input_order_type, bool>> {
+  protected:
+    void
+    SetUp() override
+    {
+      temporary_directory = snfee::test::make_temp_path("rhd_sorter");
+      boost::filesystem::create_directories(temporary_directory);
+      config.temporary_directory = temporary_directory;
+      if (std::get<1>(GetParam())) {
+        config.run_block_size = SMALL_RUN_BLOCK_SIZE;
+        config.max_memory_size = SMALL_MAX_MEMORY_SIZE;
+      }
+      return;
+    }
+
+    void
+    TearDown() override
+    {
+      boost::filesystem::remove_all(temporary_directory);
+      return;
+    }
+
+    std::string temporary_directory;
+    snfee::io::rhd_sorter::config_type config;
+  };
+
+} // namespace
+
+TEST_P(rhd_sorter_order, globally_sorted_and_stable)
+{
+  const std::vector<int32_t> trigger_ids =
+    make_trigger_ids(std::get<0>(GetParam()));
+  std::vector<std::pair<int32_t, int32_t>> output; // (trigger ID, hit num)
+  {
+    snfee::io::rhd_sorter sorter(config);
+    for (std::size_t i = 0; i < trigger_ids.size(); i++) {
+      // The hit number is the input rank:
+      auto hit = std::make_shared<snfee::data::calo_hit_record>();
+      snfee::test::make_calo_hit(*hit, i, trigger_ids[i], 16);
+      sorter.push_record(snfee::io::rhd_record(hit));
+    }
+    sorter.terminate_input();
+    while (sorter.has_next_record()) {
+      const snfee::io::rhd_record rec = sorter.pop_next_record();
+      ASSERT_TRUE(rec.is_calo_hit());
+      output.emplace_back(rec.get_trigger_id(),
+                          rec.get_calo_hit_rec()->get_hit_num());
+    }
+    EXPECT_EQ(trigger_ids.size(), sorter.get_number_of_records());
+    EXPECT_LE(sorter.get_peak_memory_size(), config.max_memory_size);
+    if (std::get<1>(GetParam())) {
+      EXPECT_GT(sorter.get_number_of_runs(), 10u);
+      EXPECT_GT(sorter.get_number_of_intermediate_merges(), 0u);
+    } else {
+      EXPECT_EQ(0u, sorter.get_number_of_runs());
+    }
+  }
+
+  // Sorted by trigger ID, then by input rank (stable sort):
+  ASSERT_EQ(trigger_ids.size(), output.size());
+  for (std::size_t i = 1; i < output.size(); i++) {
+    ASSERT_LT(output[i - 1], output[i]) << "output record #" << i;
+  }
+  // Every input record is output once:
+  for (std::size_t i = 0; i < output.size(); i++) {
+    const int32_t rank = output[i].second;
+    ASSERT_EQ(trigger_ids[rank], output[i].first);
+  }
+
+  // No temporary run file is left:
+  EXPECT_TRUE(boost::filesystem::is_empty(temporary_directory));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  orders,
+  rhd_sorter_order,
+  ::testing::Combine(::testing::Values(INPUT_REVERSE,
+                                       INPUT_BLOCK_SHUFFLED,
+                                       INPUT_ALL_EQUAL),
+                     ::testing::Bool()));
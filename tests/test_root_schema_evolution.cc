@@ -0,0 +1,87 @@
+// tests/test_root_schema_evolution.cc
+//
+// Reading of Root files written with the version 1 of the layout of
+// waveforms_record (vector of two_channel_adc_record) into the current one.
+//
+// Usage: test_root_schema_evolution <legacy Root file>
+
+// Standard library:
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+// - Root:
+#include <TFile.h>
+#include <TTree.h>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+
+#include "legacy/legacy_waveforms.h"
+
+namespace {
+
+  /// Path of the legacy Root file (first argument of the test)
+  std::string legacy_path;
+
+  //! Read all the entries of a branch and check the converted samples
+  void
+  check_branch(const char* branch_name_)
+  {
+    namespace legacy = snfee::test::legacy;
+    std::unique_ptr<TFile> file(TFile::Open(legacy_path.c_str(), "READ"));
+    ASSERT_TRUE(file and not file->IsZombie()) << legacy_path;
+    TTree* tree = nullptr;
+    file->GetObject(legacy::TREE_NAME, tree);
+    ASSERT_NE(tree, nullptr);
+    ASSERT_EQ(tree->GetEntries(), Long64_t(legacy::NUMBER_OF_ENTRIES));
+    snfee::data::calo_hit_record::waveforms_record record;
+    snfee::data::calo_hit_record::waveforms_record* waveforms = &record;
+    ASSERT_EQ(tree->SetBranchAddress(branch_name_, &waveforms), 0);
+    for (std::size_t ientry = 0; ientry < legacy::NUMBER_OF_ENTRIES;
+         ientry++) {
+      ASSERT_GT(tree->GetEntry(ientry), 0);
+      const uint16_t nb_samples = legacy::NUMBER_OF_SAMPLES[ientry];
+      ASSERT_EQ(waveforms->get_number_of_samples(), nb_samples)
+        << branch_name_ << " entry #" << ientry;
+      for (uint16_t ichannel = 0; ichannel < 2; ichannel++) {
+        const auto samples = waveforms->channel_samples(ichannel);
+        for (uint16_t isample = 0; isample < nb_samples; isample++) {
+          ASSERT_EQ(samples[isample], legacy::adc(ientry, isample, ichannel))
+            << branch_name_ << " entry #" << ientry << " channel #"
+            << ichannel << " sample #" << isample;
+        }
+      }
+    }
+    tree->ResetBranchAddresses();
+    return;
+  }
+
+} // namespace
+
+TEST(root_schema_evolution, split_waveforms_record_v1)
+{
+  check_branch(snfee::test::legacy::SPLIT_BRANCH_NAME);
+}
+
+TEST(root_schema_evolution, unsplit_waveforms_record_v1)
+{
+  check_branch(snfee::test::legacy::UNSPLIT_BRANCH_NAME);
+}
+
+int
+main(int argc_, char** argv_)
+{
+  ::testing::InitGoogleTest(&argc_, argv_);
+  if (argc_ != 2) {
+    std::cerr << "usage: test_root_schema_evolution <legacy Root file>"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  legacy_path = argv_[1];
+  return RUN_ALL_TESTS();
+}
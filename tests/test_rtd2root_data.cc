@@ -0,0 +1,153 @@
+// tests/test_rtd2root_data.cc
+//
+// Export of the RTD records to the flat data of the Root tree of rtd2root,
+// from the records and from a columnar batch.
+
+// Standard library:
+#include <memory>
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include <snfee/data/raw_trigger_data.h>
+#include <snfee/data/rtd_batch.h>
+
+#include "rtd2root_data.h"
+#include "test_records.h"
+
+namespace {
+
+  //! Check that the first entries of two arrays are equal
+  template <typename Array>
+  void
+  expect_same_column(const Array& expected_,
+                     const Array& actual_,
+                     const std::size_t count_,
+                     const char* name_)
+  {
+    for (std::size_t i = 0; i < count_; i++) {
+      EXPECT_EQ(expected_[i], actual_[i]) << name_ << "[" << i << "]";
+    }
+    return;
+  }
+
+  //! Check that two exported events are equal
+  void
+  expect_same_data(const snfee::data::rtd2root_data& expected_,
+                   const snfee::data::rtd2root_data& actual_)
+  {
+    EXPECT_EQ(expected_.run_id, actual_.run_id);
+    EXPECT_EQ(expected_.trigger_id, actual_.trigger_id);
+    EXPECT_EQ(expected_.has_trig, actual_.has_trig);
+
+    ASSERT_EQ(expected_.nb_calo_hits, actual_.nb_calo_hits);
+    const std::size_t nb_calo = expected_.nb_calo_hits;
+#define SNFEE_EXPECT_SAME_COLUMN(Name, Count)                                  \
+  expect_same_column(expected_.Name, actual_.Name, Count, #Name)
+    SNFEE_EXPECT_SAME_COLUMN(calo_tdc, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_crate_num, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_board_num, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_chip_num, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_event_id, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_l2_id, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_fcr, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_has_waveforms, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_waveform_start_sample, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_waveform_number_of_samples, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_waveform_offset, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch0_lt, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch0_ht, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch0_underflow, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch0_overflow, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch0_baseline, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch0_peak, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch0_peak_cell, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch0_charge, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch0_rising_cell, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch0_falling_cell, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch1_lt, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch1_ht, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch1_underflow, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch1_overflow, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch1_baseline, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch1_peak, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch1_peak_cell, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch1_charge, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch1_rising_cell, nb_calo);
+    SNFEE_EXPECT_SAME_COLUMN(calo_ch1_falling_cell, nb_calo);
+    EXPECT_EQ(expected_.calo_nb_waveform_samples,
+              actual_.calo_nb_waveform_samples);
+    EXPECT_EQ(expected_.calo_ch0_waveform, actual_.calo_ch0_waveform);
+    EXPECT_EQ(expected_.calo_ch1_waveform, actual_.calo_ch1_waveform);
+
+    ASSERT_EQ(expected_.nb_tracker_hits, actual_.nb_tracker_hits);
+    const std::size_t nb_tracker = expected_.nb_tracker_hits;
+    SNFEE_EXPECT_SAME_COLUMN(tracker_crate_num, nb_tracker);
+    SNFEE_EXPECT_SAME_COLUMN(tracker_board_num, nb_tracker);
+    SNFEE_EXPECT_SAME_COLUMN(tracker_chip_num, nb_tracker);
+    SNFEE_EXPECT_SAME_COLUMN(tracker_channel_num, nb_tracker);
+    SNFEE_EXPECT_SAME_COLUMN(tracker_channel_category, nb_tracker);
+    SNFEE_EXPECT_SAME_COLUMN(tracker_timestamp_category, nb_tracker);
+    SNFEE_EXPECT_SAME_COLUMN(tracker_timestamp, nb_tracker);
+#undef SNFEE_EXPECT_SAME_COLUMN
+    return;
+  }
+
+  //! Check that both exports of some records are equal
+  void
+  expect_same_exports(
+    const std::vector<snfee::data::raw_trigger_data>& records_)
+  {
+    snfee::data::rtd_batch batch;
+    for (const auto& rtd : records_) {
+      batch.append(rtd);
+    }
+    std::unique_ptr<snfee::data::rtd2root_data> from_record(
+      new snfee::data::rtd2root_data);
+    std::unique_ptr<snfee::data::rtd2root_data> from_batch(
+      new snfee::data::rtd2root_data);
+    for (std::size_t ievent = 0; ievent < records_.size(); ievent++) {
+      SCOPED_TRACE(ievent);
+      snfee::data::rtd2root_data::export_to_root(records_[ievent],
+                                                 *from_record);
+      snfee::data::rtd2root_data::export_to_root(batch, ievent, *from_batch);
+      expect_same_data(*from_record, *from_batch);
+    }
+    return;
+  }
+
+} // namespace
+
+TEST(rtd2root_data, batch_export_matches_record_export)
+{
+  std::vector<snfee::data::raw_trigger_data> records(4);
+  snfee::test::make_rtd(records[0], 0, 2, 5, 1024);
+  snfee::test::make_rtd(records[1], 1, 0, 3, 1024);
+  snfee::test::make_rtd(records[2], 2, 3, 0, 64);
+  snfee::test::make_rtd(records[3], 3, 0, 0, 0);
+  expect_same_exports(records);
+}
+
+TEST(rtd2root_data, hits_without_waveforms)
+{
+  std::vector<snfee::data::raw_trigger_data> records(2);
+  snfee::test::make_rtd(records[0], 7, 3, 2, 0);
+  snfee::test::make_rtd(records[1], 8, 1, 0, 16);
+  expect_same_exports(records);
+
+  std::unique_ptr<snfee::data::rtd2root_data> data(
+    new snfee::data::rtd2root_data);
+  ASSERT_NO_THROW(
+    snfee::data::rtd2root_data::export_to_root(records[0], *data));
+  const uint16_t invalid_start_sample =
+    snfee::data::calo_hit_record::INVALID_WAVEFORM_START_SAMPLE;
+  for (std::size_t ihit = 0; ihit < data->nb_calo_hits; ihit++) {
+    EXPECT_FALSE(data->calo_has_waveforms[ihit]);
+    EXPECT_EQ(invalid_start_sample, data->calo_waveform_start_sample[ihit]);
+    EXPECT_EQ(0, data->calo_waveform_number_of_samples[ihit]);
+  }
+  EXPECT_EQ(0u, data->calo_nb_waveform_samples);
+}
@@ -0,0 +1,175 @@
+// tests/test_trigger_id_tree.cc
+//
+// Tournament tree of the input streams of the RTD builder: its winner must
+// always be the one of a linear scan of the streams.
+
+// Standard library:
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// Third party:
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include "trigger_id_tree.h"
+
+namespace {
+
+  //! Return the stream with the smallest trigger ID by a linear scan (the
+  //! first one on ties), or the number of streams if none is competing
+  std::size_t
+  scan_top_stream(const std::vector<int32_t>& keys_)
+  {
+    std::size_t top = keys_.size();
+    for (std::size_t i = 0; i < keys_.size(); i++) {
+      if (keys_[i] == snfee::rtdb::trigger_id_tree::NO_TRIG_ID) {
+        continue;
+      }
+      if (top == keys_.size() or keys_[i] < keys_[top]) {
+        top = i;
+      }
+    }
+    return top;
+  }
+
+  //! Check the tree against a linear scan of the streams
+  void
+  expect_same_as_scan(const snfee::rtdb::trigger_id_tree& tree_,
+                      const std::vector<int32_t>& keys_)
+  {
+    const std::size_t top = scan_top_stream(keys_);
+    if (top == keys_.size()) {
+      ASSERT_TRUE(tree_.is_empty());
+      return;
+    }
+    ASSERT_FALSE(tree_.is_empty());
+    ASSERT_EQ(top, tree_.top_stream());
+    ASSERT_EQ(keys_[top], tree_.top_trig_id());
+    for (std::size_t i = 0; i < keys_.size(); i++) {
+      ASSERT_EQ(keys_[i] != snfee::rtdb::trigger_id_tree::NO_TRIG_ID,
+                tree_.contains(i));
+    }
+    return;
+  }
+
+} // namespace
+
+TEST(trigger_id_tree, empty)
+{
+  snfee::rtdb::trigger_id_tree tree(7);
+  EXPECT_TRUE(tree.is_empty());
+  EXPECT_THROW(tree.top_stream(), std::logic_error);
+  EXPECT_THROW(tree.top_trig_id(), std::logic_error);
+  tree.update(3, 12);
+  EXPECT_FALSE(tree.is_empty());
+  tree.remove(3);
+  EXPECT_TRUE(tree.is_empty());
+  // Removing an absent stream is a no-op:
+  tree.remove(3);
+  EXPECT_TRUE(tree.is_empty());
+}
+
+TEST(trigger_id_tree, invalid_update)
+{
+  snfee::rtdb::trigger_id_tree tree(3);
+  EXPECT_THROW(tree.update(3, 0), std::range_error);
+  EXPECT_THROW(tree.update(0, snfee::rtdb::trigger_id_tree::NO_TRIG_ID),
+               std::range_error);
+}
+
+TEST(trigger_id_tree, ties_ordered_by_stream)
+{
+  snfee::rtdb::trigger_id_tree tree(5);
+  tree.update(4, 10);
+  tree.update(2, 10);
+  tree.update(3, 10);
+  EXPECT_EQ(2U, tree.top_stream());
+  tree.remove(2);
+  EXPECT_EQ(3U, tree.top_stream());
+  tree.update(0, 10);
+  EXPECT_EQ(0U, tree.top_stream());
+  tree.update(0, 11);
+  EXPECT_EQ(3U, tree.top_stream());
+}
+
+TEST(trigger_id_tree, single_stream)
+{
+  snfee::rtdb::trigger_id_tree tree(1);
+  tree.update(0, 5);
+  EXPECT_EQ(0U, tree.top_stream());
+  EXPECT_EQ(5, tree.top_trig_id());
+  tree.update(0, 4);
+  EXPECT_EQ(4, tree.top_trig_id());
+}
+
+TEST(trigger_id_tree, random_updates)
+{
+  std::mt19937 random(2718);
+  // Powers of two and not, as the 7 streams of the builder:
+  for (const std::size_t nstreams : {2, 3, 7, 8, 13}) {
+    SCOPED_TRACE(nstreams);
+    snfee::rtdb::trigger_id_tree tree;
+    tree.resize(nstreams);
+    std::vector<int32_t> keys(nstreams,
+                              snfee::rtdb::trigger_id_tree::NO_TRIG_ID);
+    for (std::size_t istep = 0; istep < 20000; istep++) {
+      const std::size_t stream = random() % nstreams;
+      if (random() % 5 == 0) {
+        tree.remove(stream);
+        keys[stream] = snfee::rtdb::trigger_id_tree::NO_TRIG_ID;
+      } else {
+        // Few distinct IDs so that ties are frequent:
+        const int32_t trig_id = random() % 16;
+        tree.update(stream, trig_id);
+        keys[stream] = trig_id;
+      }
+      expect_same_as_scan(tree, keys);
+      if (HasFatalFailure()) {
+        return;
+      }
+    }
+  }
+}
+
+TEST(trigger_id_tree, k_way_merge)
+{
+  // Merge sorted streams by popping the front of the top stream:
+  std::mt19937 random(1414);
+  const std::size_t nstreams = 7;
+  std::vector<std::vector<int32_t>> streams(nstreams);
+  std::size_t nrecords = 0;
+  for (auto& stream : streams) {
+    int32_t trig_id = 0;
+    for (std::size_t i = 0; i < 500; i++) {
+      trig_id += random() % 3;
+      stream.push_back(trig_id);
+      nrecords++;
+    }
+  }
+  snfee::rtdb::trigger_id_tree tree(nstreams);
+  std::vector<std::size_t> fronts(nstreams, 0);
+  for (std::size_t i = 0; i < nstreams; i++) {
+    tree.update(i, streams[i][0]);
+  }
+  std::vector<int32_t> merged;
+  std::vector<std::size_t> merged_streams;
+  while (!tree.is_empty()) {
+    const std::size_t stream = tree.top_stream();
+    merged.push_back(tree.top_trig_id());
+    merged_streams.push_back(stream);
+    if (++fronts[stream] < streams[stream].size()) {
+      tree.update(stream, streams[stream][fronts[stream]]);
+    } else {
+      tree.remove(stream);
+    }
+  }
+  ASSERT_EQ(nrecords, merged.size());
+  for (std::size_t i = 1; i < merged.size(); i++) {
+    ASSERT_LE(merged[i - 1], merged[i]) << "record #" << i;
+    if (merged[i - 1] == merged[i]) {
+      ASSERT_LE(merged_streams[i - 1], merged_streams[i]) << "record #" << i;
+    }
+  }
+}
@@ -0,0 +1,256 @@
+// tests/test_waveform_decoder.cc
+//
+// Fuzz-style equivalence of the waveform decoder, with all the instruction
+// sets supported by the CPU, and of the former Spirit parsing of the
+// waveform lines (+qi::int_).
+
+// Standard library:
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Boost:
+#include <boost/spirit/include/qi.hpp>
+// - GTest:
+#include <gtest/gtest.h>
+
+// This project:
+#include <snfee/data/calo_hit_record.h>
+
+#include "crd_tokenizer.h"
+#include "waveform_decoder.h"
+
+namespace {
+
+  /// Capacity of the sample storage (2 x 1024 samples)
+  const std::size_t CAPACITY = 2048;
+
+  /// Number of random lines
+  const std::size_t NUMBER_OF_LINES = 20000;
+
+  /// \brief Result of the decoding of a line
+  struct decoded_type {
+    snfee::io::waveform_decoder::status_type status =
+      snfee::io::waveform_decoder::DECODE_OK;
+    std::vector<uint16_t> samples;
+  };
+
+  //! Decode a line as the former Spirit parser, with the checks of the
+  //! decoder on the parsed values
+  decoded_type
+  decode_spirit(const std::string& line_)
+  {
+    namespace qi = boost::spirit::qi;
+    decoded_type decoded;
+    std::vector<int32_t> values;
+    std::string::const_iterator first = line_.begin();
+    const bool ok =
+      qi::phrase_parse(first, line_.end(), +qi::int_, qi::space, values);
+    if (!ok or first != line_.end()) {
+      decoded.status = snfee::io::waveform_decoder::DECODE_SYNTAX_ERROR;
+      return decoded;
+    }
+    for (const int32_t value : values) {
+      const uint16_t adc = static_cast<int16_t>(value);
+      if (adc > snfee::data::calo_hit_record::SAMPLE_ADC_MAX) {
+        decoded.status = snfee::io::waveform_decoder::DECODE_RANGE_ERROR;
+        break;
+      }
+      if (decoded.samples.size() == CAPACITY) {
+        decoded.status = snfee::io::waveform_decoder::DECODE_CAPACITY_ERROR;
+        break;
+      }
+      decoded.samples.push_back(adc);
+    }
+    return decoded;
+  }
+
+  //! Decode a line with a given instruction set
+  decoded_type
+  decode(const std::string& line_,
+         const snfee::io::waveform_decoder::isa_type isa_)
+  {
+    // Copy the line so that the bytes after its end are not readable
+    // through the string:
+    std::vector<char> bytes(line_.begin(), line_.end());
+    snfee::io::crd_line line;
+    line.begin = bytes.data();
+    line.end = bytes.data() + bytes.size();
+    snfee::io::waveform_decoder decoder(isa_);
+    decoded_type decoded;
+    decoded.samples.resize(CAPACITY);
+    std::size_t nsamples = 0;
+    decoded.status = decoder.decode(line, decoded.samples.data(), CAPACITY,
+                                    nsamples);
+    decoded.samples.resize(nsamples);
+    return decoded;
+  }
+
+  //! Return the instruction sets supported by the CPU
+  std::vector<snfee::io::waveform_decoder::isa_type>
+  supported_isas()
+  {
+    std::vector<snfee::io::waveform_decoder::isa_type> isas;
+    const snfee::io::waveform_decoder::isa_type best =
+      snfee::io::waveform_decoder::best_isa();
+    for (int isa = snfee::io::waveform_decoder::ISA_SCALAR; isa <= best;
+         isa++) {
+      isas.push_back(static_cast<snfee::io::waveform_decoder::isa_type>(isa));
+    }
+    return isas;
+  }
+
+  //! Check that all the instruction sets decode a line as Spirit
+  void
+  expect_same_decoding(const std::string& line_)
+  {
+    const decoded_type expected = decode_spirit(line_);
+    for (const auto isa : supported_isas()) {
+      const decoded_type actual = decode(line_, isa);
+      SCOPED_TRACE(std::string("isa: ") +
+                   snfee::io::waveform_decoder::isa_label(isa) +
+                   ", line: '" + line_ + "'");
+      if (expected.status == snfee::io::waveform_decoder::DECODE_OK) {
+        ASSERT_EQ(snfee::io::waveform_decoder::DECODE_OK, actual.status);
+        ASSERT_EQ(expected.samples, actual.samples);
+      } else {
+        // The decoder may stop on another error than Spirit, but it must
+        // reject the line:
+        ASSERT_NE(snfee::io::waveform_decoder::DECODE_OK, actual.status);
+      }
+    }
+    return;
+  }
+
+  //! Return a random token, mostly a valid ADC value
+  std::string
+  random_token(std::mt19937& random_, const bool valid_)
+  {
+    std::uniform_int_distribution<int> adc(
+      0, snfee::data::calo_hit_record::SAMPLE_ADC_MAX);
+    if (valid_) {
+      switch (random_() % 8) {
+        case 0:
+          // Leading zeros:
+          return std::string(1 + random_() % 3, '0') +
+                 std::to_string(adc(random_));
+        case 1:
+          return "+" + std::to_string(adc(random_));
+        case 2:
+          return std::to_string(random_() % 10);
+        default:
+          return std::to_string(adc(random_));
+      }
+    }
+    switch (random_() % 8) {
+      case 0:
+        return "-" + std::to_string(1 + adc(random_));
+      case 1:
+        return std::to_string(4096 + random_() % 60000);
+      case 2:
+        return "99999999999";
+      case 3:
+        return std::to_string(adc(random_)) + "x";
+      case 4:
+        return "+";
+      case 5:
+        return ",";
+      case 6:
+        return "-0";
+      default:
+        return std::to_string(adc(random_)) + "." +
+               std::to_string(random_() % 10);
+    }
+  }
+
+  //! Return a random separator
+  std::string
+  random_separator(std::mt19937& random_)
+  {
+    static const char* separators[] = {" ", " ", " ", "  ", "\t", " \t "};
+    return separators[random_() % 6];
+  }
+
+  //! Return a random line of a given number of tokens
+  std::string
+  random_line(std::mt19937& random_,
+              const std::size_t nb_tokens_,
+              const bool valid_)
+  {
+    std::string line;
+    if (random_() % 4 == 0) {
+      line += random_separator(random_);
+    }
+    // A single invalid token at a random position:
+    const std::size_t invalid_index =
+      valid_ ? nb_tokens_ : random_() % nb_tokens_;
+    for (std::size_t itoken = 0; itoken < nb_tokens_; itoken++) {
+      if (itoken > 0) {
+        line += random_separator(random_);
+      }
+      line += random_token(random_, itoken != invalid_index);
+    }
+    if (random_() % 4 == 0) {
+      line += random_separator(random_);
+    }
+    return line;
+  }
+
+} // namespace
+
+TEST(waveform_decoder, typical_lines)
+{
+  expect_same_decoding("0");
+  expect_same_decoding("4095");
+  expect_same_decoding("4096");
+  expect_same_decoding("1 2 3 4 5 6 7 8 9 10");
+  expect_same_decoding("  2048 2049\t2050  ");
+  expect_same_decoding("");
+  expect_same_decoding("   ");
+  expect_same_decoding("12 -3 45");
+  expect_same_decoding("12 3a 45");
+}
+
+TEST(waveform_decoder, full_waveform_line)
+{
+  std::mt19937 random(1);
+  std::uniform_int_distribution<int> adc(
+    0, snfee::data::calo_hit_record::SAMPLE_ADC_MAX);
+  std::string line;
+  for (std::size_t isample = 0; isample < 1024; isample++) {
+    line += std::to_string(adc(random)) + ' ';
+  }
+  expect_same_decoding(line);
+  const decoded_type decoded =
+    decode(line, snfee::io::waveform_decoder::best_isa());
+  EXPECT_EQ(1024U, decoded.samples.size());
+}
+
+TEST(waveform_decoder, capacity)
+{
+  std::string line;
+  for (std::size_t isample = 0; isample <= CAPACITY; isample++) {
+    line += "7 ";
+  }
+  expect_same_decoding(line);
+  for (const auto isa : supported_isas()) {
+    EXPECT_EQ(snfee::io::waveform_decoder::DECODE_CAPACITY_ERROR,
+              decode(line, isa).status);
+  }
+}
+
+TEST(waveform_decoder, random_lines)
+{
+  std::mt19937 random(314159);
+  for (std::size_t iline = 0; iline < NUMBER_OF_LINES; iline++) {
+    // Lines crossing one or several 64-byte words:
+    const std::size_t nb_tokens = 1 + random() % 80;
+    const bool valid = random() % 3 != 0;
+    expect_same_decoding(random_line(random, nb_tokens, valid));
+    if (HasFatalFailure()) {
+      return;
+    }
+  }
+}
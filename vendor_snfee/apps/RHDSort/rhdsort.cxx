@@ -59,6 +59,27 @@ int main(int argc_, char ** argv_)
        ->default_value(4000),
        "set the size of the sorting buffer of RHD records")
        
+      ("auto-sort-buffer-size,A",
+       "auto-tune the size of the sorting buffer from the sort window distances of the RHD records (the sort buffer size is ignored)")
+
+      ("auto-sample-size",
+       po::value<std::size_t>(& app_params.sorter_cfg.auto_sample_size)
+       ->value_name("number")
+       ->default_value(snfee::io::rhd_sorter::DEFAULT_AUTO_SAMPLE_SIZE),
+       "set the number of RHD records sampled before sorting to auto-tune the sorting buffer (0: online tuning only)")
+
+      ("auto-safety-factor",
+       po::value<double>(& app_params.sorter_cfg.auto_safety_factor)
+       ->value_name("factor")
+       ->default_value(snfee::io::rhd_sorter::DEFAULT_AUTO_SAFETY_FACTOR),
+       "set the safety factor applied to the auto-tuned size of the sorting buffer")
+
+      ("max-sort-buffer-size",
+       po::value<std::size_t>(& app_params.sorter_cfg.max_sort_buffer_size)
+       ->value_name("number")
+       ->default_value(snfee::io::rhd_sorter::DEFAULT_MAX_SORT_BUFFER_SIZE),
+       "set the maximum auto-tuned size of the sorting buffer")
+
       ("evaluation,e", "run in 'evaluation' mode")
       
       ("evaluation-buffer-size,E",
@@ -159,6 +180,11 @@ int main(int argc_, char ** argv_)
     DT_LOG_NOTICE(datatools::logger::PRIO_ALWAYS,
                   "Config mode label = '" << app_params.sorter_cfg.mode_label << "'");
     
+    if (vm.count("auto-sort-buffer-size")) {
+      DT_LOG_NOTICE(datatools::logger::PRIO_ALWAYS, "Using auto-tuned sort buffer size");
+      app_params.sorter_cfg.auto_sort_buffer_size = true;
+    }
+
     if (vm.count("no-store")) {
       DT_LOG_NOTICE(datatools::logger::PRIO_ALWAYS, "Using 'no-store' mode");
       app_params.sorter_cfg.no_store = true;
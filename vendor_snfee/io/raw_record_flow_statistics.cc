@@ -3,6 +3,9 @@
 // Ourselves:
 #include <snfee/io/raw_record_flow_statistics.h>
 
+// Standard library:
+#include <algorithm>
+
 namespace snfee {
   namespace io {
 
@@ -52,11 +55,23 @@ namespace snfee {
     {
       return _max_inversion_distance_;
     }
+
+    int raw_record_flow_statistics::get_max_sort_window_distance() const
+    {
+      return _max_sort_window_distance_;
+    }
    
+    std::size_t raw_record_flow_statistics::get_number_of_inversions() const
+    {
+      return _number_of_inversions_;
+    }
+
     void raw_record_flow_statistics::_init_()
     {
       _hdistances_ = snfee::tools::histogram_int(0, 5000, 100);
       _max_inversion_distance_ = -1;
+      _max_sort_window_distance_ = -1;
+      _number_of_inversions_ = 0;
       return;
     }
 
@@ -72,30 +87,51 @@ namespace snfee {
         // Record the position of the first occurence of a trigger ID:
         _first_positions_[tid_] = pos_;
       }
-      // Compare with previous hits:
+      // Compare with previous hits: the first trigger ID greater than this one
+      // is the smallest greater trigger ID in the buffer:
       bool detected_inversion = false;
-      for (auto p : _first_positions_) {
-        if (tid_ < p.first) {
-          // Detected inversion:
-          detected_inversion = true;
-          int tid1 = p.first;
-          int pos1 = p.second;
-          int dist = pos_ - pos1;
-          DT_LOG_DEBUG(_logging_, "Detected inversion : trigger ID=" << tid_ << "@" << pos_
-                       << " < " << tid1 << "@" << pos1);
-          _inversions_[tid_] = inversion_record(pos1, pos_, tid1, tid_);
-          _hdistances_.add(dist);
-          if ((_max_inversion_distance_ < 0) || (dist > _max_inversion_distance_)) {
-            _max_inversion_distance_ = dist;
-          }
-          break;
+      auto found = _first_positions_.upper_bound(tid_);
+      if (found != _first_positions_.end()) {
+        // Detected inversion:
+        detected_inversion = true;
+        int tid1 = found->first;
+        int pos1 = found->second;
+        int dist = pos_ - pos1;
+        DT_LOG_DEBUG(_logging_, "Detected inversion : trigger ID=" << tid_ << "@" << pos_
+                     << " < " << tid1 << "@" << pos1);
+        _inversions_[tid_] = inversion_record(pos1, pos_, tid1, tid_);
+        _number_of_inversions_++;
+        _hdistances_.add(dist);
+        if ((_max_inversion_distance_ < 0) || (dist > _max_inversion_distance_)) {
+          _max_inversion_distance_ = dist;
         }
       }
+      // The running maximum trigger ID is non decreasing along the flow, so
+      // the earliest record with a greater trigger ID is found by a binary
+      // search:
+      auto found_max = std::upper_bound(_max_trigger_ids_.begin(),
+                                        _max_trigger_ids_.end(),
+                                        tid_,
+                                        [](const int tid, const std::pair<int,int> & max) {
+                                          return tid < max.first;
+                                        });
+      if (found_max != _max_trigger_ids_.end()) {
+        int dist = pos_ - found_max->second;
+        if ((_max_sort_window_distance_ < 0) || (dist > _max_sort_window_distance_)) {
+          _max_sort_window_distance_ = dist;
+        }
+      } else if (_max_trigger_ids_.empty() || tid_ > _max_trigger_ids_.back().first) {
+        _max_trigger_ids_.push_back(std::make_pair(tid_, pos_));
+      }
       if (! detected_inversion) {
+        // Both buffers keep the trigger IDs within the buffer size:
         while (tid_ > (get_min_trigger_id() + _buffer_size_)) {
           // Remove head:
           _first_positions_.erase(_first_positions_.begin());
         }
+        while (tid_ > (_max_trigger_ids_.front().first + _buffer_size_)) {
+          _max_trigger_ids_.pop_front();
+        }
       }  
       return;
     }
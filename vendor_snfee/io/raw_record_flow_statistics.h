@@ -22,6 +22,7 @@
 #define SNFEE_IO_RAW_RECORD_FLOW_STATISTICS_H
 
 // Standard library:
+#include <deque>
 #include <map>
 #include <utility>
 #include <iostream>
@@ -72,8 +73,22 @@ namespace snfee {
       int get_min_trigger_id();
 
       /// Return the maximum detected inversion distance
+      ///
+      /// The inversion distance of a record is the distance to the first
+      /// record with the smallest greater trigger ID.
       int get_max_inversion_distance();
 
+      /// Return the maximum sort window distance
+      ///
+      /// The sort window distance of a record is the distance to the earliest
+      /// record in the flow with a greater trigger ID, i.e. how far back a
+      /// sorting window must reach to order it. It is never smaller than the
+      /// inversion distance.
+      int get_max_sort_window_distance() const;
+
+      /// Return the number of detected inversions
+      std::size_t get_number_of_inversions() const;
+
       /// Add a new trigger ID from a position in the flow
       void add(const int pos_, const int tid_);
 
@@ -93,8 +108,11 @@ namespace snfee {
 
       // Work:
       std::map<int,int>              _first_positions_; ///< Buffer of record of trigger IDs' first positions
+      std::deque<std::pair<int,int>> _max_trigger_ids_; ///< Running maximum trigger IDs and the positions where they were reached
       std::map<int,inversion_record> _inversions_; ///< List of inversions
       int                            _max_inversion_distance_ = -1; ///< Maximum detected inversion distance
+      int                            _max_sort_window_distance_ = -1; ///< Maximum detected sort window distance
+      std::size_t                    _number_of_inversions_ = 0; ///< Number of detected inversions
       snfee::tools::histogram_int    _hdistances_; ///< Histogram of distances of inversion
       
     };
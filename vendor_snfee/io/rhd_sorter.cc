@@ -5,6 +5,8 @@
 #include <typeinfo>
 #include <iomanip>
 #include <string>
+#include <cmath>
+#include <algorithm>
 
 // Third party:
 // - Boost:
@@ -40,6 +42,41 @@ namespace snfee {
       }
     };
 
+    /// Load the next raw record from a reader
+    static void load_raw_record(multifile_data_reader & reader_,
+                                snfee::data::raw_record_ptr & ph_)
+    {
+      if (reader_.record_tag_is(snfee::data::calo_hit_record::SERIAL_TAG)) {
+        if (! ph_ || typeid(*ph_.get()) != typeid(snfee::data::calo_hit_record)) {
+          ph_ = std::make_shared<snfee::data::calo_hit_record>();
+        } else {
+          ph_->invalidate();
+        }
+        snfee::data::calo_hit_record & new_calo_hit
+          = dynamic_cast<snfee::data::calo_hit_record &>(*ph_.get());
+        reader_.load(new_calo_hit);
+      } else if (reader_.record_tag_is(snfee::data::tracker_hit_record::SERIAL_TAG)) {
+        if (! ph_ || typeid(*ph_.get()) != typeid(snfee::data::tracker_hit_record)) {
+          ph_ = std::make_shared<snfee::data::tracker_hit_record>();
+        } else {
+          ph_->invalidate();
+        }
+        snfee::data::tracker_hit_record & new_tracker_hit
+          = dynamic_cast<snfee::data::tracker_hit_record &>(*ph_.get());
+        reader_.load(new_tracker_hit);
+      } else if (reader_.record_tag_is(snfee::data::trigger_record::SERIAL_TAG)) {
+        if (! ph_ || typeid(*ph_.get()) != typeid(snfee::data::trigger_record)) {
+          ph_ = std::make_shared<snfee::data::trigger_record>();
+        } else {
+          ph_->invalidate();
+        }
+        snfee::data::trigger_record & new_trigger_rec
+          = dynamic_cast<snfee::data::trigger_record &>(*ph_.get());
+        reader_.load(new_trigger_rec);
+      }
+      return;
+    }
+
     /// \brief Running mode
     enum mode_type {
       MODE_UNDEF      = 0x0, ///< Undefined/invalid running mode
@@ -62,11 +99,23 @@ namespace snfee {
       int32_t     current_trigger_id     = -1;
       std::unique_ptr<raw_record_flow_statistics> stats;
       std::string report_filename;
+      multifile_data_reader::config_type reader_cfg;
+      bool        auto_tuning                = false;
+      std::size_t initial_sort_buffer_size   = 0;
+      std::size_t sampled_records            = 0;
+      int         sampled_sort_window_distance = -1;
+      int         max_sort_window_distance     = -1;
+      double      min_observed_safety        = -1.0;
+      std::size_t number_of_resizes          = 0;
 
       void dump_buffer(std::ostream & out_) const;
       
     };
 
+    const std::size_t rhd_sorter::DEFAULT_AUTO_SAMPLE_SIZE;
+    const std::size_t rhd_sorter::DEFAULT_MAX_SORT_BUFFER_SIZE;
+    constexpr double  rhd_sorter::DEFAULT_AUTO_SAFETY_FACTOR;
+
     rhd_sorter::rhd_sorter()
     {
       _pimpl_.reset(new pimpl_type);
@@ -181,6 +230,7 @@ namespace snfee {
       for (int ifile = 0; ifile < (int) _config_.input_rhd_filenames.size(); ifile++) {
         reader_cfg.filenames.push_back(_config_.input_rhd_filenames[ifile]);
       }
+      _pimpl_->reader_cfg = reader_cfg;
       _pimpl_->reader.reset(new multifile_data_reader(reader_cfg));
 
       bool with_writer = false;
@@ -227,7 +277,18 @@ namespace snfee {
       }
     
       // Set the capacity of the sorting buffer
-      _pimpl_->cbuffer.set_capacity(_config_.sort_buffer_size);
+      if (_pimpl_->mode == MODE_SORT && _config_.auto_sort_buffer_size) {
+        DT_THROW_IF(_config_.auto_safety_factor < 1.0, std::logic_error,
+                    "Invalid auto-tuning safety factor (" << _config_.auto_safety_factor << " < 1)!");
+        DT_THROW_IF(_config_.max_sort_buffer_size < MIN_AUTO_SORT_BUFFER_SIZE, std::logic_error,
+                    "Invalid maximum sort buffer size (" << _config_.max_sort_buffer_size << ")!");
+        _pimpl_->auto_tuning = true;
+        _pimpl_->stats.reset(new raw_record_flow_statistics(_config_.evaluation_buffer_size));
+        _auto_tune_sort_buffer_size_();
+      } else {
+        _pimpl_->cbuffer.set_capacity(_config_.sort_buffer_size);
+      }
+      _pimpl_->initial_sort_buffer_size = _pimpl_->cbuffer.capacity();
             
       _initialized_ = true;
       return;
@@ -333,40 +394,90 @@ namespace snfee {
         snfee::data::raw_record_interface * rri = ph_.get();
         DT_LOG_DEBUG(_logging_, "Input raw record type = '" << typeid(*rri).name() << "'\n");
       }
-      if (_pimpl_->reader->record_tag_is(snfee::data::calo_hit_record::SERIAL_TAG)) {
-        if (! ph_ || typeid(*ph_.get()) != typeid(snfee::data::calo_hit_record)) {
-          ph_ = std::make_shared<snfee::data::calo_hit_record>();
-        } else {
-          ph_->invalidate();
-        }
-        snfee::data::calo_hit_record & new_calo_hit
-          = dynamic_cast<snfee::data::calo_hit_record &>(*ph_.get());
-        _pimpl_->reader->load(new_calo_hit);
-      } else if (_pimpl_->reader->record_tag_is(snfee::data::tracker_hit_record::SERIAL_TAG)) {
-        if (! ph_ || typeid(*ph_.get()) != typeid(snfee::data::tracker_hit_record)) {
-          ph_ = std::make_shared<snfee::data::tracker_hit_record>();
-        } else {
-          ph_->invalidate();
-        }
-        snfee::data::tracker_hit_record & new_tracker_hit
-          = dynamic_cast<snfee::data::tracker_hit_record &>(*ph_.get());
-        _pimpl_->reader->load(new_tracker_hit);
-      } else if (_pimpl_->reader->record_tag_is(snfee::data::trigger_record::SERIAL_TAG)) {
-        if (! ph_ || typeid(*ph_.get()) != typeid(snfee::data::trigger_record)) {
-          ph_ = std::make_shared<snfee::data::trigger_record>();
-        } else {
-          ph_->invalidate();
-        }
-        ph_ = std::make_shared<snfee::data::trigger_record>();
-        snfee::data::trigger_record & new_trigger_rec
-          = dynamic_cast<snfee::data::trigger_record &>(*ph_.get());
-        _pimpl_->reader->load(new_trigger_rec);
-      }
+      load_raw_record(*_pimpl_->reader, ph_);
       _pimpl_->input_hit_counter++;
-      if (_pimpl_->mode == MODE_EVALUATION) {
+      if (_pimpl_->stats) {
         _pimpl_->stats->add(_pimpl_->input_hit_counter, ph_->get_trigger_id());
       }
+      if (_pimpl_->auto_tuning) {
+        _update_sort_buffer_size_();
+      }
+
+      return;
+    }
+
+    // static
+    std::size_t rhd_sorter::minimal_sort_buffer_size(const int max_sort_window_distance_)
+    {
+      if (max_sort_window_distance_ <= 0) {
+        // Sorted flow:
+        return 2;
+      }
+      return 2 * (std::size_t) max_sort_window_distance_;
+    }
 
+    void rhd_sorter::_auto_tune_sort_buffer_size_()
+    {
+      raw_record_flow_statistics sample_stats(_config_.evaluation_buffer_size);
+      if (_config_.auto_sample_size > 0) {
+        DT_LOG_DEBUG(_logging_, "Sampling the first " << _config_.auto_sample_size << " records...");
+        // The pre-pass uses its own reader on the same input files:
+        multifile_data_reader sample_reader(_pimpl_->reader_cfg);
+        snfee::data::raw_record_ptr p_hit;
+        while (sample_reader.has_record_tag()
+               && _pimpl_->sampled_records < _config_.auto_sample_size) {
+          load_raw_record(sample_reader, p_hit);
+          _pimpl_->sampled_records++;
+          sample_stats.add(_pimpl_->sampled_records, p_hit->get_trigger_id());
+        }
+      }
+      _pimpl_->sampled_sort_window_distance = sample_stats.get_max_sort_window_distance();
+      std::size_t size
+        = (std::size_t) std::ceil(_config_.auto_safety_factor
+                                  * minimal_sort_buffer_size(_pimpl_->sampled_sort_window_distance));
+      if (size < MIN_AUTO_SORT_BUFFER_SIZE) {
+        size = MIN_AUTO_SORT_BUFFER_SIZE;
+      }
+      if (size > _config_.max_sort_buffer_size) {
+        DT_LOG_WARNING(_logging_, "Auto-tuned sort buffer size " << size
+                       << " is limited to " << _config_.max_sort_buffer_size << "!");
+        size = _config_.max_sort_buffer_size;
+      }
+      DT_LOG_NOTICE(_logging_, "Auto-tuned sort buffer size : " << size
+                    << " (sampled records=" << _pimpl_->sampled_records
+                    << ", max sort window distance=" << _pimpl_->sampled_sort_window_distance << ")");
+      _pimpl_->cbuffer.set_capacity(size);
+      return;
+    }
+
+    void rhd_sorter::_update_sort_buffer_size_()
+    {
+      const int dist = _pimpl_->stats->get_max_sort_window_distance();
+      if (dist <= _pimpl_->max_sort_window_distance) {
+        return;
+      }
+      _pimpl_->max_sort_window_distance = dist;
+      // Safety of the current buffer with respect to the new maximum distance:
+      const std::size_t capacity = _pimpl_->cbuffer.capacity();
+      const double safety = capacity / (double) minimal_sort_buffer_size(dist);
+      if (_pimpl_->min_observed_safety < 0.0 || safety < _pimpl_->min_observed_safety) {
+        _pimpl_->min_observed_safety = safety;
+      }
+      if (safety < 1.0) {
+        DT_LOG_WARNING(_logging_, "Sort buffer size " << capacity
+                       << " is too small for the sort window distance " << dist
+                       << " met at record #" << _pimpl_->input_hit_counter << "!");
+      }
+      std::size_t size
+        = (std::size_t) std::ceil(_config_.auto_safety_factor * minimal_sort_buffer_size(dist));
+      size = std::min(size, _config_.max_sort_buffer_size);
+      if (size > capacity) {
+        // Growing the buffer preserves its content:
+        DT_LOG_NOTICE(_logging_, "Growing the sort buffer size from " << capacity << " to " << size
+                      << " (max inversion distance=" << dist << ")");
+        _pimpl_->cbuffer.set_capacity(size);
+        _pimpl_->number_of_resizes++;
+      }
       return;
     }
 
@@ -467,7 +578,21 @@ namespace snfee {
           datatools::fetch_path_with_env(fn);
           std::ofstream freport(fn);
           DT_THROW_IF(!freport, std::logic_error, "Cannot open sort report file '" << fn << "'!");
-          freport << "#@sort_buffer_size=" << _config_.sort_buffer_size << std::endl;
+          freport << "#@sort_buffer_size=" << _pimpl_->cbuffer.capacity() << std::endl;
+          if (_pimpl_->auto_tuning) {
+            freport << "#@auto_sort_buffer_size=true" << std::endl;
+            freport << "#@auto_safety_factor=" << _config_.auto_safety_factor << std::endl;
+            freport << "#@auto_sampled_records=" << _pimpl_->sampled_records << std::endl;
+            freport << "#@auto_sampled_max_sort_window_distance=" << _pimpl_->sampled_sort_window_distance << std::endl;
+            freport << "#@initial_sort_buffer_size=" << _pimpl_->initial_sort_buffer_size << std::endl;
+            freport << "#@number_of_sort_buffer_resizes=" << _pimpl_->number_of_resizes << std::endl;
+            freport << "#@number_of_inversions=" << _pimpl_->stats->get_number_of_inversions() << std::endl;
+            freport << "#@max_inversion_distance=" << _pimpl_->stats->get_max_inversion_distance() << std::endl;
+            freport << "#@max_sort_window_distance=" << _pimpl_->stats->get_max_sort_window_distance() << std::endl;
+            // Ratio of the sort buffer size to the minimal size needed by the
+            // worst inversion, as observed when it was met (>= 1 is safe):
+            freport << "#@min_observed_safety=" << _pimpl_->min_observed_safety << std::endl;
+          }
           freport << "#@input_hit_counter=" << _pimpl_->input_hit_counter << std::endl;
           freport << "#@output_hit_counter=" << _pimpl_->output_hit_counter << std::endl;
           freport << "#@output_trigger_counter=" << _pimpl_->output_trigger_counter << std::endl;
@@ -32,6 +32,10 @@ namespace snfee {
 
       static const std::size_t DEFAULT_SORT_BUFFER_SIZE       =  4000;
       static const std::size_t DEFAULT_EVALUATION_BUFFER_SIZE = 10000;
+      static const std::size_t DEFAULT_AUTO_SAMPLE_SIZE       = 100000;
+      static const std::size_t DEFAULT_MAX_SORT_BUFFER_SIZE   = 1000000;
+      static const std::size_t MIN_AUTO_SORT_BUFFER_SIZE      = 64;
+      static constexpr double  DEFAULT_AUTO_SAFETY_FACTOR     = 2.0;
            
       /// \brief Configuration data: 
       struct config_type
@@ -46,6 +50,10 @@ namespace snfee {
         // std::size_t max_total_records = 0;          ///< Max number of RHD records (very risky)
         std::size_t sort_buffer_size       = DEFAULT_SORT_BUFFER_SIZE;       ///< Size of the sorting buffer
         std::size_t evaluation_buffer_size = DEFAULT_EVALUATION_BUFFER_SIZE; ///< Size of the evaluation buffer
+        bool auto_sort_buffer_size = false;            ///< Auto-tuning of the sort buffer size from the sort window distances ('sort' mode)
+        std::size_t auto_sample_size = DEFAULT_AUTO_SAMPLE_SIZE;         ///< Number of records sampled by the auto-tuning pre-pass (0: no pre-pass)
+        double auto_safety_factor = DEFAULT_AUTO_SAFETY_FACTOR;          ///< Safety factor applied to the minimal sort buffer size
+        std::size_t max_sort_buffer_size = DEFAULT_MAX_SORT_BUFFER_SIZE; ///< Maximum auto-tuned sort buffer size
         std::size_t log_modulo = 10000;                ///< Modulo for log print
         std::string report_filename;                   ///< Name of a report file ('sort' or 'evaluation')
       };
@@ -73,6 +81,14 @@ namespace snfee {
 
       //! Run the sorter
       void run();
+
+      //! Return the minimal sort buffer size which guarantees a correct
+      //! ordering for a given maximum sort window distance
+      //!
+      //! The buffer is sorted when full and its first half is output, so
+      //! a record is correctly ordered if no record with a greater trigger
+      //! ID is met more than half a buffer before it.
+      static std::size_t minimal_sort_buffer_size(const int max_sort_window_distance_);
       
       //! Reset the sorter
       void terminate();
@@ -91,6 +107,12 @@ namespace snfee {
       //! Finalize the process
       void _finalize_();
 
+      //! Compute the initial sort buffer size from a sampling pre-pass
+      void _auto_tune_sort_buffer_size_();
+
+      //! Update the sort buffer size from the sort window distances met so far
+      void _update_sort_buffer_size_();
+
     private:
     
       // Management:
@@ -180,7 +180,9 @@ namespace snfee {
       // Ouput manager:
       DT_LOG_NOTICE(_logging_, "Instantiating the output worker...");
       pimpl.omtx = std::make_shared<std::mutex>();
+      pimpl.ocond = std::make_shared<std::condition_variable>();
       pimpl.oworker = std::make_shared<output_worker>(*pimpl.omtx.get(),
+                                                      *pimpl.ocond.get(),
                                                       pimpl.obuffer,
                                                       _config_.output_config,
                                                       _logging_);
@@ -196,6 +198,7 @@ namespace snfee {
       {
         DT_LOG_NOTICE(_logging_, "Instantiating the input buffer mutex...");
         pimpl.imtx = std::make_shared<std::mutex>();
+        pimpl.icond = std::make_shared<std::condition_variable>();
         DT_LOG_NOTICE(_logging_, "Instantiating the input RTD buffer...");
         std::size_t min_popping_trig_ids = 1;
         uint32_t capacity = _config_.rtd_buffer_capacity;
@@ -214,6 +217,7 @@ namespace snfee {
         DT_LOG_NOTICE(_logging_, "Instantiating the input worker...");
         pimpl.iworker = std::make_shared<input_worker>(0,
                                                        *pimpl.imtx.get(),
+                                                       *pimpl.icond.get(),
                                                         pimpl.ibuffer,
                                                        _config_.input_config,
                                                        _logging_);
@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
 
 // Third Party Libraries:
 #include <bayeux/datatools/i_tree_dump.h>
@@ -129,7 +130,7 @@ namespace snfee {
       // Management
       bool _initialized_ = false;
       datatools::logger::priority _logging_ = datatools::logger::PRIO_FATAL;
-      bool _stop_request_ = false;
+      std::atomic<bool> _stop_request_{false};
       
       // Configuration
       builder_config _config_;
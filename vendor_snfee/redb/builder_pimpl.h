@@ -24,6 +24,7 @@
 // Standard Library:
 #include <memory>
 #include <mutex>
+#include <condition_variable>
 
 // This project:
 #include <snfee/redb/rtd_buffer.h>
@@ -58,9 +59,11 @@ namespace snfee {
       input_worker_ptr            iworker; ///< RHD input workers
       rtd_buffer                  ibuffer; ///< Buffer of input raw trigger data records (RTD)
       std::shared_ptr<std::mutex> imtx;    ///< Mutex for individual access to input buffer
+      std::shared_ptr<std::condition_variable> icond; ///< Condition notified when the input buffer changes
       rtd2red_builder_ptr         builder; ///< builder of RED records from RTD records
       red_buffer                  obuffer; ///< Buffer of output raw trigger data (RTD)
       std::shared_ptr<std::mutex> omtx;    ///< Mutex for access to output buffer
+      std::shared_ptr<std::condition_variable> ocond; ///< Condition notified when the output buffer changes
       output_worker_ptr           oworker; ///< RED output worker
 
       builder_pimpl_type()
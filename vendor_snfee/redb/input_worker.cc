@@ -7,6 +7,7 @@ namespace snfee {
     void input_worker::stop()
     {
       _stop_request_ = true;
+      _cond_.notify_all();
       return;
     }
                         
@@ -28,10 +29,12 @@ namespace snfee {
     
     input_worker::input_worker(const int id_,
                                std::mutex & imtx_,
+                               std::condition_variable & icond_,
                                snfee::redb::rtd_buffer & ibuf_,
                                const snfee::redb::builder_config::input_config_type & iconfig_,
                                const datatools::logger::priority logging_)
       : _mtx_(imtx_)
+      , _cond_(icond_)
       , _buf_(ibuf_)
     {
       _logging_ = logging_;
@@ -125,7 +128,7 @@ namespace snfee {
         }
           
         if (!rec.empty()) {
-          std::lock_guard<std::mutex> lock(_mtx_);
+          std::unique_lock<std::mutex> lock(_mtx_);
           DT_LOG_DEBUG(_logging_, "Input buffer #" << _id_ << " is locked by input worker.");
           if (_buf_.can_push()) {
             // DT_LOG_NOTICE(_logging_, "Input worker [" << _id_ << "] run : can push!");  
@@ -136,8 +139,13 @@ namespace snfee {
               _buf_.print(std::cerr);
             }
             rec.reset();
+            _cond_.notify_all();
           } else {
             // DT_LOG_NOTICE(_logging_, "Input worker [" << _id_ << "] run : cannot push!");  
+            // Sleep until the builder pops some records (the timeout only
+            // guards against a stop request issued without notification):
+            _cond_.wait_for(lock, std::chrono::milliseconds(100),
+                            [this] { return _buf_.can_push() or _stop_request_; });
           }
         }
 
@@ -147,6 +155,7 @@ namespace snfee {
           DT_LOG_DEBUG(_logging_, "Input buffer #" << _id_ << " is locked by input worker.");
           DT_LOG_DEBUG(_logging_, "RTD [" << _id_ << "] source is done.");
           _buf_.terminate();
+          _cond_.notify_all();
           DT_LOG_DEBUG(_logging_, "Input buffer #" << _id_ << " is unlocked by input worker.");
           stop();
           if (is_stopped()) {
@@ -155,11 +164,9 @@ namespace snfee {
           }
         }
           
-        DT_LOG_DEBUG(_logging_, "Worker [" << _id_ << "] yields...");
         if (_records_counter_ % 1000 == 0 or is_stopped()) {
           DT_LOG_NOTICE(_logging_, "Input worker [" << _id_ << "] run : " << _records_counter_ << " input records");  
         }
-        std::this_thread::yield();
       } // end of run loop
       DT_LOG_NOTICE(_logging_, "Input worker [" << _id_ << "] run is stopped.");
       DT_LOG_TRACE_EXITING(_logging_);
@@ -23,6 +23,8 @@
 
 // Standard Library:
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <thread>
 #include <memory>
 #include <iostream>
@@ -56,6 +58,7 @@ namespace snfee {
       /// Constructor
       input_worker(const int id_,
                    std::mutex & imtx_,
+                   std::condition_variable & icond_,
                    snfee::redb::rtd_buffer & ibuf_,
                    const builder_config::input_config_type & iconfig_,
                    const datatools::logger::priority logging_ = datatools::logger::PRIO_FATAL);
@@ -76,12 +79,13 @@ namespace snfee {
       datatools::logger::priority _logging_; ///< Logging priority
       int          _id_ = -1; ///< Identifier of the input worker
       std::mutex & _mtx_;     ///< Handle to the mutex associated to the input RTD buffer
+      std::condition_variable & _cond_; ///< Handle to the condition associated to the input RTD buffer
       rtd_buffer & _buf_;     ///< Handle to the input RTD buffer
       bool _accept_unsorted_input_ = false;
       std::shared_ptr<snfee::io::multifile_data_reader> _preader_; ///< Data reader
 
       // Working:
-      bool                        _stop_request_ = false; ///< Control stop
+      std::atomic<bool>           _stop_request_{false}; ///< Control stop
       std::size_t                 _records_counter_ = 0;  ///< Counter of processed RTD records
       
     }; // end of struct input_worker
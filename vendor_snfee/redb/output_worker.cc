@@ -5,10 +5,12 @@ namespace snfee {
   namespace redb {
     
     output_worker::output_worker(std::mutex & omtx_,
+                                 std::condition_variable & ocond_,
                                  red_buffer & obuf_,
                                  const snfee::redb::builder_config::output_config_type & oconfig_,
                                  const datatools::logger::priority logging_)
       : _mtx_(omtx_)
+      , _cond_(ocond_)
       , _buf_(obuf_)
     {
       _logging_ = logging_;
@@ -32,6 +34,7 @@ namespace snfee {
     void output_worker::stop()
     {
       _stop_request_ = true;
+      _cond_.notify_all();
       return;
     }
 
@@ -58,11 +61,18 @@ namespace snfee {
       _stored_records_counter_ = 0;
       while (!_stop_request_) {
         {
-          std::lock_guard<std::mutex> lock(_mtx_);
+          std::unique_lock<std::mutex> lock(_mtx_);
+          // Sleep until the builder feeds or terminates the buffer (the
+          // timeout only guards against a stop request issued without
+          // notification):
+          _cond_.wait_for(lock, std::chrono::milliseconds(100),
+                          [this] { return !_buf_.is_empty() or _buf_.is_terminated() or _stop_request_; });
+          bool popped = false;
           while (!_buf_.is_empty()) {
             DT_LOG_DEBUG(_logging_, "Pop RED record from the output RED buffer...");
             _records_counter_++;
             snfee::io::red_record rec = _buf_.pop_record();
+            popped = true;
             if (!writer_is_terminated and _pwriter_->is_terminated()) {
               writer_is_terminated = true;
               DT_LOG_NOTICE(_logging_, "Output RED writer is now terminated.");
@@ -78,6 +88,9 @@ namespace snfee {
               stop();
             }
           }
+          if (popped) {
+            _cond_.notify_all();
+          }
           if (_buf_.is_empty() && _buf_.is_terminated()) {
             DT_LOG_DEBUG(_logging_, "Output RED buffer is finished.");
             if (datatools::logger::is_debug(_logging_)) {
@@ -92,7 +105,6 @@ namespace snfee {
         if (_records_counter_ % 100 == 0 or is_stopped()) {
           DT_LOG_NOTICE(_logging_, "Output worker run : " << _records_counter_ << " saved RED records");  
         }
-        std::this_thread::yield();
       }
       DT_LOG_NOTICE(_logging_, "Output worker run is stopped.");
       DT_LOG_TRACE_EXITING(_logging_);
@@ -23,6 +23,8 @@
 
 // Standard Library:
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <thread>
 #include <iostream>
 #include <sstream>
@@ -49,6 +51,7 @@ namespace snfee {
       
       /// Constructor
       output_worker(std::mutex & omtx_,
+                    std::condition_variable & ocond_,
                     red_buffer & obuf_,
                     const builder_config::output_config_type & oconfig_,
                     const datatools::logger::priority logging_ = datatools::logger::PRIO_FATAL);
@@ -71,9 +74,10 @@ namespace snfee {
     private:
       
       std::mutex & _mtx_; ///< Mutex for access to the output RED buffer
+      std::condition_variable & _cond_; ///< Condition notified when the output RED buffer changes
       red_buffer & _buf_; ///< Handle to the output RED buffer
       std::shared_ptr<snfee::io::multifile_data_writer> _pwriter_; ///< Data writer
-      bool _stop_request_ = false; ///< Thread stop request
+      std::atomic<bool> _stop_request_{false}; ///< Thread stop request
       datatools::logger::priority _logging_ = datatools::logger::PRIO_FATAL; ///< Logging priority
       std::size_t _records_counter_ = 0; ///< Counter of processed RED records
       std::size_t _stored_records_counter_ = 0; ///< Counter of stored RED records
@@ -19,6 +19,7 @@ namespace snfee {
     void rtd2red_builder::stop()
     {
       _stop_request_ = true;
+      _pimpl_.icond->notify_all();
       return;
     }
 
@@ -386,7 +387,12 @@ namespace snfee {
         // if ((_rtd_records_counter_ % 100 == 0) or is_stopped()) {
         //   DT_LOG_NOTICE(_logging_, "Builder run : " << _rtd_records_counter_ << " built RED records");  
         // }       
-        std::this_thread::yield();
+        {
+          // Sleep until the input buffer changes (the timeout only guards
+          // against a stop request issued without notification):
+          std::unique_lock<std::mutex> lck(*_pimpl_.imtx);
+          _pimpl_.icond->wait_for(lck, std::chrono::milliseconds(100));
+        }
       } // main while loop
         
       red_rec.reset();
@@ -395,6 +401,7 @@ namespace snfee {
         DT_LOG_DEBUG(_logging_, "Output buffer is terminated.");
         _pimpl_.obuffer.terminate();
       }
+      _pimpl_.ocond->notify_all();
         
       DT_LOG_NOTICE(_logging_, "Builder standard algo is done.");
       DT_LOG_TRACE_EXITING(_logging_);
@@ -25,6 +25,7 @@
 #include <set>
 #include <deque>
 #include <iostream>
+#include <atomic>
 
 // This project:
 #include <snfee/data/raw_trigger_data.h>
@@ -80,7 +81,7 @@ namespace snfee {
       builder_config::build_algo_type _algo_ = builder_config::BUILD_ALGO_NONE;
       
       // Working:
-      bool                 _stop_request_ = false;    ///< Thread stop request
+      std::atomic<bool>    _stop_request_{false};    ///< Thread stop request
       int32_t              _event_id_ = snfee::data::INVALID_EVENT_ID;
       std::size_t          _red_records_counter_ = 0; ///< Counter of built RED records
       